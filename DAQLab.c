@@ -48,6 +48,8 @@
 #define DAQLAB_SinkVChan_XML_TAG							"SinkVChan"
 #define DAQLAB_TaskControllerSettings_XML_TAG				"TaskControllerSettings"
 #define DAQLAB_MODULES_XML_TAG								"DAQLab_Modules"
+#define DAQLAB_ThreadPools_XML_TAG							"ThreadPools"
+#define DAQLAB_ThreadPool_XML_TAG							"ThreadPool"
 
 	// number of Task Controllers visible at once. If there are more, a scroll bar appears.
 #define DAQLAB_NVISIBLE_TASKCONTROLLERS						4
@@ -66,6 +68,14 @@
 #define DATAFILEBASEPATH 		"C:\\Rawdata\\"
 #define VChanDataTimeout									1e4					// Timeout in [ms] for Sink VChans to receive data  
 
+	// Pipeline metrics panel
+#define DAQLAB_METRICS_REFRESH_INTERVAL						1.0					// Time in [s] between updates of the pipeline metrics panel.
+#define DAQLAB_METRICS_PAN_HEIGHT							500
+#define DAQLAB_METRICS_PAN_WIDTH							900
+
+	// time in [s] between updates of the Task Controller execution log from the execution trace
+#define DAQLAB_TASKLOG_REFRESH_INTERVAL						0.5
+
 
 
 // Macros
@@ -100,6 +110,7 @@ AvailableDAQLabModules_type DAQLabModules_InitFunctions[] = {	  // set last para
 	{ MOD_LaserScanning_NAME, initalloc_LaserScanning, FALSE, 0},
 	{ MOD_VUPhotonCtr_NAME, initalloc_VUPhotonCtr, FALSE, 0 },
 	{ MOD_DataStorage_NAME, initalloc_DataStorage, FALSE, 0 },
+	{ MOD_DataReplay_NAME, initalloc_DataReplay, FALSE, 0 },
 	{ MOD_Pockells_NAME, initalloc_PockellsModule, FALSE, 0 },
 	{ MOD_CoherentCham_NAME, initalloc_CoherentCham, FALSE, 0}
 };
@@ -163,6 +174,15 @@ typedef struct {
 	BOOL				canBeDeleted;				// If True, node can be deleted from its current position in the tree
             
 } TaskTreeNode_type;
+
+	// Framework thread pool for a given role
+typedef struct {
+	char*					roleName;				// Role name used in DAQLabCfg.xml.
+	int						maxThreads;				// Maximum number of threads in the pool.
+	int						threadPriority;			// Priority of the pool threads, e.g. THREAD_PRIORITY_NORMAL.
+	unsigned int			cpuAffinityMask;		// Processors on which the pool threads may run, or 0 to let the system choose.
+	CmtThreadPoolHandle		poolHndl;				// Pool handle, created by InitThreadPools.
+} DLThreadPool_type;
 	
 
 	
@@ -181,6 +201,9 @@ static int				workspacePanHndl		= 0;		// Main workspace panel handle
 static int				logPanHndl				= 0;		// Log panel handle
 static int				DAQLabModulesPanHndl	= 0;		// Modules list panel handle
 static int				taskLogPanHndl			= 0;		// Log panel for task controller execution
+static int				taskLogTimer			= 0;		// Timer control appending the Task Controller execution trace to the log panel while it is open
+static size_t			taskLogTracePos			= 0;		// Execution trace position up to which Task Controller actions were added to the log panel
+static double			taskLogStartTime		= 0;		// Time in [s] given by Timer() when the log panel was opened
 
 static struct TasksUI_ {									// UI data container for Task Controllers
 	
@@ -201,10 +224,23 @@ static struct TasksUI_ {									// UI data container for Task Controllers
 	
 	int			menuID_Data;
 	int			menuDataItem_Storage;
+	int			menuDataItem_Metrics;
+	int			menuDataItem_Trace;
+	int			menuDataItem_ExportTrace;
 	
 	ListType	UItaskCtrls;								// UI Task Controllers of UITaskCtrl_type*   
 	
-} 						TasksUI						= {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+} 						TasksUI						= {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static struct MetricsUI_ {									// UI data container for the pipeline metrics panel
+	
+	int			panHndl;									// Metrics panel handle, 0 if the panel is not loaded.
+	int			textBox;									// Text box displaying the metrics.
+	int			resetBTTN;									// Resets the VChan and Task Controller metrics.
+	int			exportBTTN;									// Exports the metrics to a CSV file.
+	int			refreshTimer;								// Timer control refreshing the metrics.
+	
+} 						MetricsUI					= {0, 0, 0, 0, 0};
 	
 	// List of modules loaded in the framework. Modules inherit from DAQLabModule_type 
 	// List of DAQLabModule_type* type
@@ -214,10 +250,16 @@ ListType				DAQLabModules				= 0;
 	// List of TaskControl_type* elements
 ListType				DAQLabTCs					= 0;
 
+	// Task Controllers in DAQLabTCs indexed by name
+NameRegistry_type*		DAQLabTCNames				= NULL;
+
 	// Virtual channels from all the modules that register such channels with the framework
 	// List elements of VChan_type* type
 ListType				VChannels					= 0;
 
+	// VChans in VChannels indexed by name
+NameRegistry_type*		VChanNames					= NULL;
+
 	// List of HW Master triggers of HWTrigMaster_type*
 ListType				HWTrigMasters				= 0;
 
@@ -236,8 +278,12 @@ int						HWTrigSwitchboardPanHndl	= 0;
 	// List of Task Tree nodes of TaskTreeNode_type needed to operate the Task Tree Manager 
 ListType				TaskTreeNodes				= 0;
 
-	// Custom thread pool handle
-CmtThreadPoolHandle		DLThreadPoolHndl			= 0;
+	// Framework thread pools indexed by DLThreadPoolRoles. Default settings are used if none are found in DAQLabCfg.xml.
+DLThreadPool_type		DLThreadPools[DL_NThreadPools]	= {	{"Acquisition",		32,		THREAD_PRIORITY_ABOVE_NORMAL,	0,	0},
+															{"Processing",		16,		THREAD_PRIORITY_NORMAL,			0,	0},
+															{"Storage",			4,		THREAD_PRIORITY_NORMAL,			0,	0},
+															{"Replay",			4,		THREAD_PRIORITY_NORMAL,			0,	0},
+															{"UI",				16,		THREAD_PRIORITY_NORMAL,			0,	0}	};
 
 
 
@@ -253,7 +299,7 @@ static int 					DLSaveUITCTaskTree 							(TaskControl_type* taskController, CAO
 
 static int 					SaveVChanConnections 						(ListType VChans, CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
 
-static int 					LoadVChanConnections 						(ListType VChans, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
+static int 					LoadVChanConnections 						(ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
 
 static int 					SaveHWTriggerConnections 					(ListType hwTrigMasters, CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
 
@@ -263,6 +309,20 @@ static int 					ConnectTaskTrees 							(ActiveXMLObj_IXMLDOMElement_ UITCXMLEle
 
 static TaskControl_type*	GetTaskController							(char tcName[]);
 
+static void					UnregisterVChanName							(VChan_type* VChan);
+
+static void					UnregisterTaskControllerName				(TaskControl_type* taskController);
+
+static int 					InitThreadPools 							(void);
+
+static void 				DiscardThreadPools 							(void);
+
+static int 					LoadThreadPoolSettings 						(ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
+
+static void 				LoadThreadPoolSettingsFromFile 				(const char fileName[]);
+
+static int 					SaveThreadPoolSettings 						(CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo);
+
 static int 					DAQLab_NewXMLDOM 							(const char fileName[], CAObjHandle* xmlDOM, ActiveXMLObj_IXMLDOMElement_* rootElement);
 
 static int					DAQLab_SaveXMLDOM 							(const char fileName[], CAObjHandle* xmlDOM);
@@ -279,6 +339,9 @@ static void					DAQLab_RedrawTaskControllerUI				(void);
 
 static void 				UpdateVChanSwitchboard	 					(int panHandle, int tableControlID);
 
+	// Shows a popup menu to set the overflow policy and maximum queued data of the Sink VChan in a VChan Switchboard cell and to view and reset its drop counters
+static void					SinkVChanOverflowPopup						(int panHandle, int tableControlID, int mouseTop, int mouseLeft);
+
 static void 				UpdateHWTriggersSwitchboard					(int panHandle, int tableControlID);
 
 static void CVICALLBACK 	DAQLab_TaskMenu_CB 							(int menuBarHndl, int menuItemID, void *callbackData, int panelHndl);
@@ -289,12 +352,26 @@ void CVICALLBACK 			LogPanTaskLogMenu_CB						(int menuBar, int menuItem, void *
 	// Closes Task log panel and stops logging of active Task Controllers.
 void CVICALLBACK 			TaskLogMenuClose_CB 						(int menuBar, int menuItem, void *callbackData, int panel); 
 
+	// Adds the Task Controller actions recorded in the execution trace to the Task log panel.
+static int CVICALLBACK 		TaskLogTimer_CB 							(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+
 static int					TaskMenu_AddTaskController 					(char** errorMsg);
 
 static void					TaskMenu_DeleteTaskController 				(void);
 
 static void 				TaskMenu_DisplayDataStorage 				(void);
 
+	// Displays live VChan data rates, queue fill, dropped data packets and Task Controller callback latencies.
+static int	 				TaskMenu_DisplayMetrics 					(char** errorMsg);
+
+static void					UpdateMetricsPanel							(void);
+
+static int					ExportMetricsCSV							(char fileName[], char** errorMsg);
+
+static int CVICALLBACK 		MetricsPan_CB 								(int panel, int event, void *callbackData, int eventData1, int eventData2);
+
+static int CVICALLBACK 		MetricsCtrls_CB 							(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+
 static int CVICALLBACK 		TaskControllers_CB 							(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 
 static UITaskCtrl_type*		init_UITaskCtrl_type						(TaskControl_type* taskControl);  	
@@ -363,23 +440,21 @@ INIT_ERR
 	// set main thread sleep policy
 	errChk( SetSleepPolicy(VAL_SLEEP_SOME) );
 	
-	// create custom thread pool
-	errChk( CmtNewThreadPool(UNLIMITED_THREAD_POOL_THREADS, &DLThreadPoolHndl) );
-	
-	// adjust thread pool
-	errChk( CmtSetThreadPoolAttribute(DLThreadPoolHndl, ATTR_TP_PROCESS_EVENTS_WHILE_WAITING, TRUE) );
-	
 	// change ActiveX threading policy
 	CA_InitActiveXThreadStyleForCurrentThread(0, COINIT_APARTMENTTHREADED);
 	
+	// create thread pools before loading the environment, so that they exist for every Task Controller and module even if loading fails
+	LoadThreadPoolSettingsFromFile(DAQLAB_CFG_FILE);
+	errChk( InitThreadPools() );
+	
 	// load DAQLab environment resources
 	DAQLab_Load(); 
 	
 	// run GUI
 	errChk ( RunUserInterface() ); 
 	
-	// discard thread pool
-	errChk( CmtDiscardThreadPool(DLThreadPoolHndl) );
+	// discard thread pools
+	DiscardThreadPools();
 	
 	return 0;
 	
@@ -430,6 +505,8 @@ INIT_ERR
 	nullChk( DAQLabModules   			= ListCreate(sizeof(DAQLabModule_type*)) );		// list with loaded DAQLab modules
 	nullChk( DAQLabTCs					= ListCreate(sizeof(TaskControl_type*)) );		// list with loaded Task Controllers
 	nullChk( VChannels		   			= ListCreate(sizeof(VChan_type*)) );			// list with Virtual Channels
+	nullChk( DAQLabTCNames				= init_NameRegistry_type() );					// Task Controller names
+	nullChk( VChanNames					= init_NameRegistry_type() );					// Virtual Channel names
 	nullChk( HWTrigMasters				= ListCreate(sizeof(HWTrigMaster_type*)) );		// list with Master HW Triggers 
 	nullChk( HWTrigSlaves				= ListCreate(sizeof(HWTrigSlave_type*)) );		// list with Slave HW Triggers
 	
@@ -463,6 +540,9 @@ INIT_ERR
 	// Data storage and display
 	errChk (TasksUI.menuID_Data				= NewMenu(TasksUI.menuBarHndl, "Data", -1) );
 	errChk (TasksUI.menuDataItem_Storage	= NewMenuItem(TasksUI.menuBarHndl, TasksUI.menuID_Data, "Storage", -1, (VAL_MENUKEY_MODIFIER | 'S'), DAQLab_TaskMenu_CB, &TasksUI) );
+	errChk (TasksUI.menuDataItem_Metrics	= NewMenuItem(TasksUI.menuBarHndl, TasksUI.menuID_Data, "Metrics", -1, (VAL_MENUKEY_MODIFIER | 'M'), DAQLab_TaskMenu_CB, &TasksUI) );
+	errChk (TasksUI.menuDataItem_Trace		= NewMenuItem(TasksUI.menuBarHndl, TasksUI.menuID_Data, "Record execution trace", -1, 0, DAQLab_TaskMenu_CB, &TasksUI) );
+	errChk (TasksUI.menuDataItem_ExportTrace	= NewMenuItem(TasksUI.menuBarHndl, TasksUI.menuID_Data, "Export execution trace...", -1, 0, DAQLab_TaskMenu_CB, &TasksUI) );
 	
 	// get height and width of Task Controller panel
 	GetPanelAttribute(TasksUI.controllerPanHndl, ATTR_HEIGHT, &TasksUI.controllerPanHeight);
@@ -503,7 +583,7 @@ INIT_ERR
 		XMLErrChk ( ActiveXML_IXMLDOMNodeList_Getitem(UITaskControllersXMLNodeList, &xmlErrorInfo, i, &UITaskControllerXMLNode) );
 		
 		// create a new default UI Task Controller
-		newTaskController = init_TaskControl_type ("", NULL, DLThreadPoolHndl, ConfigureUITC, UnconfigureUITC, IterateUITC, StartUITC, 
+		newTaskController = init_TaskControl_type ("", NULL, DLGetThreadPoolHndl(DL_ThreadPool_UI), ConfigureUITC, UnconfigureUITC, IterateUITC, StartUITC, 
 												 	  ResetUITC, DoneUITC, StoppedUITC, NULL, TaskTreeStateChangeUITC, UITCActive, NULL, ErrorUITC); // module data added to the task controller below
 		
 		errChk( DLLoadTaskControllerSettingsFromXML(newTaskController, (ActiveXMLObj_IXMLDOMElement_)UITaskControllerXMLNode, &xmlErrorInfo) );
@@ -620,7 +700,7 @@ INIT_ERR
 	// Connect VChans
 	//---------------------------------------------------------------------------------------------------------------------------------------------------------
 	
-	errChk( LoadVChanConnections(VChannels, DAQLabCfg_RootElement, &xmlErrorInfo) );
+	errChk( LoadVChanConnections(DAQLabCfg_RootElement, &xmlErrorInfo) );
 	
 	//---------------------------------------------------------------------------------------------------------------------------------------------------------
 	// Connect HW Triggers
@@ -644,6 +724,8 @@ Error:
 	OKfreeList(&DAQLabModules, NULL);
 	OKfreeList(&DAQLabTCs, NULL);
 	OKfreeList(&VChannels, NULL);
+	discard_NameRegistry_type(&DAQLabTCNames);
+	discard_NameRegistry_type(&VChanNames);
 	OKfreeList(&HWTrigMasters, NULL);
 	OKfreeList(&HWTrigSlaves, NULL);
 	
@@ -688,6 +770,12 @@ INIT_ERR
 	
 	errChk( DLAddToXMLElem (DAQLabCfg_DOMHndl, DAQLabCfg_RootElement, attr1, DL_ATTRIBUTE, NumElem(attr1), &xmlErrorInfo) );
 	
+	//---------------------------------------------------------------------------------------------------------------------------------------------------------
+	// Save thread pool settings
+	//---------------------------------------------------------------------------------------------------------------------------------------------------------
+	
+	errChk( SaveThreadPoolSettings(DAQLabCfg_DOMHndl, DAQLabCfg_RootElement, &xmlErrorInfo) );
+	
 	//---------------------------------------------------------------------------------------------------------------------------------------------------------
 	// Save UI Task Controllers
 	//---------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -841,6 +929,8 @@ INIT_ERR
 	SinkVChan_type*						sinkVChan					= NULL;
 	ListType							sinkVChans					= 0;   // of SinkVChan_type* elements
 	size_t								nSinkVChans					= 0;
+	unsigned int						overflowPolicy				= 0;
+	unsigned long long					maxQueuedBytes				= 0;
 	
 	
 	// create Switchboard xml element
@@ -866,7 +956,11 @@ INIT_ERR
 			// create sink VChan xml element
 			errChk( ActiveXML_IXMLDOMDocument3_createElement (xmlDOM, xmlErrorInfo, DAQLAB_SinkVChan_XML_TAG, &sinkVChanXMLElement) );
 			nullChk( sinkVChanName = GetVChanName((VChan_type*)sinkVChan) );
-			DAQLabXMLNode sinkVChanAttr[] = { {"Name",		BasicData_CString,		sinkVChanName} };
+			overflowPolicy = (unsigned int) GetSinkVChanOverflowPolicy(sinkVChan);
+			maxQueuedBytes = (unsigned long long) GetSinkVChanMaxQueuedBytes(sinkVChan);
+			DAQLabXMLNode sinkVChanAttr[] = { {"Name",				BasicData_CString,		sinkVChanName},
+											  {"OverflowPolicy",	BasicData_UInt,			&overflowPolicy},
+											  {"MaxQueuedBytes",	BasicData_UInt64,		&maxQueuedBytes} };
 			// add attributes to sink VChan xml element
 			errChk( DLAddToXMLElem(xmlDOM, sinkVChanXMLElement, sinkVChanAttr, DL_ATTRIBUTE, NumElem(sinkVChanAttr), xmlErrorInfo) );
 			// add Sink VChan xml element to Source VChan xml element
@@ -1068,7 +1162,7 @@ Error:
 	return errorInfo.error;
 }
 
-static int LoadVChanConnections (ListType VChans, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo)
+static int LoadVChanConnections (ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo)
 {
 #define  LoadVChanConnections_Err_WrongVChanDataFlow				-2
 #define  LoadVChanConnections_Err_VChansCouldNotBeConnected			-3
@@ -1087,6 +1181,8 @@ INIT_ERR
 	VChan_type*							vChan						= NULL;
 	SourceVChan_type*					sourceVChan					= NULL;
 	SinkVChan_type*						sinkVChan					= NULL;
+	unsigned int						overflowPolicy				= 0;
+	unsigned long long					maxQueuedBytes				= 0;
 	
 	// get Switchboard xml element from parent xml element
 	errChk( DLGetSingleXMLElementFromElement(parentXMLElement, DAQLAB_Switchboard_XML_TAG, &switchboardXMLElement) );
@@ -1103,7 +1199,7 @@ INIT_ERR
 		errChk( DLGetXMLElementAttributes("", (ActiveXMLObj_IXMLDOMElement_)sourceVChanXMLNode, sourceVChanAttr, NumElem(sourceVChanAttr)) );
 		
 		// check if Source VChan with given name exists in DAQLab, if not, check another Source VChan
-		if (!(vChan = VChanNameExists(VChans, sourceVChanName, 0))) {
+		if (!(vChan = DLVChanNameExists(sourceVChanName, 0))) {
 			OKfreeCAHndl(sourceVChanXMLNode);
 			OKfree(sourceVChanName);
 			continue;
@@ -1127,7 +1223,7 @@ INIT_ERR
 			errChk( DLGetXMLElementAttributes("", (ActiveXMLObj_IXMLDOMElement_)sinkVChanXMLNode, sinkVChanAttr, NumElem(sinkVChanAttr)) );
 		
 			// check if Sink VChan with given name exists in DAQLab, if not, check another Sink VChan
-			if (!(vChan = VChanNameExists(VChans, sinkVChanName, 0))) {
+			if (!(vChan = DLVChanNameExists(sinkVChanName, 0))) {
 				OKfreeCAHndl(sinkVChanXMLNode);
 				OKfree(sinkVChanName);
 				continue;
@@ -1145,6 +1241,16 @@ INIT_ERR
 				goto Error;
 			}
 			
+			// apply Sink VChan overflow settings, keeping the settings made by the module if they were not saved
+			overflowPolicy = (unsigned int) GetSinkVChanOverflowPolicy(sinkVChan);
+			maxQueuedBytes = (unsigned long long) GetSinkVChanMaxQueuedBytes(sinkVChan);
+			DAQLabXMLNode sinkVChanOverflowAttr[] = { {"OverflowPolicy",	BasicData_UInt,			&overflowPolicy},
+													  {"MaxQueuedBytes",	BasicData_UInt64,		&maxQueuedBytes} };
+			errChk( DLGetXMLElementAttributes("", (ActiveXMLObj_IXMLDOMElement_)sinkVChanXMLNode, sinkVChanOverflowAttr, NumElem(sinkVChanOverflowAttr)) );
+			if (overflowPolicy <= SinkVChan_LatestOnly)
+				SetSinkVChanOverflowPolicy(sinkVChan, (SinkVChanOverflowPolicies) overflowPolicy);
+			SetSinkVChanMaxQueuedBytes(sinkVChan, (size_t) maxQueuedBytes);
+			
 			// cleanup
 			OKfreeCAHndl(sinkVChanXMLNode);
 			OKfree(sinkVChanName);
@@ -1258,21 +1364,7 @@ RETURN_ERR
 
 static TaskControl_type* GetTaskController (char tcName[])
 {
-	size_t				nTCs				= ListNumItems(DAQLabTCs);
-	TaskControl_type*	taskController		= NULL;
-	char*				existingTCName		= NULL;
-	
-	for (size_t i = 1; i <= nTCs; i++) {
-		taskController = *(TaskControl_type**) ListGetPtrToItem(DAQLabTCs, i);
-		existingTCName = GetTaskControlName(taskController);
-		if (!strcmp(existingTCName, tcName)) {
-			OKfree(existingTCName);
-			return taskController;	 	// found
-		}
-		OKfree(existingTCName);
-	}
-	
-	return NULL; 						// not found
+	return NameRegistryFind(DAQLabTCNames, tcName);
 }
 
 static int DAQLab_Close (void)
@@ -1303,12 +1395,14 @@ INIT_ERR
 
 	// discard Task Controller list
 	ListDispose(DAQLabTCs);
+	discard_NameRegistry_type(&DAQLabTCNames);
 	
 	// discard Task Tree node list
 	if (TaskTreeNodes) ListDispose(TaskTreeNodes);
 	
 	// discard VChans list
 	if (VChannels) ListDispose(VChannels);
+	discard_NameRegistry_type(&VChanNames);
 	
 	// discard HW Trigger lists
 	if (HWTrigMasters) ListDispose(HWTrigMasters);
@@ -1437,15 +1531,23 @@ BOOL DLRegisterVChan (DAQLabModule_type* mod, VChan_type* VChan)
 {
 	if (!VChan) return FALSE;
 	
-	// check if VChan name is unique
-	char*			VChanName;
-	VChan_type*		existingVChan;
-	existingVChan = DLVChanNameExists((VChanName = GetVChanName(VChan)), 0);
-	OKfree(VChanName);
-	if (existingVChan) return FALSE; // there is already a VChan with the same name
+	// register VChan name, this fails if there is already a VChan with the same name
+	char*			VChanName	= GetVChanName(VChan);
+	int				error		= (VChanName)? NameRegistryAdd(VChanNames, VChanName, VChan) : NameRegistry_Err_OutOfMemory;
+	
+	if (error) {
+		OKfree(VChanName);
+		return FALSE;
+	}
 	
 	// add VChan to framework
-	if (!ListInsertItem(VChannels, &VChan, END_OF_LIST)) return FALSE;
+	if (!ListInsertItem(VChannels, &VChan, END_OF_LIST)) {
+		NameRegistryRemove(VChanNames, VChanName);
+		OKfree(VChanName);
+		return FALSE;
+	}
+	OKfree(VChanName);
+	
 	// add VChan to module list of VChans
 	if (mod)
 		if (!ListInsertItem(mod->VChans, &VChan, END_OF_LIST)) return FALSE;
@@ -1474,6 +1576,7 @@ int DLUnregisterVChan (DAQLabModule_type* mod, VChan_type* VChan)
 	ListRemoveItem(mod->VChans, 0, ModItemPos);
 	// remove VChan from framework list
 	ListRemoveItem(VChannels, 0, DLItemPos);
+	UnregisterVChanName(VChan);
 	// update UI
 	UpdateVChanSwitchboard(VChanSwitchboardPanHndl, VChanTab_Switchboard);
 	
@@ -1498,6 +1601,7 @@ void DLUnregisterModuleVChans (DAQLabModule_type* mod)
 		// remove VChan from framework list
 		DLVChanExists(*VChanPtr, &DLItemPos);
 		ListRemoveItem(VChannels, 0, DLItemPos);
+		UnregisterVChanName(*VChanPtr);
 	}
 	ListClear(mod->VChans);
 	// update UI
@@ -1518,7 +1622,24 @@ BOOL DLVChanExists (VChan_type* VChan, size_t* idx)
 /// HIRET Pointer is valid until another call to DLRegisterVChan or DLUnregisterVChan. 
 VChan_type* DLVChanNameExists (char VChanName[], size_t* idx)
 {
-	return VChanNameExists (VChannels, VChanName, idx); 
+	// the list index can only be found by searching the list
+	if (idx) return VChanNameExists (VChannels, VChanName, idx);
+	
+	return NameRegistryFind(VChanNames, VChanName);
+}
+
+/// HIFN Removes the name of a VChan from the framework VChan names.
+static void UnregisterVChanName (VChan_type* VChan)
+{
+	char*	VChanName = GetVChanName(VChan);
+	
+	if (!VChanName) return;
+	
+	// remove name only if it is registered for this VChan
+	if (NameRegistryFind(VChanNames, VChanName) == VChan)
+		NameRegistryRemove(VChanNames, VChanName);
+	
+	OKfree(VChanName);
 }
 
 /// HIFN Generates a VChan Name having the form "ModuleInstanceName: TaskControllerName: VChanName idx".
@@ -1581,9 +1702,20 @@ BOOL DLValidateVChanName (char newVChanName[], void* null)
 /// HIRET True if renaming was successful, False otherwise.
 BOOL DLRenameVChan (VChan_type* VChan, char newName[])
 {
+	char*	oldName = NULL;
+	
 	// validate new VChan name
 	if (!DLValidateVChanName(newName, NULL)) return FALSE;
 	
+	// update registered name if the VChan is registered with the framework
+	if (!(oldName = GetVChanName(VChan))) return FALSE;
+	if (NameRegistryFind(VChanNames, oldName) == VChan)
+		if (NameRegistryRename(VChanNames, oldName, newName) < 0) {
+			OKfree(oldName);
+			return FALSE;
+		}
+	OKfree(oldName);
+	
 	// assign new name
 	SetVChanName(VChan, newName);
 	
@@ -2516,8 +2648,12 @@ RETURN_ERR
 /// HIRET True if all Task Controllers were removed successfully or if there are no Task Controllers to be removed, False otherwise.
 BOOL DLRemoveTaskControllers (DAQLabModule_type* mod, ListType tcList)
 {
+	size_t	nTCs = ListNumItems(tcList);
+	
 	// remove from the framework list
 	RemoveTaskControllersFromList(DAQLabTCs, tcList);
+	for (size_t i = 1; i <= nTCs; i++)
+		UnregisterTaskControllerName(*(TaskControl_type**)ListGetPtrToItem(tcList, i));
 	
 	// remove from the module's list of Task Controllers
 	if (mod)
@@ -2538,6 +2674,7 @@ BOOL DLRemoveTaskController (DAQLabModule_type* mod, TaskControl_type* taskContr
 	
 	// remove from the framework list
 	RemoveTaskControllerFromList(DAQLabTCs, taskController);
+	UnregisterTaskControllerName(taskController);
 	
 	// update Task Tree if it is displayed
 	if (TaskTreeManagerPanHndl)
@@ -2546,9 +2683,189 @@ BOOL DLRemoveTaskController (DAQLabModule_type* mod, TaskControl_type* taskContr
 	return TRUE;
 }
 
+CmtThreadPoolHandle	DLGetThreadPoolHndl (DLThreadPoolRoles role)
+{
+	if (role < 0 || role >= DL_NThreadPools) return DLThreadPools[DL_ThreadPool_Acquisition].poolHndl;
+	
+	return DLThreadPools[role].poolHndl;
+}
+
 CmtThreadPoolHandle	DLGetCommonThreadPoolHndl (void)
 {
-	return DLThreadPoolHndl;
+	return DLThreadPools[DL_ThreadPool_Acquisition].poolHndl;
+}
+
+void CVICALLBACK DLThreadPoolFunctionCallback (CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void *callbackData)
+{
+	if (event != EVENT_TP_THREAD_FUNCTION_BEGIN) return;
+	
+	// pool threads are reused, therefore the affinity is applied each time a function starts
+	for (int i = 0; i < DL_NThreadPools; i++)
+		if (DLThreadPools[i].poolHndl == poolHandle) {
+			if (DLThreadPools[i].cpuAffinityMask)
+				SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)DLThreadPools[i].cpuAffinityMask);
+			break;
+		}
+}
+
+/// HIFN Creates the framework thread pools using the settings in DLThreadPools.
+static int InitThreadPools (void)
+{
+INIT_ERR
+	
+	for (int i = 0; i < DL_NThreadPools; i++) {
+		if (DLThreadPools[i].poolHndl) continue;
+		
+		errChk( CmtNewThreadPool(DLThreadPools[i].maxThreads, &DLThreadPools[i].poolHndl) );
+		errChk( CmtSetThreadPoolAttribute(DLThreadPools[i].poolHndl, ATTR_TP_PROCESS_EVENTS_WHILE_WAITING, TRUE) );
+		errChk( CmtSetThreadPoolAttribute(DLThreadPools[i].poolHndl, ATTR_TP_THREAD_PRIORITY, DLThreadPools[i].threadPriority) );
+	}
+	
+	return 0;
+	
+Error:
+	
+	DiscardThreadPools();
+	
+	return errorInfo.error;
+}
+
+/// HIFN Discards the framework thread pools, waiting for the functions running in them to complete.
+static void DiscardThreadPools (void)
+{
+	for (int i = 0; i < DL_NThreadPools; i++)
+		if (DLThreadPools[i].poolHndl) {
+			CmtDiscardThreadPool(DLThreadPools[i].poolHndl);
+			DLThreadPools[i].poolHndl = 0;
+		}
+}
+
+static int LoadThreadPoolSettings (ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo)
+{
+INIT_ERR
+	
+	ActiveXMLObj_IXMLDOMElement_ 		threadPoolsXMLElement   	= 0;
+	ActiveXMLObj_IXMLDOMNode_			threadPoolXMLNode			= 0;
+	ActiveXMLObj_IXMLDOMNodeList_		threadPoolXMLNodeList		= 0;
+	long								nThreadPools				= 0;
+	char*								roleName					= NULL;
+	DLThreadPool_type*					threadPool					= NULL;
+	int									maxThreads					= 0;
+	
+	
+	// get ThreadPools xml element from parent xml element, if missing, keep the default settings
+	errChk( DLGetSingleXMLElementFromElement(parentXMLElement, DAQLAB_ThreadPools_XML_TAG, &threadPoolsXMLElement) );
+	if (!threadPoolsXMLElement) return 0;
+	
+	errChk ( ActiveXML_IXMLDOMElement_getElementsByTagName(threadPoolsXMLElement, xmlErrorInfo, DAQLAB_ThreadPool_XML_TAG, &threadPoolXMLNodeList) );
+	errChk ( ActiveXML_IXMLDOMNodeList_Getlength(threadPoolXMLNodeList, xmlErrorInfo, &nThreadPools) );
+	for (long i = 0; i < nThreadPools; i++) {
+		errChk ( ActiveXML_IXMLDOMNodeList_Getitem(threadPoolXMLNodeList, xmlErrorInfo, i, &threadPoolXMLNode) );
+		DAQLabXMLNode roleAttr[] = { {"Role",		BasicData_CString,		&roleName} };
+		errChk( DLGetXMLElementAttributes("", (ActiveXMLObj_IXMLDOMElement_)threadPoolXMLNode, roleAttr, NumElem(roleAttr)) );
+		
+		// find thread pool with matching role, ignore unknown roles
+		threadPool = NULL;
+		for (int j = 0; j < DL_NThreadPools; j++)
+			if (roleName && !strcmp(roleName, DLThreadPools[j].roleName)) {
+				threadPool = &DLThreadPools[j];
+				break;
+			}
+		
+		// apply settings, attributes that are missing keep their default values
+		if (threadPool) {
+			maxThreads = threadPool->maxThreads;
+			DAQLabXMLNode threadPoolAttr[] = {	{"MaxThreads",			BasicData_Int,			&maxThreads},
+												{"Priority",			BasicData_Int,			&threadPool->threadPriority},
+												{"CPUAffinityMask",		BasicData_UInt,			&threadPool->cpuAffinityMask} };
+			
+			errChk( DLGetXMLElementAttributes("", (ActiveXMLObj_IXMLDOMElement_)threadPoolXMLNode, threadPoolAttr, NumElem(threadPoolAttr)) );
+			if (maxThreads > 0) threadPool->maxThreads = maxThreads;
+		}
+		
+		// cleanup
+		OKfreeCAHndl(threadPoolXMLNode);
+		OKfree(roleName);
+	}
+	
+	// cleanup
+	OKfreeCAHndl(threadPoolXMLNodeList);
+	OKfreeCAHndl(threadPoolsXMLElement);
+	
+	return 0;
+	
+Error:
+	
+	OKfreeCAHndl(threadPoolsXMLElement);
+	OKfreeCAHndl(threadPoolXMLNode);
+	OKfreeCAHndl(threadPoolXMLNodeList);
+	OKfree(roleName);
+	
+	return errorInfo.error;
+}
+
+/// HIFN Loads the thread pool settings from the DAQLab XML config file before the DAQLab environment is loaded. If the file or settings are missing, the default settings are kept.
+static void LoadThreadPoolSettingsFromFile (const char fileName[])
+{
+	CAObjHandle							xmlDOM						= 0;
+	ActiveXMLObj_IXMLDOMElement_		rootElement					= 0;
+	ERRORINFO							xmlErrorInfo;
+	VBOOL								xmlLoaded					= VFALSE;
+	BSTR								bstrFileName				= NULL;
+	char*								rootElementName				= NULL;
+	
+	
+	if (ActiveXML_NewDOMDocument60IXMLDOMDocument3_(NULL, 1, LOCALE_NEUTRAL, 0, &xmlDOM) < 0) return;
+	
+	CA_CStringToBSTR(fileName, &bstrFileName);
+	ActiveXML_IXMLDOMDocument3_load(xmlDOM, &xmlErrorInfo, CA_VariantBSTR(bstrFileName), &xmlLoaded);
+	
+	// settings are applied only from a DAQLab config file, errors are reported when the file is loaded again by DAQLab_Load
+	if (xmlLoaded == VTRUE && ActiveXML_IXMLDOMDocument3_GetdocumentElement(xmlDOM, &xmlErrorInfo, &rootElement) >= 0 && rootElement &&
+		ActiveXML_IXMLDOMElement_GettagName(rootElement, &xmlErrorInfo, &rootElementName) >= 0 && rootElementName && !strcmp(rootElementName, DAQLAB_CFG_DOM_ROOT_NAME))
+		LoadThreadPoolSettings(rootElement, &xmlErrorInfo);
+	
+	CA_FreeMemory(rootElementName);
+	CA_FreeBSTR(bstrFileName);
+	OKfreeCAHndl(rootElement);
+	OKfreeCAHndl(xmlDOM);
+}
+
+static int SaveThreadPoolSettings (CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ parentXMLElement, ERRORINFO* xmlErrorInfo)
+{
+INIT_ERR
+	
+	ActiveXMLObj_IXMLDOMElement_ 		threadPoolsXMLElement   	= 0;
+	ActiveXMLObj_IXMLDOMElement_ 		threadPoolXMLElement   		= 0;
+	
+	
+	// create ThreadPools xml element
+	errChk( ActiveXML_IXMLDOMDocument3_createElement (xmlDOM, xmlErrorInfo, DAQLAB_ThreadPools_XML_TAG, &threadPoolsXMLElement) );
+	
+	for (int i = 0; i < DL_NThreadPools; i++) {
+		errChk( ActiveXML_IXMLDOMDocument3_createElement (xmlDOM, xmlErrorInfo, DAQLAB_ThreadPool_XML_TAG, &threadPoolXMLElement) );
+		DAQLabXMLNode threadPoolAttr[] = {	{"Role",				BasicData_CString,		DLThreadPools[i].roleName},
+											{"MaxThreads",			BasicData_Int,			&DLThreadPools[i].maxThreads},
+											{"Priority",			BasicData_Int,			&DLThreadPools[i].threadPriority},
+											{"CPUAffinityMask",		BasicData_UInt,			&DLThreadPools[i].cpuAffinityMask} };
+		
+		errChk( DLAddToXMLElem(xmlDOM, threadPoolXMLElement, threadPoolAttr, DL_ATTRIBUTE, NumElem(threadPoolAttr), xmlErrorInfo) );
+		errChk( ActiveXML_IXMLDOMElement_appendChild (threadPoolsXMLElement, xmlErrorInfo, threadPoolXMLElement, NULL) );
+		OKfreeCAHndl(threadPoolXMLElement);
+	}
+	
+	// add ThreadPools xml element to parent xml element
+	errChk( ActiveXML_IXMLDOMElement_appendChild (parentXMLElement, xmlErrorInfo, threadPoolsXMLElement, NULL) );
+	OKfreeCAHndl(threadPoolsXMLElement);
+	
+	return 0;
+	
+Error:
+	
+	OKfreeCAHndl(threadPoolsXMLElement);
+	OKfreeCAHndl(threadPoolXMLElement);
+	
+	return errorInfo.error;
 }
 
 /// HIFN Adds a list of Task Controllers provided by tcList as TaskControl_type* list elements to the DAQLab framework if their names are unique.
@@ -2556,56 +2873,38 @@ CmtThreadPoolHandle	DLGetCommonThreadPoolHndl (void)
 /// HIRET FALSE if Task Controller names in tcList and the framework are not unique.
 BOOL DLAddTaskControllers (DAQLabModule_type* mod, ListType tcList)
 {
-	ListType 			tcNamesList 	= ListCreate(sizeof(char*));
 	size_t				nTCs			= ListNumItems(tcList);
-	char*				tcName;
-	char**				tcNamePtr;
-	TaskControl_type**  tcPtr;
-	size_t				tcNameIdx;
+	char*				tcName			= NULL;
+	TaskControl_type**  tcPtr			= NULL;
 	
 	if (!nTCs) return TRUE;
 	
 	//---------------------------------------------------------
-	// check if the provided Task Controllers have unique names
+	// register Task Controller names
 	//---------------------------------------------------------
 	
-	// build up list with Task Controller names
+	// registering fails if names are not unique among themselves or within the framework
 	for (size_t i = 1; i <= nTCs; i++) {
 		tcPtr = ListGetPtrToItem(tcList, i);
 		tcName = GetTaskControlName(*tcPtr);
-		ListInsertItem(tcNamesList, &tcName, END_OF_LIST);
-	}
-	// check if names are unique among themselves
-	if (!DLUniqueStrings(tcNamesList, &tcNameIdx)) {
-		tcNamePtr = ListGetPtrToItem(tcNamesList, tcNameIdx);
-		DAQLab_Msg(DAQLAB_MSG_ERR_NOT_UNIQUE_TASKCONTROLLER_NAME, *tcNamePtr, NULL, NULL, NULL);	
-		ListDisposePtrList(tcNamesList);
-		return FALSE;	
-	}
-	
-	// check if names are unique within the framework
-	for (size_t i = 1; i <= nTCs; i++) {
-		tcNamePtr = ListGetPtrToItem(tcNamesList, i);
-		if (!DLValidTaskControllerName(*tcNamePtr)) {
-			DAQLab_Msg(DAQLAB_MSG_ERR_NOT_UNIQUE_TASKCONTROLLER_NAME, *tcNamePtr, NULL, NULL, NULL);	
+		if (!tcName || NameRegistryAdd(DAQLabTCNames, tcName, *tcPtr) < 0) {
+			if (tcName)
+				DAQLab_Msg(DAQLAB_MSG_ERR_NOT_UNIQUE_TASKCONTROLLER_NAME, tcName, NULL, NULL, NULL);
+			OKfree(tcName);
+			// undo registration of previous Task Controllers
+			for (size_t j = 1; j < i; j++)
+				UnregisterTaskControllerName(*(TaskControl_type**)ListGetPtrToItem(tcList, j));
 			return FALSE;
 		}
+		OKfree(tcName);
 	}
 	
-	ListDispose(tcNamesList);  
-	
 	// add Task Controllers to the module's list of Task Controllers if they belong to a module
 	if (mod)
 		ListAppend(mod->taskControllers, tcList);
 	// add Task Controllers to the framework
 	ListAppend(DAQLabTCs, tcList);
 	
-	// add UI resources for task controller execution logging
-	for (size_t i = 1; i <= nTCs; i++) {
-		tcPtr = ListGetPtrToItem(tcList, i);
-		SetTaskControlUILoggingInfo(*tcPtr, taskLogPanHndl, TaskLogPan_LogBox);
-	}
-	
 	// update Task Tree if it is displayed
 	if (TaskTreeManagerPanHndl)
 		DisplayTaskTreeManager(workspacePanHndl, TasksUI.UItaskCtrls, DAQLabModules);
@@ -2617,9 +2916,10 @@ BOOL DLAddTaskControllers (DAQLabModule_type* mod, ListType tcList)
 /// HIRET TRUE if successful, FALSE if the provided Task Controller name is not unique within the framework.
 BOOL DLAddTaskController (DAQLabModule_type* mod, TaskControl_type* taskController)
 {
-	// check if Task Controller name is unique
+	// register Task Controller name, this fails if the name is not unique
 	char* tcName = GetTaskControlName(taskController);
-	if (!DLValidTaskControllerName(tcName)) {
+	if (!tcName) return FALSE;
+	if (NameRegistryAdd(DAQLabTCNames, tcName, taskController) < 0) {
 		DAQLab_Msg(DAQLAB_MSG_ERR_NOT_UNIQUE_TASKCONTROLLER_NAME, tcName, NULL, NULL, NULL);
 		OKfree(tcName);
 		return FALSE;
@@ -2633,9 +2933,6 @@ BOOL DLAddTaskController (DAQLabModule_type* mod, TaskControl_type* taskControll
 	// add Task Controller to the framework's list of Task Controllers
 	ListInsertItem(DAQLabTCs, &taskController, END_OF_LIST);
 	
-	// add UI resources for task controller execution logging     
-	SetTaskControlUILoggingInfo(taskController, taskLogPanHndl, TaskLogPan_LogBox);  
-	
 	// update the Task Tree if it is displayed
 	if (TaskTreeManagerPanHndl)
 		DisplayTaskTreeManager(workspacePanHndl, TasksUI.UItaskCtrls, DAQLabModules);
@@ -2717,6 +3014,7 @@ static void UpdateVChanSwitchboard (int panHandle, int tableControlID)
 	char*					VChanName				= NULL;
 	int 					rowLabelWidth;
 	int						maxRowLabelWidth		= 0;
+	size_t					nDroppedPackets			= 0;
 	
 	if (!panHandle) return; // do nothing if panel is not loaded or list is not initialized
 	if (!VChannels) return;
@@ -2771,9 +3069,12 @@ static void UpdateVChanSwitchboard (int panHandle, int tableControlID)
 			cell.x = idx;	 // column
 			cell.y = nRows;  // row
 			sinkVChan = *(SinkVChan_type**)ListGetPtrToItem(GetSinkVChanList(srcVChan), idx);
+			GetSinkVChanDropCounters(sinkVChan, &nDroppedPackets, NULL);
 			
-			
-			if (IsVChanOpen((VChan_type*)sinkVChan))
+			// mark Sink VChans that dropped data packets, the drop counters are listed in the task log and in the popup menu of the cell
+			if (nDroppedPackets)
+				SetTableCellAttribute(panHandle, tableControlID, cell, ATTR_TEXT_COLOR, VAL_DK_YELLOW);
+			else if (IsVChanOpen((VChan_type*)sinkVChan))
 				SetTableCellAttribute(panHandle, tableControlID, cell, ATTR_TEXT_COLOR, VAL_DK_GREEN);
 			else
 				SetTableCellAttribute(panHandle, tableControlID, cell, ATTR_TEXT_COLOR, VAL_DK_RED);
@@ -2990,6 +3291,12 @@ static void UpdateHWTriggersSwitchboard (int panHandle, int tableControlID)
 // callback to operate the VChan switchboard
 int CVICALLBACK VChanSwitchboard_CB (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
 {
+	// right click on a Sink VChan shows its overflow settings
+	if (event == EVENT_RIGHT_CLICK) {
+		SinkVChanOverflowPopup(panel, control, eventData1, eventData2);
+		return 0;
+	}
+	
 	if (event != EVENT_COMMIT) return 0; // continue only if event is commit
 	
 	// eventData1 - 1-based row index
@@ -3007,7 +3314,7 @@ int CVICALLBACK VChanSwitchboard_CB (int panel, int control, int event, void *ca
 	if (!sourceVChanName) return 0;
 	
 	GetTableRowAttribute(panel, control, eventData1, ATTR_LABEL_TEXT, sourceVChanName);
-	sourceVChan = (SourceVChan_type*)VChanNameExists (VChannels, sourceVChanName, 0);
+	sourceVChan = (SourceVChan_type*)DLVChanNameExists(sourceVChanName, 0);
 	// read in new sink VChan name from the ring control
 	cell.x = eventData2;
 	cell.y = eventData1;
@@ -3027,7 +3334,7 @@ int CVICALLBACK VChanSwitchboard_CB (int panel, int control, int event, void *ca
 		
 	// reconnect new Sink VChan to the Source Vchan
 	if (strcmp(sinkVChanName, "")) {
-		sinkVChan =	(SinkVChan_type*)VChanNameExists(VChannels, sinkVChanName, 0);
+		sinkVChan =	(SinkVChan_type*)DLVChanNameExists(sinkVChanName, 0);
 		VChan_Connect(sourceVChan, sinkVChan);
 	}
 			
@@ -3040,6 +3347,104 @@ int CVICALLBACK VChanSwitchboard_CB (int panel, int control, int event, void *ca
 	return 0;
 }
 
+static void SinkVChanOverflowPopup (int panHandle, int tableControlID, int mouseTop, int mouseLeft)
+{
+	static char*				policyNames[]						= {"Block when full", "Drop newest", "Drop oldest", "Keep latest only"};	// in SinkVChanOverflowPolicies order
+	
+	SourceVChan_type*			sourceVChan							= NULL;
+	SinkVChan_type*				sinkVChan							= NULL;
+	char*						sourceVChanName						= NULL;
+	int							nChars								= 0;
+	Point						cell;
+	int							menuBarHndl							= 0;
+	int							menuID								= 0;
+	int							policyItems[NumElem(policyNames)];
+	int							maxBytesItem						= 0;
+	int							dropItem							= 0;
+	int							resetItem							= 0;
+	int							selectedItem						= 0;
+	SinkVChanOverflowPolicies	policy								= SinkVChan_Block;
+	size_t						maxQueuedBytes						= 0;
+	size_t						nDroppedPackets						= 0;
+	unsigned long long			nDroppedBytes						= 0;
+	char						itemName[100]						= "";
+	char						maxMBStr[50]						= "";
+	double						maxMB								= 0;
+	char*						endPtr								= NULL;
+	
+	// find Sink VChan in the clicked cell
+	GetTableCellFromPoint(panHandle, tableControlID, MakePoint(mouseLeft, mouseTop), &cell);
+	if (cell.x <= 0 || cell.y <= 0) return;
+	
+	GetTableRowAttribute(panHandle, tableControlID, cell.y, ATTR_LABEL_TEXT_LENGTH, &nChars);
+	sourceVChanName = malloc((nChars+1) * sizeof(char));
+	if (!sourceVChanName) return;
+	
+	GetTableRowAttribute(panHandle, tableControlID, cell.y, ATTR_LABEL_TEXT, sourceVChanName);
+	sourceVChan = (SourceVChan_type*)DLVChanNameExists(sourceVChanName, 0);
+	OKfree(sourceVChanName);
+	
+	if (!sourceVChan || cell.x > (int) GetNSinkVChans(sourceVChan)) return;
+	
+	sinkVChan		= GetSinkVChan(sourceVChan, cell.x);
+	policy			= GetSinkVChanOverflowPolicy(sinkVChan);
+	maxQueuedBytes	= GetSinkVChanMaxQueuedBytes(sinkVChan);
+	GetSinkVChanDropCounters(sinkVChan, &nDroppedPackets, &nDroppedBytes);
+	
+	// build popup menu
+	if ((menuBarHndl = NewMenuBar(0)) < 0) return;
+	if ((menuID = NewMenu(menuBarHndl, "", -1)) < 0) goto Done;
+	
+	for (int i = 0; i < NumElem(policyNames); i++) {
+		policyItems[i] = NewMenuItem(menuBarHndl, menuID, policyNames[i], -1, 0, 0, 0);
+		SetMenuBarAttribute(menuBarHndl, policyItems[i], ATTR_CHECKED, i == (int)policy);
+	}
+	
+	InsertSeparator(menuBarHndl, menuID, -1);
+	
+	if (maxQueuedBytes)
+		snprintf(itemName, sizeof(itemName), "Max. queued data: %.3f MB...", (double)maxQueuedBytes / 1e6);
+	else
+		snprintf(itemName, sizeof(itemName), "Max. queued data: no limit...");
+	
+	maxBytesItem = NewMenuItem(menuBarHndl, menuID, itemName, -1, 0, 0, 0);
+	
+	InsertSeparator(menuBarHndl, menuID, -1);
+	
+	snprintf(itemName, sizeof(itemName), "Dropped: %llu packets (%.3f MB)", (unsigned long long)nDroppedPackets, (double)nDroppedBytes / 1e6);
+	dropItem = NewMenuItem(menuBarHndl, menuID, itemName, -1, 0, 0, 0);
+	SetMenuBarAttribute(menuBarHndl, dropItem, ATTR_DIMMED, TRUE);
+	
+	resetItem = NewMenuItem(menuBarHndl, menuID, "Reset drop counters", -1, 0, 0, 0);
+	SetMenuBarAttribute(menuBarHndl, resetItem, ATTR_DIMMED, !nDroppedPackets);
+	
+	selectedItem = RunPopupMenu(menuBarHndl, menuID, panHandle, mouseTop, mouseLeft, 0, 0, 0, 0);
+	if (selectedItem <= 0) goto Done;
+	
+	// apply selection
+	for (int i = 0; i < NumElem(policyNames); i++)
+		if (selectedItem == policyItems[i])
+			SetSinkVChanOverflowPolicy(sinkVChan, (SinkVChanOverflowPolicies)i);
+	
+	if (selectedItem == maxBytesItem) {
+		snprintf(maxMBStr, sizeof(maxMBStr), "%g", (double)maxQueuedBytes / 1e6);
+		if (PromptPopup("Max. queued data", "Maximum data held by the queued data packets in [MB], or 0 for no limit:", maxMBStr, sizeof(maxMBStr) - 1) >= 0) {
+			maxMB = strtod(maxMBStr, &endPtr);
+			if (endPtr != maxMBStr && maxMB >= 0)
+				SetSinkVChanMaxQueuedBytes(sinkVChan, (size_t)(maxMB * 1e6));
+		}
+	}
+	
+	if (selectedItem == resetItem)
+		ResetSinkVChanDropCounters(sinkVChan);
+	
+	UpdateVChanSwitchboard(panHandle, tableControlID);
+	
+Done:
+	
+	DiscardMenuBar(menuBarHndl);
+}
+
 int CVICALLBACK HWTriggersSwitchboard_CB (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
 {
 	if (event != EVENT_COMMIT) return 0; // continue only if event is commit
@@ -3148,6 +3553,26 @@ INIT_ERR
 	// menu item Storage
 	if (menuItemID == TasksUI.menuDataItem_Storage ) TaskMenu_DisplayDataStorage();
 	
+	// menu item Metrics
+	if (menuItemID == TasksUI.menuDataItem_Metrics) {
+		errChk( TaskMenu_DisplayMetrics(&errorInfo.errMsg) );
+	}
+	
+	// menu item Record execution trace
+	if (menuItemID == TasksUI.menuDataItem_Trace) {
+		EnableTaskControlTracing(!GetTaskControlTracingEnabled());
+		SetMenuBarAttribute(menuBarHndl, menuItemID, ATTR_CHECKED, GetTaskControlTracingEnabled());
+	}
+	
+	// menu item Export execution trace
+	if (menuItemID == TasksUI.menuDataItem_ExportTrace) {
+		char	fileName[MAX_PATHNAME_LEN]	= "";
+		
+		if (FileSelectPopupEx("", "*.json", "*.json", "Export Task Controller execution trace", VAL_SAVE_BUTTON, 0, 1, fileName) != VAL_NO_FILE_SELECTED) {
+			errChk( ExportTaskControlTrace(fileName, &errorInfo.errMsg) );
+		}
+	}
+	
 Error:
 	
 PRINT_ERR	
@@ -3416,27 +3841,66 @@ Error:
 
 BOOL DLValidTaskControllerName (char name[])
 {
-	TaskControl_type*	taskController		= NULL;
-	char*				nameTC				= NULL; 
-	size_t				n					= ListNumItems(DAQLabTCs);
-	
 	// check if there is already another Task Controller with the same name
-	for (size_t i = 1; i <= n; i++) {
-		OKfree(nameTC);
-		taskController = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
-		nameTC = GetTaskControlName(taskController);
-		if (!strcmp(nameTC, name)) {
-			OKfree(nameTC);
+	return !NameRegistryFind(DAQLabTCNames, name);
+}
+
+char* DLGetUniqueTaskControllerName	(char baseTCName[])
+{
+	size_t 	n       		 	= 2;
+	char* 	name				= NULL;   
+	char   	countstr[500]		= "";
+	
+	name = StrDup(baseTCName);
+	AppendString(&name, " 1", -1);
+	while (!DLValidTaskControllerName(name)) {
+		OKfree(name);
+		name = StrDup(baseTCName);
+		Fmt(countstr, "%s<%d", n);
+		AppendString(&name, " ", -1);
+		AppendString(&name, countstr, -1);
+		n++;
+	}
+	
+	return name;
+}
+
+BOOL DLRenameTaskController (TaskControl_type* taskController, char newName[])
+{
+	char*	oldName = NULL;
+	
+	if (!DLValidTaskControllerName(newName)) return FALSE;
+	
+	// update registered name if the Task Controller was added to the framework
+	if (!(oldName = GetTaskControlName(taskController))) return FALSE;
+	if (NameRegistryFind(DAQLabTCNames, oldName) == taskController)
+		if (NameRegistryRename(DAQLabTCNames, oldName, newName) < 0) {
+			OKfree(oldName);
 			return FALSE;
 		}
-	}
-	OKfree(nameTC);
+	OKfree(oldName);
+	
+	SetTaskControlName(taskController, newName);
+	
+	// update Task Tree if it is displayed
+	if (TaskTreeManagerPanHndl)
+		DisplayTaskTreeManager(workspacePanHndl, TasksUI.UItaskCtrls, DAQLabModules);
+	
 	return TRUE;
 }
 
-char* DLGetUniqueTaskControllerName	(char baseTCName[])
+/// HIFN Removes the name of a Task Controller from the framework Task Controller names.
+static void UnregisterTaskControllerName (TaskControl_type* taskController)
 {
-	return GetUniqueTaskControllerName(DAQLabTCs, baseTCName);
+	char*	tcName = GetTaskControlName(taskController);
+	
+	if (!tcName) return;
+	
+	// remove name only if it is registered for this Task Controller
+	if (NameRegistryFind(DAQLabTCNames, tcName) == taskController)
+		NameRegistryRemove(DAQLabTCNames, tcName);
+	
+	OKfree(tcName);
 }
 
 static BOOL	ValidControllerName (char name[], void* listPtr)
@@ -3456,7 +3920,7 @@ INIT_ERR
 	if (!newControllerName) return 0; // operation cancelled, do nothing
 	
 	// create new task controller
-	nullChk(newTaskControllerPtr = init_TaskControl_type (newControllerName, NULL, DLThreadPoolHndl, ConfigureUITC, UnconfigureUITC, IterateUITC, StartUITC, 
+	nullChk(newTaskControllerPtr = init_TaskControl_type (newControllerName, NULL, DLGetThreadPoolHndl(DL_ThreadPool_UI), ConfigureUITC, UnconfigureUITC, IterateUITC, StartUITC, 
 												  ResetUITC, DoneUITC, StoppedUITC, NULL, TaskTreeStateChangeUITC, UITCActive, NULL, ErrorUITC) ); // module data added to the task controller below
 	OKfree(newControllerName);
 	
@@ -3497,6 +3961,248 @@ Error:
 	return;
 }
 
+static int TaskMenu_DisplayMetrics (char** errorMsg)
+{
+INIT_ERR
+	
+	if (MetricsUI.panHndl) {
+		DisplayPanel(MetricsUI.panHndl);
+		return 0; // stop here
+	}
+	
+	// create panel
+	errChk( MetricsUI.panHndl = NewPanel(workspacePanHndl, "Pipeline Metrics", VAL_AUTO_CENTER, VAL_AUTO_CENTER, DAQLAB_METRICS_PAN_HEIGHT, DAQLAB_METRICS_PAN_WIDTH) );
+	
+	// metrics display
+	errChk( MetricsUI.textBox = NewCtrl(MetricsUI.panHndl, CTRL_TEXT_BOX_LS, "", 10, 10) );
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.textBox, ATTR_WIDTH, DAQLAB_METRICS_PAN_WIDTH - 20);
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.textBox, ATTR_HEIGHT, DAQLAB_METRICS_PAN_HEIGHT - 60);
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.textBox, ATTR_NO_EDIT_TEXT, TRUE);
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.textBox, ATTR_TEXT_FONT, "Courier New");
+	
+	// buttons
+	errChk( MetricsUI.resetBTTN = NewCtrl(MetricsUI.panHndl, CTRL_SQUARE_COMMAND_BUTTON_LS, "Reset", DAQLAB_METRICS_PAN_HEIGHT - 40, 10) );
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.resetBTTN, ATTR_WIDTH, 90);
+	errChk( MetricsUI.exportBTTN = NewCtrl(MetricsUI.panHndl, CTRL_SQUARE_COMMAND_BUTTON_LS, "Export CSV...", DAQLAB_METRICS_PAN_HEIGHT - 40, 110) );
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.exportBTTN, ATTR_WIDTH, 90);
+	
+	// refresh timer
+	errChk( MetricsUI.refreshTimer = NewCtrl(MetricsUI.panHndl, CTRL_TIMER, "", 0, 0) );
+	SetCtrlAttribute(MetricsUI.panHndl, MetricsUI.refreshTimer, ATTR_INTERVAL, DAQLAB_METRICS_REFRESH_INTERVAL);
+	
+	// add callbacks
+	InstallPanelCallback(MetricsUI.panHndl, MetricsPan_CB, NULL);
+	InstallCtrlCallback(MetricsUI.panHndl, MetricsUI.resetBTTN, MetricsCtrls_CB, NULL);
+	InstallCtrlCallback(MetricsUI.panHndl, MetricsUI.exportBTTN, MetricsCtrls_CB, NULL);
+	InstallCtrlCallback(MetricsUI.panHndl, MetricsUI.refreshTimer, MetricsCtrls_CB, NULL);
+	
+	UpdateMetricsPanel();
+	DisplayPanel(MetricsUI.panHndl);
+	
+	return 0;
+	
+Error:
+	
+	OKfreePanHndl(MetricsUI.panHndl);
+	
+RETURN_ERR
+}
+
+static void UpdateMetricsPanel (void)
+{
+	size_t						nVChans				= ListNumItems(VChannels);
+	size_t						nTCs				= ListNumItems(DAQLabTCs);
+	VChan_type*					VChan				= NULL;
+	TaskControl_type*			tc					= NULL;
+	char*						name				= NULL;
+	VChanMetrics_type			vchanMetrics;
+	TCLatencyHistogram_type		iterationLatency;
+	TCLatencyHistogram_type		dataReceivedLatency;
+	TCLatencyHistogram_type		controlEventLatency;
+	TCLatencyHistogram_type		iterationJitter;
+	unsigned long long			nDataEvents			= 0;
+	unsigned long long			nCoalescedDataEvents= 0;
+	char						line[300]			= "";
+	
+	if (!MetricsUI.panHndl) return;
+	
+	ResetTextBox(MetricsUI.panHndl, MetricsUI.textBox, "");
+	
+	// Source VChans
+	snprintf(line, sizeof(line), "%-40s %12s %10s %14s %12s\n", "Source VChan", "packets/s", "MB/s", "packets", "MB");
+	SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChan = *(VChan_type**)ListGetPtrToItem(VChannels, i);
+		if (GetVChanDataFlowType(VChan) != VChan_Source) continue;
+		
+		GetVChanMetrics(VChan, &vchanMetrics);
+		name = GetVChanName(VChan);
+		snprintf(line, sizeof(line), "%-40.40s %12.1f %10.3f %14llu %12.3f\n", name, vchanMetrics.packetRate, vchanMetrics.byteRate/1e6, 
+				 (unsigned long long)vchanMetrics.nPackets, (double)vchanMetrics.nBytes/1e6);
+		SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+		OKfree(name);
+	}
+	
+	// Sink VChans
+	snprintf(line, sizeof(line), "\n%-40s %12s %14s %8s %12s %10s %12s\n", "Sink VChan", "packets/s", "queue", "max", "queued MB", "dropped", "dropped MB");
+	SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChan = *(VChan_type**)ListGetPtrToItem(VChannels, i);
+		if (GetVChanDataFlowType(VChan) != VChan_Sink) continue;
+		
+		GetVChanMetrics(VChan, &vchanMetrics);
+		name = GetVChanName(VChan);
+		snprintf(line, sizeof(line), "%-40.40s %12.1f %6llu/%-7llu %8llu %12.3f %10llu %12.3f\n", name, vchanMetrics.packetRate, 
+				 (unsigned long long)vchanMetrics.nQueuedPackets, (unsigned long long)vchanMetrics.queueSize, (unsigned long long)vchanMetrics.maxQueuedPackets,
+				 (double)vchanMetrics.nQueuedBytes/1e6, (unsigned long long)vchanMetrics.nDroppedPackets, (double)vchanMetrics.nDroppedBytes/1e6);
+		SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+		OKfree(name);
+	}
+	
+	// Task Controllers
+	snprintf(line, sizeof(line), "\n%-40s %-36s %-36s %-36s %-36s %s\n", "Task Controller", "iteration [ms] n/p50/p95/p99/max", "data received [ms] n/p50/p95/p99/max", 
+			 "control event wait [ms] n/p50/p95/p99/max", "iteration jitter [ms] n/p50/p95/p99/max", "data events/coalesced");
+	SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+	for (size_t i = 1; i <= nTCs; i++) {
+		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
+		GetTaskControlMetrics(tc, &iterationLatency, &dataReceivedLatency, &controlEventLatency, &iterationJitter);
+		GetTaskControlDataEventCounts(tc, &nDataEvents, &nCoalescedDataEvents);
+		name = GetTaskControlName(tc);
+		snprintf(line, sizeof(line), "%-40.40s %6llu/%.3g/%.3g/%.3g/%.3g %6llu/%.3g/%.3g/%.3g/%.3g %6llu/%.3g/%.3g/%.3g/%.3g %6llu/%.3g/%.3g/%.3g/%.3g %llu/%llu\n", name, 
+				 (unsigned long long)iterationLatency.nCalls, GetTCLatencyPercentile(&iterationLatency, 50), GetTCLatencyPercentile(&iterationLatency, 95), 
+				 GetTCLatencyPercentile(&iterationLatency, 99), iterationLatency.maxTime,
+				 (unsigned long long)dataReceivedLatency.nCalls, GetTCLatencyPercentile(&dataReceivedLatency, 50), GetTCLatencyPercentile(&dataReceivedLatency, 95), 
+				 GetTCLatencyPercentile(&dataReceivedLatency, 99), dataReceivedLatency.maxTime,
+				 (unsigned long long)controlEventLatency.nCalls, GetTCLatencyPercentile(&controlEventLatency, 50), GetTCLatencyPercentile(&controlEventLatency, 95), 
+				 GetTCLatencyPercentile(&controlEventLatency, 99), controlEventLatency.maxTime,
+				 (unsigned long long)iterationJitter.nCalls, GetTCLatencyPercentile(&iterationJitter, 50), GetTCLatencyPercentile(&iterationJitter, 95), 
+				 GetTCLatencyPercentile(&iterationJitter, 99), iterationJitter.maxTime, nDataEvents, nCoalescedDataEvents);
+		SetCtrlVal(MetricsUI.panHndl, MetricsUI.textBox, line);
+		OKfree(name);
+	}
+}
+
+static int ExportMetricsCSV (char fileName[], char** errorMsg)
+{
+#define ExportMetricsCSV_Err_OpenFile	-1
+INIT_ERR
+	
+	FILE*						file				= NULL;
+	size_t						nVChans				= ListNumItems(VChannels);
+	size_t						nTCs				= ListNumItems(DAQLabTCs);
+	VChan_type*					VChan				= NULL;
+	TaskControl_type*			tc					= NULL;
+	char*						name				= NULL;
+	VChanMetrics_type			vchanMetrics;
+	TCLatencyHistogram_type		latency[4];
+	char*						latencyName[4]		= {"Iteration", "DataReceived", "ControlEventWait", "IterationJitter"};
+	unsigned long long			nDataEvents			= 0;
+	unsigned long long			nCoalescedDataEvents= 0;
+	
+	if (!(file = fopen(fileName, "w")))
+		SET_ERR(ExportMetricsCSV_Err_OpenFile, "Could not open metrics file for writing.");
+	
+	// VChans
+	fprintf(file, "VChan,Flow,Packets,Bytes,PacketRate,ByteRate,QueuedPackets,MaxQueuedPackets,QueueSize,QueuedBytes,DroppedPackets,DroppedBytes\n");
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChan = *(VChan_type**)ListGetPtrToItem(VChannels, i);
+		GetVChanMetrics(VChan, &vchanMetrics);
+		name = GetVChanName(VChan);
+		fprintf(file, "\"%s\",%s,%llu,%llu,%g,%g,%llu,%llu,%llu,%llu,%llu,%llu\n", name, (GetVChanDataFlowType(VChan) == VChan_Source) ? "Source" : "Sink",
+				(unsigned long long)vchanMetrics.nPackets, vchanMetrics.nBytes, vchanMetrics.packetRate, vchanMetrics.byteRate, 
+				(unsigned long long)vchanMetrics.nQueuedPackets, (unsigned long long)vchanMetrics.maxQueuedPackets, (unsigned long long)vchanMetrics.queueSize,
+				(unsigned long long)vchanMetrics.nQueuedBytes, (unsigned long long)vchanMetrics.nDroppedPackets, vchanMetrics.nDroppedBytes);
+		OKfree(name);
+	}
+	
+	// Task Controller latency histograms, bin k counts times below 2^k us
+	fprintf(file, "\nTaskController,Callback,Calls,TotalTime_ms,MaxTime_ms,P50_ms,P95_ms,P99_ms");
+	for (int k = 0; k < TC_NLatencyBins; k++)
+		fprintf(file, ",Bin%d", k);
+	fprintf(file, "\n");
+	
+	for (size_t i = 1; i <= nTCs; i++) {
+		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
+		GetTaskControlMetrics(tc, &latency[0], &latency[1], &latency[2], &latency[3]);
+		name = GetTaskControlName(tc);
+		for (int j = 0; j < NumElem(latency); j++) {
+			fprintf(file, "\"%s\",%s,%llu,%g,%g,%g,%g,%g", name, latencyName[j], (unsigned long long)latency[j].nCalls, latency[j].totalTime, latency[j].maxTime,
+					GetTCLatencyPercentile(&latency[j], 50), GetTCLatencyPercentile(&latency[j], 95), GetTCLatencyPercentile(&latency[j], 99));
+			for (int k = 0; k < TC_NLatencyBins; k++)
+				fprintf(file, ",%llu", (unsigned long long)latency[j].bins[k]);
+			fprintf(file, "\n");
+		}
+		OKfree(name);
+	}
+	
+	// Task Controller data received events
+	fprintf(file, "\nTaskController,DataEvents,CoalescedDataEvents\n");
+	for (size_t i = 1; i <= nTCs; i++) {
+		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
+		GetTaskControlDataEventCounts(tc, &nDataEvents, &nCoalescedDataEvents);
+		name = GetTaskControlName(tc);
+		fprintf(file, "\"%s\",%llu,%llu\n", name, nDataEvents, nCoalescedDataEvents);
+		OKfree(name);
+	}
+	
+Error:
+	
+	if (file) fclose(file);
+	
+RETURN_ERR
+}
+
+static int CVICALLBACK MetricsPan_CB (int panel, int event, void *callbackData, int eventData1, int eventData2)
+{
+	switch (event) {
+			
+		case EVENT_CLOSE:
+			
+			OKfreePanHndl(MetricsUI.panHndl);
+			break;
+	}
+	
+	return 0;
+}
+
+static int CVICALLBACK MetricsCtrls_CB (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
+{
+INIT_ERR
+	
+	char		fileName[MAX_PATHNAME_LEN]	= "";
+	size_t		nVChans						= ListNumItems(VChannels);
+	size_t		nTCs						= ListNumItems(DAQLabTCs);
+	
+	if (control == MetricsUI.refreshTimer) {
+		if (event == EVENT_TIMER_TICK)
+			UpdateMetricsPanel();
+		return 0;
+	}
+	
+	if (event != EVENT_COMMIT) return 0;
+	
+	if (control == MetricsUI.resetBTTN) {
+		for (size_t i = 1; i <= nVChans; i++)
+			ResetVChanMetrics(*(VChan_type**)ListGetPtrToItem(VChannels, i));
+		
+		for (size_t i = 1; i <= nTCs; i++)
+			ResetTaskControlMetrics(*(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i));
+		
+		UpdateMetricsPanel();
+	}
+	
+	if (control == MetricsUI.exportBTTN) {
+		if (FileSelectPopupEx("", "*.csv", "*.csv", "Export pipeline metrics", VAL_SAVE_BUTTON, 0, 1, fileName) == VAL_NO_FILE_SELECTED) return 0;
+		errChk( ExportMetricsCSV(fileName, &errorInfo.errMsg) );
+	}
+	
+Error:
+	
+PRINT_ERR
+
+	return 0;
+}
+
 static void	TaskMenu_DeleteTaskController (void)
 {
 	int					delPanHndl;
@@ -4244,13 +4950,15 @@ INIT_ERR
 	size_t					nVChans			= ListNumItems(VChannels);
 	TaskControl_type*   	tc				= NULL;
 	VChan_type*				VChan			= NULL;
-	TCStates*				tcStates		= NULL;
-	BOOL*					tcStateLocks	= NULL;
 	char*					tcName			= NULL;
 	char*					VChanName		= NULL;
 	char*					tcStateName		= NULL;
 	size_t					nTSQElements	= 0;
 	char					nElemStr[50]	= "";
+	size_t					nDroppedPackets	= 0;
+	unsigned long long		nDroppedBytes	= 0;
+	char					dropStr[100]	= "";
+	TCTreeEstimate_type*	treeEstimate	= NULL;
 	
 	// clear log box
 	DeleteTextBoxLines(taskLogPanHndl, TaskLogPan_LogBox, 0, -1);
@@ -4258,23 +4966,13 @@ INIT_ERR
 	// display log panel
 	DisplayPanel(taskLogPanHndl);
 	
-	// get task controller states
-	if (nTCs) {
-		nullChk( tcStates = calloc(nTCs, sizeof(TCStates)) );
-		nullChk( tcStateLocks = calloc(nTCs, sizeof(BOOL)) );
-	}
-	
-	for (size_t i = 0; i < nTCs; i++) {
-		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i+1);
-		errChk( GetTaskControlState_GetLock(tc, &tcStates[i], &tcStateLocks[i], __LINE__, __FILE__, &errorInfo.errMsg) );
-	}
-	
 	// print current states of all task controllers
+	// Note: states are sampled without blocking state transitions of running task controllers
 	SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "Task Controller states:\n");
-	for (size_t i = 0; i < nTCs; i++) {
-		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i+1);
+	for (size_t i = 1; i <= nTCs; i++) {
+		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
 		tcName		= GetTaskControlName(tc);
-		tcStateName	= TaskControlStateToString(tcStates[i]);
+		tcStateName	= TaskControlStateToString(GetTaskControlState(tc, NULL));
 		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, tcName);
 		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, " = ");
 		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, tcStateName);
@@ -4283,6 +4981,18 @@ INIT_ERR
 		OKfree(tcStateName);
 	}
 	
+	// print dry-run estimates of task trees which are not in use
+	SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n\nTask tree estimates:\n");
+	for (size_t i = 1; i <= nTCs; i++) {
+		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
+		if (GetTaskControlParent(tc) || IsTaskTreeInUse(tc, NULL)) continue; // select root TCs of idle task trees
+		
+		errChk( EstimateTaskTree(tc, &treeEstimate, &errorInfo.errMsg) );
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, treeEstimate->report);
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n");
+		discard_TCTreeEstimate_type(&treeEstimate);
+	}
+	
 	// print number of elements left unprocessed in the Sink VChans
 	SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n\nUnprocessed Sink VChan elements:\n");
 	for (size_t i = 1; i <= nVChans; i++) {
@@ -4299,25 +5009,45 @@ INIT_ERR
 		OKfree(VChanName);
 	}
 	
+	// print number of data packets dropped by the Sink VChans overflow policies
+	SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n\nDropped Sink VChan data packets:\n");
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChan = *(VChan_type**)ListGetPtrToItem(VChannels, i);
+		if (GetVChanDataFlowType(VChan) == VChan_Source) continue; // select Sink VChans
+		
+		GetSinkVChanDropCounters((SinkVChan_type*)VChan, &nDroppedPackets, &nDroppedBytes);
+		if (!nDroppedPackets) continue;
+		
+		snprintf(dropStr, sizeof(dropStr), "%llu packets (%.3f MB)", (unsigned long long)nDroppedPackets, (double)nDroppedBytes / 1e6);
+		VChanName		= GetVChanName(VChan);
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, VChanName);
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, " = ");
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, dropStr);
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n");
+		OKfree(VChanName);
+	}
+	
 	// enable logging for all task controllers
+	// Note: Task Controller actions are recorded in the execution trace and added to the log panel only while it is open
 	SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, "\n\nTask Controller actions:\n");
+	taskLogTracePos		= GetTaskControlTracePosition();
+	taskLogStartTime	= Timer();
 	for (size_t i = 1; i <= nTCs; i++) {
 		tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i);
 		EnableTaskControlLogging(tc, TRUE);
 	}
 	
+	if (!taskLogTimer) {
+		errChk( taskLogTimer = NewCtrl(taskLogPanHndl, CTRL_TIMER, "", 0, 0) );
+		SetCtrlAttribute(taskLogPanHndl, taskLogTimer, ATTR_INTERVAL, DAQLAB_TASKLOG_REFRESH_INTERVAL);
+		InstallCtrlCallback(taskLogPanHndl, taskLogTimer, TaskLogTimer_CB, NULL);
+	}
+	SetCtrlAttribute(taskLogPanHndl, taskLogTimer, ATTR_ENABLED, TRUE);
+	
 Error:
 	
-	// release locks
-	if (tcStateLocks)
-		for (size_t i = 0; i < nTCs; i++) {
-			tc = *(TaskControl_type**)ListGetPtrToItem(DAQLabTCs, i+1);
-			if (tcStateLocks[i]) 
-				GetTaskControlState_ReleaseLock(tc, &tcStateLocks[i], &errorInfo.errMsg);
-		}
-	OKfree(tcStateLocks);
-	OKfree(tcStates);
-
+	discard_TCTreeEstimate_type(&treeEstimate);
+	
 PRINT_ERR
 }
 
@@ -4331,9 +5061,29 @@ void CVICALLBACK TaskLogMenuClose_CB (int menuBar, int menuItem, void *callbackD
 		EnableTaskControlLogging(*tcPtr, FALSE);
 	}
 	
+	// stop updating the log box
+	if (taskLogTimer)
+		SetCtrlAttribute(taskLogPanHndl, taskLogTimer, ATTR_ENABLED, FALSE);
+	
 	// clear log box
 	DeleteTextBoxLines(taskLogPanHndl, TaskLogPan_LogBox, 0, -1);
 	
 	// hide log panel
 	HidePanel(taskLogPanHndl);
 }
+
+static int CVICALLBACK TaskLogTimer_CB (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
+{
+	char*	log		= NULL;
+	
+	if (event != EVENT_TIMER_TICK) return 0;
+	
+	// add Task Controller actions recorded since the last update
+	log = FormatTaskControlTraceLog(&taskLogTracePos, taskLogStartTime);
+	if (log)
+		SetCtrlVal(taskLogPanHndl, TaskLogPan_LogBox, log);
+	
+	OKfree(log);
+	
+	return 0;
+}
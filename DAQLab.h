@@ -86,6 +86,19 @@ typedef struct{
 	
 } DAQLabXMLNode;
 
+	// Roles of the framework thread pools. Each role has its own bounded thread pool with its own thread priority and CPU affinity
+	// so that e.g. long storage or processing jobs cannot starve acquisition Task Controllers of threads.
+typedef enum {
+	
+	DL_ThreadPool_Acquisition,		// Task Controllers driving hardware and data acquisition
+	DL_ThreadPool_Processing,		// Data processing, e.g. image assembly
+	DL_ThreadPool_Storage,			// Data storage
+	DL_ThreadPool_Replay,			// Data replay, kept apart from storage so that long running replays do not hold up storage
+	DL_ThreadPool_UI,				// User interface Task Controllers
+	DL_NThreadPools
+	
+} DLThreadPoolRoles;
+
 //==============================================================================
 // Global functions
 
@@ -180,6 +193,9 @@ BOOL 				DLValidTaskControllerName			(char name[]);
 	// Returns a unique Task Controller name among existing Task Controllers within the framework
 char*				DLGetUniqueTaskControllerName		(char baseTCName[]);
 
+	// Renames a Task Controller if the new name is unique within the framework. Use this instead of SetTaskControlName for Task Controllers added to the framework.
+BOOL				DLRenameTaskController				(TaskControl_type* taskController, char newName[]);
+
 	// Adds a list of Task Controllers to the DAQLab framework.
 	// tcList of TaskControl_type* 
 BOOL				DLAddTaskControllers				(DAQLabModule_type* mod, ListType tcList);
@@ -196,8 +212,16 @@ BOOL				DLRemoveTaskController 				(DAQLabModule_type* mod, TaskControl_type* ta
 // DAQLab common thread pool management
 //-------------------------------------------------------------------------------
 
+	// Returns the thread pool handle for the given role. The pools are created when DAQLab starts, with settings loaded from DAQLabCfg.xml.
+CmtThreadPoolHandle	DLGetThreadPoolHndl					(DLThreadPoolRoles role);
+
+	// Returns the acquisition thread pool handle.
 CmtThreadPoolHandle	DLGetCommonThreadPoolHndl			(void);
 
+	// Thread function callback to pass to CmtScheduleThreadPoolFunctionAdv with EVENT_TP_THREAD_FUNCTION_BEGIN for functions scheduled
+	// in one of the framework thread pools. It applies the CPU affinity of the pool to the thread running the function.
+void CVICALLBACK	DLThreadPoolFunctionCallback		(CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void *callbackData);
+
 //-------------------------------------------------------------------------------
 // DAQLab XML management
 //-------------------------------------------------------------------------------
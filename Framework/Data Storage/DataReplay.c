@@ -0,0 +1,1059 @@
+//==============================================================================
+//
+// Title:		DataReplay.c
+// Purpose:		Replays data recorded with the Data Storage module through Source VChans.
+//
+// Created on:	18-10-2026 at 16:53:26 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public 
+//              License v. 2.0. If a copy of the MPL was not distributed with this 
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ . 
+//
+//==============================================================================
+
+//==============================================================================
+// Include files
+
+#include "DAQLab.h" 		// include this first
+#include <stdio.h>
+#include <ctype.h>
+#include <userint.h>
+#include <utility.h>
+#include "DataReplay.h"
+#include "HDF5support.h"
+
+//==============================================================================
+// Constants
+
+#define ReplayWaitInterval					0.001		// Time in [s] between checks of the abort and stop flags while waiting to send data.
+#define ReplayInfoLineLength				512
+
+	// main panel
+#define ReplayPan_Width						450
+#define ReplayPan_Height					340
+
+//==============================================================================
+// Types
+
+typedef enum {
+	ReplayRate_Original,					// Data is sent at the rate at which it was recorded.
+	ReplayRate_Scaled,						// Data is sent at the recorded rate multiplied by a speed factor.
+	ReplayRate_Max							// Data is sent as fast as possible, e.g. to measure the throughput of the processing chain.
+} ReplayRateModes;
+
+typedef struct {
+	char*					name;			// Dataset name, i.e. the name of the Source VChan from which the data was recorded.
+	DLDataTypes				dataType;		// Data packet type.
+	SourceVChan_type*		VChan;			// Source VChan through which the recorded data is sent.
+} ReplayChan_type;
+
+typedef struct {
+	HDF5Dataset_type*		dataset;		// Dataset from which the data packet is read.
+	ReplayChan_type*		chan;			// Channel through which the data packet is sent.
+	unsigned int*			indices;		// For waveforms, dataset->rank - 1 iteration indices of the waveform. For images, the index of the image in the stack.
+	unsigned int			nIndices;		// Number of elements in indices.
+} ReplayItem_type;
+
+typedef struct {
+	size_t					firstItem;		// 1-based index of the first replay item sent in this step.
+	size_t					nItems;			// Number of replay items sent in this step.
+} ReplayStep_type;
+
+//==============================================================================
+// Module implementation
+
+struct DataReplay {
+
+	// SUPER, must be the first member to inherit from
+
+	DAQLabModule_type 		baseClass;
+
+	// DATA
+
+		//-------------------------
+		// Task Controller
+		//-------------------------
+
+	TaskControl_type*		taskController;
+
+		//-------------------------
+		// Replay
+		//-------------------------
+
+	char*					fileName;		// HDF5 file from which data is replayed.
+	hid_t					fileID;			// Replay file ID while data is replayed, opened once per replay run, 0 otherwise.
+	ReplayRateModes			rateMode;
+	double					speedFactor;	// Replay speed relative to the recording speed for ReplayRate_Scaled.
+	ListType				datasets;		// Datasets found in the replay file, of HDF5Dataset_type*.
+	ListType				channels;		// One channel for each dataset name, of ReplayChan_type*.
+	ListType				items;			// Data packets in replay order, of ReplayItem_type.
+	ListType				steps;			// Data packets sent in each Task Controller iteration, of ReplayStep_type.
+
+		//-------------------------
+		// Timing and throughput
+		//-------------------------
+
+	double					startTime;		// Timer() value when the replay started in [s].
+	double					recordedTime;	// Recording time replayed so far in [s].
+	double					readTime;		// Time spent reading data from the file in [s].
+	size_t					nPacketsSent;
+	unsigned long long		nBytesSent;
+
+		//-------------------------
+		// UI
+		//-------------------------
+
+	int						mainPanHndl;
+	int*					mainPanTopPos;
+	int*					mainPanLeftPos;
+	int						fileNameCtrl;
+	int						browseCtrl;
+	int						rateModeCtrl;
+	int						speedFactorCtrl;
+	int						infoCtrl;
+
+};
+
+//==============================================================================
+// Static global variables
+
+//==============================================================================
+// Static functions
+
+static int 						Load 							(DAQLabModule_type* mod, int workspacePanHndl, char** errorMsg);
+
+static int 						LoadCfg 						(DAQLabModule_type* mod, ActiveXMLObj_IXMLDOMElement_ moduleElement, ERRORINFO* xmlErrorInfo);
+
+static int 						SaveCfg 						(DAQLabModule_type* mod, CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ moduleElement, ERRORINFO* xmlErrorInfo);
+
+static int 						DisplayPanels					(DAQLabModule_type* mod, BOOL visibleFlag);
+
+	// creates the main panel controls
+static int						InitReplayPanel					(DataReplay_type* rp, int workspacePanHndl, char** errorMsg);
+
+	// reads the datasets of a replay file and creates Source VChans for them
+static int						OpenReplayFile					(DataReplay_type* rp, char fileName[], char** errorMsg);
+
+	// unregisters the Source VChans and discards the replay data of the current replay file
+static int						CloseReplayFile					(DataReplay_type* rp, char** errorMsg);
+
+static int						AddReplayChannel				(DataReplay_type* rp, HDF5Dataset_type* dataset, ReplayChan_type** chanPtr, char** errorMsg);
+
+static void						discard_ReplayChan_type			(ReplayChan_type** chanPtr);
+
+	// adds one replay item for each waveform or image in a dataset
+static int						AddReplayItems					(DataReplay_type* rp, HDF5Dataset_type* dataset, ReplayChan_type* chan, char** errorMsg);
+
+	// orders replay items by group name, iteration indices and dataset name
+static int CVICALLBACK			CompareReplayItems				(void* item1, void* item2);
+
+	// orders group names by their Task Controller names and, numerically, by their iteration indices
+static int						CompareGroupNames				(char groupName1[], char groupName2[]);
+
+	// groups replay items with the same group name and iteration indices into replay steps
+static int						BuildReplaySteps				(DataReplay_type* rp, char** errorMsg);
+
+static DSInfo_type*				InitReplayItemDSInfo			(ReplayItem_type* item);
+
+static void						UpdateReplayInfo				(DataReplay_type* rp);
+
+	// waits until a given recording time must be replayed or until the iteration is aborted or stopped. Returns FALSE if the iteration was aborted or stopped.
+static BOOL						WaitForReplayTime				(DataReplay_type* rp, double recordedTime, BOOL const* abortFlag);
+
+static int CVICALLBACK 			UICtrls_CB 						(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+
+//-----------------------------------------
+// Task Controller Callbacks
+//-----------------------------------------
+
+static int						ConfigureTC						(TaskControl_type* taskControl, BOOL const* abortFlag, char** errorMsg);
+
+static void						IterateTC						(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag);
+
+static int						StartTC							(TaskControl_type* taskControl, BOOL const* abortFlag, char** errorMsg);
+
+static int						DoneTC							(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg);
+
+static int						StoppedTC						(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg);
+
+static int						TaskTreeStateChange				(TaskControl_type* taskControl, TaskTreeStates state, char** errorMsg);
+
+static void						ErrorTC 						(TaskControl_type* taskControl, int errorID, char errorMsg[]);
+
+//==============================================================================
+// Global variables
+
+//==============================================================================
+// Global functions
+
+/// HIFN  Allocates memory and initializes the Data Replay module.
+/// HIPAR mod/ if NULL both memory allocation and initialization must take place.
+/// HIPAR mod/ if !NULL the function performs only an initialization of a DAQLabModule_type.
+/// HIRET address of a DAQLabModule_type if memory allocation and initialization took place.
+/// HIRET NULL if only initialization was performed.
+DAQLabModule_type*	initalloc_DataReplay (DAQLabModule_type* mod, char className[], char instanceName[], int workspacePanHndl)
+{
+INIT_ERR
+
+	DataReplay_type* 	rp		= NULL;
+
+	if (!mod) {
+		rp = malloc (sizeof(DataReplay_type));
+		if (!rp) return NULL;
+	} else
+		rp = (DataReplay_type*) mod;
+
+	// initialize base class
+	initalloc_DAQLabModule(&rp->baseClass, className, instanceName, workspacePanHndl);
+
+	//---------------------------
+	// Parent Level 0: DAQLabModule_type
+
+		// overriding methods
+	rp->baseClass.Discard 			= discard_DataReplay;
+	rp->baseClass.Load				= Load;
+	rp->baseClass.LoadCfg			= LoadCfg;
+	rp->baseClass.SaveCfg			= SaveCfg;
+	rp->baseClass.DisplayPanels		= DisplayPanels;
+
+	//---------------------------
+	// Child Level 1: DataReplay_type
+
+		// DATA
+
+	// init
+	rp->taskController				= NULL;
+	rp->fileName					= NULL;
+	rp->fileID						= 0;
+	rp->rateMode					= ReplayRate_Original;
+	rp->speedFactor					= 1;
+	rp->datasets					= 0;
+	rp->channels					= 0;
+	rp->items						= 0;
+	rp->steps						= 0;
+	rp->startTime					= 0;
+	rp->recordedTime				= 0;
+	rp->readTime					= 0;
+	rp->nPacketsSent				= 0;
+	rp->nBytesSent					= 0;
+	rp->mainPanHndl					= 0;
+	rp->mainPanTopPos				= NULL;
+	rp->mainPanLeftPos				= NULL;
+	rp->fileNameCtrl				= 0;
+	rp->browseCtrl					= 0;
+	rp->rateModeCtrl				= 0;
+	rp->speedFactorCtrl				= 0;
+	rp->infoCtrl					= 0;
+
+	// alloc
+	nullChk( rp->datasets			= ListCreate(sizeof(HDF5Dataset_type*)) );
+	nullChk( rp->channels			= ListCreate(sizeof(ReplayChan_type*)) );
+	nullChk( rp->items				= ListCreate(sizeof(ReplayItem_type)) );
+	nullChk( rp->steps				= ListCreate(sizeof(ReplayStep_type)) );
+
+	// create Task Controller, the replay iterations are driven by the recorded data, thus there is no iteration timeout
+	nullChk( rp->taskController		= init_TaskControl_type (instanceName, rp, DLGetThreadPoolHndl(DL_ThreadPool_Replay), ConfigureTC, NULL, IterateTC, StartTC, NULL,
+								 	DoneTC, StoppedTC, NULL, TaskTreeStateChange, NULL, NULL, ErrorTC) );
+	SetTaskControlIterationTimeout(rp->taskController, 0);
+
+	//----------------------------------------------------------
+	if (!mod)
+		return (DAQLabModule_type*) rp;
+	else
+		return NULL;
+
+Error:
+
+	discard_DataReplay((DAQLabModule_type**)&rp);
+	return NULL;
+}
+
+/// HIFN Discards DataReplay data but does not free the structure memory.
+void discard_DataReplay (DAQLabModule_type** mod)
+{
+	DataReplay_type* 		rp 		= (DataReplay_type*) (*mod);
+
+	if (!rp) return;
+
+	//---------------------------------------
+	// discard DataReplay specific data
+	//---------------------------------------
+
+	OKfreePanHndl(rp->mainPanHndl);
+	OKfree(rp->mainPanTopPos);
+	OKfree(rp->mainPanLeftPos);
+
+	// discard Task Controller
+	if (rp->taskController) {
+		DLRemoveTaskController((DAQLabModule_type*)rp, rp->taskController);
+		discard_TaskControl_type(&rp->taskController);
+	}
+
+	// discard replay data, the Source VChans are not attached anymore to a Task Controller
+	if (rp->items) {
+		size_t				nItems 	= ListNumItems(rp->items);
+		ReplayItem_type*	item	= NULL;
+
+		for (size_t i = 1; i <= nItems; i++) {
+			item = ListGetPtrToItem(rp->items, i);
+			OKfree(item->indices);
+		}
+	}
+
+	if (rp->channels) {
+		size_t				nChans 	= ListNumItems(rp->channels);
+		ReplayChan_type*	chan	= NULL;
+
+		for (size_t i = 1; i <= nChans; i++) {
+			chan = *(ReplayChan_type**)ListGetPtrToItem(rp->channels, i);
+			DLUnregisterVChan((DAQLabModule_type*)rp, (VChan_type*)chan->VChan);
+		}
+	}
+
+	OKfreeList(&rp->items, NULL);
+	OKfreeList(&rp->steps, NULL);
+	OKfreeList(&rp->channels, (DiscardFptr_type)discard_ReplayChan_type);
+	OKfreeList(&rp->datasets, (DiscardFptr_type)discard_HDF5Dataset_type);
+	CloseHDF5File(&rp->fileID);
+	OKfree(rp->fileName);
+
+	//----------------------------------------
+	// discard DAQLabModule_type specific data
+	//----------------------------------------
+
+	discard_DAQLabModule(mod);
+}
+
+static int Load (DAQLabModule_type* mod, int workspacePanHndl, char** errorMsg)
+{
+INIT_ERR
+
+	DataReplay_type* 	rp 			= (DataReplay_type*) mod;
+	ssize_t				fileSize	= 0;
+
+	errChk( InitReplayPanel(rp, workspacePanHndl, &errorInfo.errMsg) );
+
+	// add module's task controller to the framework
+	DLAddTaskController(mod, rp->taskController);
+
+	// open replay file from the saved configuration if still available
+	if (rp->fileName && FileExists(rp->fileName, &fileSize) == 1) {
+		errChk( OpenReplayFile(rp, rp->fileName, &errorInfo.errMsg) );
+	} else
+		OKfree(rp->fileName);
+
+	errChk( TaskControlEvent(rp->taskController, TC_Event_Configure, NULL, NULL, &errorInfo.errMsg) );
+
+	DisplayPanel(rp->mainPanHndl);
+
+Error:
+
+RETURN_ERR
+}
+
+static int LoadCfg (DAQLabModule_type* mod, ActiveXMLObj_IXMLDOMElement_ moduleElement, ERRORINFO* xmlErrorInfo)
+{
+INIT_ERR
+
+	DataReplay_type*				rp								= (DataReplay_type*)mod;
+	int								rateMode						= 0;
+	char*							fileName						= NULL;
+
+	nullChk( rp->mainPanTopPos	= malloc(sizeof(int)) );
+	nullChk( rp->mainPanLeftPos	= malloc(sizeof(int)) );
+
+	DAQLabXMLNode 					moduleAttr[]					= { {"PanTopPos", BasicData_Int, rp->mainPanTopPos},
+											  		   					{"PanLeftPos", BasicData_Int, rp->mainPanLeftPos},
+																		{"FileName", BasicData_CString, &fileName},
+																		{"RateMode", BasicData_Int, &rateMode},
+																		{"SpeedFactor", BasicData_Double, &rp->speedFactor} };
+
+	errChk( DLGetXMLElementAttributes("", moduleElement, moduleAttr, NumElem(moduleAttr)) );
+
+	rp->rateMode = (ReplayRateModes) rateMode;
+	if (rp->speedFactor <= 0) rp->speedFactor = 1;
+
+	// the replay file is opened when the module is loaded
+	OKfree(rp->fileName);
+	if (fileName && fileName[0]) {
+		rp->fileName = fileName;
+		fileName = NULL;
+	}
+
+Error:
+
+	OKfree(fileName);
+
+	return errorInfo.error;
+}
+
+static int SaveCfg (DAQLabModule_type* mod, CAObjHandle xmlDOM, ActiveXMLObj_IXMLDOMElement_ moduleElement, ERRORINFO* xmlErrorInfo)
+{
+INIT_ERR
+
+	DataReplay_type*				rp						= (DataReplay_type*)mod;
+	int								panTopPos				= 0;
+	int								panLeftPos				= 0;
+	int								rateMode				= (int) rp->rateMode;
+	char*							fileName				= (rp->fileName)? rp->fileName : "";
+	DAQLabXMLNode 					moduleAttr[] 			= {{"PanTopPos", BasicData_Int, &panTopPos},
+											  		   		   {"PanLeftPos", BasicData_Int, &panLeftPos},
+															   {"FileName", BasicData_CString, fileName},
+															   {"RateMode", BasicData_Int, &rateMode},
+															   {"SpeedFactor", BasicData_Double, &rp->speedFactor}};
+
+	errChk( GetPanelAttribute(rp->mainPanHndl, ATTR_LEFT, &panLeftPos) );
+	errChk( GetPanelAttribute(rp->mainPanHndl, ATTR_TOP, &panTopPos) );
+	errChk( DLAddToXMLElem(xmlDOM, moduleElement, moduleAttr, DL_ATTRIBUTE, NumElem(moduleAttr), xmlErrorInfo) );
+
+Error:
+
+	return errorInfo.error;
+}
+
+static int DisplayPanels (DAQLabModule_type* mod, BOOL visibleFlag)
+{
+	DataReplay_type*	rp		= (DataReplay_type*)mod;
+
+	if (!rp->mainPanHndl) return 0;
+
+	if (visibleFlag)
+		return DisplayPanel(rp->mainPanHndl);
+	else
+		return HidePanel(rp->mainPanHndl);
+}
+
+static int InitReplayPanel (DataReplay_type* rp, int workspacePanHndl, char** errorMsg)
+{
+INIT_ERR
+
+	errChk( rp->mainPanHndl = NewPanel(workspacePanHndl, rp->baseClass.instanceName, VAL_AUTO_CENTER, VAL_AUTO_CENTER, ReplayPan_Height, ReplayPan_Width) );
+
+	// set main panel position
+	if (rp->mainPanLeftPos)
+		SetPanelAttribute(rp->mainPanHndl, ATTR_LEFT, *rp->mainPanLeftPos);
+
+	if (rp->mainPanTopPos)
+		SetPanelAttribute(rp->mainPanHndl, ATTR_TOP, *rp->mainPanTopPos);
+
+	// replay file
+	errChk( rp->fileNameCtrl = NewCtrl(rp->mainPanHndl, CTRL_STRING_LS, "Replay file", 25, 10) );
+	SetCtrlAttribute(rp->mainPanHndl, rp->fileNameCtrl, ATTR_WIDTH, 330);
+	SetCtrlAttribute(rp->mainPanHndl, rp->fileNameCtrl, ATTR_CTRL_MODE, VAL_INDICATOR);
+	if (rp->fileName)
+		SetCtrlVal(rp->mainPanHndl, rp->fileNameCtrl, rp->fileName);
+
+	errChk( rp->browseCtrl = NewCtrl(rp->mainPanHndl, CTRL_SQUARE_COMMAND_BUTTON_LS, "Browse...", 23, 350) );
+	SetCtrlAttribute(rp->mainPanHndl, rp->browseCtrl, ATTR_WIDTH, 90);
+
+	// replay rate
+	errChk( rp->rateModeCtrl = NewCtrl(rp->mainPanHndl, CTRL_RING_LS, "Replay rate", 70, 10) );
+	SetCtrlAttribute(rp->mainPanHndl, rp->rateModeCtrl, ATTR_WIDTH, 170);
+	InsertListItem(rp->mainPanHndl, rp->rateModeCtrl, -1, "Original", ReplayRate_Original);
+	InsertListItem(rp->mainPanHndl, rp->rateModeCtrl, -1, "Scaled", ReplayRate_Scaled);
+	InsertListItem(rp->mainPanHndl, rp->rateModeCtrl, -1, "As fast as possible", ReplayRate_Max);
+	SetCtrlVal(rp->mainPanHndl, rp->rateModeCtrl, (int)rp->rateMode);
+
+	errChk( rp->speedFactorCtrl = NewCtrl(rp->mainPanHndl, CTRL_NUMERIC_LS, "Speed factor", 70, 200) );
+	SetCtrlAttribute(rp->mainPanHndl, rp->speedFactorCtrl, ATTR_DATA_TYPE, VAL_DOUBLE);
+	SetCtrlAttribute(rp->mainPanHndl, rp->speedFactorCtrl, ATTR_MIN_VALUE, 0.001);
+	SetCtrlAttribute(rp->mainPanHndl, rp->speedFactorCtrl, ATTR_MAX_VALUE, 1000.0);
+	SetCtrlAttribute(rp->mainPanHndl, rp->speedFactorCtrl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal(rp->mainPanHndl, rp->speedFactorCtrl, rp->speedFactor);
+	SetCtrlAttribute(rp->mainPanHndl, rp->speedFactorCtrl, ATTR_DIMMED, rp->rateMode != ReplayRate_Scaled);
+
+	// replay file info
+	errChk( rp->infoCtrl = NewCtrl(rp->mainPanHndl, CTRL_TEXT_BOX_LS, "Datasets", 115, 10) );
+	SetCtrlAttribute(rp->mainPanHndl, rp->infoCtrl, ATTR_WIDTH, 430);
+	SetCtrlAttribute(rp->mainPanHndl, rp->infoCtrl, ATTR_HEIGHT, 210);
+	SetCtrlAttribute(rp->mainPanHndl, rp->infoCtrl, ATTR_NO_EDIT_TEXT, TRUE);
+
+	// connect module data and user interface callback to the controls
+	InstallCtrlCallback(rp->mainPanHndl, rp->browseCtrl, UICtrls_CB, rp);
+	InstallCtrlCallback(rp->mainPanHndl, rp->rateModeCtrl, UICtrls_CB, rp);
+	InstallCtrlCallback(rp->mainPanHndl, rp->speedFactorCtrl, UICtrls_CB, rp);
+
+Error:
+
+RETURN_ERR
+}
+
+static int OpenReplayFile (DataReplay_type* rp, char fileName[], char** errorMsg)
+{
+INIT_ERR
+
+	char*					newFileName		= NULL;
+	size_t					nDatasets		= 0;
+	HDF5Dataset_type*		dataset			= NULL;
+	ReplayChan_type*		chan			= NULL;
+
+	nullChk( newFileName = StrDup(fileName) );
+	errChk( CloseReplayFile(rp, &errorInfo.errMsg) );
+	rp->fileName = newFileName;
+	newFileName = NULL;
+
+	errChk( GetHDF5Datasets(rp->fileName, rp->datasets, &errorInfo.errMsg) );
+
+	nDatasets = ListNumItems(rp->datasets);
+	for (size_t i = 1; i <= nDatasets; i++) {
+		dataset = *(HDF5Dataset_type**)ListGetPtrToItem(rp->datasets, i);
+		errChk( AddReplayChannel(rp, dataset, &chan, &errorInfo.errMsg) );
+		if (!chan) continue;	// dataset type does not match other datasets with the same name
+
+		errChk( AddReplayItems(rp, dataset, chan, &errorInfo.errMsg) );
+	}
+
+	ListQuickSort(rp->items, CompareReplayItems);
+	errChk( BuildReplaySteps(rp, &errorInfo.errMsg) );
+
+	if (rp->mainPanHndl)
+		SetCtrlVal(rp->mainPanHndl, rp->fileNameCtrl, rp->fileName);
+
+	UpdateReplayInfo(rp);
+
+	return 0;
+
+Error:
+
+	// cleanup
+	OKfree(newFileName);
+	CloseReplayFile(rp, NULL);
+	UpdateReplayInfo(rp);
+
+RETURN_ERR
+}
+
+static int CloseReplayFile (DataReplay_type* rp, char** errorMsg)
+{
+INIT_ERR
+
+	size_t				nChans 		= ListNumItems(rp->channels);
+	size_t				nItems		= ListNumItems(rp->items);
+	size_t				nDatasets	= ListNumItems(rp->datasets);
+	ReplayChan_type**	chanPtr		= NULL;
+	ReplayItem_type*	item		= NULL;
+	HDF5Dataset_type**	datasetPtr	= NULL;
+
+	// remove Source VChans, this fails if the Task Controller is in use
+	for (size_t i = nChans; i >= 1; i--) {
+		chanPtr = ListGetPtrToItem(rp->channels, i);
+		errChk( RemoveSourceVChan(rp->taskController, (*chanPtr)->VChan, &errorInfo.errMsg) );
+		DLUnregisterVChan((DAQLabModule_type*)rp, (VChan_type*)(*chanPtr)->VChan);
+		discard_ReplayChan_type(chanPtr);
+		ListRemoveItem(rp->channels, 0, i);
+	}
+
+	for (size_t i = 1; i <= nItems; i++) {
+		item = ListGetPtrToItem(rp->items, i);
+		OKfree(item->indices);
+	}
+	ListClear(rp->items);
+	ListClear(rp->steps);
+
+	for (size_t i = 1; i <= nDatasets; i++) {
+		datasetPtr = ListGetPtrToItem(rp->datasets, i);
+		discard_HDF5Dataset_type(datasetPtr);
+	}
+	ListClear(rp->datasets);
+
+	CloseHDF5File(&rp->fileID);
+	OKfree(rp->fileName);
+
+Error:
+
+RETURN_ERR
+}
+
+static int AddReplayChannel (DataReplay_type* rp, HDF5Dataset_type* dataset, ReplayChan_type** chanPtr, char** errorMsg)
+{
+INIT_ERR
+
+	size_t				nChans		= ListNumItems(rp->channels);
+	ReplayChan_type*	chan		= NULL;
+	char*				VChanName	= NULL;
+
+	*chanPtr = NULL;
+
+	// datasets with the same name in different groups are recordings from the same Source VChan
+	for (size_t i = 1; i <= nChans; i++) {
+		chan = *(ReplayChan_type**)ListGetPtrToItem(rp->channels, i);
+		if (!strcmp(chan->name, dataset->datasetName)) {
+			if (chan->dataType == dataset->dataType)
+				*chanPtr = chan;
+
+			return 0;
+		}
+	}
+
+	nullChk( chan = malloc(sizeof(ReplayChan_type)) );
+	chan->name		= NULL;
+	chan->dataType	= dataset->dataType;
+	chan->VChan		= NULL;
+
+	nullChk( chan->name = StrDup(dataset->datasetName) );
+	nullChk( VChanName = DLVChanName((DAQLabModule_type*)rp, NULL, dataset->datasetName, 0) );
+	nullChk( chan->VChan = init_SourceVChan_type(VChanName, dataset->dataType, chan, NULL) );
+
+	// register VChan with the Task Controller and with DAQLab
+	errChk( AddSourceVChan(rp->taskController, chan->VChan, &errorInfo.errMsg) );
+	DLRegisterVChan((DAQLabModule_type*)rp, (VChan_type*)chan->VChan);
+
+	nullChk( ListInsertItem(rp->channels, &chan, END_OF_LIST) );
+
+	OKfree(VChanName);
+	*chanPtr = chan;
+
+	return 0;
+
+Error:
+
+	// cleanup
+	OKfree(VChanName);
+	if (chan && chan->VChan) {
+		RemoveSourceVChan(rp->taskController, chan->VChan, NULL);
+		DLUnregisterVChan((DAQLabModule_type*)rp, (VChan_type*)chan->VChan);
+	}
+	discard_ReplayChan_type(&chan);
+
+RETURN_ERR
+}
+
+static void discard_ReplayChan_type (ReplayChan_type** chanPtr)
+{
+	ReplayChan_type*	chan = *chanPtr;
+	if (!chan) return;
+
+	OKfree(chan->name);
+	discard_VChan_type((VChan_type**)&chan->VChan);
+
+	OKfree(*chanPtr);
+}
+
+static int AddReplayItems (DataReplay_type* rp, HDF5Dataset_type* dataset, ReplayChan_type* chan, char** errorMsg)
+{
+INIT_ERR
+
+	ReplayItem_type		item		= {.dataset = dataset, .chan = chan, .indices = NULL, .nIndices = 0};
+	unsigned int*		indices		= NULL;
+	unsigned int		nIndices	= 0;
+	size_t				nItems		= 1;
+
+	if (dataset->dataType == DL_Image) {
+		// one item for each image in the stack
+		nIndices	= 1;
+		nItems		= (size_t) dataset->dims[0];
+	} else {
+		// one item for each combination of waveform iteration indices
+		nIndices	= dataset->rank - 1;
+		for (unsigned int i = 1; i < dataset->rank; i++)
+			nItems *= (size_t) dataset->dims[i];
+	}
+
+	if (!nItems) return 0;
+
+	if (nIndices)
+		nullChk( indices = calloc(nIndices, sizeof(unsigned int)) );
+
+	for (size_t i = 0; i < nItems; i++) {
+		item.nIndices	= nIndices;
+		item.indices	= NULL;
+		if (nIndices) {
+			nullChk( item.indices = malloc(nIndices * sizeof(unsigned int)) );
+			memcpy(item.indices, indices, nIndices * sizeof(unsigned int));
+		}
+
+		nullChk( ListInsertItem(rp->items, &item, END_OF_LIST) );
+		item.indices = NULL;
+
+		// advance indices, last index first
+		if (dataset->dataType == DL_Image)
+			indices[0]++;
+		else
+			for (unsigned int j = nIndices; j >= 1; j--) {
+				if (++indices[j-1] < dataset->dims[j]) break;
+				indices[j-1] = 0;
+			}
+	}
+
+Error:
+
+	// cleanup
+	OKfree(item.indices);
+	OKfree(indices);
+
+RETURN_ERR
+}
+
+static int CVICALLBACK CompareReplayItems (void* item1, void* item2)
+{
+	ReplayItem_type*	a		= item1;
+	ReplayItem_type*	b		= item2;
+	int					result	= 0;
+
+	// group names contain the iteration indices of the parent Task Controllers, which are not zero padded
+	if ((result = CompareGroupNames(a->dataset->groupName, b->dataset->groupName))) return result;
+
+	for (unsigned int i = 0; i < a->nIndices && i < b->nIndices; i++)
+		if (a->indices[i] != b->indices[i])
+			return (a->indices[i] < b->indices[i])? -1 : 1;
+
+	if (a->nIndices != b->nIndices)
+		return (a->nIndices < b->nIndices)? -1 : 1;
+
+	return strcmp(a->dataset->datasetName, b->dataset->datasetName);
+}
+
+static int CompareGroupNames (char groupName1[], char groupName2[])
+{
+	char*				a		= groupName1;
+	char*				b		= groupName2;
+	unsigned long		idxA	= 0;
+	unsigned long		idxB	= 0;
+
+	// group names are of the form "TC name#iteration index/TC name#iteration index/...", so after each '#' the iteration indices are compared as numbers
+	while (*a && *a == *b) {
+		if (*a == '#' && isdigit((unsigned char)a[1]) && isdigit((unsigned char)b[1])) {
+			idxA = strtoul(a + 1, &a, 10);
+			idxB = strtoul(b + 1, &b, 10);
+			if (idxA != idxB)
+				return (idxA < idxB)? -1 : 1;
+
+			continue;
+		}
+
+		a++;
+		b++;
+	}
+
+	return (unsigned char)*a - (unsigned char)*b;
+}
+
+static int BuildReplaySteps (DataReplay_type* rp, char** errorMsg)
+{
+INIT_ERR
+
+	size_t				nItems		= ListNumItems(rp->items);
+	ReplayItem_type*	item		= NULL;
+	ReplayItem_type*	stepItem	= NULL;
+	ReplayStep_type		step		= {.firstItem = 0, .nItems = 0};
+
+	ListClear(rp->steps);
+
+	for (size_t i = 1; i <= nItems; i++) {
+		item = ListGetPtrToItem(rp->items, i);
+
+		// items that differ only by dataset name are sent in the same step
+		if (stepItem && !strcmp(item->dataset->groupName, stepItem->dataset->groupName) && item->nIndices == stepItem->nIndices &&
+			(!item->nIndices || !memcmp(item->indices, stepItem->indices, item->nIndices * sizeof(unsigned int)))) {
+			step.nItems++;
+			continue;
+		}
+
+		if (stepItem)
+			nullChk( ListInsertItem(rp->steps, &step, END_OF_LIST) );
+
+		stepItem		= item;
+		step.firstItem	= i;
+		step.nItems		= 1;
+	}
+
+	if (stepItem)
+		nullChk( ListInsertItem(rp->steps, &step, END_OF_LIST) );
+
+Error:
+
+RETURN_ERR
+}
+
+static DSInfo_type* InitReplayItemDSInfo (ReplayItem_type* item)
+{
+	DSInfo_type*	dsInfo		= NULL;
+	unsigned int*	indices		= NULL;
+
+	if ( !(dsInfo = init_DSInfo_type()) ) return NULL;
+
+	if (item->nIndices) {
+		if ( !(indices = malloc(item->nIndices * sizeof(unsigned int))) ) goto Error;
+		memcpy(indices, item->indices, item->nIndices * sizeof(unsigned int));
+	}
+
+	SetDSInfoGroupName(dsInfo, item->dataset->groupName);
+	SetDSInfoIterIndices(dsInfo, &indices);
+	SetDSInfoDatasetRank(dsInfo, item->nIndices);
+	SetDSDataRank(dsInfo, (item->dataset->dataType == DL_Image)? IMAGERANK : WAVERANK);
+
+	return dsInfo;
+
+Error:
+
+	discard_DSInfo_type(&dsInfo);
+	return NULL;
+}
+
+static void UpdateReplayInfo (DataReplay_type* rp)
+{
+	char				line[ReplayInfoLineLength]	= "";
+	size_t				nDatasets					= ListNumItems(rp->datasets);
+	HDF5Dataset_type*	dataset						= NULL;
+	char*				dimsString					= NULL;
+	char				dimBuff[32]					= "";
+
+	if (!rp->mainPanHndl) return;
+
+	ResetTextBox(rp->mainPanHndl, rp->infoCtrl, "");
+	if (!rp->fileName) return;
+
+	for (size_t i = 1; i <= nDatasets; i++) {
+		dataset = *(HDF5Dataset_type**)ListGetPtrToItem(rp->datasets, i);
+
+		dimsString = StrDup("");
+		for (unsigned int j = 0; j < dataset->rank; j++) {
+			snprintf(dimBuff, sizeof(dimBuff), "%s%llu", (j)? " x " : "", dataset->dims[j]);
+			AppendString(&dimsString, dimBuff, -1);
+		}
+
+		snprintf(line, ReplayInfoLineLength, "%s/%s: %s [%s]", dataset->groupName, dataset->datasetName, (dataset->dataType == DL_Image)? "images" : "waveforms",
+				 (dimsString)? dimsString : "");
+		InsertTextBoxLine(rp->mainPanHndl, rp->infoCtrl, -1, line);
+		OKfree(dimsString);
+	}
+
+	snprintf(line, ReplayInfoLineLength, "%d channels, %d data packets in %d iterations.", (int)ListNumItems(rp->channels), (int)ListNumItems(rp->items),
+			 (int)ListNumItems(rp->steps));
+	InsertTextBoxLine(rp->mainPanHndl, rp->infoCtrl, -1, line);
+}
+
+static BOOL WaitForReplayTime (DataReplay_type* rp, double recordedTime, BOOL const* abortFlag)
+{
+	double	speed		= 1;
+	double	replayTime	= 0;
+
+	switch (rp->rateMode) {
+
+		case ReplayRate_Original:
+			speed = 1;
+			break;
+
+		case ReplayRate_Scaled:
+			speed = rp->speedFactor;
+			break;
+
+		case ReplayRate_Max:
+			return !*abortFlag && !GetTaskControlIterationStopFlag(rp->taskController);
+	}
+
+	// wait relative to the start of the replay so that timing errors do not accumulate
+	replayTime = recordedTime / speed;
+	while (Timer() - rp->startTime < replayTime) {
+		if (*abortFlag || GetTaskControlIterationStopFlag(rp->taskController)) return FALSE;
+		SyncWait(Timer(), ReplayWaitInterval);
+	}
+
+	return !*abortFlag && !GetTaskControlIterationStopFlag(rp->taskController);
+}
+
+static int CVICALLBACK UICtrls_CB (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
+{
+INIT_ERR
+
+	DataReplay_type*	rp								= callbackData;
+	char				fileName[MAX_PATHNAME_LEN]		= "";
+	int					rateMode						= 0;
+
+	if (event != EVENT_COMMIT) return 0;
+
+	if (control == rp->browseCtrl) {
+
+		if (FileSelectPopup("", "*.h5", "*.h5;*.hdf5", "Select replay file", VAL_LOAD_BUTTON, 0, 1, 1, 0, fileName) <= 0) return 0;
+
+		errChk( OpenReplayFile(rp, fileName, &errorInfo.errMsg) );
+		errChk( TaskControlEvent(rp->taskController, TC_Event_Configure, NULL, NULL, &errorInfo.errMsg) );
+
+	} else if (control == rp->rateModeCtrl) {
+
+		GetCtrlVal(panel, control, &rateMode);
+		rp->rateMode = (ReplayRateModes) rateMode;
+		SetCtrlAttribute(panel, rp->speedFactorCtrl, ATTR_DIMMED, rp->rateMode != ReplayRate_Scaled);
+
+	} else if (control == rp->speedFactorCtrl)
+
+		GetCtrlVal(panel, control, &rp->speedFactor);
+
+Error:
+
+PRINT_ERR
+
+	return 0;
+}
+
+//-----------------------------------------
+// Task Controller Callbacks
+//-----------------------------------------
+
+static int ConfigureTC (TaskControl_type* taskControl, BOOL const* abortFlag, char** errorMsg)
+{
+	DataReplay_type*	rp		= GetTaskControlModuleData(taskControl);
+
+	// one iteration for each replay step
+	SetTaskControlIterations(taskControl, ListNumItems(rp->steps));
+
+	return 0;
+}
+
+static void IterateTC (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag)
+{
+#define IterateTC_Err_NoReplayData		-1
+
+INIT_ERR
+
+	DataReplay_type*	rp					= GetTaskControlModuleData(taskControl);
+	size_t				stepIdx				= GetCurrentIterIndex(iterator);
+	ReplayStep_type*	step				= NULL;
+	ReplayItem_type*	item				= NULL;
+	DataPacket_type**	dataPackets			= NULL;
+	size_t				nPackets			= 0;
+	Waveform_type*		waveform			= NULL;
+	Image_type*			image				= NULL;
+	DSInfo_type*		dsInfo				= NULL;
+	double				readStartTime		= 0;
+	double				stepDuration		= 0;
+	double				samplingRate		= 0;
+	unsigned long long	nBytes				= 0;
+	int					imgWidth			= 0;
+	int					imgHeight			= 0;
+
+	if (stepIdx >= ListNumItems(rp->steps))
+		SET_ERR(IterateTC_Err_NoReplayData, "There is no recorded data left to replay.");
+
+	step = ListGetPtrToItem(rp->steps, stepIdx + 1);
+	nullChk( dataPackets = calloc(step->nItems, sizeof(DataPacket_type*)) );
+
+	// open the replay file if the replay run did not start with StartTC, e.g. when iterating once
+	if (rp->fileID <= 0)
+		errChk( OpenHDF5File(rp->fileName, &rp->fileID, &errorInfo.errMsg) );
+
+	// read data for this step, the step lasts as long as its longest waveform
+	readStartTime = Timer();
+	for (size_t i = 0; i < step->nItems; i++) {
+		item = ListGetPtrToItem(rp->items, step->firstItem + i);
+		nullChk( dsInfo = InitReplayItemDSInfo(item) );
+
+		if (item->dataset->dataType == DL_Image) {
+			errChk( ReadHDF5Image(rp->fileID, item->dataset, item->indices[0], &image, &errorInfo.errMsg) );
+			GetImageSize(image, &imgWidth, &imgHeight);
+			nBytes += (unsigned long long) imgWidth * imgHeight * GetImageSizeofData(image);
+			nullChk( dataPackets[i] = init_DataPacket_type(DL_Image, (void**)&image, &dsInfo, (DiscardFptr_type) discard_Image_type) );
+		} else {
+			errChk( ReadHDF5Waveform(rp->fileID, item->dataset, item->indices, &waveform, &errorInfo.errMsg) );
+			samplingRate = GetWaveformSamplingRate(waveform);
+			if (samplingRate > 0 && GetWaveformNumSamples(waveform) / samplingRate > stepDuration)
+				stepDuration = GetWaveformNumSamples(waveform) / samplingRate;
+			nBytes += (unsigned long long) GetWaveformNumSamples(waveform) * GetWaveformSizeofData(waveform);
+			nullChk( dataPackets[i] = init_DataPacket_type(item->dataset->dataType, (void**)&waveform, &dsInfo, (DiscardFptr_type) discard_Waveform_type) );
+		}
+		nPackets++;
+	}
+	rp->readTime += Timer() - readStartTime;
+
+	// send data when it would have been available during the recording
+	rp->recordedTime += stepDuration;
+	if (!WaitForReplayTime(rp, rp->recordedTime, abortIterationFlag)) goto Stopped;
+
+	for (size_t i = 0; i < nPackets; i++) {
+		item = ListGetPtrToItem(rp->items, step->firstItem + i);
+		errChk( SendDataPacket(item->chan->VChan, &dataPackets[i], FALSE, &errorInfo.errMsg) );
+	}
+
+	// send NULL packets to terminate transmission
+	for (size_t i = 0; i < nPackets; i++) {
+		item = ListGetPtrToItem(rp->items, step->firstItem + i);
+		errChk( SendNullPacket(item->chan->VChan, &errorInfo.errMsg) );
+	}
+
+	rp->nPacketsSent	+= nPackets;
+	rp->nBytesSent		+= nBytes;
+
+Stopped:
+
+	// iterations that are completed, stopped or failed share the same cleanup and report completion only once
+
+Error:
+
+	// cleanup
+	for (size_t i = 0; i < nPackets; i++)
+		discard_DataPacket_type(&dataPackets[i]);
+	OKfree(dataPackets);
+	discard_Waveform_type(&waveform);
+	discard_Image_type(&image);
+	discard_DSInfo_type(&dsInfo);
+
+	TaskControlIterationDone(taskControl, errorInfo.error, errorInfo.errMsg, FALSE, NULL);
+	OKfree(errorInfo.errMsg);
+}
+
+static int StartTC (TaskControl_type* taskControl, BOOL const* abortFlag, char** errorMsg)
+{
+INIT_ERR
+
+	DataReplay_type*	rp		= GetTaskControlModuleData(taskControl);
+
+	// open the replay file once for the whole replay run
+	CloseHDF5File(&rp->fileID);
+	if (rp->fileName)
+		errChk( OpenHDF5File(rp->fileName, &rp->fileID, &errorInfo.errMsg) );
+
+	rp->startTime		= Timer();
+	rp->recordedTime	= 0;
+	rp->readTime		= 0;
+	rp->nPacketsSent	= 0;
+	rp->nBytesSent		= 0;
+
+Error:
+
+RETURN_ERR
+}
+
+static int DoneTC (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg)
+{
+	DataReplay_type*	rp							= GetTaskControlModuleData(taskControl);
+	double				elapsedTime					= Timer() - rp->startTime;
+	double				nMBytes						= rp->nBytesSent / 1048576.0;
+	char				msg[ReplayInfoLineLength]	= "";
+
+	CloseHDF5File(&rp->fileID);
+
+	// report replay throughput, in "As fast as possible" mode this is the throughput of the processing chain connected to the replay VChans
+	if (elapsedTime <= 0) return 0;
+
+	snprintf(msg, ReplayInfoLineLength, "%s: replayed %d packets (%.2f MB) in %.3f s, %.1f packets/s, %.2f MB/s. Reading from file took %.3f s.\n",
+			 rp->baseClass.instanceName, (int)rp->nPacketsSent, nMBytes, elapsedTime, rp->nPacketsSent / elapsedTime, nMBytes / elapsedTime, rp->readTime);
+	DLMsg(msg, 0);
+
+	return 0;
+}
+
+static int StoppedTC (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg)
+{
+	return DoneTC(taskControl, iterator, abortFlag, errorMsg);
+}
+
+static int TaskTreeStateChange (TaskControl_type* taskControl, TaskTreeStates state, char** errorMsg)
+{
+	DataReplay_type*	rp		= GetTaskControlModuleData(taskControl);
+
+	// the replay file cannot be changed while data is replayed
+	if (rp->mainPanHndl)
+		SetCtrlAttribute(rp->mainPanHndl, rp->browseCtrl, ATTR_DIMMED, (int) state);
+
+	return 0;
+}
+
+static void ErrorTC (TaskControl_type* taskControl, int errorID, char errorMsg[])
+{
+	DataReplay_type*	rp		= GetTaskControlModuleData(taskControl);
+
+	CloseHDF5File(&rp->fileID);
+
+	// print error message
+	DLMsg(errorMsg, 1);
+}
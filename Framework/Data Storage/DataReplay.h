@@ -0,0 +1,48 @@
+//==============================================================================
+//
+// Title:		DataReplay.h
+// Purpose:		Replays data recorded with the Data Storage module through Source VChans.
+//
+// Created on:	18-10-2026 at 16:53:26 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public 
+//              License v. 2.0. If a copy of the MPL was not distributed with this 
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ . 
+//
+//==============================================================================
+
+#ifndef __DataReplay_H__
+#define __DataReplay_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//==============================================================================
+// Include files
+
+#include "DAQLabModule.h"
+
+//==============================================================================
+// Constants
+
+#define MOD_DataReplay_NAME 		"Data Replay"
+
+//==============================================================================
+// Types
+
+typedef struct DataReplay		DataReplay_type;
+
+//==============================================================================
+// Global functions
+
+DAQLabModule_type*	initalloc_DataReplay 	(DAQLabModule_type* mod, char className[], char instanceName[], int workspacePanHndl);
+
+void 				discard_DataReplay    	(DAQLabModule_type** mod);
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __DataReplay_H__ */
@@ -138,7 +138,7 @@ DAQLabModule_type*	initalloc_DataStorage (DAQLabModule_type* mod, char className
 	ds->overwrite_files		= FALSE;
 	
 	// create Data Storage Task Controller
-	tc = init_TaskControl_type (instanceName, ds, DLGetCommonThreadPoolHndl(), NULL, NULL, NULL, NULL, NULL,
+	tc = init_TaskControl_type (instanceName, ds, DLGetThreadPoolHndl(DL_ThreadPool_Storage), NULL, NULL, NULL, NULL, NULL,
 								 NULL, NULL, NULL, TaskTreeStateChange, NULL, NULL, ErrorTC);
 	if (!tc) {discard_DAQLabModule((DAQLabModule_type**)&ds); return NULL;}
 	
@@ -112,6 +112,19 @@ static char* 					RemoveSlashes 						(char* name);
 	// coverts waveform data types to HDF5 data types
 static void						WaveformDataTypeToHDF5				(WaveformTypes waveformType, hid_t* typeIDPtr, hid_t* memTypeIDPtr);
 
+	//----------------------------------
+	// Reading
+	//----------------------------------
+	// H5Ovisit callback collecting dataset paths
+static herr_t					CollectDatasetPaths					(hid_t objID, const char* name, const H5O_info_t* info, void* opData);
+static int						InitHDF5DatasetFromFile				(hid_t fileID, char datasetPath[], HDF5Dataset_type** datasetPtr, char** errorMsg);
+static int						ReadStringAttr						(hid_t datasetID, char attr_name[], char** attr_dataPtr, char** errorMsg);
+static int						ReadDoubleAttrArrElement			(hid_t datasetID, char attr_name[], size_t index, double* attr_data, char** errorMsg);
+static char*					GetHDF5DatasetPath					(HDF5Dataset_type* dataset);
+	// converts HDF5 data types to waveform data types, returns FALSE if there is no matching waveform type
+static BOOL						HDF5ToWaveformDataType				(hid_t typeID, WaveformTypes* waveformTypePtr);
+static BOOL						WaveformToImageType					(WaveformTypes waveformType, ImageTypes* imageTypePtr);
+
 
 //==============================================================================
 // Global variables
@@ -636,6 +649,318 @@ Error:
 RETURN_ERR
 }
 
+int GetHDF5Datasets (char fileName[], ListType datasets, char** errorMsg)
+{
+#define GetHDF5Datasets_Err_NoFile		-1
+	
+INIT_ERR
+
+	hid_t					fileID				= 0;
+	ListType				datasetPaths		= 0;	// List of char* dataset paths in the file.
+	char**					datasetPathPtr		= NULL;
+	size_t					nDatasetPaths		= 0;
+	HDF5Dataset_type*		dataset				= NULL;
+	
+	// check if a file name is given
+	if (!fileName || !fileName[0])
+		SET_ERR(GetHDF5Datasets_Err_NoFile, "No file name given.");
+	
+	nullChk( datasetPaths = ListCreate(sizeof(char*)) );
+	
+	hdf5ErrChk( fileID = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT) );
+	
+	// collect the paths of all datasets in the file
+	hdf5ErrChk( H5Ovisit(fileID, H5_INDEX_NAME, H5_ITER_INC, CollectDatasetPaths, datasetPaths) );
+	
+	// describe each dataset, skipping datasets that were not written as waveforms or images
+	nDatasetPaths = ListNumItems(datasetPaths);
+	for (size_t i = 1; i <= nDatasetPaths; i++) {
+		datasetPathPtr = ListGetPtrToItem(datasetPaths, i);
+		errChk( InitHDF5DatasetFromFile(fileID, *datasetPathPtr, &dataset, &errorInfo.errMsg) );
+		if (!dataset) continue;
+		
+		nullChk( ListInsertItem(datasets, &dataset, END_OF_LIST) );
+		dataset = NULL;
+	}
+	
+	hdf5ErrChk( H5Fclose(fileID) );
+	fileID = 0;
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (fileID > 0) H5Fclose(fileID);
+	discard_HDF5Dataset_type(&dataset);
+	
+	if (datasetPaths) {
+		nDatasetPaths = ListNumItems(datasetPaths);
+		for (size_t i = 1; i <= nDatasetPaths; i++) {
+			datasetPathPtr = ListGetPtrToItem(datasetPaths, i);
+			OKfree(*datasetPathPtr);
+		}
+		ListDispose(datasetPaths);
+	}
+	
+RETURN_ERR
+}
+
+void discard_HDF5Dataset_type (HDF5Dataset_type** datasetPtr)
+{
+	HDF5Dataset_type*	dataset = *datasetPtr;
+	if (!dataset) return;
+	
+	OKfree(dataset->groupName);
+	OKfree(dataset->datasetName);
+	OKfree(dataset->dims);
+	
+	OKfree(*datasetPtr);
+}
+
+int OpenHDF5File (char fileName[], hid_t* fileIDPtr, char** errorMsg)
+{
+INIT_ERR
+
+	hid_t					fileID				= 0;
+	
+	*fileIDPtr = 0;
+	
+	hdf5ErrChk( fileID = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT) );
+	*fileIDPtr = fileID;
+	
+HDF5Error:
+	
+Error:
+	
+RETURN_ERR
+}
+
+void CloseHDF5File (hid_t* fileIDPtr)
+{
+	if (*fileIDPtr <= 0) return;
+	
+	H5Fclose(*fileIDPtr);
+	*fileIDPtr = 0;
+}
+
+int ReadHDF5Waveform (hid_t fileID, HDF5Dataset_type* dataset, unsigned int indices[], Waveform_type** waveformPtr, char** errorMsg)
+{
+#define ReadHDF5Waveform_Err_NotWaveform	-1
+#define ReadHDF5Waveform_Err_IndexOutOfRange	-2
+	
+INIT_ERR
+
+	unsigned int			rank				= dataset->rank;
+	hid_t					datasetID			= 0;
+	hid_t					fileSpaceID			= 0;
+	hid_t					memSpaceID			= 0;
+	hid_t					typeID				= 0;
+	hid_t					memTypeID			= 0;
+	hsize_t*				offset				= NULL;
+	hsize_t*				count				= NULL;
+	hsize_t					memDims[1]			= {0};
+	unsigned long long		nSamples			= dataset->dims[0];
+	void*					waveformData		= NULL;
+	Waveform_type*			waveform			= NULL;
+	char*					datasetPath			= NULL;
+	char*					waveformName		= NULL;
+	char*					unitName			= NULL;
+	
+	*waveformPtr = NULL;
+	
+	if (dataset->dataType < DL_Waveform_Char || dataset->dataType > DL_Waveform_Double)
+		SET_ERR(ReadHDF5Waveform_Err_NotWaveform, "Dataset does not contain waveforms.");
+	
+	for (unsigned int i = 1; i < rank; i++)
+		if (indices[i-1] >= dataset->dims[i])
+			SET_ERR(ReadHDF5Waveform_Err_IndexOutOfRange, "Waveform index out of range.");
+	
+	nullChk( offset	= calloc(rank, sizeof(hsize_t)) );
+	nullChk( count	= calloc(rank, sizeof(hsize_t)) );
+	nullChk( datasetPath = GetHDF5DatasetPath(dataset) );
+	
+	hdf5ErrChk( datasetID = H5Dopen2(fileID, datasetPath, H5P_DEFAULT) );
+	
+	// waveforms stored along the first index may have different lengths, their number of elements being kept in an attribute
+	if (rank > 1 && H5Aexists(datasetID, NUMELEMENTS_NAME) > 0) {
+		errChk( ReadNumElemAttr(datasetID, indices[0], &nSamples, (size_t)dataset->dims[1], &errorInfo.errMsg) );
+		if (nSamples > dataset->dims[0]) nSamples = dataset->dims[0];
+	}
+	
+	// select waveform samples
+	count[0] = nSamples;
+	for (unsigned int i = 1; i < rank; i++) {
+		offset[i]	= indices[i-1];
+		count[i]	= 1;
+	}
+	
+	hdf5ErrChk( fileSpaceID = H5Dget_space(datasetID) );
+	hdf5ErrChk( H5Sselect_hyperslab(fileSpaceID, H5S_SELECT_SET, offset, NULL, count, NULL) );
+	memDims[0] = nSamples;
+	hdf5ErrChk( memSpaceID = H5Screate_simple(1, memDims, NULL) );
+	
+	WaveformDataTypeToHDF5(dataset->waveformType, &typeID, &memTypeID);
+	
+	if (nSamples) {
+		nullChk( waveformData = malloc((size_t)nSamples * H5Tget_size(memTypeID)) );
+		hdf5ErrChk( H5Dread(datasetID, memTypeID, memSpaceID, fileSpaceID, H5P_DEFAULT, waveformData) );
+	}
+	
+	nullChk( waveform = init_Waveform_type(dataset->waveformType, dataset->samplingRate, (size_t)nSamples, &waveformData) );
+	
+	// waveform info
+	errChk( ReadStringAttr(datasetID, "Name", &waveformName, &errorInfo.errMsg) );
+	if (waveformName) SetWaveformName(waveform, waveformName);
+	errChk( ReadStringAttr(datasetID, "Units", &unitName, &errorInfo.errMsg) );
+	if (unitName) SetWaveformPhysicalUnit(waveform, unitName);
+	
+	hdf5ErrChk( H5Sclose(memSpaceID) );
+	memSpaceID = 0;
+	hdf5ErrChk( H5Sclose(fileSpaceID) );
+	fileSpaceID = 0;
+	hdf5ErrChk( H5Dclose(datasetID) );
+	datasetID = 0;
+	
+	*waveformPtr = waveform;
+	waveform = NULL;
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (memSpaceID > 0) H5Sclose(memSpaceID);
+	if (fileSpaceID > 0) H5Sclose(fileSpaceID);
+	if (datasetID > 0) H5Dclose(datasetID);
+	
+	OKfree(offset);
+	OKfree(count);
+	OKfree(datasetPath);
+	OKfree(waveformData);
+	OKfree(waveformName);
+	OKfree(unitName);
+	discard_Waveform_type(&waveform);
+	
+RETURN_ERR
+}
+
+int ReadHDF5Image (hid_t fileID, HDF5Dataset_type* dataset, size_t imageIdx, Image_type** imagePtr, char** errorMsg)
+{
+#define ReadHDF5Image_Err_NotImage			-1
+#define ReadHDF5Image_Err_IndexOutOfRange	-2
+	
+INIT_ERR
+
+	hid_t					datasetID			= 0;
+	hid_t					fileSpaceID			= 0;
+	hid_t					memSpaceID			= 0;
+	hid_t					attributeID			= 0;
+	hid_t					memTypeID			= 0;
+	hsize_t					offset[3]			= {imageIdx, 0, 0};
+	hsize_t					count[3]			= {1, 0, 0};
+	double					pixSize[3]			= {0};
+	double					imgTopLeftXCoord	= 0;
+	double					imgTopLeftYCoord	= 0;
+	double					imgZCoord			= 0;
+	void*					pixels				= NULL;
+	Image_type*				image				= NULL;
+	char*					datasetPath			= NULL;
+	
+	*imagePtr = NULL;
+	
+	if (dataset->dataType != DL_Image || dataset->rank != 3)
+		SET_ERR(ReadHDF5Image_Err_NotImage, "Dataset does not contain images.");
+	
+	if (imageIdx >= dataset->dims[0])
+		SET_ERR(ReadHDF5Image_Err_IndexOutOfRange, "Image index out of range.");
+	
+	count[1] = dataset->dims[1];
+	count[2] = dataset->dims[2];
+	
+	switch (dataset->imageType) {
+			
+		case Image_UChar:
+			memTypeID = H5T_NATIVE_UCHAR;
+			break;
+			
+		case Image_UShort:
+			memTypeID = H5T_NATIVE_USHORT;
+			break;
+			
+		case Image_Short:
+			memTypeID = H5T_NATIVE_SHORT;
+			break;
+			
+		case Image_UInt:
+			memTypeID = H5T_NATIVE_UINT;
+			break;
+			
+		case Image_Int:
+			memTypeID = H5T_NATIVE_INT;
+			break;
+			
+		case Image_Float:
+			memTypeID = H5T_NATIVE_FLOAT;
+			break;
+			
+		default:
+			SET_ERR(ReadHDF5Image_Err_NotImage, "Image pixel type not supported.");
+	}
+	
+	nullChk( datasetPath = GetHDF5DatasetPath(dataset) );
+	nullChk( pixels = malloc((size_t)(count[1] * count[2]) * H5Tget_size(memTypeID)) );
+	
+	hdf5ErrChk( datasetID = H5Dopen2(fileID, datasetPath, H5P_DEFAULT) );
+	
+	// select image from the stack
+	hdf5ErrChk( fileSpaceID = H5Dget_space(datasetID) );
+	hdf5ErrChk( H5Sselect_hyperslab(fileSpaceID, H5S_SELECT_SET, offset, NULL, count, NULL) );
+	hdf5ErrChk( memSpaceID = H5Screate_simple(3, count, NULL) );
+	hdf5ErrChk( H5Dread(datasetID, memTypeID, memSpaceID, fileSpaceID, H5P_DEFAULT, pixels) );
+	
+	nullChk( image = init_Image_type(dataset->imageType, (int)count[1], (int)count[2], &pixels) );
+	
+	// pixel size
+	hdf5ErrChk( attributeID = H5Aopen(datasetID, PIXELSIZE_NAME, H5P_DEFAULT) );
+	hdf5ErrChk( H5Aread(attributeID, H5T_NATIVE_DOUBLE, pixSize) );
+	hdf5ErrChk( H5Aclose(attributeID) );
+	attributeID = 0;
+	SetImagePixSize(image, pixSize[0]);
+	
+	// image coordinates
+	errChk( ReadDoubleAttrArrElement(datasetID, "TopLeftXCoord", imageIdx, &imgTopLeftXCoord, &errorInfo.errMsg) );
+	errChk( ReadDoubleAttrArrElement(datasetID, "TopLeftYCoord", imageIdx, &imgTopLeftYCoord, &errorInfo.errMsg) );
+	errChk( ReadDoubleAttrArrElement(datasetID, "ZCoord", imageIdx, &imgZCoord, &errorInfo.errMsg) );
+	SetImageCoord(image, imgTopLeftXCoord, imgTopLeftYCoord, imgZCoord);
+	
+	hdf5ErrChk( H5Sclose(memSpaceID) );
+	memSpaceID = 0;
+	hdf5ErrChk( H5Sclose(fileSpaceID) );
+	fileSpaceID = 0;
+	hdf5ErrChk( H5Dclose(datasetID) );
+	datasetID = 0;
+	
+	*imagePtr = image;
+	image = NULL;
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (attributeID > 0) H5Aclose(attributeID);
+	if (memSpaceID > 0) H5Sclose(memSpaceID);
+	if (fileSpaceID > 0) H5Sclose(fileSpaceID);
+	if (datasetID > 0) H5Dclose(datasetID);
+	
+	OKfree(pixels);
+	OKfree(datasetPath);
+	discard_Image_type(&image);
+	
+RETURN_ERR
+}
+
 static int CreateRootGroup (hid_t fileID, char *group_name, char** errorMsg)
 {
 INIT_ERR
@@ -1406,4 +1731,275 @@ Error:
 RETURN_ERR
 }
 
+// H5Ovisit callback, adds the full path of each dataset to a list of char* elements passed as opData.
+static herr_t CollectDatasetPaths (hid_t objID, const char* name, const H5O_info_t* info, void* opData)
+{
+	ListType	datasetPaths	= opData;
+	char*		datasetPath		= NULL;
+	
+	if (info->type != H5O_TYPE_DATASET) return 0;
+	
+	if ( !(datasetPath = StrDup(name)) ) return -1;
+	if (!ListInsertItem(datasetPaths, &datasetPath, END_OF_LIST)) {
+		OKfree(datasetPath);
+		return -1;
+	}
+	
+	return 0;
+}
 
+// Creates a dataset description from a dataset in an open file. If the dataset was not written as waveforms or images, *datasetPtr is set to NULL.
+static int InitHDF5DatasetFromFile (hid_t fileID, char datasetPath[], HDF5Dataset_type** datasetPtr, char** errorMsg)
+{
+INIT_ERR
+
+	hid_t					datasetID			= 0;
+	hid_t					dataSpaceID			= 0;
+	hid_t					typeID				= 0;
+	hid_t					attributeID			= 0;
+	int						rank				= 0;
+	hsize_t					dims[H5S_MAX_RANK]	= {0};
+	WaveformTypes			waveformType		= Waveform_UChar;
+	ImageTypes				imageType			= Image_UChar;
+	BOOL					isImage				= FALSE;
+	HDF5Dataset_type*		dataset				= NULL;
+	char*					lastSlash			= NULL;
+	
+	*datasetPtr = NULL;
+	
+	hdf5ErrChk( datasetID = H5Dopen2(fileID, datasetPath, H5P_DEFAULT) );
+	hdf5ErrChk( dataSpaceID = H5Dget_space(datasetID) );
+	hdf5ErrChk( rank = H5Sget_simple_extent_dims(dataSpaceID, dims, NULL) );
+	hdf5ErrChk( typeID = H5Dget_type(datasetID) );
+	
+	// skip datasets with data types that cannot be sent as waveforms or images
+	if (rank < 1 || !HDF5ToWaveformDataType(typeID, &waveformType)) goto Skip;
+	
+	// image stacks are written with a pixel size attribute
+	if (H5Aexists(datasetID, PIXELSIZE_NAME) > 0) {
+		if (rank != 3 || !WaveformToImageType(waveformType, &imageType)) goto Skip;
+		isImage = TRUE;
+	}
+	
+	nullChk( dataset = malloc(sizeof(HDF5Dataset_type)) );
+	dataset->groupName		= NULL;
+	dataset->datasetName	= NULL;
+	dataset->dataType		= (isImage)? DL_Image : (DLDataTypes)(DL_Waveform_Char + waveformType);
+	dataset->waveformType	= waveformType;
+	dataset->imageType		= imageType;
+	dataset->rank			= (unsigned int) rank;
+	dataset->dims			= NULL;
+	dataset->samplingRate	= 0;
+	
+	nullChk( dataset->dims = malloc(rank * sizeof(unsigned long long)) );
+	for (int i = 0; i < rank; i++)
+		dataset->dims[i] = dims[i];
+	
+	// split path into group name and dataset name
+	lastSlash = strrchr(datasetPath, '/');
+	if (lastSlash) {
+		nullChk( dataset->datasetName = StrDup(lastSlash + 1) );
+		*lastSlash = 0;
+		nullChk( dataset->groupName = StrDup(datasetPath) );
+		*lastSlash = '/';
+	} else {
+		nullChk( dataset->datasetName = StrDup(datasetPath) );
+		nullChk( dataset->groupName = StrDup("") );
+	}
+	
+	// sampling rate
+	if (!isImage && H5Aexists(datasetID, "SamplingRate") > 0) {
+		hdf5ErrChk( attributeID = H5Aopen(datasetID, "SamplingRate", H5P_DEFAULT) );
+		hdf5ErrChk( H5Aread(attributeID, H5T_NATIVE_DOUBLE, &dataset->samplingRate) );
+		hdf5ErrChk( H5Aclose(attributeID) );
+		attributeID = 0;
+	}
+	
+	*datasetPtr = dataset;
+	dataset = NULL;
+	
+Skip:
+	
+	errorInfo.error = 0;
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (attributeID > 0) H5Aclose(attributeID);
+	if (typeID > 0) H5Tclose(typeID);
+	if (dataSpaceID > 0) H5Sclose(dataSpaceID);
+	if (datasetID > 0) H5Dclose(datasetID);
+	discard_HDF5Dataset_type(&dataset);
+	
+RETURN_ERR
+}
+
+// Reads a string attribute if it exists, otherwise *attr_dataPtr is set to NULL.
+static int ReadStringAttr (hid_t datasetID, char attr_name[], char** attr_dataPtr, char** errorMsg)
+{
+INIT_ERR
+
+	hid_t		attributeID		= 0;
+	hid_t		datatype		= 0;
+	size_t		size			= 0;
+	char*		attr_data		= NULL;
+	
+	*attr_dataPtr = NULL;
+	if (H5Aexists(datasetID, attr_name) <= 0) return 0;
+	
+	hdf5ErrChk( attributeID = H5Aopen(datasetID, attr_name, H5P_DEFAULT) );
+	hdf5ErrChk( datatype = H5Aget_type(attributeID) );
+	size = H5Tget_size(datatype);
+	nullChk( attr_data = calloc(size + 1, sizeof(char)) );
+	hdf5ErrChk( H5Aread(attributeID, datatype, attr_data) );
+	
+	*attr_dataPtr = attr_data;
+	attr_data = NULL;
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (datatype > 0) H5Tclose(datatype);
+	if (attributeID > 0) H5Aclose(attributeID);
+	OKfree(attr_data);
+	
+RETURN_ERR
+}
+
+// Reads an element from a double attribute array such as the image coordinates. If the attribute or element does not exist, *attr_data is set to 0.
+static int ReadDoubleAttrArrElement (hid_t datasetID, char attr_name[], size_t index, double* attr_data, char** errorMsg)
+{
+INIT_ERR
+
+	hid_t		attributeID		= 0;
+	hid_t		dataSpaceID		= 0;
+	hssize_t	nElem			= 0;
+	double*		attr_array		= NULL;
+	
+	*attr_data = 0;
+	if (H5Aexists(datasetID, attr_name) <= 0) return 0;
+	
+	hdf5ErrChk( attributeID = H5Aopen(datasetID, attr_name, H5P_DEFAULT) );
+	hdf5ErrChk( dataSpaceID = H5Aget_space(attributeID) );
+	hdf5ErrChk( nElem = H5Sget_simple_extent_npoints(dataSpaceID) );
+	if ((hssize_t)index < nElem) {
+		nullChk( attr_array = malloc(nElem * sizeof(double)) );
+		hdf5ErrChk( H5Aread(attributeID, H5T_NATIVE_DOUBLE, attr_array) );
+		*attr_data = attr_array[index];
+	}
+	
+HDF5Error:
+	
+Error:
+	
+	// cleanup
+	if (dataSpaceID > 0) H5Sclose(dataSpaceID);
+	if (attributeID > 0) H5Aclose(attributeID);
+	OKfree(attr_array);
+	
+RETURN_ERR
+}
+
+// Returns the full path of a dataset in the file. The returned string must be freed by the caller.
+static char* GetHDF5DatasetPath (HDF5Dataset_type* dataset)
+{
+	char*	datasetPath = NULL;
+	
+	if ( !(datasetPath = StrDup(dataset->groupName)) ) return NULL;
+	if (datasetPath[0] && AppendString(&datasetPath, "/", -1) < 0) goto Error;
+	if (AppendString(&datasetPath, dataset->datasetName, -1) < 0) goto Error;
+	
+	return datasetPath;
+	
+Error:
+	
+	OKfree(datasetPath);
+	return NULL;
+}
+
+static BOOL HDF5ToWaveformDataType (hid_t typeID, WaveformTypes* waveformTypePtr)
+{
+	size_t		size		= H5Tget_size(typeID);
+	BOOL		isSigned	= (H5Tget_sign(typeID) == H5T_SGN_2);
+	
+	switch (H5Tget_class(typeID)) {
+			
+		case H5T_INTEGER:
+			
+			switch (size) {
+					
+				case 1:
+					*waveformTypePtr = (isSigned)? Waveform_Char : Waveform_UChar;
+					return TRUE;
+					
+				case 2:
+					*waveformTypePtr = (isSigned)? Waveform_Short : Waveform_UShort;
+					return TRUE;
+					
+				case 4:
+					*waveformTypePtr = (isSigned)? Waveform_Int : Waveform_UInt;
+					return TRUE;
+					
+				case 8:
+					*waveformTypePtr = (isSigned)? Waveform_Int64 : Waveform_UInt64;
+					return TRUE;
+			}
+			break;
+			
+		case H5T_FLOAT:
+			
+			switch (size) {
+					
+				case 4:
+					*waveformTypePtr = Waveform_Float;
+					return TRUE;
+					
+				case 8:
+					*waveformTypePtr = Waveform_Double;
+					return TRUE;
+			}
+			break;
+			
+		default:
+			break;
+	}
+	
+	return FALSE;
+}
+
+static BOOL WaveformToImageType (WaveformTypes waveformType, ImageTypes* imageTypePtr)
+{
+	switch (waveformType) {
+			
+		case Waveform_UChar:
+			*imageTypePtr = Image_UChar;
+			return TRUE;
+			
+		case Waveform_UShort:
+			*imageTypePtr = Image_UShort;
+			return TRUE;
+			
+		case Waveform_Short:
+			*imageTypePtr = Image_Short;
+			return TRUE;
+			
+		case Waveform_UInt:
+			*imageTypePtr = Image_UInt;
+			return TRUE;
+			
+		case Waveform_Int:
+			*imageTypePtr = Image_Int;
+			return TRUE;
+			
+		case Waveform_Float:
+			*imageTypePtr = Image_Float;
+			return TRUE;
+			
+		default:
+			return FALSE;
+	}
+}
@@ -22,6 +22,8 @@
 // Include files
 
 //#include "cvidef.h"
+#include "hdf5.h"
+#include "DataTypes.h"
 
 //==============================================================================
 // Constants
@@ -37,6 +39,19 @@ typedef enum {
 	
 } CompressionMethods;
 
+	// Describes a dataset written with WriteHDF5Waveform or WriteHDF5Image that can be read back, e.g. for data replay.
+typedef struct {
+	char*					groupName;				// Group path of the dataset, with groups separated by "/". Empty string if the dataset is in the root group.
+	char*					datasetName;			// Dataset name, i.e. the name of the Source VChan from which the data was stored.
+	DLDataTypes				dataType;				// Data packet type of the stored data, either one of the DL_Waveform_ types or DL_Image.
+	WaveformTypes			waveformType;			// For waveform datasets, the waveform data type.
+	ImageTypes				imageType;				// For image datasets, the image pixel type.
+	unsigned int			rank;					// Number of dataset dimensions. For waveforms, the first dimension holds the samples and the others the iteration indices.
+													// For images, the first dimension is the image index in the stack, followed by image height and width.
+	unsigned long long*		dims;					// Dataset dimensions, array of rank elements.
+	double					samplingRate;			// For waveforms, sampling rate in [Hz] or 0 if not known.
+} HDF5Dataset_type;
+
 //==============================================================================
 // External variables
 
@@ -53,6 +68,23 @@ int					WriteHDF5WaveformList			(char fileName[], ListType waveformList, Compres
 
 int 				WriteHDF5Image					(char fileName[], char datasetName[], DSInfo_type* dsInfo, Image_type* image, CompressionMethods compression, char** errorMsg);
 
+	// Finds all waveform and image datasets in a file and adds them as HDF5Dataset_type* elements to the provided datasets list.
+int					GetHDF5Datasets					(char fileName[], ListType datasets, char** errorMsg);
+
+void				discard_HDF5Dataset_type		(HDF5Dataset_type** datasetPtr);
+
+	// Opens a file for reading with ReadHDF5Waveform and ReadHDF5Image. The file must be closed with CloseHDF5File.
+int					OpenHDF5File					(char fileName[], hid_t* fileIDPtr, char** errorMsg);
+
+	// Closes a file opened with OpenHDF5File and sets its file ID to 0. Does nothing if the file is not open.
+void				CloseHDF5File					(hid_t* fileIDPtr);
+
+	// Reads a waveform from a waveform dataset given its iteration indices, an array of dataset->rank - 1 elements.
+int					ReadHDF5Waveform				(hid_t fileID, HDF5Dataset_type* dataset, unsigned int indices[], Waveform_type** waveformPtr, char** errorMsg);
+
+	// Reads an image with a given 0-based index from an image dataset.
+int					ReadHDF5Image					(hid_t fileID, HDF5Dataset_type* dataset, size_t imageIdx, Image_type** imagePtr, char** errorMsg);
+
 #ifdef __cplusplus
     }
 #endif
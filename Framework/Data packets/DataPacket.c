@@ -150,4 +150,55 @@ DSInfo_type* GetDataPacketDSData (DataPacket_type* dataPacket)
 {
 	return dataPacket->dsInfo;
 }
+
+size_t GetDataPacketDataSize (DataPacket_type* dataPacket)
+{
+	int		width		= 0;
+	int		height		= 0;
+	
+	if (!dataPacket || !dataPacket->data) return 0;
+	
+	switch (dataPacket->dataType) {
+			
+		case DL_Waveform_Char:						
+		case DL_Waveform_UChar:						
+		case DL_Waveform_Short:						
+		case DL_Waveform_UShort:					
+		case DL_Waveform_Int:						
+		case DL_Waveform_UInt:
+		case DL_Waveform_Int64:						
+		case DL_Waveform_UInt64:
+		case DL_Waveform_SSize:						
+		case DL_Waveform_Size:								   			
+		case DL_Waveform_Float:						
+		case DL_Waveform_Double:
+			
+			return GetWaveformNumSamples(dataPacket->data) * GetWaveformSizeofData(dataPacket->data);
+			
+		case DL_RepeatedWaveform_Char:						
+		case DL_RepeatedWaveform_UChar:						
+		case DL_RepeatedWaveform_Short:						
+		case DL_RepeatedWaveform_UShort:					
+		case DL_RepeatedWaveform_Int:						
+		case DL_RepeatedWaveform_UInt:
+		case DL_RepeatedWaveform_Int64:						
+		case DL_RepeatedWaveform_UInt64:						
+		case DL_RepeatedWaveform_SSize:						
+		case DL_RepeatedWaveform_Size:								   			
+		case DL_RepeatedWaveform_Float:						
+		case DL_RepeatedWaveform_Double:
+			
+			return GetRepeatedWaveformNumSamples(dataPacket->data) * GetRepeatedWaveformSizeofData(dataPacket->data);
+			
+		case DL_Image:
+			
+			GetImageSize(dataPacket->data, &width, &height);
+			return (size_t)width * (size_t)height * GetImageSizeofData(dataPacket->data);
+			
+		default:
+			
+			// atomic types and small structures, count only the data packet itself
+			return sizeof(DataPacket_type);
+	}
+}
 				  
@@ -54,6 +54,8 @@ DLDataTypes				GetDataPacketDataType				(DataPacket_type* dataPacket);
 void**					GetDataPacketPtrToData				(DataPacket_type* dataPacket, DLDataTypes* dataType);
 	// Returns a pointer to the data storage data
 DSInfo_type* 		GetDataPacketDSData 				(DataPacket_type* dataPacket);
+	// Returns the approximate number of bytes of data held by the data packet. Returns 0 for a NULL data packet.
+size_t					GetDataPacketDataSize				(DataPacket_type* dataPacket);
 
 
 #ifdef __cplusplus
@@ -22,6 +22,45 @@
 //==============================================================================
 // Constants
 
+//==============================================================================
+// Macros
+
+// Sums the pixels of an image of a given pixel type covered by a ROI mask.
+#define SumMaskPixels(type, pixArray, imgWidth, mask, sum) { \
+	for (int row = (mask)->top; row < (mask)->top + (mask)->nRows; row++) { \
+		type*	pix = (type*)(pixArray) + (size_t)row * (imgWidth) + (mask)->left; \
+		for (int col = 0; col < (mask)->nCols; col++) \
+			(sum) += pix[col]; \
+	} \
+}
+
+// Builds the summed-area table of the region of an image covered by a ROI masks table, summing pixels of a given pixel type as sumType. Element (row, col) of the
+// (tableRows + 1) x (tableCols + 1) table is the sum of all region pixels above and to the left of region pixel (row, col).
+#define BuildSummedAreaTable(type, sumType, pixArray, imgWidth, masks, table) { \
+	size_t		stride	= (size_t)(masks)->tableCols + 1; \
+	sumType		rowSum	= 0; \
+	for (size_t col = 0; col < stride; col++) \
+		(table)[col] = 0; \
+	for (int row = 0; row < (masks)->tableRows; row++) { \
+		type*		pix		= (type*)(pixArray) + (size_t)((masks)->tableTop + row) * (imgWidth) + (masks)->tableLeft; \
+		sumType*	prev	= (table) + (size_t)row * stride; \
+		sumType*	curr	= prev + stride; \
+		rowSum 	= 0; \
+		curr[0]	= 0; \
+		for (int col = 0; col < (masks)->tableCols; col++) { \
+			rowSum 			+= pix[col]; \
+			curr[col + 1] 	= prev[col + 1] + rowSum; \
+		} \
+	} \
+}
+
+// Takes the sum of the pixels covered by a ROI mask from a summed-area table built with BuildSummedAreaTable.
+#define SummedAreaTableSum(table, masks, mask) \
+	( (table)[(size_t)((mask)->top - (masks)->tableTop + (mask)->nRows) * ((masks)->tableCols + 1) + (mask)->left - (masks)->tableLeft + (mask)->nCols] \
+	- (table)[(size_t)((mask)->top - (masks)->tableTop) * ((masks)->tableCols + 1) + (mask)->left - (masks)->tableLeft + (mask)->nCols] \
+	- (table)[(size_t)((mask)->top - (masks)->tableTop + (mask)->nRows) * ((masks)->tableCols + 1) + (mask)->left - (masks)->tableLeft] \
+	+ (table)[(size_t)((mask)->top - (masks)->tableTop) * ((masks)->tableCols + 1) + (mask)->left - (masks)->tableLeft] )
+
 //==============================================================================
 // Types
 
@@ -54,6 +93,36 @@ struct Image {
 	ImageDisplayTransforms		dispTransformFunc;		// function to use for mapping pixel values to display.
 };
 
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// ROI masks
+//---------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+typedef struct {
+	ROITypes					ROIType;				// Type of ROI from which the mask was created.
+	int							x;						// Point x or rectangle left position of the ROI, used to check if the mask can be reused.
+	int							y;						// Point y or rectangle top position of the ROI.
+	int							height;					// Rectangle height, 1 for points.
+	int							width;					// Rectangle width, 1 for points.
+	int							top;					// First image row covered by the ROI.
+	int							left;					// First image column covered by the ROI.
+	int							nRows;					// Number of image rows covered by the ROI, 0 if the ROI lies outside the image.
+	int							nCols;					// Number of image columns covered by the ROI, 0 if the ROI lies outside the image.
+} ROIMask_type;
+
+struct ROIMasks {
+	int							imgWidth;				// Image width in [pix] for which the masks were created.
+	int							imgHeight;				// Image height in [pix] for which the masks were created.
+	size_t						nMasks;					// Number of elements in masks.
+	ROIMask_type*				masks;					// Mask of each ROI, in the order of the ROI list.
+	size_t						nMaskPixels;			// Total number of image pixels covered by the masks.
+	int							tableTop;				// First image row of the smallest region covering all masks, from which the summed-area table is built.
+	int							tableLeft;				// First image column of the region covering all masks.
+	int							tableRows;				// Number of image rows of the region covering all masks, 0 if all ROIs lie outside the image.
+	int							tableCols;				// Number of image columns of the region covering all masks.
+	void*						summedAreaTable;		// Summed-area table of the masks region of the last image, of long long elements for integer images and of double elements
+														// for float images. NULL if not needed.
+};
+
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // Waveforms
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1419,6 +1488,249 @@ Error:
 	return errorInfo.error;
 }
 
+//-------------------------     
+// ROI intensities
+//-------------------------
+
+static void SetROIMask (ROIMask_type* mask, ROI_type* ROI, int imgWidth, int imgHeight)
+{
+	int		bottom		= 0;
+	int		right		= 0;
+	
+	mask->ROIType = ROI->ROIType;
+	
+	switch (ROI->ROIType) {
+			
+		case ROI_Point:
+			
+			mask->x			= ((Point_type*)ROI)->x;
+			mask->y			= ((Point_type*)ROI)->y;
+			mask->height	= 1;
+			mask->width		= 1;
+			break;
+			
+		case ROI_Rectangle:
+			
+			mask->x			= ((Rect_type*)ROI)->left;
+			mask->y			= ((Rect_type*)ROI)->top;
+			mask->height	= ((Rect_type*)ROI)->height;
+			mask->width		= ((Rect_type*)ROI)->width;
+			break;
+	}
+	
+	// clip to the image
+	mask->top 	= (mask->y > 0) ? mask->y : 0;
+	mask->left	= (mask->x > 0) ? mask->x : 0;
+	bottom		= (mask->y + mask->height < imgHeight) ? mask->y + mask->height : imgHeight;
+	right		= (mask->x + mask->width < imgWidth) ? mask->x + mask->width : imgWidth;
+	
+	if (bottom > mask->top && right > mask->left) {
+		mask->nRows = bottom - mask->top;
+		mask->nCols	= right - mask->left;
+	} else {
+		mask->nRows = 0;
+		mask->nCols	= 0;
+	}
+}
+
+ROIMasks_type* init_ROIMasks_type (ListType ROIList, int imgWidth, int imgHeight)
+{
+INIT_ERR
+
+	ROIMasks_type*	masks 	= malloc(sizeof(ROIMasks_type));
+	ROI_type*		ROI		= NULL;
+	ROIMask_type*	mask	= NULL;
+	int				bottom	= 0;
+	int				right	= 0;
+	
+	if (!masks) return NULL;
+	
+	// init
+	masks->imgWidth			= imgWidth;
+	masks->imgHeight		= imgHeight;
+	masks->nMasks			= ListNumItems(ROIList);
+	masks->masks			= NULL;
+	masks->nMaskPixels		= 0;
+	masks->tableTop			= 0;
+	masks->tableLeft		= 0;
+	masks->tableRows		= 0;
+	masks->tableCols		= 0;
+	masks->summedAreaTable	= NULL;
+	
+	// alloc
+	if (masks->nMasks) {
+		nullChk( masks->masks = malloc(masks->nMasks * sizeof(ROIMask_type)) );
+	}
+	
+	for (size_t i = 0; i < masks->nMasks; i++) {
+		ROI 	= *(ROI_type**) ListGetPtrToItem(ROIList, i + 1);
+		mask	= &masks->masks[i];
+		SetROIMask(mask, ROI, imgWidth, imgHeight);
+		if (!mask->nRows) continue;
+		
+		masks->nMaskPixels += (size_t)mask->nRows * mask->nCols;
+		
+		// grow the region covering all masks
+		if (!masks->tableRows) {
+			masks->tableTop		= mask->top;
+			masks->tableLeft	= mask->left;
+			bottom				= mask->top + mask->nRows;
+			right				= mask->left + mask->nCols;
+		} else {
+			if (mask->top < masks->tableTop) masks->tableTop = mask->top;
+			if (mask->left < masks->tableLeft) masks->tableLeft = mask->left;
+			if (mask->top + mask->nRows > bottom) bottom = mask->top + mask->nRows;
+			if (mask->left + mask->nCols > right) right = mask->left + mask->nCols;
+		}
+		
+		masks->tableRows	= bottom - masks->tableTop;
+		masks->tableCols	= right - masks->tableLeft;
+	}
+	
+	return masks;
+	
+Error:
+	
+	discard_ROIMasks_type(&masks);
+	return NULL;
+}
+
+void discard_ROIMasks_type (ROIMasks_type** masksPtr)
+{
+	ROIMasks_type*	masks = *masksPtr;
+	if (!masks) return;
+	
+	OKfree(masks->masks);
+	OKfree(masks->summedAreaTable);
+	
+	OKfree(*masksPtr);
+}
+
+BOOL ROIMasksMatch (ROIMasks_type* masks, ListType ROIList, int imgWidth, int imgHeight)
+{
+	ROIMask_type	mask;
+	ROIMask_type*	oldMask	= NULL;
+	
+	if (!masks || masks->imgWidth != imgWidth || masks->imgHeight != imgHeight || masks->nMasks != ListNumItems(ROIList)) return FALSE;
+	
+	for (size_t i = 0; i < masks->nMasks; i++) {
+		SetROIMask(&mask, *(ROI_type**) ListGetPtrToItem(ROIList, i + 1), imgWidth, imgHeight);
+		oldMask = &masks->masks[i];
+		if (mask.ROIType != oldMask->ROIType || mask.x != oldMask->x || mask.y != oldMask->y || mask.height != oldMask->height || mask.width != oldMask->width)
+			return FALSE;
+	}
+	
+	return TRUE;
+}
+
+size_t GetROIMasksNumROIs (ROIMasks_type* masks)
+{
+	return masks->nMasks;
+}
+
+int GetImageROIIntensities (ROIMasks_type* masks, Image_type* image, double sums[], double means[], char** errorMsg)
+{
+#define GetImageROIIntensities_Err_ImageSize	-1
+#define GetImageROIIntensities_Err_ImageType	-2
+INIT_ERR
+
+	ROIMask_type*	mask			= NULL;
+	long long*		intTable		= NULL;
+	double*			floatTable		= NULL;
+	BOOL			useTable		= masks->nMaskPixels > (size_t)masks->tableRows * masks->tableCols;
+	double			sum				= 0;
+	
+	if (image->imgWidth != masks->imgWidth || image->imgHeight != masks->imgHeight)
+		SET_ERR(GetImageROIIntensities_Err_ImageSize, "Image size differs from the size for which the ROI masks were created.");
+	
+	// build summed-area table of the region covering all ROIs if the ROIs overlap so much that summing their pixels directly would take longer. Integer pixels
+	// are summed as integers, which is exact and avoids converting each pixel to double.
+	if (useTable) {
+		if (!masks->summedAreaTable) {
+			nullChk( masks->summedAreaTable = malloc(((size_t)masks->tableCols + 1) * (masks->tableRows + 1) * 
+													 ((sizeof(long long) > sizeof(double)) ? sizeof(long long) : sizeof(double))) );
+		}
+		intTable 	= masks->summedAreaTable;
+		floatTable	= masks->summedAreaTable;
+		
+		switch (image->imageType) {
+				
+			case Image_UChar:
+				BuildSummedAreaTable(unsigned char, long long, image->pixData, image->imgWidth, masks, intTable);
+				break;
+				
+			case Image_UShort:
+				BuildSummedAreaTable(unsigned short, long long, image->pixData, image->imgWidth, masks, intTable);
+				break;
+				
+			case Image_Short:
+				BuildSummedAreaTable(short, long long, image->pixData, image->imgWidth, masks, intTable);
+				break;
+				
+			case Image_UInt:
+				BuildSummedAreaTable(unsigned int, long long, image->pixData, image->imgWidth, masks, intTable);
+				break;
+				
+			case Image_Int:
+				BuildSummedAreaTable(int, long long, image->pixData, image->imgWidth, masks, intTable);
+				break;
+				
+			case Image_Float:
+				BuildSummedAreaTable(float, double, image->pixData, image->imgWidth, masks, floatTable);
+				break;
+				
+			default:
+				SET_ERR(GetImageROIIntensities_Err_ImageType, "ROI intensities cannot be computed for this image type.");
+		}
+	}
+	
+	for (size_t i = 0; i < masks->nMasks; i++) {
+		mask 	= &masks->masks[i];
+		sum		= 0;
+		
+		if (useTable) {
+			if (mask->nRows)
+				sum = (image->imageType == Image_Float) ? SummedAreaTableSum(floatTable, masks, mask) : (double) SummedAreaTableSum(intTable, masks, mask);
+		} else
+			switch (image->imageType) {
+					
+				case Image_UChar:
+					SumMaskPixels(unsigned char, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				case Image_UShort:
+					SumMaskPixels(unsigned short, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				case Image_Short:
+					SumMaskPixels(short, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				case Image_UInt:
+					SumMaskPixels(unsigned int, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				case Image_Int:
+					SumMaskPixels(int, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				case Image_Float:
+					SumMaskPixels(float, image->pixData, image->imgWidth, mask, sum);
+					break;
+					
+				default:
+					SET_ERR(GetImageROIIntensities_Err_ImageType, "ROI intensities cannot be computed for this image type.");
+			}
+		
+		if (sums) sums[i] = sum;
+		if (means) means[i] = (mask->nRows) ? sum / ((double)mask->nRows * mask->nCols) : 0;
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
 CallbackGroup_type* init_CallbackGroup_type	(void* callbackGroupOwner, size_t nCallbackFunctions, CallbackFptr_type* callbackFunctions, void** callbackFunctionsData, DiscardFptr_type* discardCallbackDataFunctions)
 {
 INIT_ERR
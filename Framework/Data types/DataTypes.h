@@ -254,6 +254,7 @@ struct RGBAU64 {
 typedef struct ROI 			ROI_type;			// Base class
 typedef struct Point		Point_type;		 	// Child class of ROI_type
 typedef struct Rect			Rect_type;		 	// Child class of ROI_type
+typedef struct ROIMasks		ROIMasks_type;		// Pixel masks of a list of ROIs on images of a given size, used to extract ROI intensities.
 
 typedef enum {
 	ROI_Point,
@@ -695,6 +696,26 @@ char*						GetDefaultUniqueROIName					(ListType ROIList);
 
 int							SetROIName								(ROI_type* ROI, char newName[]);
 
+//---------------------------
+// ROI intensities
+//---------------------------
+
+	// Precomputes the pixels covered by each ROI of a list of ROI_type* elements on images of imgWidth x imgHeight pixels. ROIs are clipped to the image.
+ROIMasks_type*				init_ROIMasks_type						(ListType ROIList, int imgWidth, int imgHeight);
+
+void						discard_ROIMasks_type					(ROIMasks_type** masksPtr);
+
+	// Returns TRUE if the masks were created for the same ROI shapes and image size and can be reused, FALSE otherwise.
+BOOL						ROIMasksMatch							(ROIMasks_type* masks, ListType ROIList, int imgWidth, int imgHeight);
+
+size_t						GetROIMasksNumROIs						(ROIMasks_type* masks);
+
+	// Computes the sum and mean pixel value of each ROI of an image into sums and means, arrays with GetROIMasksNumROIs elements, of which either can be NULL. ROIs lying 
+	// outside the image have a sum and mean of 0. If the ROIs together cover more pixels than the smallest region of the image covering all ROIs, a summed-area table
+	// of that region is built once from which each ROI sum is taken in constant time, otherwise the ROI pixels are summed directly. Integer images are summed in an
+	// integer table. The table memory is kept with the masks and reused for the next image.
+int							GetImageROIIntensities					(ROIMasks_type* masks, Image_type* image, double sums[], double means[], char** errorMsg);
+
 //----------------------------------------------------------------------------------------------
 // Callback group
 //----------------------------------------------------------------------------------------------
@@ -11,18 +11,108 @@
 //
 //==============================================================================
 
+#include <windows.h>
+#include <ansi_c.h>
+#include "DAQLab.h"
 #include "ImageDisplay.h"
 #include "DAQLabErrHandling.h"
 
 //==============================================================================
 // Constants
 
+#define NCompositeLevels		4096	// Number of levels to which color channel intensities are quantized when mapped to channel colors.
+
+#define StatsPan_Height			300		// Histogram panel height.
+#define StatsPan_Width			450		// Histogram panel width.
+#define NPixelValues_16bit		65536	// Number of pixel values of 16-bit images.
+
+//==============================================================================
+// Macros
+
+// Adds the pixels of a channel image of a given pixel type at its offset to the channel intensities of the composite image.
+#define AddChannelImagePixels(type, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth) \
+	for (int row = 0; row < (imgHeight); row++) { \
+		type*	src = (type*)(pixArray) + (size_t)row * (imgWidth); \
+		float*	dst = (intensities) + (size_t)(row + (yOffset)) * (compWidth) + (xOffset); \
+		for (int col = 0; col < (imgWidth); col++) \
+			dst[col] += (float) src[col]; \
+	}
+
+// Computes the statistics of an image of a given pixel type in one pass for the pixel value range and sums and another pass for the histogram. NaN pixels are left out.
+#define ComputePixelStats(type, pixArray, nPixels, stats) { \
+	type*	pix 		= (type*)(pixArray); \
+	double	minVal		= HUGE_VAL; \
+	double	maxVal		= -HUGE_VAL; \
+	double	binScale	= 0; \
+	for (size_t i = 0; i < (nPixels); i++) { \
+		if (pix[i] != pix[i]) continue; \
+		if (pix[i] < minVal) minVal = (double) pix[i]; \
+		if (pix[i] > maxVal) maxVal = (double) pix[i]; \
+		AccumulateImageStats(stats, pix[i]); \
+	} \
+	if ((stats)->nPixels) { \
+		binScale = SetImageStatsRange(stats, minVal, maxVal); \
+		for (size_t i = 0; i < (nPixels); i++) \
+			if (pix[i] == pix[i]) \
+				AddImageStatsBin(stats, pix[i], binScale); \
+	} \
+}
+
+// Counts the pixels of each value of an 8 or 16-bit image of a given pixel type in one pass, with offset added to a pixel value to obtain its count index.
+#define CountPixelValues(type, pixArray, nPixels, pixelCounts, offset) { \
+	type*			pix 	= (type*)(pixArray); \
+	unsigned int*	counts	= (pixelCounts) + (offset); \
+	for (size_t i = 0; i < (nPixels); i++) \
+		counts[pix[i]]++; \
+}
+
 //==============================================================================
 // Types
 
+struct ImageDisplayUpdates {
+	ImageDisplay_type*				imgDisplay;						// Display to update. Set to NULL if the display is discarded while a display update is posted, in which case the update discards this object.
+	CmtThreadLockHandle				lock;							// Prevents discarding the display while it is being updated.
+	CmtThreadLockHandle				renderLock;						// Prevents discarding the display while an image is rendered on a worker thread.
+	void* volatile					pendingImage;					// Latest received Image_type* waiting to be displayed, NULL if none.
+	volatile LONG					updatePosted;					// 1 if a display update was posted to the main thread and did not yet take the pending image, 0 otherwise.
+	BOOL							rendering;						// True from scheduling an image for rendering until the rendered image is shown. Accessed only on the main thread.
+	Image_type*						renderImage;					// Image handed over to the worker thread for rendering.
+	int								renderError;					// Error code returned when rendering the last image, 0 if rendering succeeded.
+	double							minUpdateInterval;				// Minimum time in [s] between display updates, 0 if not limited.
+	double							lastUpdateTime;					// Time in [s] given by Timer() of the last display update.
+	volatile LONG					nReceived;						// Number of images received.
+	volatile LONG					nDisplayed;						// Number of images displayed.
+	CmtThreadLockHandle				rowsLock;						// Protects the image that is still being acquired and its changed rows.
+	Image_type*						rowsImage;						// Image that is still being acquired, assembled from rows received with UpdateImageDisplayRows.
+	int								firstDirtyRow;					// First row of rowsImage changed since it was last shown.
+	int								endDirtyRow;					// Row following the last changed row of rowsImage. Equal to firstDirtyRow if no rows changed.
+};
+
 // Used to group several image displays that show an image in different color channels or combined in a composite image. 
 // All images must have the same dimension and they share the same ROIs.
 
+struct ImageDisplayComposite {
+	CmtThreadLockHandle				lock;							// Allows composing color channels for the display from any thread.
+	float*							intensities;					// Channel intensities of the composite image, stored channel after channel. Kept between composites.
+	size_t							nIntensities;					// Number of elements allocated in intensities.
+	unsigned char*					LUTs;							// Lookup tables of NCompositeLevels RGB triplets for each channel.
+	float*							lowIntensities;					// Lowest intensity of each channel.
+	float*							levelScales;					// Factor converting the intensities of each channel to lookup table levels.
+	size_t							nChannels;						// Number of channels for which LUTs, lowIntensities and levelScales are allocated.
+};
+
+struct ImageDisplayStats {
+	ImageStats_type					stats;							// Statistics of the last rendered image. Filled in while rendering and read on the main thread once the image is shown.
+	BOOL							valid;							// True if the statistics belong to the image being shown.
+	volatile BOOL					enabled;						// If True, statistics are computed for each displayed image.
+	double							saturationLevel;				// Pixel value from which pixels are counted as saturated, 0 to use the largest value of the pixel type.
+	int								panHndl;						// Histogram panel, 0 if not created.
+	int								graphCtrl;						// Histogram graph.
+	int								infoCtrl;						// Text with the statistics.
+	volatile BOOL					panVisible;						// True while the histogram panel is shown.
+	unsigned int*					pixelCounts;					// Number of pixels of each value of 8 and 16-bit images, NPixelValues_16bit elements allocated when first needed. Used only while rendering.
+};
+
 struct ChannelGroupDisplay {
 	char*							name;							// Channel group display name.
 	size_t							displayGroupIdx;				// Index assigned to this display group which can be used to identify it uniquely among several groups within a channel group display container.
@@ -42,6 +132,47 @@ struct ChannelGroupDisplayContainer {
 //==============================================================================
 // Static functions
 
+static ImageDisplayUpdates_type*	init_ImageDisplayUpdates_type	(ImageDisplay_type* imgDisplay);
+
+static void							discard_ImageDisplayUpdates_type (ImageDisplayUpdates_type** updatesPtr);
+
+	// Displays the pending image on the main thread.
+static void CVICALLBACK 			ImageDisplayUpdate_CB			(void* callbackData);
+
+	// Renders the image for display on a worker thread for displays that implement renderImageFptr.
+static int CVICALLBACK 				RenderImageDisplayUpdate		(void* functionData);
+
+	// Shows the rendered image on the main thread.
+static void CVICALLBACK 			BlitImageDisplayUpdate_CB		(void* callbackData);
+
+static void							DiscardImageDisplayUpdates		(ImageDisplayUpdates_type* updates);
+
+	// Shows the rows of the image being acquired that changed since they were last shown. Called on the main thread.
+static int							DisplayImageRows				(ImageDisplayUpdates_type* updates, char** errorMsg);
+
+static ImageDisplayComposite_type*	init_ImageDisplayComposite_type	(void);
+
+static void							discard_ImageDisplayComposite_type (ImageDisplayComposite_type** compositePtr);
+
+static ImageDisplayStats_type*		init_ImageDisplayStats_type		(void);
+
+static void							discard_ImageDisplayStats_type	(ImageDisplayStats_type** displayStatsPtr);
+
+	// Passes the statistics of the image shown to the display callbacks and the histogram panel. Called on the main thread.
+static void							ReportImageDisplayStats			(ImageDisplay_type* imgDisplay);
+
+static double						GetPixelTypeMaxValue			(ImageTypes imageType);
+
+static size_t						GetPixelTypeSize				(ImageTypes imageType);
+
+static int CVICALLBACK 				StatsPan_CB						(int panel, int event, void *callbackData, int eventData1, int eventData2);
+
+	// Sums up the pixel values of the images of a color channel placed at their offsets into intensities of a composite image of compWidth x compHeight pixels.
+static int							AddColorChannelImages			(ColorChannel_type* colorChan, float intensities[], int compWidth, int compHeight, char** errorMsg);
+
+	// Fills a lookup table of NCompositeLevels RGB triplets with the gamma corrected channel color for each intensity level.
+static void							FillColorChannelLUT				(ColorChannel_type* colorChan, unsigned char LUT[]);
+
 //==============================================================================
 // Global variables
 
@@ -73,7 +204,7 @@ INIT_ERR
 			ret->images[i] = *imagePtrs[i];
 			*imagePtrs[i] = NULL;
 		} else {
-			*imagePtrs[i] = NULL;
+			ret->images[i] = NULL;
 		}
 		
 		ret->xOffsets[i] = xOffsets[i];
@@ -81,6 +212,13 @@ INIT_ERR
 	}
 	
 	imagePtrs = NULL;
+	
+	// display
+	ret->color.R		= 255;
+	ret->color.G		= 255;
+	ret->color.B		= 255;
+	ret->color.alpha	= 0;
+	ret->gamma			= Default_ColorChannel_Gamma;
 		
 	return ret;
 		
@@ -100,10 +238,248 @@ void discard_ColorChannel_type(ColorChannel_type** colorChanPtr) {
 			discard_Image_type(&colorChan->images[i]);
 	}
 	
+	OKfree(colorChan->images);
 	OKfree(colorChan->xOffsets);
 	OKfree(colorChan->yOffsets);
-
+	
+	OKfree(*colorChanPtr);
 };
+
+void SetColorChannelDisplay (ColorChannel_type* colorChan, RGBA_type color, double gamma)
+{
+	colorChan->color	= color;
+	colorChan->gamma	= (gamma > 0) ? gamma : Default_ColorChannel_Gamma;
+}
+
+int CompositeColorChannels (ImageDisplay_type* imgDisplay, size_t nChannels, ColorChannel_type* colorChans[], ColorBlendModes blendMode, Image_type** compositeImagePtr, char** errorMsg)
+{
+#define CompositeColorChannels_Err_NoChannels		-1
+#define CompositeColorChannels_Err_ZeroSizeImage	-2
+#define CompositeColorChannels_Err_NoComposite		-3
+INIT_ERR
+
+	ImageDisplayComposite_type*	composite		= imgDisplay->composite;
+	BOOL						compositeLocked	= FALSE;
+	int							compWidth		= 0;
+	int							compHeight		= 0;
+	int							imgWidth		= 0;
+	int							imgHeight		= 0;
+	size_t						nPixels			= 0;
+	float*						intensities		= NULL;
+	unsigned char*				LUTs			= NULL;
+	float*						lowIntensities	= NULL;
+	float*						levelScales		= NULL;
+	RGBA_type*					pixels			= NULL;
+	
+	*compositeImagePtr = NULL;
+	
+	if (!composite)
+		SET_ERR(CompositeColorChannels_Err_NoComposite, "Image display composites are not initialized.");
+	
+	if (!nChannels)
+		SET_ERR(CompositeColorChannels_Err_NoChannels, "No color channels to compose.");
+	
+	// composite image size fitting all channel images at their offsets
+	for (size_t chan = 0; chan < nChannels; chan++)
+		for (size_t i = 0; i < colorChans[chan]->nImages; i++) {
+			if (!colorChans[chan]->images[i]) continue;
+			
+			GetImageSize(colorChans[chan]->images[i], &imgWidth, &imgHeight);
+			if (imgWidth + (int)colorChans[chan]->xOffsets[i] > compWidth)
+				compWidth = imgWidth + (int)colorChans[chan]->xOffsets[i];
+			if (imgHeight + (int)colorChans[chan]->yOffsets[i] > compHeight)
+				compHeight = imgHeight + (int)colorChans[chan]->yOffsets[i];
+		}
+	
+	if (!compWidth || !compHeight)
+		SET_ERR(CompositeColorChannels_Err_ZeroSizeImage, "Color channel images have zero size.");
+	
+	nPixels = (size_t)compWidth * compHeight;
+	
+	// the composite pixels are handed over to the composite image and are allocated for each composite
+	nullChk( pixels = malloc(nPixels * sizeof(RGBA_type)) );
+	
+	CmtGetLock(composite->lock);
+	compositeLocked = TRUE;
+	
+	// enlarge the buffers kept between composites only if they are too small
+	if (composite->nIntensities < nChannels * nPixels) {
+		OKfree(composite->intensities);
+		composite->nIntensities = 0;
+		nullChk( composite->intensities = malloc(nChannels * nPixels * sizeof(float)) );
+		composite->nIntensities = nChannels * nPixels;
+	}
+	
+	if (composite->nChannels < nChannels) {
+		OKfree(composite->LUTs);
+		OKfree(composite->lowIntensities);
+		OKfree(composite->levelScales);
+		composite->nChannels = 0;
+		nullChk( composite->LUTs 			= malloc(nChannels * 3 * NCompositeLevels * sizeof(unsigned char)) );
+		nullChk( composite->lowIntensities 	= malloc(nChannels * sizeof(float)) );
+		nullChk( composite->levelScales 	= malloc(nChannels * sizeof(float)) );
+		composite->nChannels = nChannels;
+	}
+	
+	intensities		= composite->intensities;
+	LUTs			= composite->LUTs;
+	lowIntensities	= composite->lowIntensities;
+	levelScales		= composite->levelScales;
+	
+	// channel images are added up, and may not cover the whole composite image
+	memset(intensities, 0, nChannels * nPixels * sizeof(float));
+	
+	//-----------------------------------------
+	// Channel intensities and lookup tables
+	//-----------------------------------------
+	
+	for (size_t chan = 0; chan < nChannels; chan++) {
+		float*	chanIntensities	= intensities + chan * nPixels;
+		float	minIntensity	= 0;
+		float	maxIntensity	= 0;
+		
+		errChk( AddColorChannelImages(colorChans[chan], chanIntensities, compWidth, compHeight, &errorInfo.errMsg) );
+		
+		minIntensity = chanIntensities[0];
+		maxIntensity = chanIntensities[0];
+		for (size_t i = 1; i < nPixels; i++) {
+			if (chanIntensities[i] < minIntensity) minIntensity = chanIntensities[i];
+			if (chanIntensities[i] > maxIntensity) maxIntensity = chanIntensities[i];
+		}
+		
+		lowIntensities[chan] 	= minIntensity;
+		levelScales[chan]		= (maxIntensity > minIntensity) ? (NCompositeLevels - 1) / (maxIntensity - minIntensity) : 0.0f;
+		
+		FillColorChannelLUT(colorChans[chan], LUTs + chan * 3 * NCompositeLevels);
+	}
+	
+	//-----------------------------------------
+	// Blend channel colors
+	//-----------------------------------------
+	
+	// single pass over the composite image, with each channel contributing its lookup table color
+	for (size_t i = 0; i < nPixels; i++) {
+		unsigned int	R	= 0;
+		unsigned int	G	= 0;
+		unsigned int	B	= 0;
+		
+		for (size_t chan = 0; chan < nChannels; chan++) {
+			int					level 	= (int) ((intensities[chan * nPixels + i] - lowIntensities[chan]) * levelScales[chan]);
+			unsigned char*		rgb		= LUTs + (chan * NCompositeLevels + level) * 3;
+			
+			if (blendMode == ColorBlend_Max) {
+				if (rgb[0] > R) R = rgb[0];
+				if (rgb[1] > G) G = rgb[1];
+				if (rgb[2] > B) B = rgb[2];
+			} else {
+				R += rgb[0];
+				G += rgb[1];
+				B += rgb[2];
+			}
+		}
+		
+		pixels[i].R 	= (unsigned char) ((R > 255) ? 255 : R);
+		pixels[i].G 	= (unsigned char) ((G > 255) ? 255 : G);
+		pixels[i].B 	= (unsigned char) ((B > 255) ? 255 : B);
+		pixels[i].alpha = 0;
+	}
+	
+	CmtReleaseLock(composite->lock);
+	compositeLocked = FALSE;
+	
+	nullChk( *compositeImagePtr = init_Image_type(Image_RGBA, compHeight, compWidth, (void**)&pixels) );
+	
+Error:
+	
+	if (compositeLocked) CmtReleaseLock(composite->lock);
+	OKfree(pixels);
+	
+RETURN_ERR
+}
+
+int UpdateImageDisplayComposite (ImageDisplay_type* imgDisplay, size_t nChannels, ColorChannel_type* colorChans[], ColorBlendModes blendMode, char** errorMsg)
+{
+INIT_ERR
+
+	Image_type*		compositeImage	= NULL;
+	
+	errChk( CompositeColorChannels(imgDisplay, nChannels, colorChans, blendMode, &compositeImage, &errorInfo.errMsg) );
+	errChk( UpdateImageDisplay(imgDisplay, &compositeImage, &errorInfo.errMsg) );
+	
+Error:
+	
+	discard_Image_type(&compositeImage);
+	
+RETURN_ERR
+}
+
+static int AddColorChannelImages (ColorChannel_type* colorChan, float intensities[], int compWidth, int compHeight, char** errorMsg)
+{
+#define AddColorChannelImages_Err_ImageTypeNotSupported		-1
+INIT_ERR
+
+	int				imgWidth		= 0;
+	int				imgHeight		= 0;
+	int				xOffset			= 0;
+	int				yOffset			= 0;
+	void*			pixArray		= NULL;
+	
+	for (size_t i = 0; i < colorChan->nImages; i++) {
+		if (!colorChan->images[i]) continue;
+		
+		GetImageSize(colorChan->images[i], &imgWidth, &imgHeight);
+		pixArray 	= GetImagePixelArray(colorChan->images[i]);
+		xOffset		= (int)colorChan->xOffsets[i];
+		yOffset		= (int)colorChan->yOffsets[i];
+		
+		switch (GetImageType(colorChan->images[i])) {
+				
+			case Image_UChar:
+				AddChannelImagePixels(unsigned char, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			case Image_UShort:
+				AddChannelImagePixels(unsigned short, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			case Image_Short:
+				AddChannelImagePixels(short, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			case Image_UInt:
+				AddChannelImagePixels(unsigned int, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			case Image_Int:
+				AddChannelImagePixels(int, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			case Image_Float:
+				AddChannelImagePixels(float, pixArray, imgWidth, imgHeight, xOffset, yOffset, intensities, compWidth);
+				break;
+				
+			default:
+				SET_ERR(AddColorChannelImages_Err_ImageTypeNotSupported, "Color channel image type not supported.");
+		}
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
+static void FillColorChannelLUT (ColorChannel_type* colorChan, unsigned char LUT[])
+{
+	double	intensity	= 0;
+	
+	for (int level = 0; level < NCompositeLevels; level++) {
+		intensity = pow((double)level / (NCompositeLevels - 1), colorChan->gamma);
+		
+		LUT[3 * level]		= (unsigned char) (colorChan->color.R * intensity + 0.5);
+		LUT[3 * level + 1]	= (unsigned char) (colorChan->color.G * intensity + 0.5);
+		LUT[3 * level + 2]	= (unsigned char) (colorChan->color.B * intensity + 0.5);
+	}
+}
 int init_ImageDisplay_type (ImageDisplay_type* 				imageDisplay,
 							void*							imageDisplayOwner,
 							Image_type**					imagePtr,
@@ -130,11 +506,17 @@ INIT_ERR
 	imageDisplay->visible					= FALSE;
 	imageDisplay->selectionROI				= NULL;
 	imageDisplay->addROIToImage				= FALSE;
+	imageDisplay->updates					= NULL;
+	imageDisplay->stats						= NULL;
+	imageDisplay->composite					= NULL;
 	
 	// methods
 	imageDisplay->imageDisplayDiscardFptr 	= imageDisplayDiscardFptr;
 	imageDisplay->displayImageFptr			= displayImageFptr;
 	imageDisplay->ROIActionsFptr			= ROIActionsFptr;
+	imageDisplay->renderImageFptr			= NULL;
+	imageDisplay->blitImageFptr				= NULL;
+	imageDisplay->updateRowsFptr			= NULL;
 	
 	// callbacks
 	if (callbackGroupPtr) {
@@ -144,7 +526,13 @@ INIT_ERR
 	} else
 		imageDisplay->callbackGroup			= NULL;
 		
+	//----------------------------------------------------------
+	// Alloc
+	//----------------------------------------------------------
 	
+	nullChk( imageDisplay->updates = init_ImageDisplayUpdates_type(imageDisplay) );
+	nullChk( imageDisplay->stats = init_ImageDisplayStats_type() );
+	nullChk( imageDisplay->composite = init_ImageDisplayComposite_type() );
  
 Error:
 	
@@ -167,9 +555,761 @@ void discard_ImageDisplay_type (ImageDisplay_type** imageDisplayPtr)
 	// discard callback group
 	discard_CallbackGroup_type(&imageDisplay->callbackGroup);
 	
+	// discard display updates
+	discard_ImageDisplayUpdates_type(&imageDisplay->updates);
+	
+	// discard statistics
+	discard_ImageDisplayStats_type(&imageDisplay->stats);
+	
+	// discard composite buffers
+	discard_ImageDisplayComposite_type(&imageDisplay->composite);
+	
 	OKfree(*imageDisplayPtr);
 }
 
+//-----------------------------------------------------------------------------------------------------------------------
+// Display updates
+//-----------------------------------------------------------------------------------------------------------------------
+
+static ImageDisplayUpdates_type* init_ImageDisplayUpdates_type (ImageDisplay_type* imgDisplay)
+{
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates = malloc(sizeof(ImageDisplayUpdates_type));
+	if (!updates) return NULL;
+	
+	// init
+	updates->imgDisplay			= imgDisplay;
+	updates->lock				= 0;
+	updates->renderLock			= 0;
+	updates->pendingImage		= NULL;
+	updates->updatePosted		= 0;
+	updates->rendering			= FALSE;
+	updates->renderImage		= NULL;
+	updates->renderError		= 0;
+	updates->minUpdateInterval	= 1.0/Default_ImageDisplay_MaxFrameRate;
+	updates->lastUpdateTime		= 0;
+	updates->nReceived			= 0;
+	updates->nDisplayed			= 0;
+	updates->rowsLock			= 0;
+	updates->rowsImage			= NULL;
+	updates->firstDirtyRow		= 0;
+	updates->endDirtyRow		= 0;
+	
+	// alloc
+	errChk( CmtNewLock(NULL, 0, &updates->lock) );
+	errChk( CmtNewLock(NULL, 0, &updates->renderLock) );
+	errChk( CmtNewLock(NULL, 0, &updates->rowsLock) );
+	
+	return updates;
+	
+Error:
+	
+	if (updates->renderLock) CmtDiscardLock(updates->renderLock);
+	if (updates->lock) CmtDiscardLock(updates->lock);
+	OKfree(updates);
+	return NULL;
+}
+
+static void discard_ImageDisplayUpdates_type (ImageDisplayUpdates_type** updatesPtr)
+{
+	ImageDisplayUpdates_type*	updates 		= *updatesPtr;
+	Image_type*					pendingImage	= NULL;
+	BOOL						updatePosted	= FALSE;
+	
+	if (!updates) return;
+	
+	*updatesPtr = NULL;
+	
+	// wait for an ongoing display update and image rendering to complete and detach from the display
+	if (updates->lock) CmtGetLock(updates->lock);
+	if (updates->renderLock) CmtGetLock(updates->renderLock);
+	
+	updates->imgDisplay = NULL;
+	pendingImage = InterlockedExchangePointer(&updates->pendingImage, NULL);
+	discard_Image_type(&pendingImage);
+	updatePosted = (BOOL) updates->updatePosted;
+	
+	if (updates->renderLock) CmtReleaseLock(updates->renderLock);
+	if (updates->lock) CmtReleaseLock(updates->lock);
+	
+	// a posted display update or an image being rendered will discard this object when it finds the display discarded
+	if (updatePosted || updates->rendering) return;
+	
+	DiscardImageDisplayUpdates(updates);
+}
+
+static void DiscardImageDisplayUpdates (ImageDisplayUpdates_type* updates)
+{
+	discard_Image_type(&updates->renderImage);
+	discard_Image_type(&updates->rowsImage);
+	if (updates->rowsLock) CmtDiscardLock(updates->rowsLock);
+	if (updates->renderLock) CmtDiscardLock(updates->renderLock);
+	if (updates->lock) CmtDiscardLock(updates->lock);
+	free(updates);
+}
+
+int UpdateImageDisplay (ImageDisplay_type* imgDisplay, Image_type** imagePtr, char** errorMsg)
+{
+#define UpdateImageDisplay_Err_NoUpdates		-1
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates 		= imgDisplay->updates;
+	Image_type*					oldImage		= NULL;
+	
+	if (!updates)
+		SET_ERR(UpdateImageDisplay_Err_NoUpdates, "Image display updates are not initialized.");
+	
+	// replace the pending image, dropping the image that was not displayed yet
+	oldImage = InterlockedExchangePointer(&updates->pendingImage, *imagePtr);
+	*imagePtr = NULL;
+	discard_Image_type(&oldImage);
+	
+	InterlockedIncrement(&updates->nReceived);
+	
+	// post a display update unless one is already waiting
+	if (!InterlockedCompareExchange(&updates->updatePosted, 1, 0))
+		if ( (errorInfo.error = PostDeferredCall(ImageDisplayUpdate_CB, updates)) < 0) {
+			InterlockedExchange(&updates->updatePosted, 0);
+			SET_ERR(errorInfo.error, "Posting image display update failed.");
+		}
+	
+Error:
+	
+RETURN_ERR
+}
+
+int UpdateImageDisplayRows (ImageDisplay_type* imgDisplay, ImageTypes imageType, int imgWidth, int imgHeight, int firstRow, int nRows, void* framePixels, char** errorMsg)
+{
+#define UpdateImageDisplayRows_Err_NoUpdates		-1
+#define UpdateImageDisplayRows_Err_RowsOutOfRange	-2
+#define UpdateImageDisplayRows_Err_WrongImageType	-3
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates 		= imgDisplay->updates;
+	BOOL						rowsLocked		= FALSE;
+	void*						pixels			= NULL;
+	int							width			= 0;
+	int							height			= 0;
+	size_t						rowNBytes		= (size_t)imgWidth * GetPixelTypeSize(imageType);
+	
+	if (!updates)
+		SET_ERR(UpdateImageDisplayRows_Err_NoUpdates, "Image display updates are not initialized.");
+	
+	// display shows only complete images
+	if (!imgDisplay->updateRowsFptr || nRows <= 0) return 0;
+	
+	if (firstRow < 0 || firstRow + nRows > imgHeight)
+		SET_ERR(UpdateImageDisplayRows_Err_RowsOutOfRange, "Image rows are out of range.");
+	
+	if (!rowNBytes)
+		SET_ERR(UpdateImageDisplayRows_Err_WrongImageType, "Wrong image type.");
+	
+	CmtGetLock(updates->rowsLock);
+	rowsLocked = TRUE;
+	
+	// (re)create the image being acquired if its size or type changed, in which case all rows are shown again
+	if (updates->rowsImage)
+		GetImageSize(updates->rowsImage, &width, &height);
+	
+	if (!updates->rowsImage || width != imgWidth || height != imgHeight || GetImageType(updates->rowsImage) != imageType) {
+		discard_Image_type(&updates->rowsImage);
+		nullChk( pixels = calloc(imgHeight, rowNBytes) );
+		nullChk( updates->rowsImage = init_Image_type(imageType, imgHeight, imgWidth, &pixels) );
+		updates->firstDirtyRow	= 0;
+		updates->endDirtyRow	= 0;
+	}
+	
+	// copy new rows
+	memcpy((char*)GetImagePixelArray(updates->rowsImage) + firstRow * rowNBytes, (char*)framePixels + firstRow * rowNBytes, nRows * rowNBytes);
+	
+	// extend the changed rows
+	if (updates->endDirtyRow > updates->firstDirtyRow) {
+		updates->firstDirtyRow	= min(updates->firstDirtyRow, firstRow);
+		updates->endDirtyRow	= max(updates->endDirtyRow, firstRow + nRows);
+	} else {
+		updates->firstDirtyRow	= firstRow;
+		updates->endDirtyRow	= firstRow + nRows;
+	}
+	
+	CmtReleaseLock(updates->rowsLock);
+	rowsLocked = FALSE;
+	
+	// post a display update unless one is already waiting
+	if (!InterlockedCompareExchange(&updates->updatePosted, 1, 0))
+		if ( (errorInfo.error = PostDeferredCall(ImageDisplayUpdate_CB, updates)) < 0) {
+			InterlockedExchange(&updates->updatePosted, 0);
+			SET_ERR(errorInfo.error, "Posting image display update failed.");
+		}
+	
+Error:
+	
+	OKfree(pixels);
+	if (rowsLocked) CmtReleaseLock(updates->rowsLock);
+	
+RETURN_ERR
+}
+
+static void CVICALLBACK ImageDisplayUpdate_CB (void* callbackData)
+{
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates 		= callbackData;
+	ImageDisplay_type*			imgDisplay		= NULL;
+	Image_type*					image			= NULL;
+	double						currentTime		= 0;
+	
+	CmtGetLock(updates->lock);
+	
+	// display was discarded while this update was posted
+	if (!updates->imgDisplay) {
+		InterlockedExchange(&updates->updatePosted, 0);
+		CmtReleaseLock(updates->lock);
+		if (!updates->rendering)
+			DiscardImageDisplayUpdates(updates);
+		return;
+	}
+	
+	imgDisplay 	= updates->imgDisplay;
+	currentTime = Timer();
+	
+	// postpone update if the display was updated too recently
+	if (currentTime - updates->lastUpdateTime < updates->minUpdateInterval) {
+		errChk( PostDelayedCall(ImageDisplayUpdate_CB, updates, updates->minUpdateInterval - (currentTime - updates->lastUpdateTime)) );
+		CmtReleaseLock(updates->lock);
+		return;
+	}
+	
+	// allow posting a new update for images received from now on
+	InterlockedExchange(&updates->updatePosted, 0);
+	
+	// an image is still being rendered, the pending image is taken once the rendered image is shown
+	if (updates->rendering) {
+		CmtReleaseLock(updates->lock);
+		return;
+	}
+	
+	image = InterlockedExchangePointer(&updates->pendingImage, NULL);
+	
+	if (image) {
+		updates->lastUpdateTime = currentTime;
+		InterlockedIncrement(&updates->nDisplayed);
+		
+		if (imgDisplay->renderImageFptr) {
+			// render the image on a worker thread and show it afterwards on the main thread
+			updates->renderImage 	= image;
+			image 					= NULL;
+			updates->rendering		= TRUE;
+			if ( (errorInfo.error = CmtScheduleThreadPoolFunction(DLGetThreadPoolHndl(DL_ThreadPool_Processing), RenderImageDisplayUpdate, updates, NULL)) < 0) {
+				updates->rendering = FALSE;
+				discard_Image_type(&updates->renderImage);
+				SET_ERR(errorInfo.error, "Scheduling image rendering failed.");
+			}
+		} else {
+			errChk( (*imgDisplay->displayImageFptr) (imgDisplay, &image, &errorInfo.errMsg) );
+			ReportImageDisplayStats(imgDisplay);
+		}
+	} else if (updates->endDirtyRow > updates->firstDirtyRow) {
+		// show rows of the image being acquired once complete images were shown
+		updates->lastUpdateTime = currentTime;
+		errChk( DisplayImageRows(updates, &errorInfo.errMsg) );
+	}
+	
+	CmtReleaseLock(updates->lock);
+	return;
+	
+Error:
+	
+	// make sure a new update can be posted
+	InterlockedExchange(&updates->updatePosted, 0);
+	CmtReleaseLock(updates->lock);
+	discard_Image_type(&image);
+	
+	if (errorInfo.errMsg)
+		DLMsg(errorInfo.errMsg, 1);
+	
+	OKfree(errorInfo.errMsg);
+}
+
+static int CVICALLBACK RenderImageDisplayUpdate (void* functionData)
+{
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates 		= functionData;
+	
+	// the main thread is not blocked while rendering since it only waits for this lock when discarding the display
+	CmtGetLock(updates->renderLock);
+	
+	if (updates->imgDisplay)
+		errChk( (*updates->imgDisplay->renderImageFptr) (updates->imgDisplay, &updates->renderImage, &errorInfo.errMsg) );
+	
+Error:
+	
+	// drop the image if it was not taken over by the display
+	discard_Image_type(&updates->renderImage);
+	updates->renderError = errorInfo.error;
+	
+	CmtReleaseLock(updates->renderLock);
+	
+	if (errorInfo.errMsg)
+		DLMsg(errorInfo.errMsg, 1);
+	
+	OKfree(errorInfo.errMsg);
+	
+	// show the rendered image on the main thread
+	PostDeferredCall(BlitImageDisplayUpdate_CB, updates);
+	
+	return 0;
+}
+
+static void CVICALLBACK BlitImageDisplayUpdate_CB (void* callbackData)
+{
+INIT_ERR
+
+	ImageDisplayUpdates_type*	updates 		= callbackData;
+	ImageDisplay_type*			imgDisplay		= NULL;
+	
+	CmtGetLock(updates->lock);
+	
+	updates->rendering = FALSE;
+	
+	// display was discarded while the image was rendered
+	if (!updates->imgDisplay) {
+		CmtReleaseLock(updates->lock);
+		if (!updates->updatePosted)
+			DiscardImageDisplayUpdates(updates);
+		return;
+	}
+	
+	imgDisplay = updates->imgDisplay;
+	
+	if (!updates->renderError) {
+		errChk( (*imgDisplay->blitImageFptr) (imgDisplay, &errorInfo.errMsg) );
+		ReportImageDisplayStats(imgDisplay);
+	}
+	
+Error:
+	
+	// post a display update for images and rows received while rendering
+	if ((updates->pendingImage || updates->endDirtyRow > updates->firstDirtyRow) && !InterlockedCompareExchange(&updates->updatePosted, 1, 0))
+		if (PostDeferredCall(ImageDisplayUpdate_CB, updates) < 0)
+			InterlockedExchange(&updates->updatePosted, 0);
+	
+	CmtReleaseLock(updates->lock);
+	
+	if (errorInfo.errMsg)
+		DLMsg(errorInfo.errMsg, 1);
+	
+	OKfree(errorInfo.errMsg);
+}
+
+void SetImageDisplayRenderer (ImageDisplay_type* imgDisplay, RenderImageFptr_type renderImageFptr, BlitImageFptr_type blitImageFptr)
+{
+	imgDisplay->renderImageFptr	= renderImageFptr;
+	imgDisplay->blitImageFptr	= blitImageFptr;
+}
+
+static int DisplayImageRows (ImageDisplayUpdates_type* updates, char** errorMsg)
+{
+INIT_ERR
+
+	ImageDisplay_type*			imgDisplay		= updates->imgDisplay;
+	int							firstRow		= 0;
+	int							nRows			= 0;
+	
+	// rows received while they are converted are shown with the next display update
+	CmtGetLock(updates->rowsLock);
+	
+	firstRow 				= updates->firstDirtyRow;
+	nRows					= updates->endDirtyRow - updates->firstDirtyRow;
+	updates->firstDirtyRow	= 0;
+	updates->endDirtyRow	= 0;
+	
+	if (nRows > 0 && imgDisplay->updateRowsFptr)
+		errChk( (*imgDisplay->updateRowsFptr) (imgDisplay, updates->rowsImage, firstRow, nRows, &errorInfo.errMsg) );
+	
+Error:
+	
+	CmtReleaseLock(updates->rowsLock);
+	
+RETURN_ERR
+}
+
+void SetImageDisplayRowUpdater (ImageDisplay_type* imgDisplay, UpdateImageRowsFptr_type updateRowsFptr)
+{
+	imgDisplay->updateRowsFptr = updateRowsFptr;
+}
+
+void StopImageDisplayUpdates (ImageDisplay_type* imgDisplay)
+{
+	discard_ImageDisplayUpdates_type(&imgDisplay->updates);
+}
+
+void SetImageDisplayMaxFrameRate (ImageDisplay_type* imgDisplay, double maxFrameRate)
+{
+	if (!imgDisplay->updates) return;
+	
+	imgDisplay->updates->minUpdateInterval = (maxFrameRate > 0) ? 1.0/maxFrameRate : 0;
+}
+
+void GetImageDisplayFrameCounts (ImageDisplay_type* imgDisplay, size_t* nReceivedPtr, size_t* nDisplayedPtr)
+{
+	if (nReceivedPtr) *nReceivedPtr = (imgDisplay->updates) ? (size_t) imgDisplay->updates->nReceived : 0;
+	if (nDisplayedPtr) *nDisplayedPtr = (imgDisplay->updates) ? (size_t) imgDisplay->updates->nDisplayed : 0;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------
+// Color channel composites
+//-----------------------------------------------------------------------------------------------------------------------
+
+static ImageDisplayComposite_type* init_ImageDisplayComposite_type (void)
+{
+	ImageDisplayComposite_type*	composite = malloc(sizeof(ImageDisplayComposite_type));
+	if (!composite) return NULL;
+	
+	// init
+	composite->lock				= 0;
+	composite->intensities		= NULL;
+	composite->nIntensities		= 0;
+	composite->LUTs				= NULL;
+	composite->lowIntensities	= NULL;
+	composite->levelScales		= NULL;
+	composite->nChannels		= 0;
+	
+	// alloc
+	if (CmtNewLock(NULL, 0, &composite->lock) < 0) {
+		OKfree(composite);
+		return NULL;
+	}
+	
+	return composite;
+}
+
+static void discard_ImageDisplayComposite_type (ImageDisplayComposite_type** compositePtr)
+{
+	ImageDisplayComposite_type*	composite = *compositePtr;
+	
+	if (!composite) return;
+	
+	OKfree(composite->intensities);
+	OKfree(composite->LUTs);
+	OKfree(composite->lowIntensities);
+	OKfree(composite->levelScales);
+	if (composite->lock) CmtDiscardLock(composite->lock);
+	
+	OKfree(*compositePtr);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------
+// Image statistics
+//-----------------------------------------------------------------------------------------------------------------------
+
+static ImageDisplayStats_type* init_ImageDisplayStats_type (void)
+{
+	ImageDisplayStats_type*	displayStats = malloc(sizeof(ImageDisplayStats_type));
+	if (!displayStats) return NULL;
+	
+	memset(&displayStats->stats, 0, sizeof(ImageStats_type));
+	displayStats->valid				= FALSE;
+	displayStats->enabled			= FALSE;
+	displayStats->saturationLevel	= 0;
+	displayStats->panHndl			= 0;
+	displayStats->graphCtrl			= 0;
+	displayStats->infoCtrl			= 0;
+	displayStats->panVisible		= FALSE;
+	displayStats->pixelCounts		= NULL;
+	
+	return displayStats;
+}
+
+static void discard_ImageDisplayStats_type (ImageDisplayStats_type** displayStatsPtr)
+{
+	ImageDisplayStats_type*	displayStats = *displayStatsPtr;
+	
+	if (!displayStats) return;
+	
+	OKfreePanHndl(displayStats->panHndl);
+	OKfree(displayStats->pixelCounts);
+	
+	OKfree(*displayStatsPtr);
+}
+
+void SetImageDisplayStats (ImageDisplay_type* imgDisplay, BOOL enabled, double saturationLevel)
+{
+	if (!imgDisplay->stats) return;
+	
+	imgDisplay->stats->saturationLevel	= saturationLevel;
+	imgDisplay->stats->enabled			= enabled;
+}
+
+int ShowImageDisplayHistogram (ImageDisplay_type* imgDisplay, char** errorMsg)
+{
+INIT_ERR
+
+	ImageDisplayStats_type*	displayStats = imgDisplay->stats;
+	
+	if (!displayStats->panHndl) {
+		errChk( displayStats->panHndl = NewPanel(0, "Histogram", VAL_AUTO_CENTER, VAL_AUTO_CENTER, StatsPan_Height, StatsPan_Width) );
+		
+		// histogram graph
+		errChk( displayStats->graphCtrl = NewCtrl(displayStats->panHndl, CTRL_GRAPH_LS, "", 10, 10) );
+		SetCtrlAttribute(displayStats->panHndl, displayStats->graphCtrl, ATTR_WIDTH, StatsPan_Width - 20);
+		SetCtrlAttribute(displayStats->panHndl, displayStats->graphCtrl, ATTR_HEIGHT, StatsPan_Height - 70);
+		SetCtrlAttribute(displayStats->panHndl, displayStats->graphCtrl, ATTR_XNAME, "Pixel value");
+		SetCtrlAttribute(displayStats->panHndl, displayStats->graphCtrl, ATTR_YNAME, "Pixels");
+		
+		// statistics
+		errChk( displayStats->infoCtrl = NewCtrl(displayStats->panHndl, CTRL_TEXT_MSG, "", StatsPan_Height - 50, 10) );
+		SetCtrlAttribute(displayStats->panHndl, displayStats->infoCtrl, ATTR_SIZE_TO_TEXT, TRUE);
+		
+		InstallPanelCallback(displayStats->panHndl, StatsPan_CB, imgDisplay);
+	}
+	
+	// statistics are shown from the next displayed image on
+	displayStats->panVisible = TRUE;
+	errChk( DisplayPanel(displayStats->panHndl) );
+	
+	return 0;
+	
+Error:
+	
+	OKfreePanHndl(displayStats->panHndl);
+	displayStats->panVisible = FALSE;
+	
+RETURN_ERR
+}
+
+static int CVICALLBACK StatsPan_CB (int panel, int event, void *callbackData, int eventData1, int eventData2)
+{
+	ImageDisplay_type*	imgDisplay = callbackData;
+	
+	switch (event) {
+			
+		case EVENT_CLOSE:
+			
+			// stop computing statistics for the panel
+			imgDisplay->stats->panVisible = FALSE;
+			HidePanel(panel);
+			break;
+	}
+	
+	return 0;
+}
+
+ImageStats_type* BeginImageDisplayStats (ImageDisplay_type* imgDisplay, ImageTypes imageType)
+{
+	ImageDisplayStats_type*	displayStats	= imgDisplay->stats;
+	ImageStats_type*		stats			= NULL;
+	
+	if (!displayStats) return NULL;
+	
+	displayStats->valid = FALSE;
+	
+	if (!displayStats->enabled && !displayStats->panVisible) return NULL;
+	
+	stats = &displayStats->stats;
+	memset(stats, 0, sizeof(ImageStats_type));
+	stats->saturationLevel = (displayStats->saturationLevel > 0) ? displayStats->saturationLevel : GetPixelTypeMaxValue(imageType);
+	
+	return stats;
+}
+
+double SetImageStatsRange (ImageStats_type* stats, double min, double max)
+{
+	stats->min		= min;
+	stats->max		= max;
+	stats->histMin	= min;
+	stats->histMax	= max;
+	
+	// all pixels of a constant image fall in the first bin
+	return (max > min) ? ImageStats_NBins / (max - min) : 0;
+}
+
+void AddPixelCountStats (ImageStats_type* stats, unsigned int pixelCounts[], int nValues, int firstValue)
+{
+	int		minIdx		= 0;
+	int		maxIdx		= nValues - 1;
+	int		bin			= 0;
+	double	binScale	= 0;
+	double	pixVal		= 0;
+	
+	while (minIdx < nValues && !pixelCounts[minIdx]) minIdx++;
+	if (minIdx == nValues) return; // no pixels
+	while (!pixelCounts[maxIdx]) maxIdx--;
+	
+	binScale = SetImageStatsRange(stats, firstValue + minIdx, firstValue + maxIdx);
+	
+	for (int i = minIdx; i <= maxIdx; i++) {
+		if (!pixelCounts[i]) continue;
+		pixVal 			= firstValue + i;
+		stats->nPixels	+= pixelCounts[i];
+		stats->sum		+= pixVal * pixelCounts[i];
+		stats->sumSq	+= pixVal * pixVal * pixelCounts[i];
+		if (pixVal >= stats->saturationLevel)
+			stats->nSaturated += pixelCounts[i];
+		
+		
+		bin = (int) ((pixVal - stats->histMin) * binScale);
+		stats->histogram[(bin < ImageStats_NBins) ? bin : ImageStats_NBins - 1] += pixelCounts[i];
+	}
+}
+
+void EndImageDisplayStats (ImageDisplay_type* imgDisplay)
+{
+	ImageStats_type*	stats		= &imgDisplay->stats->stats;
+	double				variance	= 0;
+	
+	if (!stats->nPixels) return;
+	
+	stats->mean		= stats->sum / stats->nPixels;
+	variance		= stats->sumSq / stats->nPixels - stats->mean * stats->mean;
+	stats->std		= (variance > 0) ? sqrt(variance) : 0;
+	
+	imgDisplay->stats->valid = TRUE;
+}
+
+void ComputeImageDisplayStats (ImageDisplay_type* imgDisplay, Image_type* image)
+{
+	ImageTypes			imageType		= GetImageType(image);
+	ImageStats_type*	stats			= BeginImageDisplayStats(imgDisplay, imageType);
+	void*				pixArray		= GetImagePixelArray(image);
+	unsigned int*		pixelCounts		= NULL;
+	int					imgWidth		= 0;
+	int					imgHeight		= 0;
+	size_t				nPixels			= 0;
+	
+	if (!stats) return;
+	
+	GetImageSize(image, &imgWidth, &imgHeight);
+	nPixels = (size_t)imgWidth * imgHeight;
+	if (!nPixels || !pixArray) return;
+	
+	// 8 and 16-bit images are reduced to pixel counts in one pass
+	if (imageType == Image_UChar || imageType == Image_UShort || imageType == Image_Short) {
+		if (!imgDisplay->stats->pixelCounts)
+			if ( !(imgDisplay->stats->pixelCounts = malloc(NPixelValues_16bit * sizeof(unsigned int))) ) return;
+		
+		pixelCounts = imgDisplay->stats->pixelCounts;
+	}
+	
+	switch (imageType) {
+			
+		case Image_UChar:
+			memset(pixelCounts, 0, (UCHAR_MAX + 1) * sizeof(unsigned int));
+			CountPixelValues(unsigned char, pixArray, nPixels, pixelCounts, 0);
+			AddPixelCountStats(stats, pixelCounts, UCHAR_MAX + 1, 0);
+			break;
+			
+		case Image_UShort:
+			memset(pixelCounts, 0, NPixelValues_16bit * sizeof(unsigned int));
+			CountPixelValues(unsigned short, pixArray, nPixels, pixelCounts, 0);
+			AddPixelCountStats(stats, pixelCounts, NPixelValues_16bit, 0);
+			break;
+			
+		case Image_Short:
+			memset(pixelCounts, 0, NPixelValues_16bit * sizeof(unsigned int));
+			CountPixelValues(short, pixArray, nPixels, pixelCounts, -SHRT_MIN);
+			AddPixelCountStats(stats, pixelCounts, NPixelValues_16bit, SHRT_MIN);
+			break;
+			
+		case Image_UInt:
+			ComputePixelStats(unsigned int, pixArray, nPixels, stats);
+			break;
+			
+		case Image_Int:
+			ComputePixelStats(int, pixArray, nPixels, stats);
+			break;
+			
+		case Image_Float:
+			ComputePixelStats(float, pixArray, nPixels, stats);
+			break;
+			
+		default:
+			return; // no statistics for color images
+	}
+	
+	EndImageDisplayStats(imgDisplay);
+}
+
+static void ReportImageDisplayStats (ImageDisplay_type* imgDisplay)
+{
+	ImageDisplayStats_type*	displayStats	= imgDisplay->stats;
+	ImageStats_type*		stats			= NULL;
+	char					info[256]		= "";
+	
+	if (!displayStats || !displayStats->valid) return;
+	
+	stats = &displayStats->stats;
+	
+	// update histogram panel
+	if (displayStats->panVisible) {
+		DeleteGraphPlot(displayStats->panHndl, displayStats->graphCtrl, -1, VAL_DELAYED_DRAW);
+		PlotWaveform(displayStats->panHndl, displayStats->graphCtrl, stats->histogram, ImageStats_NBins, VAL_UNSIGNED_INTEGER, 1.0, 0.0, stats->histMin, 
+					 (stats->histMax - stats->histMin) / ImageStats_NBins, VAL_THIN_STEP, VAL_NO_POINT, VAL_SOLID, 1, VAL_WHITE);
+		
+		snprintf(info, sizeof(info), "Min: %g   Max: %g   Mean: %g   Std: %g\nSaturated: %llu pixels (%.2f%%)", stats->min, stats->max, stats->mean, stats->std, 
+				 (unsigned long long)stats->nSaturated, 100.0 * stats->nSaturated / stats->nPixels);
+		SetCtrlVal(displayStats->panHndl, displayStats->infoCtrl, info);
+	}
+	
+	// inform listeners
+	if (displayStats->enabled)
+		FireCallbackGroup(imgDisplay->callbackGroup, ImageDisplay_Statistics, stats);
+}
+
+static double GetPixelTypeMaxValue (ImageTypes imageType)
+{
+	switch (imageType) {
+			
+		case Image_UChar:
+			return UCHAR_MAX;
+			
+		case Image_UShort:
+			return USHRT_MAX;
+			
+		case Image_Short:
+			return SHRT_MAX;
+			
+		case Image_UInt:
+			return UINT_MAX;
+			
+		case Image_Int:
+			return INT_MAX;
+			
+		default:
+			return HUGE_VAL; // floating point pixels do not saturate
+	}
+}
+
+static size_t GetPixelTypeSize (ImageTypes imageType)
+{
+	switch (imageType) {
+			
+		case Image_UChar:
+			return sizeof(unsigned char);
+			
+		case Image_UShort:
+		case Image_Short:
+			return sizeof(short);
+			
+		case Image_UInt:
+		case Image_Int:
+			return sizeof(int);
+			
+		case Image_Float:
+			return sizeof(float);
+			
+		case Image_RGBA:
+			return sizeof(RGBA_type);
+			
+		case Image_RGBAU64:
+			return sizeof(RGBAU64_type);
+			
+		default:
+			return 0;
+	}
+}
+
 //-----------------------------------------------------------------------------------------------------------------------
 // Channel group display
 //-----------------------------------------------------------------------------------------------------------------------
@@ -32,6 +32,12 @@
 #define Default_ROI_B_Color					0		// blue
 #define Default_ROI_A_Color					0		// alpha
 
+#define Default_ImageDisplay_MaxFrameRate	30		// Default maximum number of display updates per second.
+
+#define Default_ColorChannel_Gamma			1.0		// Default gamma correction of color channel intensities.
+
+#define ImageStats_NBins					256		// Number of histogram bins of image statistics.
+
 
 //==============================================================================
 // Types
@@ -43,6 +49,12 @@ typedef struct ChannelGroupDisplay				ChannelGroupDisplay_type;			// Used to gro
 																					// All images must have the same dimension and they share the same regions of interest (ROIs).
 																					
 typedef struct ChannelGroupDisplayContainer		ChannelGroupDisplayContainer_type;	// Container for multiple channel display groups. Image dimensions between different channel groups need not be the same.
+
+typedef struct ImageDisplayUpdates				ImageDisplayUpdates_type;			// Schedules display updates on the main thread, keeping only the latest received image.
+
+typedef struct ImageDisplayStats				ImageDisplayStats_type;				// Pixel statistics of the displayed image and their histogram panel.
+
+typedef struct ImageDisplayComposite			ImageDisplayComposite_type;			// Buffers kept between composites of color channels shown by the display.
 																	
 
 //--------------------------------------------------------------		
@@ -61,6 +73,9 @@ typedef enum {
 	ImageDisplay_ROI_Added,											// A ROI was added to the image. Event data in CallbackFptr_type will be a ROI_type* of the added ROI to the image.
 	ImageDisplay_ROI_Removed,										// A ROI was removed from the image.
 	
+	// Statistics events
+	ImageDisplay_Statistics,										// Pixel statistics of the displayed image were updated. Event data in CallbackFptr_type will be a ImageStats_type* valid only during the callback.
+	
 } ImageDisplayEvents;
 
 // Allowed operations on ROIs
@@ -70,6 +85,46 @@ typedef enum {
 	ROI_Delete														// ROI is deleted from the image.
 } ROIActions;
 
+// Combination of color channel colors into a composite image
+typedef enum {
+	ColorBlend_Additive,											// Channel colors are added and saturated.
+	ColorBlend_Max													// The brightest channel color is used for each color component.
+} ColorBlendModes;
+
+//--------------------------------------------------------------
+// Image statistics
+//--------------------------------------------------------------
+
+// Pixel value statistics of an image, computed by the display while converting the image for display.
+typedef struct {
+	size_t			nPixels;						// Number of pixels, leaving out NaN pixels.
+	double			min;							// Smallest pixel value.
+	double			max;							// Largest pixel value.
+	double			mean;							// Mean pixel value.
+	double			std;							// Standard deviation of the pixel values.
+	double			sum;							// Sum of the pixel values.
+	double			sumSq;							// Sum of the squared pixel values.
+	double			saturationLevel;				// Pixel value from which pixels are counted as saturated.
+	size_t			nSaturated;						// Number of saturated pixels.
+	double			histMin;						// Pixel value at the start of the first histogram bin, equal to min.
+	double			histMax;						// Pixel value at the end of the last histogram bin, equal to max.
+	unsigned int	histogram[ImageStats_NBins];	// Number of pixels in each of the equally wide pixel value bins spanning [histMin, histMax], with pixels at histMax in the last bin.
+} ImageStats_type;
+
+// Accumulates a pixel value in the pixel count, sums and saturated pixel count of image statistics. NaN pixel values must be left out by the caller.
+#define AccumulateImageStats(stats, pixVal) { \
+	(stats)->nPixels++; \
+	(stats)->sum 	+= (double)(pixVal); \
+	(stats)->sumSq 	+= (double)(pixVal) * (double)(pixVal); \
+	if ((double)(pixVal) >= (stats)->saturationLevel) (stats)->nSaturated++; \
+}
+
+// Adds a pixel value to the histogram of image statistics, using the bin scale returned by SetImageStatsRange. NaN pixel values must be left out by the caller.
+#define AddImageStatsBin(stats, pixVal, binScale) { \
+	int	statsBin = (int) (((double)(pixVal) - (stats)->histMin) * (binScale)); \
+	(stats)->histogram[(statsBin < ImageStats_NBins) ? statsBin : ImageStats_NBins - 1]++; \
+}
+
 //--------------------------------------------------------------
 // Functions
 //--------------------------------------------------------------
@@ -77,12 +132,25 @@ typedef enum {
 // Displays or updates an image in a display window
 typedef int				(*DisplayImageFptr_type)					(ImageDisplay_type* imgDisplay, Image_type** image, char** errorMsg);
 
-// Displays a composite image from multiple images from separate R, G and B colors. All image dimensions must be the same.
+// Prepares an image for display without accessing the user interface, e.g. by converting its pixels to a bitmap and drawing its ROIs. Called on a worker thread
+// and must not use panels or display windows. The display takes over the image.
+typedef int				(*RenderImageFptr_type)						(ImageDisplay_type* imgDisplay, Image_type** image, char** errorMsg);
+
+// Shows on the main thread the last image prepared by RenderImageFptr_type.
+typedef int				(*BlitImageFptr_type)						(ImageDisplay_type* imgDisplay, char** errorMsg);
+
+// Converts and shows on the main thread rows firstRow to firstRow + nRows - 1 of an image that is still being acquired. Only these rows changed since the last call.
+// The image remains owned by the base class and must not be kept.
+typedef int				(*UpdateImageRowsFptr_type)					(ImageDisplay_type* imgDisplay, Image_type* image, int firstRow, int nRows, char** errorMsg);
+
+// Color channel of a composite image. The pixel values of the channel images placed at their offsets are summed up and shown in the channel color.
 typedef struct {
 	size_t			nImages;	// Number of images belonging to this channel.
 	Image_type** 	images;		// Image array.
 	uInt32*			yOffsets;	// Image position offset in the height direction;
 	uInt32*			xOffsets;   // Image position offset in the width direction;
+	RGBA_type		color;		// Color in which the brightest channel pixels are shown. Default: white.
+	double			gamma;		// Gamma correction applied to the channel intensities normalized to [0, 1]. Default: Default_ColorChannel_Gamma.
 } ColorChannel_type; 
 
 typedef int				(*DisplayRGBImageChannels_type)				(ImageDisplay_type* imgDisplay, ColorChannel_type** RChanPtr, ColorChannel_type** GChanPtr, ColorChannel_type** BChanPtr);
@@ -105,6 +173,9 @@ struct ImageDisplay {
 	BOOL								visible;					// If True, the image window is visible, False otherwise. This flag should be by the displayImageFptr method to either display a new window or just update the current image.
 	ROI_type*							selectionROI;				// Keeps track of the last placed ROI on the image.
 	BOOL								addROIToImage;				// If True, the selected ROI will be added to the image.
+	ImageDisplayUpdates_type*			updates;					// Display update scheduling for images received with UpdateImageDisplay.
+	ImageDisplayStats_type*				stats;						// Pixel statistics of the displayed image.
+	ImageDisplayComposite_type*			composite;					// Buffers used to compose color channels for the display.
 	
 	
 	//----------------------------------------------------
@@ -114,6 +185,9 @@ struct ImageDisplay {
 	DiscardFptr_type					imageDisplayDiscardFptr;	// Method to discard the image display.
 	DisplayImageFptr_type				displayImageFptr;			// Method to display or update an image depending on the visible flag.
 	ROIActionsFptr_type					ROIActionsFptr;				// Method to apply ROI actions to the image.
+	RenderImageFptr_type				renderImageFptr;			// Optional method to prepare images received with UpdateImageDisplay on a worker thread. If NULL, displayImageFptr is called on the main thread instead.
+	BlitImageFptr_type					blitImageFptr;				// Method to show a rendered image on the main thread. Must be provided if renderImageFptr is provided.
+	UpdateImageRowsFptr_type			updateRowsFptr;				// Optional method to show rows received with UpdateImageDisplayRows. If NULL, only complete images are shown.
 	
 	
 	//----------------------------------------------------
@@ -145,6 +219,64 @@ int										init_ImageDisplay_type						(ImageDisplay_type* 		imageDisplay,
 
 void									discard_ImageDisplay_type					(ImageDisplay_type** imageDisplayPtr);
 
+//--------------------------------------------------------------------------------------------------------------------------
+// Display updates
+//--------------------------------------------------------------------------------------------------------------------------
+
+// Passes an image to be displayed from any thread without waiting for the display. The image is displayed on the main thread at most at the maximum frame rate
+// of the display. If an image is still waiting to be displayed, it is discarded and replaced by the new image.
+int										UpdateImageDisplay							(ImageDisplay_type* imgDisplay, Image_type** imagePtr, char** errorMsg);
+
+// Passes rows of an image that is still being acquired to be displayed from any thread without waiting for the display. Rows firstRow to firstRow + nRows - 1 are copied from
+// framePixels, the pixel array of the whole imgWidth x imgHeight image of imageType, so that the cost is proportional to the number of new rows. Rows received between display
+// updates are shown together, after any image passed with UpdateImageDisplay. Does nothing if the display does not implement updateRowsFptr.
+int										UpdateImageDisplayRows						(ImageDisplay_type* imgDisplay, ImageTypes imageType, int imgWidth, int imgHeight, int firstRow, int nRows, void* framePixels, char** errorMsg);
+
+// Sets the maximum number of display updates per second. If 0, the display is updated each time the main thread processes a new image.
+void									SetImageDisplayMaxFrameRate					(ImageDisplay_type* imgDisplay, double maxFrameRate);
+
+// Renders images received with UpdateImageDisplay on a worker thread such that the main thread only shows the rendered image. Since rendering and showing
+// share the display data, images must then not be passed directly to displayImageFptr while display updates are in progress.
+void									SetImageDisplayRenderer						(ImageDisplay_type* imgDisplay, RenderImageFptr_type renderImageFptr, BlitImageFptr_type blitImageFptr);
+
+// Shows rows of images that are still being acquired, received with UpdateImageDisplayRows, using updateRowsFptr.
+void									SetImageDisplayRowUpdater					(ImageDisplay_type* imgDisplay, UpdateImageRowsFptr_type updateRowsFptr);
+
+// Stops display updates and waits for an image being rendered. Child classes that render images must call this before discarding the data used for rendering.
+void									StopImageDisplayUpdates						(ImageDisplay_type* imgDisplay);
+
+// Returns the number of images received by UpdateImageDisplay and the number of images passed on to the display, including the image being displayed.
+void									GetImageDisplayFrameCounts					(ImageDisplay_type* imgDisplay, size_t* nReceivedPtr, size_t* nDisplayedPtr);
+
+//--------------------------------------------------------------------------------------------------------------------------
+// Image statistics
+//--------------------------------------------------------------------------------------------------------------------------
+
+// Computes pixel statistics for images received with UpdateImageDisplay and passes them to the display callbacks with the ImageDisplay_Statistics event. Statistics are also
+// computed while the histogram panel is shown. Pixels with values from saturationLevel are counted as saturated. If saturationLevel is 0, the largest value of the pixel type is used.
+void									SetImageDisplayStats						(ImageDisplay_type* imgDisplay, BOOL enabled, double saturationLevel);
+
+// Shows a panel with the histogram and statistics of the displayed image.
+int										ShowImageDisplayHistogram					(ImageDisplay_type* imgDisplay, char** errorMsg);
+
+// Used by child classes while rendering an image. Returns cleared statistics to be filled in while converting the image pixels, or NULL if statistics are not needed.
+// Child classes either count the pixels of each value and pass the counts to AddPixelCountStats, or accumulate pixel values with AccumulateImageStats, set the pixel value
+// range with SetImageStatsRange and bin the pixel values with AddImageStatsBin. Afterwards they call EndImageDisplayStats.
+ImageStats_type*						BeginImageDisplayStats						(ImageDisplay_type* imgDisplay, ImageTypes imageType);
+
+// Sets the pixel value range of image statistics, which is also the range spanned by the histogram, and returns the bin scale to pass to AddImageStatsBin.
+double									SetImageStatsRange							(ImageStats_type* stats, double min, double max);
+
+// Fills in image statistics from the number of pixels with each integer pixel value, where pixelCounts[i] is the number of pixels with value firstValue + i.
+void									AddPixelCountStats							(ImageStats_type* stats, unsigned int pixelCounts[], int nValues, int firstValue);
+
+// Computes the mean and standard deviation of statistics filled in after BeginImageDisplayStats. The statistics are reported once the image is shown.
+void									EndImageDisplayStats						(ImageDisplay_type* imgDisplay);
+
+// Computes the statistics of an image for child classes that do not convert the pixels themselves. 8 and 16-bit images take one pass over the pixels and
+// 32-bit images take two passes. NaN pixels are left out. Does nothing if statistics are not needed.
+void									ComputeImageDisplayStats					(ImageDisplay_type* imgDisplay, Image_type* image);
+
 //--------------------------------------------------------------------------------------------------------------------------
 // Color Channels
 //--------------------------------------------------------------------------------------------------------------------------
@@ -153,6 +285,17 @@ ColorChannel_type*						init_ColorChannel_type						(size_t nImages, Image_type*
 
 void									discard_ColorChannel_type					(ColorChannel_type** colorChanPtr);
 
+// Sets the color and gamma correction with which a color channel is shown in a composite image.
+void									SetColorChannelDisplay						(ColorChannel_type* colorChan, RGBA_type color, double gamma);
+
+// Composes color channels into an RGBA image. Each channel is normalized to its pixel value range, gamma corrected and colored with the channel color, after which
+// the channel colors are combined using blendMode. The composite image is large enough to fit all channel images at their offsets. The channel intensities are
+// summed up in buffers of imgDisplay that are kept between composites. Can be called from any thread.
+int										CompositeColorChannels						(ImageDisplay_type* imgDisplay, size_t nChannels, ColorChannel_type* colorChans[], ColorBlendModes blendMode, Image_type** compositeImagePtr, char** errorMsg);
+
+// Composes color channels as CompositeColorChannels does and passes the composite image to UpdateImageDisplay. Can be called from any thread.
+int										UpdateImageDisplayComposite					(ImageDisplay_type* imgDisplay, size_t nChannels, ColorChannel_type* colorChans[], ColorBlendModes blendMode, char** errorMsg);
+
 //--------------------------------------------------------------------------------------------------------------------------
 // Channel Group Display
 //--------------------------------------------------------------------------------------------------------------------------
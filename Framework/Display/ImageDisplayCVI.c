@@ -1,3 +1,5 @@
+#include <ansi_c.h>
+#include <formatio.h>
 #include <userint.h>
 
 //==============================================================================
@@ -32,8 +34,6 @@
 #define ZoomFactor 			0.25
 #define maxZoomLevel 		4
 		
-#define getByte(value, byteNum) ((value >> (8*byteNum)) & 0xff)
-		
 #define BUTNUM 				6
 #define CANVAS_MIN_HEIGHT	200
 #define CANVAS_MIN_WIDTH	200
@@ -52,6 +52,15 @@
 		
 #define CROSS_LENGTH						6
 
+#define MaxPyramidLevels					16		// Maximum number of image pyramid levels, including the full resolution level.
+
+#define NHistBins_8bit						256		// Histogram bins and lookup table size for 8 bit images.
+#define NHistBins_16bit						65536	// Histogram bins and lookup table size for 16 bit images.
+#define NHistBins_32bit						4096	// Histogram bins spanning the pixel value range of 32 bit images.
+
+#define ContrastLowPercentile				0.1		// Lower percentile of the display range selected from the Contrast menu.
+#define ContrastHighPercentile				99.9	// Upper percentile of the display range selected from the Contrast menu.
+
 
 // These macros add two numbers by avoiding positive and negative overflow.
 // Currently not supported by CVI, can be used if updated in future
@@ -74,6 +83,12 @@
 //==============================================================================
 // Types
 
+typedef struct {
+	unsigned char*			pixels;					// Pixel array with 4 bytes per pixel, same layout as the bitmap bit array.
+	int						width;
+	int						height;
+} PyramidLevel_type;
+
 struct ImageDisplayCVI {
 	
 	//---------------------------------------------------------------------------------------------------------------
@@ -94,9 +109,25 @@ struct ImageDisplayCVI {
 	int						imgHeight;				// Image height.
 	int 					imgWidth;				// Image width.
 	double					zoomLevel;				// Current zoom level.
-	int*					interpolationArray; 	// Array used to perform normalization (squashing 4 bytes into an int) for the Bilinear interpolation.
-	int*					resizedArray;			// Array used to deserialize bytes from the integer into bitmapBitArray.
-	float*					RGBOverlayBuffer[3];	// Image buffer used to sum up and overlay images from multiple RGB channels.
+	PyramidLevel_type		pyramid[MaxPyramidLevels];	// Image pyramid of the displayed image. Level 0 is the full resolution image and each next level is box-filtered to half the size.
+	int						nPyramidLevels;			// Number of pyramid levels built for the displayed image. Levels are built when needed for zooming out and reset when a new image is displayed.
+	ImgDisplayContrastModes	contrastMode;			// Mapping of pixel values to display intensities.
+	double					contrastLow;			// Lower percentile or pixel value of the display range depending on contrastMode.
+	double					contrastHigh;			// Upper percentile or pixel value of the display range depending on contrastMode.
+	unsigned int*			histogram;				// Pixel value histogram of the image being rendered, of NHistBins_16bit elements.
+	unsigned char*			LUT;					// Lookup table mapping 8 and 16 bit pixel values to display intensities, of NHistBins_16bit elements.
+	
+	//---------------------------------------------------------------------------------------------------------------
+	// RENDERING (written on a worker thread by RenderImage and taken over on the main thread by BlitImage)
+	//---------------------------------------------------------------------------------------------------------------
+	
+	Image_type*				renderedImage;			// Rendered image, becomes the base class image when shown.
+	PyramidLevel_type		renderPyramid[MaxPyramidLevels];	// Image pyramid of the rendered image.
+	int						nRenderPyramidLevels;	// Number of pyramid levels built for the rendered image.
+	unsigned char*			renderBitArray;			// Bit array of the rendered image at renderZoomLevel, including ROI outlines.
+	int						renderWidth;			// Width of the rendered bit array.
+	int						renderHeight;			// Height of the rendered bit array.
+	double					renderZoomLevel;		// Zoom level at which the image was rendered.
 	
 	//---------------------------------------------------------------------------------------------------------------
 	// UI
@@ -107,6 +138,9 @@ struct ImageDisplayCVI {
 	int						menuBarHndl;
 	int						fileMenuID;
 	int						imageMenuID;
+	int						contrastAutoItemID;
+	int						contrastPercentileItemID;
+	int						contrastFixedItemID;
 	
 	//---------------------------------------------------------------------------------------------------------------
 	// CALLBACK
@@ -125,14 +159,45 @@ static int buttonArray[] = {DisplayPan_Zoom, DisplayPan_RectROI, DisplayPan_Poin
 //==============================================================================
 // Static functions
 
-static int						DisplayImage				(ImageDisplayCVI_type* imgDisplay, Image_type** image);
+static int						DisplayImage				(ImageDisplayCVI_type* imgDisplay, Image_type** image, char** errorMsg);
+
+	// Converts the image to a bit array at the current zoom level with ROI outlines, without accessing the user interface.
+static int						RenderImage					(ImageDisplayCVI_type* imgDisplay, Image_type** image, char** errorMsg);
+
+	// Shows the rendered bit array on the canvas.
+static int						BlitImage					(ImageDisplayCVI_type* imgDisplay, char** errorMsg);
+
+	// Converts an image to a bit array using the display contrast. If stats is not NULL, the image statistics are filled in within the same passes over the pixels.
+static int	 					ConvertToBitArray			(ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg);
+
+	// Converts an 8 or 16 bit image to display intensities using a lookup table.
+static int						ConvertToBitArray_LUT		(ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg);
+
+	// Converts a 32 bit integer or float image to display intensities by scaling the display range.
+static int						ConvertToBitArray_Scale		(ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg);
+
+static unsigned char			ScaleToDisplayValue			(float pixVal, float low, float high, float scaleFactor);
+
+	// Returns the histogram bins corresponding to the given percentiles of the pixel count.
+static void						GetHistogramRange			(unsigned int histogram[], int nBins, size_t nPixels, double lowPercentile, double highPercentile, int* lowBinPtr, int* highBinPtr);
 
-static void 					ConvertToBitArray			(ImageDisplayCVI_type* display, Image_type* image);
+	// Returns the pyramid level from which an image is resampled for a given zoom level.
+static int						GetPyramidLevel				(double zoomLevel);
 
-static void 					BilinearResize				(int* input, int** outputPtr, int sourceWidth, int sourceHeight, int targetWidth, int targetHeight);
+	// Builds an image pyramid up to nLevels levels if not already built. Level 0 must hold the full resolution image.
+static int						BuildImagePyramid			(PyramidLevel_type pyramid[], int* nPyramidLevelsPtr, int nLevels);
+
+	// Box-filters a pyramid level to half its size.
+static void						DownsampleImageLevel		(PyramidLevel_type* src, PyramidLevel_type* dst);
+
+	// Resamples a pixel array with 4 bytes per pixel to the target size using bilinear interpolation.
+static int 						BilinearResize				(unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst, int dstWidth, int dstHeight);
 
 static int 						Zoom						(ImageDisplayCVI_type* display, double zoomLevel);
 
+	// Sets the canvas size for a zoomed image, within the canvas size limits.
+static void						SetZoomedCanvasSize			(ImageDisplayCVI_type* display, int width, int height);
+
 static int CVICALLBACK 			CanvasCallback 				(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 
 static int CVICALLBACK 			DisplayPanCtrlCallback 		(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
@@ -141,24 +206,26 @@ static int CVICALLBACK 			DisplayPanCallback			(int panel, int event, void *call
 
 static int CVICALLBACK 			CanvasPanelCallback 		(int panel, int event, void *callbackData, int eventData1, int eventData2);
 
-void 							NormalizePixelArray			(ImageDisplayCVI_type* display, int **arrayPtr);
+static void 					DrawROIs					(ImageDisplayCVI_type* display);
+
+static void						DrawROILabels				(ImageDisplayCVI_type* display);
 
-static void 					Deserialize					(ImageDisplayCVI_type* display, int* array, int length);
+	// Draws the outlines of the active ROIs of an image into a bit array rendered at the given zoom level.
+static void						DrawROIOutlines				(ListType ROIList, unsigned char* bitArray, int width, int height, double zoomLevel);
 
-static void 					DrawROIs					(ImageDisplayCVI_type* display);
+static void						SetBitArrayPixel			(unsigned char* bitArray, int width, int height, int x, int y, RGBA_type color);
 
 void CVICALLBACK 				MenuSaveCB 					(int menuBarHandle, int menuItemID, void *callbackData, int panelHandle);
 
 void CVICALLBACK 				MenuRestoreCB 				(int menuBarHandle, int menuItemID, void *callbackData, int panelHandle);
 
-void 							GetResultedImageSize		(ColorChannel_type* colorChan, int* heightPtr, int* widthPtr);
+void CVICALLBACK 				MenuHistogramCB 			(int menuBarHandle, int menuItemID, void *callbackData, int panelHandle);
 
-void 							AddImagePixels				(float** ResultImagePixArrayPtr, int ResultImageHeight, int ResultImageWidth, ColorChannel_type*  colorChan);
+void CVICALLBACK 				MenuContrastCB 				(int menuBarHandle, int menuItemID, void *callbackData, int panelHandle);
 
+	// Composes the given red, green and blue channels into an RGB image and displays it. The display takes over the color channels.
 int 							DisplayRGBImageChannels 	(ImageDisplayCVI_type* imgDisplay, ColorChannel_type** RChanPtr, ColorChannel_type** GChanPtr, ColorChannel_type** BChanPtr);
 
-void 							NormalizeFloatArrayToRGBA	(RGBA_type* outputPtr[], float* input, int nPixels, int RGBAChannel);
-
 
 
 
@@ -211,6 +278,7 @@ INIT_ERR
 
 	
 	init_ImageDisplay_type(&imgDisplay->baseClass, &imgDisplay, NULL, (DiscardFptr_type) discard_ImageDisplayCVI_type, (DisplayImageFptr_type) DisplayImage, NULL, callbackGroupPtr);
+	SetImageDisplayRenderer(&imgDisplay->baseClass, (RenderImageFptr_type) RenderImage, (BlitImageFptr_type) BlitImage);
 
 	
 	//-------------------------------------
@@ -230,6 +298,29 @@ INIT_ERR
 	imgDisplay->imgWidth			= imgWidth;
 	imgDisplay->bitmapBitArray		= NULL;
 	imgDisplay->zoomLevel			= 1;
+	imgDisplay->nPyramidLevels		= 0;
+	imgDisplay->contrastMode		= ImgDisplayContrast_Auto;
+	imgDisplay->contrastLow			= ContrastLowPercentile;
+	imgDisplay->contrastHigh		= ContrastHighPercentile;
+	imgDisplay->histogram			= NULL;
+	imgDisplay->LUT					= NULL;
+	for (int i = 0; i < MaxPyramidLevels; i++) {
+		imgDisplay->pyramid[i].pixels	= NULL;
+		imgDisplay->pyramid[i].width	= 0;
+		imgDisplay->pyramid[i].height	= 0;
+	}
+	
+	imgDisplay->renderedImage			= NULL;
+	imgDisplay->nRenderPyramidLevels	= 0;
+	for (int i = 0; i < MaxPyramidLevels; i++) {
+		imgDisplay->renderPyramid[i].pixels	= NULL;
+		imgDisplay->renderPyramid[i].width	= 0;
+		imgDisplay->renderPyramid[i].height	= 0;
+	}
+	imgDisplay->renderBitArray			= NULL;
+	imgDisplay->renderWidth				= 0;
+	imgDisplay->renderHeight			= 0;
+	imgDisplay->renderZoomLevel			= 1;
 	
 	// ALLOC Resources
 	//---------------------------------
@@ -266,6 +357,13 @@ INIT_ERR
 	
 	imgDisplay->imageMenuID = NewMenu(imgDisplay->menuBarHndl, "Image", -1);
 	NewMenuItem(imgDisplay->menuBarHndl, imgDisplay->imageMenuID, "Restore", -1, VAL_F1_VKEY, MenuRestoreCB, imgDisplay);
+	NewMenuItem(imgDisplay->menuBarHndl, imgDisplay->imageMenuID, "Histogram", -1, VAL_F3_VKEY, MenuHistogramCB, imgDisplay);
+	
+	int		contrastMenuID	= NewSubMenu(imgDisplay->menuBarHndl, NewMenuItem(imgDisplay->menuBarHndl, imgDisplay->imageMenuID, "Contrast", -1, 0, NULL, NULL));
+	imgDisplay->contrastAutoItemID			= NewMenuItem(imgDisplay->menuBarHndl, contrastMenuID, "Auto", -1, 0, MenuContrastCB, imgDisplay);
+	imgDisplay->contrastPercentileItemID	= NewMenuItem(imgDisplay->menuBarHndl, contrastMenuID, "Percentile 0.1% - 99.9%", -1, 0, MenuContrastCB, imgDisplay);
+	imgDisplay->contrastFixedItemID			= NewMenuItem(imgDisplay->menuBarHndl, contrastMenuID, "Fixed...", -1, 0, MenuContrastCB, imgDisplay);
+	SetMenuBarAttribute(imgDisplay->menuBarHndl, imgDisplay->contrastAutoItemID, ATTR_CHECKED, TRUE);
 	
 	
 	// create image list
@@ -274,13 +372,6 @@ INIT_ERR
 	// create bitmap bit array
 	if(imgHeight > 0 && imgWidth > 0) {
 		nullChk( imgDisplay->bitmapBitArray 		= malloc(4 * imgWidth * imgHeight) );
-		nullChk( imgDisplay->resizedArray   		= malloc(imgWidth * imgHeight * sizeof(int)) );
-		nullChk( imgDisplay->interpolationArray   	= malloc(imgWidth * imgHeight * sizeof(int)) ); 
-		
-		// allocate RGB overlay buffers
-		for(int i = 0; i < 3; i++) {
-			nullChk( imgDisplay->RGBOverlayBuffer[i] = malloc(imgWidth * imgHeight * sizeof(float)) );
-		}
 	} else
 		goto Error;
 				 
@@ -303,6 +394,9 @@ static void discard_ImageDisplayCVI_type (ImageDisplayCVI_type** imageDisplayPtr
 	ImageDisplayCVI_type* imgDisp = *imageDisplayPtr;
 	if (!imgDisp) return;
 	
+	// wait for an image being rendered
+	StopImageDisplayUpdates(&imgDisp->baseClass);
+	
 	//--------------
 	// Images
 	//--------------
@@ -316,6 +410,23 @@ static void discard_ImageDisplayCVI_type (ImageDisplayCVI_type** imageDisplayPtr
 	
 	OKfree(imgDisp->bitmapBitArray);
 	
+	for (int i = 0; i < MaxPyramidLevels; i++)
+		OKfree(imgDisp->pyramid[i].pixels);
+	
+	OKfree(imgDisp->histogram);
+	OKfree(imgDisp->LUT);
+	
+	//--------------
+	// Rendering
+	//--------------
+	
+	discard_Image_type(&imgDisp->renderedImage);
+	
+	for (int i = 0; i < MaxPyramidLevels; i++)
+		OKfree(imgDisp->renderPyramid[i].pixels);
+	
+	OKfree(imgDisp->renderBitArray);
+	
 	//--------------
 	// UI
 	//--------------
@@ -323,325 +434,688 @@ static void discard_ImageDisplayCVI_type (ImageDisplayCVI_type** imageDisplayPtr
 	OKfreePanHndl(imgDisp->canvasPanHndl); 	
 	OKfreePanHndl(imgDisp->displayPanHndl);
 
+	//--------------
+	// Parent Class
+	//--------------
 	
-	OKfree(* imageDisplayPtr);
-	
-	// maybe needed in the future to discard parent resources as well
-	// discard_ImageDisplay_type (imageDisplayPtr)
-	
+	discard_ImageDisplay_type ((ImageDisplay_type**)imageDisplayPtr);
 }
 
-static void ConvertToBitArray(ImageDisplayCVI_type* display, Image_type* image) 
+static int ConvertToBitArray (ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg)
 {
+#define ConvertToBitArray_Err_ImageTypeNotSupported		-1
 INIT_ERR
 	
-	int 				iterations 			= 0;
 	int					imgHeight			= 0;
 	int					imgWidth			= 0;
-	ImageTypes 			imgType				= GetImageType(image);
-	int 				nPixels				= 0;
-	uInt64				bitChunkIdx			= 0;
-	
+	size_t				nPixels				= 0;
+	size_t				bitChunkIdx			= 0;
 	
 	GetImageSize(image, &imgWidth, &imgHeight);
+	nPixels	= (size_t)imgHeight * imgWidth;
 	
-	nPixels	= imgHeight * imgWidth;
-			
-	switch (imgType) {
+	switch (GetImageType(image)) {
 		
-		// 8 bit  
-		case Image_UChar:					
-	
-			unsigned char* 			ucharPix 			= (unsigned char*) GetImagePixelArray(image);
-	
+		// 8 bit and 16 bit images are mapped through a lookup table
+		case Image_UChar:
+		case Image_UShort:
+		case Image_Short:
+			
+			errChk( ConvertToBitArray_LUT(imgDisplay, image, bitArray, stats, &errorInfo.errMsg) );
+			break;
+			
+		// 32 bit images are scaled
+		case Image_UInt:
+		case Image_Int:
+		case Image_Float:
+			
+			errChk( ConvertToBitArray_Scale(imgDisplay, image, bitArray, stats, &errorInfo.errMsg) );
+			break;
+			
+		case Image_RGBA:
+
+			RGBA_type* 				rgbaPix = (RGBA_type*) GetImagePixelArray(image);
+
 			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
+			for (size_t i = 0; i < nPixels; i++) {
 				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= ucharPix[i];
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
+				bitArray[bitChunkIdx] 	= rgbaPix[i].B;
+				bitArray[bitChunkIdx+1] = rgbaPix[i].G;
+				bitArray[bitChunkIdx+2] = rgbaPix[i].R;
+				bitArray[bitChunkIdx+3] = 0;
 			}
 			break;
-	
-		// 16 bit unsigned
-		case Image_UShort:
 		
-			unsigned short int* 	ushortPix 			= (unsigned short int*) GetImagePixelArray(image);
-			unsigned short int		ushort_min	 		= ushortPix[0];
-			unsigned short int		ushort_max	 		= ushortPix[0];
-	
-			for (int i = 0; i < nPixels; i++) {
-				if (ushortPix[i] > ushort_max)
-					ushort_max = ushortPix[i];
+		default:
 		
-				if (ushortPix[i] < ushort_min)
-					ushort_min = ushortPix[i];
-			}
+			SET_ERR(ConvertToBitArray_Err_ImageTypeNotSupported, "Image type not supported.");
+	}
 	
-			float					ushortScaleFactor 	= 255.0 / (ushort_max - ushort_min);
+Error:
 	
-			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
-				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= (unsigned char) ((ushortPix[i] - ushort_min) * ushortScaleFactor);
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
-			}
-			break;								
+RETURN_ERR
+}
+
+static int ConvertToBitArray_LUT (ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg)
+{
+INIT_ERR
+	
+	int						imgWidth		= 0;
+	int						imgHeight		= 0;
+	size_t					nPixels			= 0;
+	size_t					bitChunkIdx		= 0;
+	int						nBins			= 0;
+	int						offset			= 0;		// added to a pixel value to obtain its histogram bin and lookup table index
+	int						lowBin			= 0;
+	int						highBin			= 0;
+	unsigned char*			LUT				= NULL;
+	unsigned int*			histogram		= NULL;
+	void*					pixArray		= GetImagePixelArray(image);
+	ImageTypes				imageType		= GetImageType(image);
+	// contrast settings may be changed from the main thread while rendering
+	ImgDisplayContrastModes	contrastMode	= imgDisplay->contrastMode;
+	double					contrastLow		= imgDisplay->contrastLow;
+	double					contrastHigh	= imgDisplay->contrastHigh;
+	
+	GetImageSize(image, &imgWidth, &imgHeight);
+	nPixels	= (size_t)imgHeight * imgWidth;
 	
-		// 16 bit signed 
+	switch (imageType) {
+			
+		case Image_UChar:
+			nBins 	= NHistBins_8bit;
+			offset	= 0;
+			break;
+			
+		case Image_UShort:
+			nBins 	= NHistBins_16bit;
+			offset	= 0;
+			break;
+			
 		case Image_Short:
+			nBins 	= NHistBins_16bit;
+			offset	= 32768;
+			break;
+			
+		default:
+			break;
+	}
 	
-			short int* 				shortPix  			= (short int*) GetImagePixelArray(image);
-			short int  				short_min 			= shortPix[0];
-			short int  				short_max			= shortPix[0];
-
-			for (int i = 0; i < nPixels; i++) {
-				if (shortPix[i] > short_max)
-					short_max = shortPix[i];
-		
-				if (shortPix[i] < short_min)
-					short_min = shortPix[i];
-			}
+	if (!imgDisplay->LUT)
+		nullChk( imgDisplay->LUT = malloc(NHistBins_16bit * sizeof(unsigned char)) );
 	
-			float					shortScaleFactor 	= 255.0 / (short_max - short_min); 
+	if (!imgDisplay->histogram)
+		nullChk( imgDisplay->histogram = malloc(NHistBins_16bit * sizeof(unsigned int)) );
 	
-			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
-				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= (unsigned char)((shortPix[i] - short_min) * shortScaleFactor);
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
-			}
-			break;
+	LUT 		= imgDisplay->LUT;
+	histogram	= imgDisplay->histogram;
 	
-		// 32 bit unsigned 
-		case Image_UInt:					
-		
-			unsigned  int* 			uintPix 			= (unsigned int*) GetImagePixelArray(image);
-			unsigned  int			uint_min	 		= uintPix[0];
-			unsigned  int			uint_max	 		= uintPix[0];
+	// pixel value histogram, which provides the display range and the image statistics without further passes over the pixels
+	memset(histogram, 0, nBins * sizeof(unsigned int));
 	
-			for (int i = 0; i < nPixels; i++) {
-				if (uintPix[i] > uint_max)
-					uint_max = uintPix[i];
-		
-				if (uintPix[i] < uint_min)
-					uint_min = uintPix[i];
-			}
+	switch (imageType) {
+			
+		case Image_UChar:
+			
+			unsigned char* 		ucharPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++)
+				histogram[ucharPix[i]]++;
+			
+			break;
+			
+		case Image_UShort:
+			
+			unsigned short* 	ushortPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++)
+				histogram[ushortPix[i]]++;
+			
+			break;
+			
+		case Image_Short:
+			
+			short* 				shortPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++)
+				histogram[shortPix[i] + offset]++;
+			
+			break;
+			
+		default:
+			break;
+	}
 	
-			float					uintScaleFactor 	= 255.0 / (uint_max - uint_min);  
+	// get display range
+	switch (contrastMode) {
+			
+		case ImgDisplayContrast_Auto:
+			
+			GetHistogramRange(histogram, nBins, nPixels, 0, 100, &lowBin, &highBin);
+			break;
+			
+		case ImgDisplayContrast_Percentile:
+			
+			GetHistogramRange(histogram, nBins, nPixels, contrastLow, contrastHigh, &lowBin, &highBin);
+			break;
+			
+		case ImgDisplayContrast_Fixed:
+			
+			lowBin 	= (int)floor(contrastLow) + offset;
+			highBin = (int)ceil(contrastHigh) + offset;
+			break;
+	}
 	
-			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
+	// build lookup table; if the range is empty, e.g. for a constant image, pixels up to and including the range are black and pixels above are white
+	for (int i = 0; i < nBins; i++)
+		if (i <= lowBin)
+			LUT[i] = 0;
+		else if (i >= highBin)
+			LUT[i] = 255;
+		else
+			LUT[i] = (unsigned char) ((double)(i - lowBin) * 255 / (highBin - lowBin));
+	
+	// map pixels to display values, pixel mapping B->G->R->ignored byte
+	switch (imageType) {
+			
+		case Image_UChar:
+				
+			unsigned char* 		ucharPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++) {
+				bitChunkIdx = i*4;
+				bitArray[bitChunkIdx]   	= LUT[ucharPix[i]];
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
+			}
+			
+			break;
+				
+		case Image_UShort:
+				
+			unsigned short* 	ushortPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++) {
 				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= (unsigned char)((uintPix[i] - uint_min) * uintScaleFactor);
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
+				bitArray[bitChunkIdx]   	= LUT[ushortPix[i]];
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
 			}
-			break;										
+			
+			break;
+				
+		case Image_Short:
+				
+			short* 				shortPix 	= pixArray;
+			unsigned char*		shortLUT	= LUT + offset;
+			for (size_t i = 0; i < nPixels; i++) {
+				bitChunkIdx = i*4;
+				bitArray[bitChunkIdx]   	= shortLUT[shortPix[i]];
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
+			}
+			
+			break;
+			
+		default:
+			break;
+	}
 	
-		// 32 bit signed 
-		case Image_Int:
+	// image statistics from the pixel value histogram
+	if (stats)
+		AddPixelCountStats(stats, histogram, nBins, -offset);
+	
+Error:
+	
+RETURN_ERR
+}
 
-			int* 					intPix 	 			= (int*) GetImagePixelArray(image);
-			int	 					int_min	 			= intPix[0];
-			int	 					int_max			 	= intPix[0];
+static int ConvertToBitArray_Scale (ImageDisplayCVI_type* imgDisplay, Image_type* image, unsigned char* bitArray, ImageStats_type* stats, char** errorMsg)
+{
+INIT_ERR
 	
-			for (int i = 0; i < nPixels; i++) {
-				if (intPix[i] > int_max)
-					int_max = intPix[i];
-		
-				if (intPix[i] < int_min)
-					int_min = intPix[i];
-			}
+	int						imgWidth		= 0;
+	int						imgHeight		= 0;
+	size_t					nPixels			= 0;
+	size_t					nValidPixels	= 0;		// number of pixels that are not NaN
+	size_t					bitChunkIdx		= 0;
+	double					minVal			= 0;
+	double					maxVal			= 0;
+	double					low				= 0;
+	double					high			= 0;
+	double					binFactor		= 0;
+	double					binScale		= 0;
+	float					scaleFactor		= 0;
+	float					lowF			= 0;
+	float					highF			= 0;
+	int						lowBin			= 0;
+	int						highBin			= 0;
+	unsigned int*			histogram		= NULL;
+	void*					pixArray		= GetImagePixelArray(image);
+	ImageTypes				imageType		= GetImageType(image);
+	// contrast settings may be changed from the main thread while rendering
+	ImgDisplayContrastModes	contrastMode	= imgDisplay->contrastMode;
+	double					contrastLow		= imgDisplay->contrastLow;
+	double					contrastHigh	= imgDisplay->contrastHigh;
 	
-			float					intScaleFactor 		= 255.0 / (int_max - int_min);
+	GetImageSize(image, &imgWidth, &imgHeight);
+	nPixels			= (size_t)imgHeight * imgWidth;
+	nValidPixels	= nPixels;
 	
-			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
-				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= (unsigned char)((intPix[i] - int_min) * intScaleFactor);
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
+	// get pixel value range
+	switch (imageType) {
+			
+		case Image_UInt:
+			
+			unsigned int*	uintPix 	= pixArray;
+			unsigned int	uint_min	= uintPix[0];
+			unsigned int	uint_max	= uintPix[0];
+			for (size_t i = 0; i < nPixels; i++) {
+				if (uintPix[i] > uint_max) uint_max = uintPix[i];
+				if (uintPix[i] < uint_min) uint_min = uintPix[i];
+				if (stats)
+					AccumulateImageStats(stats, uintPix[i]);
 			}
+			minVal = uint_min;
+			maxVal = uint_max;
 			break;
-
-		// 32 bit float
-		case Image_Float:					
-	
-			float* 					floatPix 	 		= (float*) GetImagePixelArray(image);
-			float  					float_min	 		= floatPix[0];
-			float  					float_max			= floatPix[0];
+			
+		case Image_Int:
+			
+			int*			intPix 		= pixArray;
+			int				int_min		= intPix[0];
+			int				int_max		= intPix[0];
+			for (size_t i = 0; i < nPixels; i++) {
+				if (intPix[i] > int_max) int_max = intPix[i];
+				if (intPix[i] < int_min) int_min = intPix[i];
+				if (stats)
+					AccumulateImageStats(stats, intPix[i]);
+			}
+			minVal = int_min;
+			maxVal = int_max;
+			break;
+			
+		case Image_Float:
+			
+			// NaN pixels are left out of the pixel value range
+			float*			floatPix 	= pixArray;
+			float			float_min	= FLT_MAX;
+			float			float_max	= -FLT_MAX;
+			nValidPixels = 0;
+			for (size_t i = 0; i < nPixels; i++) {
+				if (isnan(floatPix[i])) continue;
+				if (floatPix[i] > float_max) float_max = floatPix[i];
+				if (floatPix[i] < float_min) float_min = floatPix[i];
+				if (stats)
+					AccumulateImageStats(stats, floatPix[i]);
+				nValidPixels++;
+			}
+			minVal = (nValidPixels) ? float_min : 0;
+			maxVal = (nValidPixels) ? float_max : 0;
+			break;
+			
+		default:
+			break;
+	}
 	
-			for (int i = 0; i < nPixels; i++) {
-				if (floatPix[i] > float_max)
-					float_max = floatPix[i];
-		
-				if (floatPix[i] < float_min)
-					float_min = floatPix[i];
+	// get display range
+	switch (contrastMode) {
+			
+		case ImgDisplayContrast_Auto:
+			
+			low		= minVal;
+			high	= maxVal;
+			break;
+			
+		case ImgDisplayContrast_Percentile:
+			
+			low		= minVal;
+			high	= maxVal;
+			if (maxVal <= minVal) break;	// constant image
+			
+			// histogram of NHistBins_32bit bins spanning the pixel value range
+			if (!imgDisplay->histogram)
+				nullChk( imgDisplay->histogram = malloc(NHistBins_16bit * sizeof(unsigned int)) );
+			
+			histogram = imgDisplay->histogram;
+			memset(histogram, 0, NHistBins_32bit * sizeof(unsigned int));
+			binFactor = (NHistBins_32bit - 1) / (maxVal - minVal);
+			
+			switch (imageType) {
+					
+				case Image_UInt:
+					
+					unsigned int*	uintPix	= pixArray;
+					for (size_t i = 0; i < nPixels; i++)
+						histogram[(int)((uintPix[i] - minVal) * binFactor)]++;
+					break;
+					
+				case Image_Int:
+					
+					int*			intPix	= pixArray;
+					for (size_t i = 0; i < nPixels; i++)
+						histogram[(int)((intPix[i] - minVal) * binFactor)]++;
+					break;
+					
+				case Image_Float:
+					
+					float*			floatPix = pixArray;
+					for (size_t i = 0; i < nPixels; i++)
+						if (!isnan(floatPix[i]))
+							histogram[(int)((floatPix[i] - minVal) * binFactor)]++;
+					break;
+					
+				default:
+					break;
 			}
-												
-			float					floatScaleFactor 	= 255.0 / (float_max - float_min);
+			
+			GetHistogramRange(histogram, NHistBins_32bit, nValidPixels, contrastLow, contrastHigh, &lowBin, &highBin);
+			low		= minVal + lowBin / binFactor;
+			high	= minVal + highBin / binFactor;
+			break;
+			
+		case ImgDisplayContrast_Fixed:
+			
+			low		= contrastLow;
+			high	= contrastHigh;
+			break;
+	}
 	
-			// pixel mapping B->G->R->ignored byte
-			bitChunkIdx = 0;
-			for (int i = 0; i < nPixels; i++) {
+	// if the range is empty, e.g. for a constant image, pixels up to and including the range are black and pixels above are white
+	lowF		= (float)low;
+	highF		= (float)high;
+	scaleFactor = (high > low) ? (float)(255.0 / (high - low)) : 0;
+	
+	// histogram bins span the pixel value range and are filled in while mapping the pixels
+	if (stats)
+		binScale = SetImageStatsRange(stats, minVal, maxVal);
+	
+	// pixel mapping B->G->R->ignored byte
+	switch (imageType) {
+			
+		case Image_UInt:
+			
+			unsigned int*		uintPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++) {
 				bitChunkIdx = i*4;
-				display->bitmapBitArray[bitChunkIdx]   	= (unsigned char) ((floatPix[i] - float_min) * floatScaleFactor);
-				display->bitmapBitArray[bitChunkIdx+1] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+2] 	= display->bitmapBitArray[bitChunkIdx];
-				display->bitmapBitArray[bitChunkIdx+3] 	= 0;
+				bitArray[bitChunkIdx]   	= ScaleToDisplayValue((float)uintPix[i], lowF, highF, scaleFactor);
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
+				if (stats)
+					AddImageStatsBin(stats, uintPix[i], binScale);
 			}
 			break;
 			
-		case Image_RGBA:
-
-			RGBA_type* 				rgbaPix = (RGBA_type*) GetImagePixelArray(image);
-
-			for (int i = 0; i < nPixels; i++){
-				display->bitmapBitArray[i] 	 = (rgbaPix+i)->B;
-				display->bitmapBitArray[i+1] = (rgbaPix+i)->G;
-				display->bitmapBitArray[i+2] = (rgbaPix+i)->R;
-				display->bitmapBitArray[i+3] = 0;
+		case Image_Int:
+			
+			int*				intPix 		= pixArray;
+			for (size_t i = 0; i < nPixels; i++) {
+				bitChunkIdx = i*4;
+				bitArray[bitChunkIdx]   	= ScaleToDisplayValue((float)intPix[i], lowF, highF, scaleFactor);
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
+				if (stats)
+					AddImageStatsBin(stats, intPix[i], binScale);
 			}
 			break;
-		
-		/* not functional, must be modified accordingly
-		case Image_RGBAU64:
-	
-			RGBAU64_type* RGBAU64_ptr   = (RGBAU64_type*) GetImagePixelArray(image);
-			RGBAU64_type* iterr_u64		= NULL;
-			unsigned short maxR			= iterr->R;
-			unsigned short maxG			= iterr->G;
-			unsigned short maxB			= iterr->B;
-			unsigned short minR			= iterr->R;
-			unsigned short minG			= iterr->G;
-			unsigned short minB		    = iterr->B;
-			unsigned short intervalR	= 0;
-			unsigned short intervalG	= 0;
-			unsigned short intervalB	= 0;
-
-			for (int i = 0; i < nPixels; i++, iterr_u64++) {
-
-				if(maxR < iterr->R)
-					maxR = iterr->R;
-				if(minR > iterr->R)
-					minR = iterr->R;
-
-				if(maxG < iterr->G)
-					maxG = iterr->G;
-				if(minG > iterr->G)
-					minG = iterr->G;
-
-				if(maxB < iterr->B)
-					maxB = iterr->B;
-				if(minB > iterr->B)
-					minB = iterr->B;
-			}
-
-			//reset pointer position
-			iterr_u64 = RGBAU64_ptr;
-
-			intervalB = maxB - minB;
-			intervalG = maxG - minG;
-			intervalR = maxR - minR;
-
-			for (int i = 0; i < nPixels; i++, iterr_u64++){
-				display->bitmapBitArray[i]   = (unsigned char) ((iterr_u64->B - minB) * 255 /intervalB);
-				display->bitmapBitArray[i+1] = (unsigned char) ((iterr_u64->G - minG) * 255 /intervalG);
-				display->bitmapBitArray[i+2] = (unsigned char) ((iterr_u64->R - minR) * 255 /intervalR);
-				display->bitmapBitArray[i+3] = 0;
+			
+		case Image_Float:
+			
+			float*				floatPix 	= pixArray;
+			for (size_t i = 0; i < nPixels; i++) {
+				bitChunkIdx = i*4;
+				bitArray[bitChunkIdx]   	= ScaleToDisplayValue(floatPix[i], lowF, highF, scaleFactor);
+				bitArray[bitChunkIdx+1] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+2] 	= bitArray[bitChunkIdx];
+				bitArray[bitChunkIdx+3] 	= 0;
+				if (stats && !isnan(floatPix[i]))
+					AddImageStatsBin(stats, floatPix[i], binScale);
 			}
-
 			break;
-		*/
-		
+			
 		default:
-		
 			break;
+	}
 	
+Error:
+	
+RETURN_ERR
+}
+
+static unsigned char ScaleToDisplayValue (float pixVal, float low, float high, float scaleFactor)
+{
+	// NaN pixels are black
+	if (!(pixVal > low))
+		return 0;
+	
+	if (pixVal >= high)
+		return 255;
+	
+	return (unsigned char) ((pixVal - low) * scaleFactor);
+}
+
+static void GetHistogramRange (unsigned int histogram[], int nBins, size_t nPixels, double lowPercentile, double highPercentile, int* lowBinPtr, int* highBinPtr)
+{
+	double		lowCount		= lowPercentile / 100 * nPixels;
+	double		highCount		= highPercentile / 100 * nPixels;
+	size_t		cumCount		= 0;
+	int			bin				= 0;
+	
+	// first bin at which the cumulative pixel count exceeds the low percentile
+	for (bin = 0; bin < nBins - 1; bin++) {
+		cumCount += histogram[bin];
+		if (cumCount > lowCount) break;
+	}
+	*lowBinPtr = bin;
+	
+	// first bin at which the cumulative pixel count reaches the high percentile
+	cumCount = 0;
+	for (bin = 0; bin < nBins - 1; bin++) {
+		cumCount += histogram[bin];
+		if (cumCount && cumCount >= highCount) break;
 	}
+	*highBinPtr = bin;
+}
+
+/// HIFN Sets how pixel values are mapped to display intensities and shows the displayed image again with the new contrast. For ImgDisplayContrast_Percentile, 
+/// HIFN low and high are percentiles between 0 and 100 of the pixel value histogram. For ImgDisplayContrast_Fixed, low and high are pixel values. 
+/// HIFN For ImgDisplayContrast_Auto, low and high are ignored. Call this function from the main thread.
+int SetImageDisplayCVIContrast (ImageDisplayCVI_type* imgDisplay, ImgDisplayContrastModes contrastMode, double low, double high, char** errorMsg)
+{
+INIT_ERR
+
+	Image_type*		image	= NULL;
+	
+	imgDisplay->contrastMode 	= contrastMode;
+	imgDisplay->contrastLow		= low;
+	imgDisplay->contrastHigh	= high;
+	
+	SetMenuBarAttribute(imgDisplay->menuBarHndl, imgDisplay->contrastAutoItemID, ATTR_CHECKED, contrastMode == ImgDisplayContrast_Auto);
+	SetMenuBarAttribute(imgDisplay->menuBarHndl, imgDisplay->contrastPercentileItemID, ATTR_CHECKED, contrastMode == ImgDisplayContrast_Percentile);
+	SetMenuBarAttribute(imgDisplay->menuBarHndl, imgDisplay->contrastFixedItemID, ATTR_CHECKED, contrastMode == ImgDisplayContrast_Fixed);
+	
+	// show the displayed image again with the new contrast
+	if (!imgDisplay->baseClass.image) return 0;
+	
+	nullChk( image = copy_Image_type(imgDisplay->baseClass.image) );
+	errChk( UpdateImageDisplay(&imgDisplay->baseClass, &image, &errorInfo.errMsg) );
 	
 Error:
 	
-	return;
+	discard_Image_type(&image);
 	
+RETURN_ERR
 }
 
 
-static int DisplayImage (ImageDisplayCVI_type* imgDisplay, Image_type** imagePtr)
+static int DisplayImage (ImageDisplayCVI_type* imgDisplay, Image_type** imagePtr, char** errorMsg)
 {
 INIT_ERR 
 	
-	Image_type* 	image     		= *imagePtr;
-	int 			imgHeight 		= 0;
-	int 			imgWidth 		= 0;
-	*imagePtr						= NULL;
+	errChk( RenderImage(imgDisplay, imagePtr, &errorInfo.errMsg) );
+	errChk( BlitImage(imgDisplay, &errorInfo.errMsg) );
+	
+Error:
 	
-	imgDisplay->baseClass.image		= image;
-	*imagePtr = NULL;
+RETURN_ERR
+}
+
+static int RenderImage (ImageDisplayCVI_type* imgDisplay, Image_type** imagePtr, char** errorMsg)
+{
+INIT_ERR
+
+	Image_type*			image			= *imagePtr;
+	PyramidLevel_type*	fullLevel		= &imgDisplay->renderPyramid[0];
+	PyramidLevel_type*	srcLevel		= NULL;
+	unsigned char*		newPixels		= NULL;
+	double				zoomLevel		= imgDisplay->zoomLevel;
+	int					imgWidth		= 0;
+	int					imgHeight		= 0;
+	int					width			= 0;
+	int					height			= 0;
+	int					level			= 0;
+	ImageStats_type*	stats			= NULL;
+	
+	// keep the image until it is shown
+	discard_Image_type(&imgDisplay->renderedImage);
+	imgDisplay->renderedImage	= image;
+	*imagePtr					= NULL;
 	
-	GetImageSize(image, &imgWidth, &imgHeight);  
+	GetImageSize(image, &imgWidth, &imgHeight);
 	
-	if (imgWidth != imgDisplay->imgWidth || imgHeight != imgDisplay->imgHeight) {
+	// convert image to the full resolution level of the image pyramid
+	if (imgWidth != fullLevel->width || imgHeight != fullLevel->height || !fullLevel->pixels) {
+		nullChk( newPixels = realloc(fullLevel->pixels, imgWidth * imgHeight * 4) );
+		fullLevel->pixels 	= newPixels;
+		fullLevel->width	= imgWidth;
+		fullLevel->height	= imgHeight;
+	}
 	
-		// clear old display internal bitmap image data
-		OKfree(imgDisplay->bitmapBitArray);
-		if(imgDisplay->imgBitmapID) { 
-			DiscardBitmap(imgDisplay->imgBitmapID);
-			imgDisplay->imgBitmapID = 0;
-		}
+	stats = BeginImageDisplayStats(&imgDisplay->baseClass, GetImageType(image));
+	errChk( ConvertToBitArray(imgDisplay, image, fullLevel->pixels, stats, &errorInfo.errMsg) );
+	if (stats)
+		EndImageDisplayStats(&imgDisplay->baseClass);
+	imgDisplay->nRenderPyramidLevels = 1;
+	
+	// resample the image at the current zoom level
+	width 	= RoundRealToNearestInteger(imgWidth * zoomLevel);
+	height 	= RoundRealToNearestInteger(imgHeight * zoomLevel);
+	if (width < 1) width = 1;
+	if (height < 1) height = 1;
+	
+	nullChk( newPixels = realloc(imgDisplay->renderBitArray, width * height * 4) );
+	imgDisplay->renderBitArray	= newPixels;
+	imgDisplay->renderWidth		= width;
+	imgDisplay->renderHeight	= height;
+	imgDisplay->renderZoomLevel	= zoomLevel;
+	
+	if (zoomLevel == 1)
+		memcpy(imgDisplay->renderBitArray, fullLevel->pixels, width * height * 4);
+	else {
+		level = GetPyramidLevel(zoomLevel);
+		errChk( BuildImagePyramid(imgDisplay->renderPyramid, &imgDisplay->nRenderPyramidLevels, level + 1) );
+		if (level > imgDisplay->nRenderPyramidLevels - 1)
+			level = imgDisplay->nRenderPyramidLevels - 1;
 		
-		// allocate and update display internal data with new image content 
-		nullChk( imgDisplay->bitmapBitArray 		= (unsigned char*) malloc(imgHeight * imgWidth * 4) );
-		nullChk( imgDisplay->interpolationArray 	= (int*) realloc(imgDisplay->interpolationArray, imgHeight * imgWidth * sizeof(int)) );
-		
-		imgDisplay->nBytes	  = imgHeight * imgWidth * 4; 
-		imgDisplay->imgHeight = imgHeight;
-		imgDisplay->imgWidth  = imgWidth;
+		srcLevel = &imgDisplay->renderPyramid[level];
+		errChk( BilinearResize(srcLevel->pixels, srcLevel->width, srcLevel->height, imgDisplay->renderBitArray, width, height) );
+	}
 	
-		// convert new image data to bit array and create bitmap image
-		ConvertToBitArray(imgDisplay, image);
-		errChk( NewBitmap (-1, PixelDepth, imgDisplay->imgWidth, imgDisplay->imgHeight, NULL, imgDisplay->bitmapBitArray, NULL, &imgDisplay->imgBitmapID) );
+	// draw ROI outlines, the labels are drawn on the canvas when the image is shown
+	DrawROIOutlines(GetImageROIs(image), imgDisplay->renderBitArray, width, height, zoomLevel);
 	
-	} else {
-		
-		// only update bitmap data 
-		ConvertToBitArray(imgDisplay, image);
-		SetBitmapData(imgDisplay->imgBitmapID, -1, PixelDepth, NULL, imgDisplay->bitmapBitArray, NULL);
+Error:
 	
-	}
+RETURN_ERR
+}
 
+static int BlitImage (ImageDisplayCVI_type* imgDisplay, char** errorMsg)
+{
+INIT_ERR
+
+	PyramidLevel_type	pyramidLevel	= {.pixels = NULL, .width = 0, .height = 0};
+	unsigned char*		bitArray		= NULL;
+	int					nLevels			= 0;
+	BOOL				sizeChanged		= FALSE;
+	int					panVisible		= FALSE;
+	size_t				nReceived		= 0;
+	size_t				nDisplayed		= 0;
+	char				panTitle[64]	= "";
+	
+	if (!imgDisplay->renderedImage) return 0; // nothing rendered
+	
+	// discard current image and assign rendered image
+	discard_Image_type(&imgDisplay->baseClass.image);
+	imgDisplay->baseClass.image = imgDisplay->renderedImage;
+	imgDisplay->renderedImage 	= NULL;
+	
+	// swap the image pyramid and bit array of the displayed image with the rendered ones, keeping the buffers for rendering the next image
+	for (int i = 0; i < MaxPyramidLevels; i++) {
+		pyramidLevel 					= imgDisplay->pyramid[i];
+		imgDisplay->pyramid[i] 			= imgDisplay->renderPyramid[i];
+		imgDisplay->renderPyramid[i]	= pyramidLevel;
+	}
+	
+	nLevels 							= imgDisplay->nPyramidLevels;
+	imgDisplay->nPyramidLevels 			= imgDisplay->nRenderPyramidLevels;
+	imgDisplay->nRenderPyramidLevels	= nLevels;
+	
+	bitArray							= imgDisplay->bitmapBitArray;
+	imgDisplay->bitmapBitArray			= imgDisplay->renderBitArray;
+	imgDisplay->renderBitArray			= bitArray;
+	
+	sizeChanged = (imgDisplay->renderWidth != imgDisplay->imgWidth || imgDisplay->renderHeight != imgDisplay->imgHeight);
+	
+	imgDisplay->imgWidth	= imgDisplay->renderWidth;
+	imgDisplay->imgHeight	= imgDisplay->renderHeight;
+	imgDisplay->nBytes		= imgDisplay->imgWidth * imgDisplay->imgHeight * 4;
+	
+	// user zoomed while the image was rendered
+	if (imgDisplay->zoomLevel != imgDisplay->renderZoomLevel) {
+		errChk( Zoom(imgDisplay, imgDisplay->zoomLevel) );
+		goto ShowPanel;
+	}
+	
+	// update bitmap
+	if (sizeChanged || !imgDisplay->imgBitmapID) {
+		if (imgDisplay->imgBitmapID) {
+			DiscardBitmap(imgDisplay->imgBitmapID);
+			imgDisplay->imgBitmapID = 0;
+		}
+		errChk( NewBitmap (-1, PixelDepth, imgDisplay->imgWidth, imgDisplay->imgHeight, NULL, imgDisplay->bitmapBitArray, NULL, &imgDisplay->imgBitmapID) );
+	} else
+		errChk( SetBitmapData(imgDisplay->imgBitmapID, -1, PixelDepth, NULL, imgDisplay->bitmapBitArray, NULL) );
+	
 	// adjust canvas size to match image size
-	SetCtrlAttribute(imgDisplay->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , imgWidth);
-	SetCtrlAttribute(imgDisplay->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, imgHeight);
+	if (imgDisplay->zoomLevel == 1) {
+		SetCtrlAttribute(imgDisplay->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , imgDisplay->imgWidth);
+		SetCtrlAttribute(imgDisplay->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, imgDisplay->imgHeight);
+	} else
+		SetZoomedCanvasSize(imgDisplay, imgDisplay->imgWidth, imgDisplay->imgHeight);
 	
 	// draw bitmap on canvas
+	CanvasStartBatchDraw(imgDisplay->canvasPanHndl, CanvasPan_Canvas);
 	CanvasDrawBitmap (imgDisplay->canvasPanHndl, CanvasPan_Canvas, imgDisplay->imgBitmapID, VAL_ENTIRE_OBJECT, VAL_ENTIRE_OBJECT);
+	DrawROILabels(imgDisplay);
+	CanvasEndBatchDraw(imgDisplay->canvasPanHndl, CanvasPan_Canvas);
+	
+ShowPanel:
+	
+	// report displayed frames if the image was received through display updates
+	GetImageDisplayFrameCounts(&imgDisplay->baseClass, &nReceived, &nDisplayed);
+	if (nReceived) {
+		Fmt(panTitle, "Displayed %d of %d frames", (int)nDisplayed, (int)nReceived);
+		SetPanelAttribute(imgDisplay->displayPanHndl, ATTR_TITLE, panTitle);
+	}
 	
-	int panVisible	= FALSE;
 	GetPanelAttribute(imgDisplay->displayPanHndl, ATTR_VISIBLE, &panVisible);
 	
 	if (!panVisible)
 		DisplayPanel(imgDisplay->displayPanHndl); 
 	
-	return 0;
-	
-Error: 
-	
-	return errorInfo.error;
+Error:
 	
+RETURN_ERR
 }
 
 static int CVICALLBACK CanvasCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2)
@@ -1066,10 +1540,15 @@ static int Zoom (ImageDisplayCVI_type* display, double zoomLevel)
 {
 INIT_ERR 
 
-	int 	newWidth 			= 0;
-	int 	newHeight 			= 0;
-	int 	imageWidth			= 0;
-	int 	imageHeight			= 0;
+	int 				newWidth 			= 0;
+	int 				newHeight 			= 0;
+	int 				imageWidth			= 0;
+	int 				imageHeight			= 0;
+	int					level				= 0;
+	PyramidLevel_type*	srcLevel			= NULL;
+	unsigned char*		newBitArray			= NULL;
+	
+	if (!display->baseClass.image || !display->nPyramidLevels) return 0;
 	
 	display->zoomLevel = zoomLevel;
 	
@@ -1077,6 +1556,16 @@ INIT_ERR
 
 	newWidth 	= RoundRealToNearestInteger(imageWidth * display->zoomLevel);
 	newHeight 	= RoundRealToNearestInteger(imageHeight * display->zoomLevel);
+	if (newWidth < 1) newWidth = 1;
+	if (newHeight < 1) newHeight = 1;
+	
+	level = GetPyramidLevel(zoomLevel);
+	
+	errChk( BuildImagePyramid(display->pyramid, &display->nPyramidLevels, level + 1) );
+	if (level > display->nPyramidLevels - 1)
+		level = display->nPyramidLevels - 1;
+	
+	srcLevel = &display->pyramid[level];
 
 	// clean old bitmap since we'll rebuild the image
 	if (display->imgBitmapID) {
@@ -1084,112 +1573,177 @@ INIT_ERR
 		display->imgBitmapID = 0;
 	}
 	
-	nullChk ( display->resizedArray  =  (int*) realloc(display->resizedArray, newWidth * newHeight * sizeof(int)) );
- 
-	// update display image parameters (Image structure in baseClass is unmodified)
-	display->imgHeight 	= imageHeight;
-	display->imgWidth 	= imageWidth;
-	display->nBytes 	= imageHeight * imageWidth * 4;
-	
-	// convert the pixel array to byte array of pixels (PixelDepth 32 -> 4 bytes per pixel)	
-	ConvertToBitArray(display, display->baseClass.image);
-	NormalizePixelArray(display, &display->interpolationArray);
-	
-	// free the byte array and interpolate a new one
-	OKfree(display->bitmapBitArray); 
-	BilinearResize(display->interpolationArray, &display->resizedArray, imageWidth, imageHeight, newWidth, newHeight);
-	
 	// update image array size and allocate memory
 	display->imgWidth 	= newWidth;
 	display->imgHeight 	= newHeight;
 	display->nBytes 	= newWidth * newHeight * 4;
 	
-	nullChk( display->bitmapBitArray = (unsigned char*) malloc(display->nBytes * sizeof(unsigned char)) );  
+	nullChk( newBitArray = (unsigned char*) realloc(display->bitmapBitArray, display->nBytes * sizeof(unsigned char)) );
+	display->bitmapBitArray = newBitArray;
+	
+	// resample selected pyramid level to the displayed size
+	errChk( BilinearResize(srcLevel->pixels, srcLevel->width, srcLevel->height, display->bitmapBitArray, newWidth, newHeight) );
+
+	SetZoomedCanvasSize(display, newWidth, newHeight);
+	
+	errChk( NewBitmap (-1, PixelDepth, display->imgWidth, display->imgHeight, NULL, display->bitmapBitArray, NULL, &display->imgBitmapID) );
+	CanvasDrawBitmap (display->canvasPanHndl, CanvasPan_Canvas, display->imgBitmapID, VAL_ENTIRE_OBJECT, VAL_ENTIRE_OBJECT);
+	DrawROIs(display);
+	
+Error:
+	
+	return errorInfo.error; 
+	
 	
-	Deserialize(display, display->resizedArray, newWidth * newHeight);
+}
 
+static void SetZoomedCanvasSize (ImageDisplayCVI_type* display, int width, int height)
+{
 	// resize canvas according to image size, within defined limits
-	if(newWidth < CANVAS_MIN_WIDTH) 
+	if(width < CANVAS_MIN_WIDTH) 
 		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , CANVAS_MIN_WIDTH); 
-	else if (newWidth > CANVAS_MAX_WIDTH)
+	else if (width > CANVAS_MAX_WIDTH)
 		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , CANVAS_MAX_WIDTH);    
 	else 
-		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , newWidth);
+		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_WIDTH , width);
 	
-	 
-	if(newHeight < CANVAS_MIN_HEIGHT)
+	if(height < CANVAS_MIN_HEIGHT)
 		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, CANVAS_MIN_HEIGHT);
-	else if (newHeight > CANVAX_MAX_HEIGHT)
+	else if (height > CANVAX_MAX_HEIGHT)
 		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, CANVAX_MAX_HEIGHT); 
 	else
-	SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, newHeight);
+		SetCtrlAttribute(display->canvasPanHndl, CanvasPan_Canvas, ATTR_HEIGHT, height);
+}
+
+static int GetPyramidLevel (double zoomLevel)
+{
+	int		level	= 0;
 	
-	errChk( NewBitmap (-1, PixelDepth, display->imgWidth, display->imgHeight, NULL, display->bitmapBitArray, NULL, &display->imgBitmapID) );
-	CanvasDrawBitmap (display->canvasPanHndl, CanvasPan_Canvas, display->imgBitmapID, VAL_ENTIRE_OBJECT, VAL_ENTIRE_OBJECT);
-	DrawROIs(display);
+	// select the pyramid level from which the image is shrunk at most by a factor of 2, such that resampling touches a number of pixels proportional to the displayed size
+	while (level < MaxPyramidLevels - 1 && zoomLevel * (1 << (level + 1)) <= 1)
+		level++;
 	
-Error:
+	return level;
+}
+
+static int BuildImagePyramid (PyramidLevel_type pyramid[], int* nPyramidLevelsPtr, int nLevels)
+{
+INIT_ERR
 	
-	return errorInfo.error; 
+	PyramidLevel_type*	level			= NULL;
+	unsigned char*		newPixels		= NULL;
+	int					width			= 0;
+	int					height			= 0;
+	
+	// level 0 must hold the full resolution image
+	if (!*nPyramidLevelsPtr) return 0;
+	
+	// add levels until the requested number is reached or the image cannot be reduced further
+	while (*nPyramidLevelsPtr < nLevels) {
+		level = &pyramid[*nPyramidLevelsPtr - 1];
+		if (level->width == 1 && level->height == 1) break;
+		
+		width 	= (level->width + 1) / 2;
+		height 	= (level->height + 1) / 2;
+		nullChk( newPixels = realloc(pyramid[*nPyramidLevelsPtr].pixels, width * height * 4) );
+		pyramid[*nPyramidLevelsPtr].pixels 	= newPixels;
+		pyramid[*nPyramidLevelsPtr].width	= width;
+		pyramid[*nPyramidLevelsPtr].height	= height;
+		
+		DownsampleImageLevel(level, &pyramid[*nPyramidLevelsPtr]);
+		(*nPyramidLevelsPtr)++;
+	}
 	
+Error:
 	
+	return errorInfo.error;
 }
 
-static void Deserialize(ImageDisplayCVI_type* display, int* array, int length) {
-
-	for(int i = 0; i < length; i++) {
-		display->bitmapBitArray[4 * i] 	   = getByte(array[i], 3);
-		display->bitmapBitArray[4 * i + 1] = getByte(array[i], 2);
-		display->bitmapBitArray[4 * i + 2] = getByte(array[i], 1);
-		display->bitmapBitArray[4 * i + 3] = getByte(array[i], 0);	     
+static void DownsampleImageLevel (PyramidLevel_type* src, PyramidLevel_type* dst)
+{
+	unsigned char*		srcRow0		= NULL;
+	unsigned char*		srcRow1		= NULL;
+	unsigned char*		dstPix		= dst->pixels;
+	int					x0			= 0;
+	int					x1			= 0;
+	
+	// average 2x2 pixel blocks; for odd sizes the last row and column are repeated
+	for (int i = 0; i < dst->height; i++) {
+		srcRow0 = src->pixels + (size_t)(2 * i) * src->width * 4;
+		srcRow1 = (2 * i + 1 < src->height) ? srcRow0 + src->width * 4 : srcRow0;
+		
+		for (int j = 0; j < dst->width; j++) {
+			x0 = 8 * j;
+			x1 = (2 * j + 1 < src->width) ? x0 + 4 : x0;
+			for (int k = 0; k < 4; k++)
+				*dstPix++ = (unsigned char) ((srcRow0[x0 + k] + srcRow0[x1 + k] + srcRow1[x0 + k] + srcRow1[x1 + k] + 2) >> 2);
+		}
 	}
 }
 
-static void BilinearResize(int* input, int** outputPtr, int sourceWidth, int sourceHeight, int targetWidth, int targetHeight)
-{    
-    int a, b, c, d, x, y, index;
-	float x_diff, y_diff, blue, red, green;
-	
-    float 	x_ratio 	= ((float)(sourceWidth - 1)) / targetWidth;
-    float 	y_ratio 	= ((float)(sourceHeight - 1)) / targetHeight;
-    int*  	output 		= *outputPtr;
-    int 	offset 		= 0 ;
- 
-    for (int i = 0; i < targetHeight; i++) {
-        for (int j = 0; j < targetWidth; j++) {
-			
-            x 		= (int)(x_ratio * j) ;
-            y 		= (int)(y_ratio * i) ;
-            x_diff 	= (x_ratio * j) - x ;
-            y_diff 	= (y_ratio * i) - y ;
-            index 	= (y * sourceWidth + x) ;
-			
-            a 		= input[index] ;
-            b 		= input[index + 1] ;
-            c 		= input[index + sourceWidth] ;
-            d 		= input[index + sourceWidth + 1] ;
-
-			// blue element
-            blue 	= getByte(a, 3) * (1-x_diff)*(1-y_diff) + getByte(b, 3) * (x_diff)*(1-y_diff) +
-                   	  getByte(c, 3) * (y_diff)*(1-x_diff)   + getByte(d, 3) * (x_diff*y_diff);
-
-			// green element
-            green 	= getByte(a, 2) * (1-x_diff)*(1-y_diff) + getByte(b, 2) * (x_diff)*(1-y_diff) +
-                  	  getByte(c, 2) * (y_diff)*(1-x_diff)   + getByte(d, 2) * (x_diff*y_diff);
-			
- 			
-			// red element
-			red 	= getByte(a, 1) * (1-x_diff)*(1-y_diff) + getByte(b, 1) * (x_diff)*(1-y_diff) +
-                      getByte(c, 1) * (y_diff)*(1-x_diff)   + getByte(d, 1) * (x_diff*y_diff);
-			
-            output [offset++] =
-                    0x0 | // alpha
-                    ((((int)blue) & 0xff)   << 24) |
-                    ((((int)green) & 0xff) << 16) |
-                    ((((int)red) & 0xff)  << 8);
-			
-        }
-    }
+static int BilinearResize (unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst, int dstWidth, int dstHeight)
+{
+INIT_ERR
+	
+	int*				xIdx		= NULL;		// left source column for each target column, in bytes
+	int*				xWeight		= NULL;		// weight of the right source column, in 1/256 units
+	unsigned char*		srcRow0		= NULL;
+	unsigned char*		srcRow1		= NULL;
+	float 				x_ratio 	= (float)srcWidth / dstWidth;
+	float 				y_ratio 	= (float)srcHeight / dstHeight;
+	float				srcPos		= 0;
+	int					pos			= 0;
+	int					yWeight		= 0;
+	int					top			= 0;
+	int					bottom		= 0;
+	int					xOffset		= 0;
+	
+	nullChk( xIdx 		= malloc(dstWidth * sizeof(int)) );
+	nullChk( xWeight 	= malloc(dstWidth * sizeof(int)) );
+	
+	// column sampling positions are the same for all rows
+	for (int j = 0; j < dstWidth; j++) {
+		srcPos = (j + 0.5f) * x_ratio - 0.5f;
+		if (srcPos < 0) srcPos = 0;
+		pos = (int)srcPos;
+		if (pos >= srcWidth - 1) {
+			pos 		= srcWidth - 1;
+			xWeight[j]	= 0;
+		} else
+			xWeight[j]	= (int)((srcPos - pos) * 256);
+		
+		xIdx[j] = pos * 4;
+	}
+	
+	for (int i = 0; i < dstHeight; i++) {
+		srcPos = (i + 0.5f) * y_ratio - 0.5f;
+		if (srcPos < 0) srcPos = 0;
+		pos = (int)srcPos;
+		if (pos >= srcHeight - 1) {
+			pos 	= srcHeight - 1;
+			yWeight	= 0;
+		} else
+			yWeight	= (int)((srcPos - pos) * 256);
+		
+		srcRow0 = src + (size_t)pos * srcWidth * 4;
+		srcRow1 = yWeight ? srcRow0 + srcWidth * 4 : srcRow0;
+		
+		for (int j = 0; j < dstWidth; j++) {
+			xOffset = (xWeight[j]) ? 4 : 0;
+			for (int k = 0; k < 4; k++) {
+				top 	= srcRow0[xIdx[j] + k] * (256 - xWeight[j]) + srcRow0[xIdx[j] + xOffset + k] * xWeight[j];
+				bottom 	= srcRow1[xIdx[j] + k] * (256 - xWeight[j]) + srcRow1[xIdx[j] + xOffset + k] * xWeight[j];
+				*dst++ 	= (unsigned char) ((top * (256 - yWeight) + bottom * yWeight + (1 << 15)) >> 16);
+			}
+		}
+	}
+	
+Error:
+	
+	OKfree(xIdx);
+	OKfree(xWeight);
+	
+	return errorInfo.error;
 }
 
 
@@ -1224,13 +1778,7 @@ static void DrawROIs(ImageDisplayCVI_type* display) {
 						 			 .height	= ((Rect_type*)ROI_iterr)->height * magnify	};
 				
 				
-				Rect	textrect = { .top 		= ((Rect_type*)ROI_iterr)->top * magnify + ROILabel_YOffset,
-						 			 .left 		= ((Rect_type*)ROI_iterr)->left * magnify + ROILabel_XOffset,
-						 			 .width 	= ROI_LABEL_WIDTH,
-						 			 .height	= ROI_LABEL_HEIGHT	};
-				
 				CanvasDrawRect (display->canvasPanHndl, CanvasPan_Canvas, rect, VAL_DRAW_FRAME);
-				CanvasDrawText (display->canvasPanHndl, CanvasPan_Canvas, ROI_iterr->ROIName,VAL_APP_META_FONT,textrect, VAL_LOWER_LEFT);
 			}
 			
 			// in case current roi is a point
@@ -1239,25 +1787,113 @@ static void DrawROIs(ImageDisplayCVI_type* display) {
 				Point 		point = { .x = ((Point_type*)ROI_iterr)->x * magnify, 
 								  	  .y = ((Point_type*)ROI_iterr)->y * magnify	};
 			
-				Rect	textrect_point = { 	.top 		= point.y + ROILabel_YOffset,
-						 			 	   	.left 		= point.x + ROILabel_XOffset,
-						 			 		.width 	= ROI_LABEL_WIDTH,
-						 			 		.height	= ROI_LABEL_HEIGHT	};
-				
-				
 				// draw the cross that marks a ROI point
 				CanvasDrawLine(display->canvasPanHndl, CanvasPan_Canvas, MakePoint(point.x - CROSS_LENGTH, point.y), MakePoint(point.x + CROSS_LENGTH, point.y));
 				CanvasDrawLine(display->canvasPanHndl, CanvasPan_Canvas, MakePoint(point.x, point.y - CROSS_LENGTH), MakePoint(point.x, point.y + CROSS_LENGTH));
-				CanvasDrawText(display->canvasPanHndl, CanvasPan_Canvas, ROI_iterr->ROIName,VAL_APP_META_FONT,textrect_point, VAL_LOWER_LEFT);
 					
 				
 			}
 	   	}
 	}
 	
+	DrawROILabels(display);
+	
 	CanvasEndBatchDraw (display->canvasPanHndl, CanvasPan_Canvas);  
 }
 
+static void DrawROILabels (ImageDisplayCVI_type* display)
+{
+	ListType	ROIlist				= GetImageROIs(display->baseClass.image);
+	size_t 		nROIs 				= ListNumItems(ROIlist);
+	ROI_type*	ROI					= NULL;
+	Point		labelPos			= {.x = 0, .y = 0};
+	
+	for (size_t i = 1; i <= nROIs; i++) {
+		ROI = *(ROI_type**) ListGetPtrToItem(ROIlist, i);
+		if (!ROI->active) continue;
+		
+		// ROIs are stored without zoom and the current magnification needs to be applied
+		switch (ROI->ROIType) {
+				
+			case ROI_Rectangle:
+				labelPos = MakePoint(((Rect_type*)ROI)->left * display->zoomLevel, ((Rect_type*)ROI)->top * display->zoomLevel);
+				break;
+				
+			case ROI_Point:
+				labelPos = MakePoint(((Point_type*)ROI)->x * display->zoomLevel, ((Point_type*)ROI)->y * display->zoomLevel);
+				break;
+		}
+		
+		CanvasDrawText(display->canvasPanHndl, CanvasPan_Canvas, ROI->ROIName, VAL_APP_META_FONT, 
+					   MakeRect(labelPos.y + ROILabel_YOffset, labelPos.x + ROILabel_XOffset, ROI_LABEL_HEIGHT, ROI_LABEL_WIDTH), VAL_LOWER_LEFT);
+	}
+}
+
+static void DrawROIOutlines (ListType ROIList, unsigned char* bitArray, int width, int height, double zoomLevel)
+{
+	size_t 		nROIs 				= ListNumItems(ROIList);
+	ROI_type*	ROI					= NULL;
+	int			top					= 0;
+	int			left				= 0;
+	int			bottom				= 0;
+	int			right				= 0;
+	int			x					= 0;
+	int			y					= 0;
+	
+	for (size_t i = 1; i <= nROIs; i++) {
+		ROI = *(ROI_type**) ListGetPtrToItem(ROIList, i);
+		if (!ROI->active) continue;
+		
+		// ROIs are stored without zoom and the rendered magnification needs to be applied
+		switch (ROI->ROIType) {
+				
+			case ROI_Rectangle:
+				
+				top 	= RoundRealToNearestInteger(((Rect_type*)ROI)->top * zoomLevel);
+				left	= RoundRealToNearestInteger(((Rect_type*)ROI)->left * zoomLevel);
+				bottom	= RoundRealToNearestInteger((((Rect_type*)ROI)->top + ((Rect_type*)ROI)->height) * zoomLevel) - 1;
+				right	= RoundRealToNearestInteger((((Rect_type*)ROI)->left + ((Rect_type*)ROI)->width) * zoomLevel) - 1;
+				
+				for (x = left; x <= right; x++) {
+					SetBitArrayPixel(bitArray, width, height, x, top, ROI->rgba);
+					SetBitArrayPixel(bitArray, width, height, x, bottom, ROI->rgba);
+				}
+				
+				for (y = top; y <= bottom; y++) {
+					SetBitArrayPixel(bitArray, width, height, left, y, ROI->rgba);
+					SetBitArrayPixel(bitArray, width, height, right, y, ROI->rgba);
+				}
+				break;
+				
+			case ROI_Point:
+				
+				// draw the cross that marks a ROI point
+				x = RoundRealToNearestInteger(((Point_type*)ROI)->x * zoomLevel);
+				y = RoundRealToNearestInteger(((Point_type*)ROI)->y * zoomLevel);
+				
+				for (int j = -CROSS_LENGTH; j <= CROSS_LENGTH; j++) {
+					SetBitArrayPixel(bitArray, width, height, x + j, y, ROI->rgba);
+					SetBitArrayPixel(bitArray, width, height, x, y + j, ROI->rgba);
+				}
+				break;
+		}
+	}
+}
+
+static void SetBitArrayPixel (unsigned char* bitArray, int width, int height, int x, int y, RGBA_type color)
+{
+	unsigned char*	pixel	= NULL;
+	
+	if (x < 0 || y < 0 || x >= width || y >= height) return;
+	
+	// pixel mapping B->G->R->ignored byte
+	pixel 		= bitArray + ((size_t)y * width + x) * 4;
+	pixel[0]	= color.B;
+	pixel[1]	= color.G;
+	pixel[2]	= color.R;
+	pixel[3]	= 0;
+}
+
 static void CVIROIActions (ImageDisplayCVI_type* display, int ROIIdx, ROIActions action)
 {
 	ROI_type**		ROIPtr 		= NULL;
@@ -1368,259 +2004,79 @@ void CVICALLBACK MenuRestoreCB (int menuBarHandle, int menuItemID, void *callbac
 		FireCallbackGroup(display->baseClass.callbackGroup, ImageDisplay_RestoreSettings, NULL); 
 };
 
-int DisplayRGBImageChannels (ImageDisplayCVI_type* imgDisplay, ColorChannel_type** RChanPtr, ColorChannel_type** GChanPtr, ColorChannel_type** BChanPtr) {
-
+//Callback triggered when "Histogram" menu item is clicked  
+void CVICALLBACK MenuHistogramCB (int menuBarHandle, int menuItemID, void *callbackData, int panelHandle) {
+	
 INIT_ERR
 	
-	ColorChannel_type* RChan; 			
-	ColorChannel_type* GChan; 
-	ColorChannel_type* BChan;
+		ImageDisplayCVI_type* 	display 		= (ImageDisplayCVI_type*) callbackData;
+		errChk( ShowImageDisplayHistogram(&display->baseClass, &errorInfo.errMsg) );
 	
-	if(RChanPtr)
-		RChan	= *RChanPtr;
-	else
-		RChan	= NULL;
+Error:
 	
-	if(GChanPtr)
-		GChan	= *GChanPtr;
-	else
-		GChan	= NULL;
+PRINT_ERR
+};
 
-	if(BChanPtr)
-		BChan	= *BChanPtr;
-	else
-		BChan	= NULL;
-	
-	int 		RImageHeight		= 0;	
-	int 		RImageWidth			= 0;	
-	int 		GImageHeight		= 0;	
-	int 		GImageWidth			= 0;	
-	int 		BImageHeight		= 0;	
-	int 		BImageWidth			= 0;	
-	int 		finalImageHeight	= 0;
-	int 		finalImageWidth		= 0;
-	RGBA_type* 	pixelArray			= NULL;
-	int			nPixels				= 0;
-	Image_type* finalImage			= NULL;
-	
-	if(RChan == NULL && GChan == NULL && BChan == NULL)
-		return -1;
+//Callback triggered when a "Contrast" menu item is clicked
+void CVICALLBACK MenuContrastCB (int menuBarHandle, int menuItemID, void *callbackData, int panelHandle) {
 	
-	if(RChan) {
-		
-		//get max height and width for the red Channel resulted image, including all offsets
-		GetResultedImageSize(RChan, &RImageHeight, &RImageWidth);
-
-		//reallocate buffers to fit red channel resulted image pixels
-		nullChk(imgDisplay->RGBOverlayBuffer[0] = realloc(imgDisplay->RGBOverlayBuffer[0], RImageHeight * RImageWidth * sizeof(float)) );
-
-		//sum up pixels for each image of the red Channel
-		AddImagePixels(&imgDisplay->RGBOverlayBuffer[0], RImageHeight, RImageWidth, RChan); 
-		
-	};
+INIT_ERR
 	
-	if(GChan) {
-		
-		//get max height and width for the green Channel resulted image, including all offsets
-		GetResultedImageSize(GChan, &GImageHeight, &GImageWidth);
+		ImageDisplayCVI_type* 	display 		= (ImageDisplayCVI_type*) callbackData;
+		char					rangeStr[64]	= "";
+		double					low				= 0;
+		double					high			= 0;
 		
-		//reallocate buffers to fit green channel resulted image pixels
-		nullChk(imgDisplay->RGBOverlayBuffer[1] = realloc(imgDisplay->RGBOverlayBuffer[1], GImageHeight * GImageWidth * sizeof(float)) );
-
-		//sum up pixels for each image of the green Channel  
-		AddImagePixels(&imgDisplay->RGBOverlayBuffer[1], GImageHeight, GImageWidth, GChan); 	
-	}
-
-	
-	if (BChan) {
-		//get max height and width for the blue Channel resulted image, including all offsets 
-		GetResultedImageSize(BChan, &BImageHeight, &BImageWidth);
+		if (menuItemID == display->contrastAutoItemID)
+			errChk( SetImageDisplayCVIContrast(display, ImgDisplayContrast_Auto, 0, 0, &errorInfo.errMsg) );
 		
-		//reallocate buffers to fit blue channel resulted image pixels
-		nullChk(imgDisplay->RGBOverlayBuffer[2] = realloc(imgDisplay->RGBOverlayBuffer[2], BImageHeight * BImageWidth * sizeof(float)) );
+		if (menuItemID == display->contrastPercentileItemID)
+			errChk( SetImageDisplayCVIContrast(display, ImgDisplayContrast_Percentile, ContrastLowPercentile, ContrastHighPercentile, &errorInfo.errMsg) );
 		
-		//sum up pixels for each image of the blue Channel 
-		AddImagePixels(&imgDisplay->RGBOverlayBuffer[2], BImageHeight, BImageWidth, BChan); 
-	}
-	
-	//adjust final image to the size of the channel resulted image with highest dimensions
-	if(finalImageHeight < RImageHeight)
-		finalImageHeight = RImageHeight;
-	if(finalImageWidth < RImageWidth)
-		finalImageWidth = RImageWidth;
-	
-	
-	if(finalImageHeight < GImageHeight)
-		finalImageHeight = GImageHeight;
-	if(finalImageWidth < GImageWidth)
-		finalImageWidth = GImageWidth;
-	
-	
-	if(finalImageHeight < BImageHeight)
-		finalImageHeight = BImageHeight;
-	if(finalImageWidth < BImageWidth)
-		finalImageWidth = BImageWidth;
-	
-	nPixels = finalImageWidth * finalImageHeight;
+		if (menuItemID == display->contrastFixedItemID) {
+			if (display->contrastMode == ImgDisplayContrast_Fixed)
+				snprintf(rangeStr, sizeof(rangeStr), "%g, %g", display->contrastLow, display->contrastHigh);
+			
+			if (PromptPopup("Fixed contrast", "Displayed pixel value range as low, high:", rangeStr, sizeof(rangeStr) - 1) >= 0)
+				if (sscanf(rangeStr, "%lf , %lf", &low, &high) == 2 && high > low)
+					errChk( SetImageDisplayCVIContrast(display, ImgDisplayContrast_Fixed, low, high, &errorInfo.errMsg) );
+		}
 	
-	//allocate pixelArray to be used when constructing the final image
-	nullChk( pixelArray=(RGBA_type*) calloc(nPixels, sizeof(RGBA_type)) );
+Error:
 	
-	//set R, G or B field in the pixelArray for the final Image, Normalize convers from [max, min] range in RGBOverlayBuffer[i] to [0, 255]
-	if(RChan){
-		int RedPixelsNum = RImageHeight * RImageWidth;
-		NormalizeFloatArrayToRGBA(&pixelArray, imgDisplay->RGBOverlayBuffer[0], RedPixelsNum, 0);
-	}
+PRINT_ERR
+};
+
+int DisplayRGBImageChannels (ImageDisplayCVI_type* imgDisplay, ColorChannel_type** RChanPtr, ColorChannel_type** GChanPtr, ColorChannel_type** BChanPtr) {
+
+INIT_ERR
 	
-	if(GChan){
-		int GreenPixelsNum = GImageHeight * GImageWidth;
-		NormalizeFloatArrayToRGBA(&pixelArray, imgDisplay->RGBOverlayBuffer[1], GreenPixelsNum, 1);  
-	}
+	ColorChannel_type**		chanPtrs[3]		= {RChanPtr, GChanPtr, BChanPtr};
+	RGBA_type				chanColors[3]	= {{.R = 255}, {.G = 255}, {.B = 255}};
+	ColorChannel_type*		colorChans[3]	= {NULL, NULL, NULL};
+	size_t					nChannels		= 0;
 	
-	if(BChan){
-		int BluePixelsNum = BImageHeight * BImageWidth;
-		NormalizeFloatArrayToRGBA(&pixelArray, imgDisplay->RGBOverlayBuffer[2], BluePixelsNum, 2);  
+	// compose the channels that are given in red, green and blue
+	for (int i = 0; i < 3; i++) {
+		if (!chanPtrs[i] || !*chanPtrs[i]) continue;
 		
+		SetColorChannelDisplay(*chanPtrs[i], chanColors[i], (*chanPtrs[i])->gamma);
+		colorChans[nChannels++] = *chanPtrs[i];
 	}
-
-	finalImage = init_Image_type(Image_RGBA, finalImageHeight, finalImageWidth, &pixelArray);
 	
-	DisplayImage(imgDisplay, &finalImage);
-	
-	return 0;
+	if (!nChannels)
+		return -1;
 	
+	// the composite image is rendered on a worker thread and shown on the main thread like any other image
+	errChk( UpdateImageDisplayComposite(&imgDisplay->baseClass, nChannels, colorChans, ColorBlend_Additive, &errorInfo.errMsg) );
 	
 Error:
-	return errorInfo.error;
-}
-
-
-//Converts a float array to a [0, 255] range array, representing R, G or B field in RGBA_type pixel array
-void NormalizeFloatArrayToRGBA(RGBA_type* outputPtr[], float* input, int nPixels, int RGBAChannel) {
 	
-	float 		min 		= input[0];
-	float 		max 		= input[0];
-	float 		interval 	=  0;
-	RGBA_type* 	output 		= *outputPtr;
+	for (int i = 0; i < 3; i++)
+		if (chanPtrs[i])
+			discard_ColorChannel_type(chanPtrs[i]);
 	
-	for(int i = 0; i < nPixels; i++) {
-		if (input[i] > max)
-			max = input[i];
-		if (input[i] < min)
-			min = input[i];
-	}
-	interval = max - min;
-	
-	for(int i = 0; i < nPixels; i++) {
-		if(RGBAChannel == 0) {
-			output[i].R = (unsigned char) ((input[i] - min)	* 255.0 / interval);
-		}
-		if(RGBAChannel == 1) {
-			output[i].G = (unsigned char) ((input[i] - min)	* 255.0 / interval);
-		}
-		if(RGBAChannel == 2) {
-			output[i].B = (unsigned char) ((input[i] - min)	* 255.0 / interval);
-		}
-	}
-}
-//Taking into account all offsets, calculate the max size(height and width) for the image
-// resulted by summing up pixels from all of the channel's images.
-void GetResultedImageSize(ColorChannel_type* colorChan, int* heightPtr, int* widthPtr) {
-  
-  int MaxHeight = 0;
-  int MaxWidth 	= 0;
-  int crtHeight = 0;
-  int crtWidth  = 0;
-  
-  for (int i = 0; i < colorChan->nImages; i++) {
-  	GetImageSize( colorChan->images[i], &crtHeight, &crtWidth);
-	
-	if ( (crtHeight + colorChan->xOffsets[i])  > MaxHeight)
-		MaxHeight = crtHeight + colorChan->xOffsets[i];
-	
-	if ( (crtWidth + colorChan->yOffsets[i]) > MaxWidth)
-		MaxWidth = crtWidth + colorChan->yOffsets[i];
-  }
-  
-  *heightPtr = MaxHeight;
-  *widthPtr  = MaxWidth;
-  
-};
-
-//Sum pixels in each position for all of the channel's images, taking into account the offset
-void AddImagePixels(float** ResultImagePixArrayPtr, int ResultImageHeight, int ResultImageWidth, ColorChannel_type*  colorChan) {
-	
-	ImageTypes 			imgType;
-	int					height;
-	int 				width;
-	int 				pixels;
-	float*				array = *ResultImagePixArrayPtr;
-	for(int i = 0; i < colorChan->nImages; i++) {
-		
-		imgType = GetImageType(colorChan->images[i]);
-		GetImageSize(colorChan->images[i], &height, &width);
-		pixels = height * width;
-		
-		int offset = colorChan->xOffsets[i] * ResultImageHeight + colorChan->yOffsets[i];
-		
-		switch(imgType) {
-			case Image_UChar:
-			
-			unsigned char* uchar_iterr = (unsigned char*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				// add_of(array[offset + j], aray[offset + j] , uchar_iterr[j])
-				array[offset + j] = array[offset + j] +  uchar_iterr[j];
-			}
-			
-			break;
-			
-			case Image_UShort:					// 16 bit unsigned
-			
-			unsigned short int* ushort_iterr = (unsigned short int*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				array[offset + j] = array[offset + j] +  ushort_iterr[j];
-			}
-			
-			break;
-			
-			case Image_Short:
-			
-			short int* short_iterr = (short int*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				array[offset + j] = array[offset + j] +  short_iterr[j];
-			}
-			
-			break;
-			
-			case Image_UInt:					// 32 bit unsigned
-			
-			unsigned  int* 	uint_iterr 		= (unsigned int*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				array[offset + j] = array[offset + j] +  uint_iterr[j];
-			}
-			
-			break;
-			
-			case Image_Int:						// 32 bit signed
-			
-			int* 	int_iterr 		= (int*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				array[offset + j] = array[offset + j] +  int_iterr[j];
-			}
-			
-			break;
-
-			case Image_Float:					// 32 bit float 
-			
-			float* 	float_iterr 		= (float*) GetImagePixelArray(colorChan->images[i]);
-			for(int j = 0; j < pixels; j++) {
-				array[offset + j] = array[j] +  float_iterr[j];
-			}
-			
-			break;
-			
-		}
-	}
+PRINT_ERR
 	
+	return errorInfo.error;
 }
-			
@@ -35,6 +35,12 @@
 		
 typedef struct ImageDisplayCVI	ImageDisplayCVI_type; 
 
+typedef enum {
+	ImgDisplayContrast_Auto,			// Display range spans the pixel values of each image.
+	ImgDisplayContrast_Percentile,		// Display range spans the given lower and upper percentiles of the pixel value histogram of each image.
+	ImgDisplayContrast_Fixed			// Display range is a fixed window of pixel values.
+} ImgDisplayContrastModes;
+
 
 //=============================================================================
 // External variables
@@ -51,6 +57,13 @@ ImageDisplayCVI_type* 		init_ImageDisplayCVI_type 		(	int    					parentPanHandl
 
 void						discard_ImageDisplayCVI_type	(ImageDisplayCVI_type** imageDisplayPtr);
 
+	// Sets how pixel values are mapped to display intensities and shows the displayed image again. Also available from the Image>>Contrast menu.
+int							SetImageDisplayCVIContrast		(ImageDisplayCVI_type* 		imgDisplay,
+															 ImgDisplayContrastModes	contrastMode,
+															 double						low,
+															 double						high,
+															 char**						errorMsg);
+
 
 
 #ifdef __cplusplus
@@ -0,0 +1,871 @@
+//==============================================================================
+//
+// Title:		ImageDisplayHeadless.c
+// Purpose:		Image display rendering into memory without a user interface.
+//
+// Created on:	18-10-2026 at 18:10:51 by agent.
+// Copyright:	VU University Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+//==============================================================================
+// Include files
+
+#include <ansi_c.h>
+#include "ImageDisplayHeadless.h"
+#include "DAQLabErrHandling.h"
+
+//==============================================================================
+// Platform
+
+// Runtime functions used by the headless display, mapped to the CVI runtime or otherwise to their C11 and POSIX equivalents.
+#ifdef _CVI_
+
+	#include <utility.h>
+	#include "toolbox.h"
+	
+	typedef CmtThreadLockHandle		HeadlessLock_type;
+	
+	#define HeadlessMaxPathLen							MAX_PATHNAME_LEN
+	#define NewHeadlessLock(lockPtr)					CmtNewLock(NULL, 0, lockPtr)
+	#define DiscardHeadlessLock(lock)					CmtDiscardLock(lock)
+	#define GetHeadlessLock(lock)						CmtGetLock(lock)
+	#define ReleaseHeadlessLock(lock)					CmtReleaseLock(lock)
+	#define HeadlessTimer()								Timer()
+	#define HeadlessStrDup(str)							StrDup(str)
+	#define MakeHeadlessPathname(folder, file, path)	MakePathname(folder, file, path)
+
+#else
+
+	#include <pthread.h>
+	#include <time.h>
+	
+	typedef pthread_mutex_t*		HeadlessLock_type;
+	
+	#define HeadlessMaxPathLen							4096
+	#define GetHeadlessLock(lock)						pthread_mutex_lock(lock)
+	#define ReleaseHeadlessLock(lock)					pthread_mutex_unlock(lock)
+	#define HeadlessStrDup(str)							strdup(str)
+	#define MakeHeadlessPathname(folder, file, path)	snprintf(path, HeadlessMaxPathLen, "%s/%s", folder, file)
+	
+	static int NewHeadlessLock (HeadlessLock_type* lockPtr)
+	{
+		if ( !(*lockPtr = malloc(sizeof(pthread_mutex_t))) ) return -1;
+		if (pthread_mutex_init(*lockPtr, NULL)) {
+			OKfree(*lockPtr);
+			return -1;
+		}
+		return 0;
+	}
+	
+	static void DiscardHeadlessLock (HeadlessLock_type lock)
+	{
+		pthread_mutex_destroy(lock);
+		free(lock);
+	}
+	
+	static double HeadlessTimer (void)
+	{
+		struct timespec		now;
+		
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+
+#endif
+
+//==============================================================================
+// Constants
+
+#define PNG_MaxStoredBlock		65535		// Largest number of bytes in an uncompressed deflate block of a PNG file.
+#define Adler32_Modulus			65521		// Modulus of the Adler-32 checksum of a zlib stream.
+#define Adler32_MaxSums			5552		// Largest number of bytes summed before the Adler-32 sums must be reduced.
+
+//==============================================================================
+// Macros
+
+// Finds the smallest and largest pixel values of a pixel array of a given type, leaving out NaN pixels. If stats is not NULL, the pixel values are also accumulated in the statistics.
+#define GetPixelRange(type, pixArray, nPixels, minVal, maxVal, stats) { \
+	type*	pix 	= (type*)(pixArray); \
+	size_t	nValid	= 0; \
+	(minVal) = HUGE_VAL; \
+	(maxVal) = -HUGE_VAL; \
+	for (size_t i = 0; i < (nPixels); i++) { \
+		if (pix[i] != pix[i]) continue; \
+		if (pix[i] < (minVal)) (minVal) = (double) pix[i]; \
+		if (pix[i] > (maxVal)) (maxVal) = (double) pix[i]; \
+		if (stats) AccumulateImageStats(stats, pix[i]); \
+		nValid++; \
+	} \
+	if (!nValid) (minVal) = (maxVal) = 0; \
+}
+
+// Maps pixel values of a given type from minVal onwards to 8 bit intensities, saturating values outside the range and showing NaN pixels black. If stats is not NULL,
+// the pixel values are also added to the statistics histogram.
+#define NormalizePixels(type, pixArray, nPixels, minVal, scale, dst, stats, binScale) { \
+	type*	pix = (type*)(pixArray); \
+	double	val	= 0; \
+	for (size_t i = 0; i < (nPixels); i++) { \
+		val = ((double) pix[i] - (minVal)) * (scale); \
+		(dst)[i] = (unsigned char) ((!(val > 0)) ? 0 : ((val > 255) ? 255 : val)); \
+		if (stats && pix[i] == pix[i]) AddImageStatsBin(stats, pix[i], binScale); \
+	} \
+}
+
+//==============================================================================
+// Types
+
+// 8 bit grayscale or 24 bit RGB pixels rendered from an image.
+typedef struct {
+	unsigned char*						pixels;					// Pixel array with nChannels bytes per pixel.
+	int									width;					// Frame width.
+	int									height;					// Frame height.
+	int									nChannels;				// 1 for grayscale and 3 for RGB frames.
+	double								minVal;					// Pixel value shown as black in grayscale frames.
+	double								maxVal;					// Pixel value shown as white in grayscale frames.
+} HeadlessFrame_type;
+
+struct ImageDisplayHeadless {
+	// BASE CLASS
+	ImageDisplay_type					baseClass;
+	
+	// DATA
+	HeadlessFrame_type					frame;					// Frame shown last.
+	HeadlessFrame_type					renderFrame;			// Frame rendered on a worker thread which replaces frame when shown.
+	Image_type*							renderedImage;			// Image from which renderFrame was rendered, becomes the base class image when shown.
+	double								renderTime;				// Time in [ms] taken to render renderFrame.
+	char*								dumpFolderPath;			// Folder to which shown frames are written, NULL if frames are not written.
+	char*								dumpFilePrefix;			// File name prefix of written frames.
+	HeadlessFrameFormats				dumpFormat;				// File format of written frames.
+	
+	// TIMING
+	HeadlessLock_type					timingLock;				// Protects timing, which is read from any thread.
+	HeadlessDisplayTiming_type			timing;					// Render timing of the shown frames.
+	size_t								timingIdx;				// Index in timing.renderTimes and timing.blitTimes where the next frame is recorded.
+	double								totalRenderTime;		// Sum of frame render times in [ms].
+	double								totalBlitTime;			// Sum of frame show times in [ms].
+};
+
+//==============================================================================
+// Static global variables
+
+//==============================================================================
+// Static functions
+
+static int								DisplayHeadlessImage							(ImageDisplayHeadless_type* imgDisplay, Image_type** imagePtr, char** errorMsg);
+
+	// Converts the image to an 8 bit grayscale or 24 bit RGB frame in memory. Called on a worker thread.
+static int								RenderHeadlessImage								(ImageDisplayHeadless_type* imgDisplay, Image_type** imagePtr, char** errorMsg);
+
+	// Shows the rendered frame by making it the current frame, writes it to a file if needed and records its timing.
+static int								BlitHeadlessImage								(ImageDisplayHeadless_type* imgDisplay, char** errorMsg);
+
+	// Converts only the given rows of an image still being acquired into the current frame, using the pixel value range of the frame.
+static int								UpdateHeadlessImageRows							(ImageDisplayHeadless_type* imgDisplay, Image_type* image, int firstRow, int nRows, char** errorMsg);
+
+static void								HeadlessROIActions								(ImageDisplayHeadless_type* imgDisplay, char ROIName[], ROIActions action);
+
+	// Makes sure the frame can hold the pixels of an image. If the frame size changes, its pixels are not preserved and the function returns TRUE in sizeChangedPtr.
+static int								ResizeHeadlessFrame								(HeadlessFrame_type* frame, Image_type* image, BOOL* sizeChangedPtr, char** errorMsg);
+
+	// Converts rows of an image into a frame. If findRange is TRUE, the pixel value range of grayscale frames is set to the range of these rows. If stats is not NULL, the
+	// statistics of grayscale rows are filled in within the same passes over the pixels, in which case findRange must be TRUE.
+static int								ConvertToHeadlessFrame							(HeadlessFrame_type* frame, Image_type* image, int firstRow, int nRows, BOOL findRange, ImageStats_type* stats, char** errorMsg);
+
+	// Writes a frame to a file in the given format.
+static int								WriteHeadlessFrame								(HeadlessFrame_type* frame, char fileName[], HeadlessFrameFormats format, char** errorMsg);
+
+	// Writes a frame to a binary PGM or PPM file.
+static int								WriteHeadlessFramePNM							(HeadlessFrame_type* frame, char fileName[], char** errorMsg);
+
+	// Writes a frame to an 8 bit grayscale or RGB PNG file. The pixels are stored in uncompressed deflate blocks, so that no compression library is needed.
+static int								WriteHeadlessFramePNG							(HeadlessFrame_type* frame, char fileName[], char** errorMsg);
+
+	// Writes the length and type of a PNG chunk and starts its CRC.
+static BOOL								BeginPNGChunk									(FILE* file, char type[], size_t length, unsigned long crcTable[], unsigned long* crcPtr);
+
+	// Writes data of a PNG chunk and updates its CRC.
+static BOOL								WritePNGChunkData								(FILE* file, unsigned char data[], size_t nBytes, unsigned long crcTable[], unsigned long* crcPtr);
+
+	// Writes the CRC that ends a PNG chunk.
+static BOOL								EndPNGChunk										(FILE* file, unsigned long crc);
+
+static void								InitCRC32Table									(unsigned long crcTable[]);
+
+static unsigned long					Adler32											(unsigned char data[], size_t nBytes);
+
+static void								PutUInt32BE										(unsigned char bytes[], unsigned long value);
+
+static BOOL								HasPNGExtension									(char fileName[]);
+
+static void								discard_HeadlessFrame_type						(HeadlessFrame_type* frame);
+
+//==============================================================================
+// Global variables
+
+//==============================================================================
+// Global functions
+
+ImageDisplayHeadless_type* init_ImageDisplayHeadless_type (void* imageDisplayOwner, CallbackGroup_type** callbackGroupPtr)
+{
+INIT_ERR
+	
+	ImageDisplayHeadless_type*	imgDisplay 	= malloc(sizeof(ImageDisplayHeadless_type));
+	if (!imgDisplay) return NULL;
+	
+	//------------------------------------------------------------------------------------
+	// INIT
+	//------------------------------------------------------------------------------------
+	
+	// Child class
+	//----------------------------
+	
+	memset(&imgDisplay->frame, 0, sizeof(HeadlessFrame_type));
+	memset(&imgDisplay->renderFrame, 0, sizeof(HeadlessFrame_type));
+	imgDisplay->renderedImage			= NULL;
+	imgDisplay->renderTime				= 0;
+	imgDisplay->dumpFolderPath			= NULL;
+	imgDisplay->dumpFilePrefix			= NULL;
+	imgDisplay->dumpFormat				= HeadlessFrame_PNM;
+	imgDisplay->timingLock				= 0;
+	
+	// Base class
+	//----------------------------
+	
+	errChk( init_ImageDisplay_type(	&imgDisplay->baseClass,
+									imageDisplayOwner,
+									NULL,
+									(DiscardFptr_type) discard_ImageDisplayHeadless_type,
+									(DisplayImageFptr_type) DisplayHeadlessImage,
+									(ROIActionsFptr_type) HeadlessROIActions,
+									callbackGroupPtr) );
+	
+	SetImageDisplayRenderer(&imgDisplay->baseClass, (RenderImageFptr_type) RenderHeadlessImage, (BlitImageFptr_type) BlitHeadlessImage);
+	SetImageDisplayRowUpdater(&imgDisplay->baseClass, (UpdateImageRowsFptr_type) UpdateHeadlessImageRows);
+	
+	// frames are shown as fast as they are rendered
+	SetImageDisplayMaxFrameRate(&imgDisplay->baseClass, 0);
+	
+	//------------------------------------------------------------------------------------
+	// ALLOC
+	//------------------------------------------------------------------------------------
+	
+	errChk( NewHeadlessLock(&imgDisplay->timingLock) );
+	ResetImageDisplayHeadlessTiming(imgDisplay);
+	
+	return imgDisplay;
+	
+Error:
+	
+	discard_ImageDisplayHeadless_type(&imgDisplay);
+	return NULL;
+}
+
+void discard_ImageDisplayHeadless_type (ImageDisplayHeadless_type** imageDisplayPtr)
+{
+	ImageDisplayHeadless_type*	imgDisplay = *imageDisplayPtr;
+	
+	if (!imgDisplay) return;
+	
+	// wait for an image being rendered
+	StopImageDisplayUpdates(&imgDisplay->baseClass);
+	
+	//---------------------------------------------------
+	// discard child class data
+	
+	discard_HeadlessFrame_type(&imgDisplay->frame);
+	discard_HeadlessFrame_type(&imgDisplay->renderFrame);
+	discard_Image_type(&imgDisplay->renderedImage);
+	OKfree(imgDisplay->dumpFolderPath);
+	OKfree(imgDisplay->dumpFilePrefix);
+	
+	if (imgDisplay->timingLock) {
+		DiscardHeadlessLock(imgDisplay->timingLock);
+		imgDisplay->timingLock = 0;
+	}
+	
+	//---------------------------------------------------
+	// discard parent class
+	discard_ImageDisplay_type((ImageDisplay_type**) imageDisplayPtr);
+}
+
+int SetImageDisplayHeadlessDump (ImageDisplayHeadless_type* imgDisplay, char folderPath[], char filePrefix[], HeadlessFrameFormats format, char** errorMsg)
+{
+INIT_ERR
+	
+	OKfree(imgDisplay->dumpFolderPath);
+	OKfree(imgDisplay->dumpFilePrefix);
+	
+	if (!folderPath || !folderPath[0]) return 0;
+	
+	nullChk( imgDisplay->dumpFolderPath = HeadlessStrDup(folderPath) );
+	nullChk( imgDisplay->dumpFilePrefix = HeadlessStrDup((filePrefix) ? filePrefix : "") );
+	imgDisplay->dumpFormat = format;
+	
+	return 0;
+	
+Error:
+	
+	OKfree(imgDisplay->dumpFolderPath);
+	OKfree(imgDisplay->dumpFilePrefix);
+	
+RETURN_ERR
+}
+
+int SaveImageDisplayHeadlessFrame (ImageDisplayHeadless_type* imgDisplay, char fileName[], char** errorMsg)
+{
+#define SaveImageDisplayHeadlessFrame_Err_NoFrame	-1
+INIT_ERR
+	
+	if (!imgDisplay->frame.pixels)
+		SET_ERR(SaveImageDisplayHeadlessFrame_Err_NoFrame, "There is no frame to save.");
+	
+	errChk( WriteHeadlessFrame(&imgDisplay->frame, fileName, HasPNGExtension(fileName) ? HeadlessFrame_PNG : HeadlessFrame_PNM, &errorInfo.errMsg) );
+	
+Error:
+	
+RETURN_ERR
+}
+
+unsigned char* GetImageDisplayHeadlessFrame (ImageDisplayHeadless_type* imgDisplay, int* widthPtr, int* heightPtr, int* nChannelsPtr)
+{
+	if (widthPtr) *widthPtr = imgDisplay->frame.width;
+	if (heightPtr) *heightPtr = imgDisplay->frame.height;
+	if (nChannelsPtr) *nChannelsPtr = imgDisplay->frame.nChannels;
+	
+	return imgDisplay->frame.pixels;
+}
+
+void GetImageDisplayHeadlessTiming (ImageDisplayHeadless_type* imgDisplay, HeadlessDisplayTiming_type* timing)
+{
+	size_t		nOlder		= 0;
+	
+	GetHeadlessLock(imgDisplay->timingLock);
+	
+	*timing = imgDisplay->timing;
+	
+	// order the recorded times from oldest to newest
+	if (imgDisplay->timing.nTimedFrames == HeadlessDisplay_NTimedFrames && imgDisplay->timingIdx) {
+		nOlder = HeadlessDisplay_NTimedFrames - imgDisplay->timingIdx;
+		memcpy(timing->renderTimes, imgDisplay->timing.renderTimes + imgDisplay->timingIdx, nOlder * sizeof(double));
+		memcpy(timing->renderTimes + nOlder, imgDisplay->timing.renderTimes, imgDisplay->timingIdx * sizeof(double));
+		memcpy(timing->blitTimes, imgDisplay->timing.blitTimes + imgDisplay->timingIdx, nOlder * sizeof(double));
+		memcpy(timing->blitTimes + nOlder, imgDisplay->timing.blitTimes, imgDisplay->timingIdx * sizeof(double));
+	}
+	
+	ReleaseHeadlessLock(imgDisplay->timingLock);
+}
+
+void ResetImageDisplayHeadlessTiming (ImageDisplayHeadless_type* imgDisplay)
+{
+	GetHeadlessLock(imgDisplay->timingLock);
+	
+	memset(&imgDisplay->timing, 0, sizeof(HeadlessDisplayTiming_type));
+	imgDisplay->timingIdx		= 0;
+	imgDisplay->totalRenderTime	= 0;
+	imgDisplay->totalBlitTime	= 0;
+	
+	ReleaseHeadlessLock(imgDisplay->timingLock);
+}
+
+static int DisplayHeadlessImage (ImageDisplayHeadless_type* imgDisplay, Image_type** imagePtr, char** errorMsg)
+{
+INIT_ERR
+	
+	errChk( RenderHeadlessImage(imgDisplay, imagePtr, &errorInfo.errMsg) );
+	errChk( BlitHeadlessImage(imgDisplay, &errorInfo.errMsg) );
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int RenderHeadlessImage (ImageDisplayHeadless_type* imgDisplay, Image_type** imagePtr, char** errorMsg)
+{
+INIT_ERR
+	
+	double				startTime		= HeadlessTimer();
+	int					imgHeight		= 0;
+	int					imgWidth		= 0;
+	ImageStats_type*	stats			= NULL;
+	
+	// keep new image until it is shown
+	discard_Image_type(&imgDisplay->renderedImage);
+	imgDisplay->renderedImage = *imagePtr;
+	*imagePtr = NULL;
+	
+	GetImageSize(imgDisplay->renderedImage, &imgWidth, &imgHeight);
+	
+	errChk( ResizeHeadlessFrame(&imgDisplay->renderFrame, imgDisplay->renderedImage, NULL, &errorInfo.errMsg) );
+	
+	// the statistics are filled in while converting the image
+	stats = BeginImageDisplayStats(&imgDisplay->baseClass, GetImageType(imgDisplay->renderedImage));
+	errChk( ConvertToHeadlessFrame(&imgDisplay->renderFrame, imgDisplay->renderedImage, 0, imgHeight, TRUE, stats, &errorInfo.errMsg) );
+	if (stats)
+		EndImageDisplayStats(&imgDisplay->baseClass);
+	
+	imgDisplay->renderTime = (HeadlessTimer() - startTime) * 1e3;
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int BlitHeadlessImage (ImageDisplayHeadless_type* imgDisplay, char** errorMsg)
+{
+INIT_ERR
+	
+	double					startTime					= HeadlessTimer();
+	double					blitTime					= 0;
+	HeadlessFrame_type		frame						= imgDisplay->frame;
+	char					fileName[HeadlessMaxPathLen]	= "";
+	char					pathName[HeadlessMaxPathLen]	= "";
+	
+	if (!imgDisplay->renderedImage) return 0; // nothing rendered
+	
+	// discard current image and assign rendered image
+	discard_Image_type(&imgDisplay->baseClass.image);
+	imgDisplay->baseClass.image = imgDisplay->renderedImage;
+	imgDisplay->renderedImage = NULL;
+	
+	// swap shown and rendered frames
+	imgDisplay->frame		= imgDisplay->renderFrame;
+	imgDisplay->renderFrame	= frame;
+	
+	// write frame to file
+	if (imgDisplay->dumpFolderPath) {
+		snprintf(fileName, sizeof(fileName), "%s%06u.%s", imgDisplay->dumpFilePrefix, (unsigned int)imgDisplay->timing.nFrames, 
+				 (imgDisplay->dumpFormat == HeadlessFrame_PNG) ? "png" : ((imgDisplay->frame.nChannels == 1) ? "pgm" : "ppm"));
+		MakeHeadlessPathname(imgDisplay->dumpFolderPath, fileName, pathName);
+		errChk( WriteHeadlessFrame(&imgDisplay->frame, pathName, imgDisplay->dumpFormat, &errorInfo.errMsg) );
+	}
+	
+Error:
+	
+	blitTime = (HeadlessTimer() - startTime) * 1e3;
+	
+	// record frame timing
+	GetHeadlessLock(imgDisplay->timingLock);
+	
+	imgDisplay->timing.nFrames++;
+	imgDisplay->timing.lastRenderTime	= imgDisplay->renderTime;
+	if (imgDisplay->timing.nFrames == 1 || imgDisplay->renderTime < imgDisplay->timing.minRenderTime)
+		imgDisplay->timing.minRenderTime = imgDisplay->renderTime;
+	if (imgDisplay->renderTime > imgDisplay->timing.maxRenderTime)
+		imgDisplay->timing.maxRenderTime = imgDisplay->renderTime;
+	imgDisplay->totalRenderTime			+= imgDisplay->renderTime;
+	imgDisplay->totalBlitTime			+= blitTime;
+	imgDisplay->timing.meanRenderTime	= imgDisplay->totalRenderTime / imgDisplay->timing.nFrames;
+	imgDisplay->timing.meanBlitTime		= imgDisplay->totalBlitTime / imgDisplay->timing.nFrames;
+	
+	imgDisplay->timing.renderTimes[imgDisplay->timingIdx]	= imgDisplay->renderTime;
+	imgDisplay->timing.blitTimes[imgDisplay->timingIdx]		= blitTime;
+	imgDisplay->timingIdx = (imgDisplay->timingIdx + 1) % HeadlessDisplay_NTimedFrames;
+	if (imgDisplay->timing.nTimedFrames < HeadlessDisplay_NTimedFrames)
+		imgDisplay->timing.nTimedFrames++;
+	
+	ReleaseHeadlessLock(imgDisplay->timingLock);
+	
+RETURN_ERR
+}
+
+static int UpdateHeadlessImageRows (ImageDisplayHeadless_type* imgDisplay, Image_type* image, int firstRow, int nRows, char** errorMsg)
+{
+INIT_ERR
+	
+	BOOL	sizeChanged		= FALSE;
+	
+	errChk( ResizeHeadlessFrame(&imgDisplay->frame, image, &sizeChanged, &errorInfo.errMsg) );
+	
+	// without a complete frame of this size, the pixel value range is taken from the first received rows
+	errChk( ConvertToHeadlessFrame(&imgDisplay->frame, image, firstRow, nRows, sizeChanged, NULL, &errorInfo.errMsg) );
+	
+	GetHeadlessLock(imgDisplay->timingLock);
+	imgDisplay->timing.nRowUpdates++;
+	ReleaseHeadlessLock(imgDisplay->timingLock);
+	
+Error:
+	
+RETURN_ERR
+}
+
+static void HeadlessROIActions (ImageDisplayHeadless_type* imgDisplay, char ROIName[], ROIActions action)
+{
+	ROI_type**		ROIPtr 		= NULL;
+	ROI_type*		ROI			= NULL;
+	ListType		ROIlist 	= GetImageROIs(imgDisplay->baseClass.image);
+	size_t			nROIs		= ListNumItems(ROIlist);
+	size_t			i			= 1;
+	
+	// ROIs are not drawn, only their state is kept with the image
+	while (i <= nROIs) {
+	
+		ROIPtr = ListGetPtrToItem(ROIlist, i);
+		ROI = *ROIPtr;
+	
+		if (ROIName && strcmp(ROIName, ROI->ROIName)) {
+			i++;
+			continue;
+		}
+	
+		switch (action) {
+	
+			case ROI_Show:
+	
+				ROI->active = TRUE;
+				i++;
+				break;
+	
+			case ROI_Hide:
+	
+				ROI->active = FALSE;
+				i++;
+				break;
+	
+			case ROI_Delete:
+	
+				(*ROI->discardFptr)((void**)ROIPtr);
+				ListRemoveItem(ROIlist, 0, i);
+				nROIs--;
+				break;
+		}
+	}
+}
+
+static int ResizeHeadlessFrame (HeadlessFrame_type* frame, Image_type* image, BOOL* sizeChangedPtr, char** errorMsg)
+{
+INIT_ERR
+	
+	int					imgWidth		= 0;
+	int					imgHeight		= 0;
+	int					nChannels		= (GetImageType(image) == Image_RGBA) ? 3 : 1;
+	unsigned char*		pixels			= NULL;
+	
+	GetImageSize(image, &imgWidth, &imgHeight);
+	
+	if (sizeChangedPtr) *sizeChangedPtr = FALSE;
+	
+	if (frame->pixels && frame->width == imgWidth && frame->height == imgHeight && frame->nChannels == nChannels) return 0;
+	
+	nullChk( pixels = realloc(frame->pixels, (size_t)imgWidth * imgHeight * nChannels) );
+	
+	frame->pixels		= pixels;
+	frame->width		= imgWidth;
+	frame->height		= imgHeight;
+	frame->nChannels	= nChannels;
+	
+	if (sizeChangedPtr) *sizeChangedPtr = TRUE;
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int ConvertToHeadlessFrame (HeadlessFrame_type* frame, Image_type* image, int firstRow, int nRows, BOOL findRange, ImageStats_type* stats, char** errorMsg)
+{
+#define ConvertToHeadlessFrame_Err_WrongImageType	-1
+INIT_ERR
+	
+	size_t				firstPixel		= (size_t)firstRow * frame->width;
+	size_t				nPixels			= (size_t)nRows * frame->width;
+	void*				pixArray		= GetImagePixelArray(image);
+	unsigned char*		dst				= frame->pixels + firstPixel * frame->nChannels;
+	double				scale			= 0;
+	double				binScale		= 0;
+	
+	if (!nPixels) return 0;
+	
+	// RGB frames
+	if (GetImageType(image) == Image_RGBA) {
+		RGBA_type*	pix = (RGBA_type*)pixArray + firstPixel;
+	
+		for (size_t i = 0; i < nPixels; i++) {
+			dst[3*i]	= pix[i].R;
+			dst[3*i+1]	= pix[i].G;
+			dst[3*i+2]	= pix[i].B;
+		}
+	
+		return 0;
+	}
+	
+	// grayscale frames
+	if (findRange)
+		switch (GetImageType(image)) {
+	
+			case Image_UChar:
+				GetPixelRange(unsigned char, (unsigned char*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			case Image_UShort:
+				GetPixelRange(unsigned short, (unsigned short*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			case Image_Short:
+				GetPixelRange(short, (short*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			case Image_UInt:
+				GetPixelRange(unsigned int, (unsigned int*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			case Image_Int:
+				GetPixelRange(int, (int*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			case Image_Float:
+				GetPixelRange(float, (float*)pixArray + firstPixel, nPixels, frame->minVal, frame->maxVal, stats);
+				break;
+	
+			default:
+				SET_ERR(ConvertToHeadlessFrame_Err_WrongImageType, "Image type not supported by the headless display.");
+		}
+	
+	scale = (frame->maxVal > frame->minVal) ? 255.0 / (frame->maxVal - frame->minVal) : 0;
+	if (stats)
+		binScale = SetImageStatsRange(stats, frame->minVal, frame->maxVal);
+	
+	switch (GetImageType(image)) {
+	
+		case Image_UChar:
+			NormalizePixels(unsigned char, (unsigned char*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		case Image_UShort:
+			NormalizePixels(unsigned short, (unsigned short*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		case Image_Short:
+			NormalizePixels(short, (short*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		case Image_UInt:
+			NormalizePixels(unsigned int, (unsigned int*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		case Image_Int:
+			NormalizePixels(int, (int*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		case Image_Float:
+			NormalizePixels(float, (float*)pixArray + firstPixel, nPixels, frame->minVal, scale, dst, stats, binScale);
+			break;
+	
+		default:
+			SET_ERR(ConvertToHeadlessFrame_Err_WrongImageType, "Image type not supported by the headless display.");
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int WriteHeadlessFrame (HeadlessFrame_type* frame, char fileName[], HeadlessFrameFormats format, char** errorMsg)
+{
+INIT_ERR
+	
+	switch (format) {
+			
+		case HeadlessFrame_PNM:
+			errChk( WriteHeadlessFramePNM(frame, fileName, &errorInfo.errMsg) );
+			break;
+			
+		case HeadlessFrame_PNG:
+			errChk( WriteHeadlessFramePNG(frame, fileName, &errorInfo.errMsg) );
+			break;
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int WriteHeadlessFramePNM (HeadlessFrame_type* frame, char fileName[], char** errorMsg)
+{
+#define WriteHeadlessFramePNM_Err_OpenFile		-1
+#define WriteHeadlessFramePNM_Err_WriteFile	-2
+INIT_ERR
+	
+	FILE*		file		= NULL;
+	size_t		nBytes		= (size_t)frame->width * frame->height * frame->nChannels;
+	
+	if (!(file = fopen(fileName, "wb")))
+		SET_ERR(WriteHeadlessFramePNM_Err_OpenFile, "Could not open frame file for writing.");
+	
+	// binary PGM (P5) or PPM (P6) header followed by the pixels
+	if (fprintf(file, "%s\n%d %d\n255\n", (frame->nChannels == 1) ? "P5" : "P6", frame->width, frame->height) < 0 || fwrite(frame->pixels, 1, nBytes, file) != nBytes)
+		SET_ERR(WriteHeadlessFramePNM_Err_WriteFile, "Could not write frame file.");
+	
+Error:
+	
+	if (file) fclose(file);
+	
+RETURN_ERR
+}
+
+static int WriteHeadlessFramePNG (HeadlessFrame_type* frame, char fileName[], char** errorMsg)
+{
+#define WriteHeadlessFramePNG_Err_OpenFile		-1
+#define WriteHeadlessFramePNG_Err_WriteFile		-2
+INIT_ERR
+	
+	static unsigned char	signature[]			= {137, 80, 78, 71, 13, 10, 26, 10};
+	static unsigned char	zlibHeader[]		= {0x78, 0x01};
+	FILE*					file				= NULL;
+	unsigned char*			rawData				= NULL;
+	size_t					rowBytes			= (size_t)frame->width * frame->nChannels;
+	size_t					nRawBytes			= (rowBytes + 1) * frame->height;
+	size_t					nBlocks				= (nRawBytes) ? (nRawBytes + PNG_MaxStoredBlock - 1) / PNG_MaxStoredBlock : 1;
+	size_t					blockSize			= 0;
+	unsigned long			crcTable[256];
+	unsigned long			crc					= 0;
+	unsigned char			header[13];
+	unsigned char			blockHeader[5];
+	unsigned char			checksum[4];
+	
+	// scanlines, each starting with filter type 0 for unfiltered pixels
+	nullChk( rawData = malloc((nRawBytes) ? nRawBytes : 1) );
+	for (int row = 0; row < frame->height; row++) {
+		rawData[row * (rowBytes + 1)] = 0;
+		memcpy(rawData + row * (rowBytes + 1) + 1, frame->pixels + row * rowBytes, rowBytes);
+	}
+	
+	InitCRC32Table(crcTable);
+	PutUInt32BE(checksum, Adler32(rawData, nRawBytes));
+	
+	// image header with bit depth 8, grayscale (0) or RGB (2) color type, deflate compression, adaptive filtering and no interlacing
+	PutUInt32BE(header, frame->width);
+	PutUInt32BE(header + 4, frame->height);
+	header[8]	= 8;
+	header[9]	= (frame->nChannels == 1) ? 0 : 2;
+	header[10]	= 0;
+	header[11]	= 0;
+	header[12]	= 0;
+	
+	if (!(file = fopen(fileName, "wb")))
+		SET_ERR(WriteHeadlessFramePNG_Err_OpenFile, "Could not open frame file for writing.");
+	
+	if (fwrite(signature, 1, sizeof(signature), file) != sizeof(signature) ||
+		!BeginPNGChunk(file, "IHDR", sizeof(header), crcTable, &crc) || !WritePNGChunkData(file, header, sizeof(header), crcTable, &crc) || !EndPNGChunk(file, crc))
+		SET_ERR(WriteHeadlessFramePNG_Err_WriteFile, "Could not write frame file.");
+	
+	// image data as a zlib stream of uncompressed deflate blocks
+	if (!BeginPNGChunk(file, "IDAT", sizeof(zlibHeader) + nBlocks * sizeof(blockHeader) + nRawBytes + sizeof(checksum), crcTable, &crc) || 
+		!WritePNGChunkData(file, zlibHeader, sizeof(zlibHeader), crcTable, &crc))
+		SET_ERR(WriteHeadlessFramePNG_Err_WriteFile, "Could not write frame file.");
+	
+	for (size_t i = 0; i < nBlocks; i++) {
+		blockSize		= (nRawBytes - i * PNG_MaxStoredBlock < PNG_MaxStoredBlock) ? nRawBytes - i * PNG_MaxStoredBlock : PNG_MaxStoredBlock;
+		blockHeader[0]	= (i == nBlocks - 1);		// final block flag and stored block type
+		blockHeader[1]	= blockSize & 0xFF;
+		blockHeader[2]	= (blockSize >> 8) & 0xFF;
+		blockHeader[3]	= ~blockSize & 0xFF;
+		blockHeader[4]	= (~blockSize >> 8) & 0xFF;
+		
+		if (!WritePNGChunkData(file, blockHeader, sizeof(blockHeader), crcTable, &crc) || !WritePNGChunkData(file, rawData + i * PNG_MaxStoredBlock, blockSize, crcTable, &crc))
+			SET_ERR(WriteHeadlessFramePNG_Err_WriteFile, "Could not write frame file.");
+	}
+	
+	if (!WritePNGChunkData(file, checksum, sizeof(checksum), crcTable, &crc) || !EndPNGChunk(file, crc) ||
+		!BeginPNGChunk(file, "IEND", 0, crcTable, &crc) || !EndPNGChunk(file, crc))
+		SET_ERR(WriteHeadlessFramePNG_Err_WriteFile, "Could not write frame file.");
+	
+Error:
+	
+	if (file) fclose(file);
+	OKfree(rawData);
+	
+RETURN_ERR
+}
+
+static BOOL BeginPNGChunk (FILE* file, char type[], size_t length, unsigned long crcTable[], unsigned long* crcPtr)
+{
+	unsigned char	lengthBytes[4];
+	
+	PutUInt32BE(lengthBytes, (unsigned long)length);
+	if (fwrite(lengthBytes, 1, 4, file) != 4) return FALSE;
+	
+	// the CRC covers the chunk type and data
+	*crcPtr = 0xFFFFFFFFUL;
+	
+	return WritePNGChunkData(file, (unsigned char*)type, 4, crcTable, crcPtr);
+}
+
+static BOOL WritePNGChunkData (FILE* file, unsigned char data[], size_t nBytes, unsigned long crcTable[], unsigned long* crcPtr)
+{
+	unsigned long	crc		= *crcPtr;
+	
+	for (size_t i = 0; i < nBytes; i++)
+		crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	
+	*crcPtr = crc;
+	
+	return fwrite(data, 1, nBytes, file) == nBytes;
+}
+
+static BOOL EndPNGChunk (FILE* file, unsigned long crc)
+{
+	unsigned char	crcBytes[4];
+	
+	PutUInt32BE(crcBytes, crc ^ 0xFFFFFFFFUL);
+	
+	return fwrite(crcBytes, 1, 4, file) == 4;
+}
+
+static void InitCRC32Table (unsigned long crcTable[])
+{
+	unsigned long	value	= 0;
+	
+	for (unsigned long i = 0; i < 256; i++) {
+		value = i;
+		for (int bit = 0; bit < 8; bit++)
+			value = (value & 1) ? 0xEDB88320UL ^ (value >> 1) : value >> 1;
+		crcTable[i] = value;
+	}
+}
+
+static unsigned long Adler32 (unsigned char data[], size_t nBytes)
+{
+	unsigned long	sum1	= 1;
+	unsigned long	sum2	= 0;
+	size_t			nSums	= 0;
+	
+	// the sums are reduced only every Adler32_MaxSums bytes, before they could overflow
+	while (nBytes) {
+		nSums	= (nBytes < Adler32_MaxSums) ? nBytes : Adler32_MaxSums;
+		nBytes	-= nSums;
+		for (size_t i = 0; i < nSums; i++) {
+			sum1 += *data++;
+			sum2 += sum1;
+		}
+		sum1 %= Adler32_Modulus;
+		sum2 %= Adler32_Modulus;
+	}
+	
+	return (sum2 << 16) | sum1;
+}
+
+static void PutUInt32BE (unsigned char bytes[], unsigned long value)
+{
+	bytes[0] = (value >> 24) & 0xFF;
+	bytes[1] = (value >> 16) & 0xFF;
+	bytes[2] = (value >> 8) & 0xFF;
+	bytes[3] = value & 0xFF;
+}
+
+static BOOL HasPNGExtension (char fileName[])
+{
+	size_t	length	= strlen(fileName);
+	
+	return length >= 4 && (!strcmp(fileName + length - 4, ".png") || !strcmp(fileName + length - 4, ".PNG"));
+}
+
+static void discard_HeadlessFrame_type (HeadlessFrame_type* frame)
+{
+	OKfree(frame->pixels);
+	frame->width		= 0;
+	frame->height		= 0;
+	frame->nChannels	= 0;
+}
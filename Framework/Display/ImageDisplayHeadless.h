@@ -0,0 +1,94 @@
+//==============================================================================
+//
+// Title:		ImageDisplayHeadless.h
+// Purpose:		Image display rendering into memory without a user interface.
+//
+// Created on:	18-10-2026 at 18:10:51 by agent.
+// Copyright:	VU University Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+#ifndef __ImageDisplayHeadless_H__
+#define __ImageDisplayHeadless_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//==============================================================================
+// Include files
+
+#include "cvidef.h"
+#include "ImageDisplay.h"
+
+//==============================================================================
+// Constants
+
+#define HeadlessDisplay_NTimedFrames		1024	// Number of most recent frames for which render and blit times are kept.
+
+//==============================================================================
+// Types
+
+typedef struct ImageDisplayHeadless		ImageDisplayHeadless_type;	// Child class of ImageDisplay_type
+
+// File formats of frames written by a headless display.
+typedef enum {
+	HeadlessFrame_PNM,												// Binary PGM for grayscale and PPM for RGB frames.
+	HeadlessFrame_PNG												// PNG with uncompressed pixels, 8 bit grayscale or RGB.
+} HeadlessFrameFormats;
+
+// Render timing of the frames shown by a headless display. Times are in [ms].
+typedef struct {
+	size_t			nFrames;										// Number of frames shown.
+	size_t			nRowUpdates;									// Number of row updates shown for images still being acquired.
+	double			lastRenderTime;									// Time to render the last frame.
+	double			minRenderTime;									// Shortest frame render time.
+	double			maxRenderTime;									// Longest frame render time.
+	double			meanRenderTime;									// Mean frame render time.
+	double			meanBlitTime;									// Mean time to show a rendered frame, including writing it to a file.
+	size_t			nTimedFrames;									// Number of elements in renderTimes and blitTimes, at most HeadlessDisplay_NTimedFrames.
+	double			renderTimes[HeadlessDisplay_NTimedFrames];		// Render times of the most recent frames, from oldest to newest.
+	double			blitTimes[HeadlessDisplay_NTimedFrames];		// Show times of the most recent frames, from oldest to newest.
+} HeadlessDisplayTiming_type;
+
+//==============================================================================
+// External variables
+
+//==============================================================================
+// Global functions
+
+
+// Initializes an image display that renders images into memory without any panels or display windows, e.g. to run acquisitions without a user interface or to measure
+// the performance of the display pipeline. Grayscale images are normalized to their pixel value range and rendered as 8 bit pixels, RGBA images as 24 bit RGB pixels.
+// ROIs are kept with the image but not drawn. The display itself uses no user interface, NI Vision or Windows functions and maps its few runtime calls (locks, timer
+// and paths) either to the CVI runtime or, without it, to C11 and POSIX. The ImageDisplay base class however still relies on the CVI thread pools, deferred calls and
+// Windows interlocked functions, so the display runs wherever the CVI Run-Time Engine runs, e.g. on a Windows server without a desktop session, but not yet on Linux.
+ImageDisplayHeadless_type* 			init_ImageDisplayHeadless_type			(void*						imageDisplayOwner,
+																			 CallbackGroup_type**		callbackGroupPtr);
+
+void								discard_ImageDisplayHeadless_type		(ImageDisplayHeadless_type** imageDisplayPtr);
+
+// Writes each shown frame in the given format to folderPath, named with filePrefix and a 6 digit frame number. If folderPath is NULL or empty, frames are not written.
+int									SetImageDisplayHeadlessDump				(ImageDisplayHeadless_type* imgDisplay, char folderPath[], char filePrefix[], HeadlessFrameFormats format, char** errorMsg);
+
+// Writes the frame shown last to a PNG file if fileName ends with .png, otherwise to a binary PGM or PPM file.
+int									SaveImageDisplayHeadlessFrame			(ImageDisplayHeadless_type* imgDisplay, char fileName[], char** errorMsg);
+
+// Returns a pointer to the pixels of the frame shown last, which remain valid until the next frame is shown on the main thread. If there is no frame, returns NULL.
+// Each pixel has nChannels bytes, 1 for grayscale and 3 for RGB frames.
+unsigned char*						GetImageDisplayHeadlessFrame			(ImageDisplayHeadless_type* imgDisplay, int* widthPtr, int* heightPtr, int* nChannelsPtr);
+
+// Copies the render timing of the frames shown so far.
+void								GetImageDisplayHeadlessTiming			(ImageDisplayHeadless_type* imgDisplay, HeadlessDisplayTiming_type* timing);
+
+// Clears the render timing.
+void								ResetImageDisplayHeadlessTiming			(ImageDisplayHeadless_type* imgDisplay);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __ImageDisplayHeadless_H__ */
@@ -49,7 +49,8 @@ typedef enum {
 	NIDisplayMenu_Image,
 	NIDisplayMenu_Image_Equalize,
 	NIDisplayMenu_Image_Equalize_Linear,
-	NIDisplayMenu_Image_Equalize_Logarithmic,	
+	NIDisplayMenu_Image_Equalize_Logarithmic,
+	NIDisplayMenu_Image_Histogram
 } NIDisplayMenuItems;
 
 typedef enum {
@@ -63,6 +64,8 @@ struct ImageDisplayNIVision {
 	
 	// DATA
 	Image*								NIImage;				// NI Image displayed in the window. Depending on various transformations that can be applied to the original image, this image may be different from the original image kept in the base class.
+	Image*								renderNIImage;			// NI Image rendered on a worker thread which replaces NIImage when shown.
+	Image_type*							renderedImage;			// Image from which renderNIImage was rendered, becomes the base class image when shown.
 	int									imaqWndID;				// Assigned IMAQ window ID for display.
 	HWND								imaqWndWindowsHndl;		// Windows window handle assigned to display the IMAQ image.
 	
@@ -110,7 +113,14 @@ static int								AdjustNIVisionImageDisplay						(ImageDisplayNIVision_type* im
 
 static int								DisplayNIVisionImage							(ImageDisplayNIVision_type* imgDisplay, Image_type** newImagePtr, char** errorMsg);
 
-static int								DisplayNIVisionRGBImage							(ImageDisplayNIVision_type* imgDisplay, Image_type** imageR, Image_type** imageG, Image_type** imageB);	
+	// Converts the image and draws its ROIs into the NI render image without accessing the display window.
+static int								RenderNIVisionImage								(ImageDisplayNIVision_type* imgDisplay, Image_type** newImagePtr, char** errorMsg);
+
+	// Shows the NI render image in the display window.
+static int								BlitNIVisionImage								(ImageDisplayNIVision_type* imgDisplay, char** errorMsg);
+
+	// Converts only the given rows of an image still being acquired into the displayed NI image and shows it.
+static int								UpdateNIVisionImageRows							(ImageDisplayNIVision_type* imgDisplay, Image_type* image, int firstRow, int nRows, char** errorMsg);
 
 	// displays a file selection popup-box and saves a given NI image as two grayscale TIFF files with ZIP compression with and without ROI flattened
 static int 								ImageSavePopup 									(Image* image, NIDisplayFileSaveFormats fileFormat, char** errorMsg);
@@ -262,6 +272,8 @@ INIT_ERR
 	//----------------------------
 	
 	niImgDisp->NIImage					= NULL;
+	niImgDisp->renderNIImage			= NULL;
+	niImgDisp->renderedImage			= NULL;
 	niImgDisp->imaqWndID				= -1;
 	niImgDisp->imaqWndWindowsHndl		= 0;	
 	niImgDisp->imaqWndProc				= 0;
@@ -277,6 +289,9 @@ INIT_ERR
 									(ROIActionsFptr_type) NIVisionROIActions,
 									callbackGroupPtr) );
 	
+	SetImageDisplayRenderer(&niImgDisp->baseClass, (RenderImageFptr_type) RenderNIVisionImage, (BlitImageFptr_type) BlitNIVisionImage);
+	SetImageDisplayRowUpdater(&niImgDisp->baseClass, (UpdateImageRowsFptr_type) UpdateNIVisionImageRows);
+	
 	
 	//------------------------------------------------------------------------------------
 	// ALLOC
@@ -346,6 +361,8 @@ INIT_ERR
 	// pre allocate image memory
 	nullChk( niImgDisp->NIImage = imaqCreateImage(imaqImgType, 0) );
 	nullChk( imaqSetImageSize(niImgDisp->NIImage, imgWidth, imgHeight) );
+	nullChk( niImgDisp->renderNIImage = imaqCreateImage(imaqImgType, 0) );
+	nullChk( imaqSetImageSize(niImgDisp->renderNIImage, imgWidth, imgHeight) );
 	
 	//--------------------------------------------------------------------------------------------------------
 	// Create menu bar and add menu items
@@ -383,6 +400,9 @@ INIT_ERR
 	// add menu item "Equalize" to Menu->Image
 	AppendMenu(imageMenuHndl, MF_STRING | MF_POPUP, (UINT_PTR)equalizeMenuHndl, "&Equalize");
 	
+	// add menu item "Histogram" to Menu->Image
+	AppendMenu(imageMenuHndl, MF_STRING, NIDisplayMenu_Image_Histogram, "&Histogram");
+	
 	
 	// add custom window callback function
 	
@@ -405,6 +425,9 @@ static void discard_ImageDisplayNIVision_type (ImageDisplayNIVision_type** displ
 	
 	if (!display) return;
 	
+	// wait for an image being rendered
+	StopImageDisplayUpdates(&display->baseClass);
+	
 	//---------------------------------------------------
 	// discard child class data
 	
@@ -413,6 +436,8 @@ static void discard_ImageDisplayNIVision_type (ImageDisplayNIVision_type** displ
 	
 	// discard NI image
 	DiscardImaqImg((Image**)&display->NIImage);
+	DiscardImaqImg((Image**)&display->renderNIImage);
+	discard_Image_type(&display->renderedImage);
 
 	//---------------------------------------------------
 	// discard parent class
@@ -423,22 +448,71 @@ static int DisplayNIVisionImage (ImageDisplayNIVision_type* imgDisplay, Image_ty
 {								
 INIT_ERR
 
-	// bind image display data to window ID
-	NIDisplays[imgDisplay->imaqWndID] = imgDisplay;
+	errChk( RenderNIVisionImage(imgDisplay, newImagePtr, &errorInfo.errMsg) );
+	errChk( BlitNIVisionImage(imgDisplay, &errorInfo.errMsg) );
+	
+Error:
 	
+RETURN_ERR
+}
+
+static int RenderNIVisionImage (ImageDisplayNIVision_type* imgDisplay, Image_type** newImagePtr, char** errorMsg)
+{
+INIT_ERR
+
 	// apply current image transform if there was any to the new image
 	if (imgDisplay->baseClass.image)
 		SetImageDisplayTransform(*newImagePtr, GetImageDisplayTransform(imgDisplay->baseClass.image));
 	
-	// discard current image and assign new image
-	discard_Image_type(&imgDisplay->baseClass.image);
-	imgDisplay->baseClass.image = *newImagePtr;
+	// keep new image until it is shown
+	discard_Image_type(&imgDisplay->renderedImage);
+	imgDisplay->renderedImage = *newImagePtr;
 	*newImagePtr = NULL;
 	
-	errChk( ConvertImageTypeToNIImage(imgDisplay->NIImage, imgDisplay->baseClass.image, &errorInfo.errMsg) );
+	errChk( ConvertImageTypeToNIImage(imgDisplay->renderNIImage, imgDisplay->renderedImage, &errorInfo.errMsg) );
+	
+	// NI Vision converts the pixels itself, so the statistics take their own pass over the pixels, two passes for 32-bit images
+	ComputeImageDisplayStats(&imgDisplay->baseClass, imgDisplay->renderedImage);
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int BlitNIVisionImage (ImageDisplayNIVision_type* imgDisplay, char** errorMsg)
+{
+INIT_ERR
+
+	Image*		NIImage		= NULL;
+	
+	if (!imgDisplay->renderedImage) return 0; // nothing rendered
+	
+	// bind image display data to window ID
+	NIDisplays[imgDisplay->imaqWndID] = imgDisplay;
+	
+	// discard current image and assign rendered image
+	discard_Image_type(&imgDisplay->baseClass.image);
+	imgDisplay->baseClass.image = imgDisplay->renderedImage;
+	imgDisplay->renderedImage = NULL;
+	
+	// swap displayed and rendered NI images
+	NIImage						= imgDisplay->NIImage;
+	imgDisplay->NIImage			= imgDisplay->renderNIImage;
+	imgDisplay->renderNIImage	= NIImage;
 	
 	// display NI image
 	nullChk( imaqDisplayImage(imgDisplay->NIImage, imgDisplay->imaqWndID, FALSE) );
+	
+	// report displayed frames if the image was received through display updates
+	size_t	nReceived		= 0;
+	size_t	nDisplayed		= 0;
+	char	wndTitle[64]	= "";
+	
+	GetImageDisplayFrameCounts(&imgDisplay->baseClass, &nReceived, &nDisplayed);
+	if (nReceived) {
+		Fmt(wndTitle, "Displayed %d of %d frames", (int)nDisplayed, (int)nReceived);
+		imaqSetWindowTitle(imgDisplay->imaqWndID, wndTitle);
+	}
 			 
 	// display IMAQ tool window
 	int		isToolWindowVisible = 0;
@@ -455,9 +529,62 @@ Error:
 RETURN_ERR
 }
 
-static int DisplayNIVisionRGBImage (ImageDisplayNIVision_type* imgDisplay, Image_type** imageR, Image_type** imageG, Image_type** imageB)
+static int UpdateNIVisionImageRows (ImageDisplayNIVision_type* imgDisplay, Image_type* image, int firstRow, int nRows, char** errorMsg)
 {
-	return 0;
+INIT_ERR
+
+	ImageInfo	NIImageInfo		= {0};
+	int			imgWidth		= 0;
+	int			imgHeight		= 0;
+	int			NIImgWidth		= 0;
+	int			NIImgHeight		= 0;
+	void*		pixelArray		= GetImagePixelArray(image);
+	ImageTypes	imageType		= GetImageType(image);
+	size_t		pixelSize		= GetImageSizeofData(image);
+	size_t		NIPixelSize		= (imageType == Image_UInt || imageType == Image_Int) ? sizeof(float) : pixelSize;  // no 32 bit integer support in IMAQ, these are displayed as float
+	char*		srcRow			= NULL;
+	char*		dstRow			= NULL;
+	
+	if (!imgDisplay->NIImage) return 0;
+	
+	GetImageSize(image, &imgWidth, &imgHeight);
+	nullChk( imaqGetImageSize(imgDisplay->NIImage, &NIImgWidth, &NIImgHeight) );
+	if (NIImgWidth != imgWidth || NIImgHeight != imgHeight) {
+		nullChk( imaqSetImageSize(imgDisplay->NIImage, imgWidth, imgHeight) );
+	}
+	
+	// copy rows directly into the NI image pixels, which are stored with a line stride of pixelsPerLine
+	nullChk( imaqGetImageInfo(imgDisplay->NIImage, &NIImageInfo) );
+	
+	for (int row = firstRow; row < firstRow + nRows; row++) {
+		srcRow = (char*)pixelArray + (size_t)row * imgWidth * pixelSize;
+		dstRow = (char*)NIImageInfo.imageStart + (size_t)row * NIImageInfo.pixelsPerLine * NIPixelSize;
+		
+		switch (imageType) {
+				
+			case Image_UInt:
+				for (int col = 0; col < imgWidth; col++)
+					((float*)dstRow)[col] = (float) ((unsigned int*)srcRow)[col];
+				break;
+				
+			case Image_Int:
+				for (int col = 0; col < imgWidth; col++)
+					((float*)dstRow)[col] = (float) ((int*)srcRow)[col];
+				break;
+				
+			default:
+				memcpy(dstRow, srcRow, imgWidth * pixelSize);
+				break;
+		}
+	}
+	
+	// ROIs are kept as overlays of the NI image and need not be drawn again
+	NIDisplays[imgDisplay->imaqWndID] = imgDisplay;
+	nullChk( imaqDisplayImage(imgDisplay->NIImage, imgDisplay->imaqWndID, FALSE) );
+	
+Error:
+	
+RETURN_ERR
 }
 
 static int DrawROI (Image* image, ROI_type* ROI)
@@ -791,6 +918,11 @@ INIT_ERR
 					// display image
 					nullChk( imaqDisplayImage(disp->NIImage, disp->imaqWndID, FALSE) );
 					break;
+					
+				case NIDisplayMenu_Image_Histogram:
+					
+					errChk( ShowImageDisplayHistogram(&disp->baseClass, &errorInfo.errMsg) );
+					break;
 			}
 			
 			break;
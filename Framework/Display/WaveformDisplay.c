@@ -27,14 +27,47 @@
 
 #define WaveformDisplay_UI 	"./Framework/Display/UI_WaveformDisplay.uir"
 
+#define DecimationFactor		4		// Number of samples or blocks of a decimation level that are combined into one block of the next level.
+#define MaxDecimationLevels		16		// Maximum number of min/max decimation levels of a plotted waveform.
+
+//==============================================================================
+// Macros
+
+// Computes the minimum and maximum of consecutive blocks of DecimationFactor samples of a given type, storing them as pairs in minMax.
+#define DecimateSamples(type, samples, nSamples, minMax) \
+	for (size_t block = 0, idx = 0; idx < (nSamples); block++) { \
+		size_t	lastIdx = (idx + DecimationFactor < (nSamples)) ? idx + DecimationFactor : (nSamples); \
+		double	minVal 	= (double) ((type*)(samples))[idx]; \
+		double	maxVal 	= minVal; \
+		for (idx++; idx < lastIdx; idx++) { \
+			if ((double) ((type*)(samples))[idx] < minVal) minVal = (double) ((type*)(samples))[idx]; \
+			if ((double) ((type*)(samples))[idx] > maxVal) maxVal = (double) ((type*)(samples))[idx]; \
+		} \
+		(minMax)[2 * block] 	= minVal; \
+		(minMax)[2 * block + 1] = maxVal; \
+	}
+
 //==============================================================================
 // Types
 
+typedef struct {
+	double*					minMax;				// Minimum and maximum value pairs of each block of samples.
+	size_t					nBlocks;			// Number of blocks.
+	size_t					blockSize;			// Number of waveform samples in a block.
+} DecimationLevel_type;
+
 struct WaveformDisplay {
 	
 	// DATA
 	ListType				waveforms;			// List of Waveform_type* elements. Data in this waveform is used to update the plot whenever needed. Note: do not modify this data directly!
 	BOOL					update;				// If True, the plot will display each time the latest waveform added to it. If False, the user can use the scrollbar to return to a previous plot. Default: True.
+	size_t					maxWaveforms;		// Maximum number of waveforms kept in the waveforms list, 0 if not limited. When exceeded, the oldest waveforms are discarded.
+	size_t					maxSamples;			// Maximum total number of samples of the waveforms kept in the waveforms list, 0 if not limited. When exceeded, the oldest waveforms are discarded.
+	size_t					nSamples;			// Total number of samples of the waveforms in the waveforms list.
+	Waveform_type*			plotWaveform;		// Waveform currently plotted, NULL if none.
+	Waveform_type*			decimWaveform;		// Waveform for which the decimation levels were built, NULL if none.
+	DecimationLevel_type	decimLevels[MaxDecimationLevels];	// Min/max decimation pyramid of decimWaveform, with each level combining DecimationFactor blocks of the previous level.
+	int						nDecimLevels;		// Number of decimation levels built.
 	
 	// UI
 	int						plotPanHndl;
@@ -63,9 +96,26 @@ static int CVICALLBACK 			TSPanScrollbar_CB 					(int panel, int control, int ev
 // Callback for other TSPan controls
 static int CVICALLBACK 			TSPanCtrls_CB	 					(int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 
-// Adds a waveform to a graph. Multiple waveforms can be added to the same graph by calling this function repeatedly.
-// Do not free or modify the waveforms while the graph is active as the waveform data is used for graph refresh/updating.
-static int						AddWaveformToGraph					(int panel, int control, Waveform_type* waveform); 
+// Plots a waveform from the waveforms list and sets the graph axis labels.
+static int						AddWaveformToGraph					(WaveformDisplay_type* waveDisp, Waveform_type* waveform); 
+
+// Plots the samples of the plotted waveform within the X axis range using at most about twice as many points as the plot area is wide in pixels.
+static int						PlotWaveformRange					(WaveformDisplay_type* waveDisp);
+
+// Plots nSamples samples of a waveform starting from sample index firstSample.
+static int						PlotWaveformSamples					(int panel, int control, Waveform_type* waveform, size_t firstSample, size_t nSamples, double xIncrement);
+
+// Builds the min/max decimation pyramid of a waveform. If this fails, the waveform is plotted without decimation.
+static int						BuildDecimationPyramid				(WaveformDisplay_type* waveDisp, Waveform_type* waveform);
+
+// Discards the oldest waveforms if the memory limits are exceeded.
+static void						LimitWaveformHistory				(WaveformDisplay_type* waveDisp);
+
+// Applies the memory limits and updates the scrollbar and the plot.
+static int						UpdateWaveformHistory				(WaveformDisplay_type* waveDisp);
+
+// Replots the waveform after the graph was zoomed or panned.
+static void CVICALLBACK			RedrawWaveformDisplay_CB			(void* callbackData);
 
 // Updates the value of the cursor
 static void 					UpdateGraphCursors 					(int panel, int control);
@@ -91,6 +141,17 @@ INIT_ERR
 	// DATA
 	waveDisp->waveforms			= 0;
 	waveDisp->update			= TRUE;
+	waveDisp->maxWaveforms		= Default_WaveformDisplay_MaxWaveforms;
+	waveDisp->maxSamples		= Default_WaveformDisplay_MaxSamples;
+	waveDisp->nSamples			= 0;
+	waveDisp->plotWaveform		= NULL;
+	waveDisp->decimWaveform		= NULL;
+	waveDisp->nDecimLevels		= 0;
+	for (int i = 0; i < MaxDecimationLevels; i++) {
+		waveDisp->decimLevels[i].minMax		= NULL;
+		waveDisp->decimLevels[i].nBlocks	= 0;
+		waveDisp->decimLevels[i].blockSize	= 0;
+	}
 	
 	// UI
 	waveDisp->plotPanHndl		= 0;
@@ -117,6 +178,8 @@ INIT_ERR
 	errChk( waveDisp->plotPanHndl = LoadPanel(parentPanHndl, WaveformDisplay_UI, TSPan) );
 	// set panel title
 	errChk( SetPanelAttribute(waveDisp->plotPanHndl, ATTR_TITLE, displayTitle) );
+	// used to find the waveform display from the panel handle
+	errChk( SetPanelAttribute(waveDisp->plotPanHndl, ATTR_CALLBACK_DATA, waveDisp) );
 		
 	// add menu bar
 	errChk( waveDisp->menuBarHndl = NewMenuBar(waveDisp->plotPanHndl) );
@@ -192,6 +255,9 @@ void discard_WaveformDisplay_type (WaveformDisplay_type** waveDispPtr)
 	
 	OKfreeList(&waveDisp->waveforms, (DiscardFptr_type)discard_Waveform_type);
 	
+	for (int i = 0; i < MaxDecimationLevels; i++)
+		OKfree(waveDisp->decimLevels[i].minMax);
+	
 	//--------------
 	// UI
 	//--------------
@@ -222,36 +288,27 @@ ListType GetDisplayWaveformList (WaveformDisplay_type* waveDisp)
 	return waveDisp->waveforms;
 }
 
+int SetWaveformDisplayMemoryLimits (WaveformDisplay_type* waveDisp, size_t maxWaveforms, size_t maxSamples)
+{
+	waveDisp->maxWaveforms 	= maxWaveforms;
+	waveDisp->maxSamples	= maxSamples;
+	
+	return UpdateWaveformHistory(waveDisp);
+}
+
 int DisplayWaveform (WaveformDisplay_type* waveDisp, Waveform_type** waveformPtr)
 {
 INIT_ERR
 
-	size_t			nWaveforms			= 0;	 	// number of waveforms contained by the waveform display
+	size_t			nSamples			= GetWaveformNumSamples(*waveformPtr);
 	
 	// add new waveform to list
 	nullChk( ListInsertItem(waveDisp->waveforms, waveformPtr, END_OF_LIST) );
 	*waveformPtr = NULL;  // take data in
-	nWaveforms = ListNumItems(waveDisp->waveforms);
+	waveDisp->nSamples += nSamples;
 	
-	// update scrollbar min max range
-	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MIN_VALUE, 1);
-	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MAX_VALUE, nWaveforms);
-	// undim scrollbar if there is more than one waveform in the list
-	if (nWaveforms > 1)
-		SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_DIMMED, FALSE);
-	else
-		SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_DIMMED, TRUE);
-		
-	// update plot if needed
-	if (waveDisp->update) {
-		// clear plot
-		errChk( DeleteGraphPlot(waveDisp->plotPanHndl, TSPan_GraphPlot, -1, VAL_IMMEDIATE_DRAW) );
-		// add waveform to plot
-		errChk( AddWaveformToGraph(waveDisp->plotPanHndl, TSPan_GraphPlot, *(Waveform_type**)ListGetPtrToItem(waveDisp->waveforms, nWaveforms)) );
-		// update scrollbar and display
-		SetCtrlVal(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, nWaveforms);
-		SetCtrlVal(waveDisp->plotPanHndl, TSPan_SBIndex, nWaveforms);
-	}
+	// discard oldest waveforms if needed and update plot
+	errChk( UpdateWaveformHistory(waveDisp) );
 	
 	DisplayPanel(waveDisp->plotPanHndl);
 	
@@ -268,6 +325,10 @@ INIT_ERR
 	errChk( DeleteGraphPlot(waveDisp->plotPanHndl, TSPan_GraphPlot, -1, VAL_IMMEDIATE_DRAW) );
 	// discard waveforms
 	ClearWaveformList(waveDisp->waveforms);
+	waveDisp->nSamples		= 0;
+	waveDisp->plotWaveform	= NULL;
+	waveDisp->decimWaveform	= NULL;
+	waveDisp->nDecimLevels	= 0;
 	// update scrollbar maximum range and index display
 	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MIN_VALUE, 0);
 	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MAX_VALUE, 0);
@@ -352,10 +413,8 @@ INIT_ERR
 			SetCtrlVal(panel, TSPan_SBIndex, waveformIdx);
 			// get waveform
 			waveform = *(Waveform_type**)ListGetPtrToItem(waveDisp->waveforms, waveformIdx);
-			// clear plot
-			errChk( DeleteGraphPlot(waveDisp->plotPanHndl, TSPan_GraphPlot, -1, VAL_IMMEDIATE_DRAW) );
 			// add waveform to plot
-			errChk( AddWaveformToGraph(waveDisp->plotPanHndl, TSPan_GraphPlot, waveform) );
+			errChk( AddWaveformToGraph(waveDisp, waveform) );
 			break;
 	}
 	
@@ -398,98 +457,266 @@ static int CVICALLBACK TSPanCtrls_CB (int panel, int control, int event, void *c
 			}
 			break;
 			
+		case EVENT_ZOOM:
+			
+			// decimate the waveform again for the new X axis range once the graph is zoomed or panned
+			PostDeferredCall(RedrawWaveformDisplay_CB, (void*)(intptr_t)waveDisp->plotPanHndl);
+			break;
+			
 	}
 
 	return 0;
 }
 
-static int AddWaveformToGraph (int panel, int control, Waveform_type* waveform)
+static void CVICALLBACK RedrawWaveformDisplay_CB (void* callbackData)
 {
 INIT_ERR
+
+	int						panel		= (int)(intptr_t)callbackData;
+	WaveformDisplay_type*	waveDisp	= NULL;
 	
-	void*			waveformData		= NULL;
-	size_t			nSamples			= 0;
-	double			samplingRate		= GetWaveformSamplingRate(waveform);
-	char*			waveformName		= GetWaveformName(waveform);
-	char*			waveformUnit		= GetWaveformPhysicalUnit(waveform);
-	WaveformColors	waveformColor		= GetWaveformColor(waveform);
-	double			xIncrement			= 1.0;
+	// the waveform display may have been discarded in the meantime
+	if (GetPanelAttribute(panel, ATTR_CALLBACK_DATA, &waveDisp) < 0 || !waveDisp) return;
 	
-	waveformData = *(void**)GetWaveformPtrToData(waveform, &nSamples);
+	errChk( PlotWaveformRange(waveDisp) );
 	
-	// set X axis increment
-	if (samplingRate == 0.0)
-		xIncrement = 1.0;
-	else
-		xIncrement = 1/samplingRate;
+Error:
 	
-	// set Y axis label
-	if (waveformName && waveformName[0]) {
-		// add unit to waveform name if there is one
-		if (waveformUnit && waveformUnit[0]) {
-			nullChk( AppendString(&waveformName, " (", -1) );
-			nullChk( AppendString(&waveformName, waveformUnit, -1) );
-			nullChk( AppendString(&waveformName, ")", -1) );
+PRINT_ERR
+}
+
+static void LimitWaveformHistory (WaveformDisplay_type* waveDisp)
+{
+	size_t			nWaveforms		= ListNumItems(waveDisp->waveforms);
+	Waveform_type*	waveform		= NULL;
+	
+	// discard oldest waveforms until the memory limits are met, keeping at least the latest waveform
+	while (nWaveforms > 1 && ((waveDisp->maxWaveforms && nWaveforms > waveDisp->maxWaveforms) || (waveDisp->maxSamples && waveDisp->nSamples > waveDisp->maxSamples))) {
+		ListRemoveItem(waveDisp->waveforms, &waveform, FRONT_OF_LIST);
+		waveDisp->nSamples -= GetWaveformNumSamples(waveform);
+		
+		if (waveform == waveDisp->plotWaveform)
+			waveDisp->plotWaveform = NULL;
+		
+		if (waveform == waveDisp->decimWaveform) {
+			waveDisp->decimWaveform = NULL;
+			waveDisp->nDecimLevels	= 0;
 		}
 		
-		SetCtrlAttribute(panel, control, ATTR_YNAME, waveformName);
+		discard_Waveform_type(&waveform);
+		nWaveforms--;
 	}
+}
+
+static int UpdateWaveformHistory (WaveformDisplay_type* waveDisp)
+{
+INIT_ERR
+
+	size_t			nWaveforms		= 0;
+	size_t			waveformIdx		= 0;
+	Waveform_type*	waveform		= NULL;
 	
-	// set plot title
-	//SetCtrlAttribute(panel, control, ATTR_LABEL_TEXT, plotTitle);
+	LimitWaveformHistory(waveDisp);
+	
+	nWaveforms = ListNumItems(waveDisp->waveforms);
+	if (!nWaveforms) return 0;
+	
+	// show the latest waveform if updating, otherwise keep showing the waveform selected by the user or the oldest waveform if it was discarded
+	if (waveDisp->update)
+		waveformIdx = nWaveforms;
+	else if (waveDisp->plotWaveform)
+		waveformIdx = ListFindItem(waveDisp->waveforms, &waveDisp->plotWaveform, FRONT_OF_LIST, NULL);
+	
+	if (!waveformIdx)
+		waveformIdx = 1;
+	
+	// update scrollbar min max range
+	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MIN_VALUE, 1);
+	SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_MAX_VALUE, nWaveforms);
+	// undim scrollbar if there is more than one waveform in the list
+	if (nWaveforms > 1)
+		SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_DIMMED, FALSE);
+	else
+		SetCtrlAttribute(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, ATTR_DIMMED, TRUE);
+	
+	SetCtrlVal(waveDisp->plotPanHndl, waveDisp->scrollbarCtrl, waveformIdx);
+	SetCtrlVal(waveDisp->plotPanHndl, TSPan_SBIndex, waveformIdx);
+	
+	// update plot if needed
+	waveform = *(Waveform_type**)ListGetPtrToItem(waveDisp->waveforms, waveformIdx);
+	if (waveform != waveDisp->plotWaveform)
+		errChk( AddWaveformToGraph(waveDisp, waveform) );
+	
+Error:
+	
+	return errorInfo.error;
+}
+
+static int BuildDecimationPyramid (WaveformDisplay_type* waveDisp, Waveform_type* waveform)
+{
+INIT_ERR
+
+	size_t					nSamples		= 0;
+	void*					waveformData	= *(void**)GetWaveformPtrToData(waveform, &nSamples);
+	DecimationLevel_type*	level			= NULL;
+	DecimationLevel_type*	prevLevel		= NULL;
+	double*					newMinMax		= NULL;
+	size_t					nBlocks			= 0;
+	size_t					lastBlock		= 0;
+	double					minVal			= 0;
+	double					maxVal			= 0;
+	
+	waveDisp->decimWaveform = waveform;
+	waveDisp->nDecimLevels	= 0;
+	
+	if (nSamples <= DecimationFactor) return 0;
+	
+	//-----------------------------------------
+	// First level from waveform samples
+	//-----------------------------------------
+	
+	level 	= &waveDisp->decimLevels[0];
+	nBlocks = (nSamples + DecimationFactor - 1) / DecimationFactor;
+	
+	nullChk( newMinMax = realloc(level->minMax, 2 * nBlocks * sizeof(double)) );
+	level->minMax 		= newMinMax;
+	level->nBlocks		= nBlocks;
+	level->blockSize	= DecimationFactor;
 	
-	// plot waveforms
 	switch (GetWaveformDataType(waveform)) {
 			
 		case Waveform_Char:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_CHAR, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(char, waveformData, nSamples, level->minMax);
 			break;
 			
-		case Waveform_UChar:  
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_CHAR, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+		case Waveform_UChar:
+			DecimateSamples(unsigned char, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Short:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SHORT_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(short, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_UShort:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_SHORT_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(unsigned short, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Int:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(int, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_UInt:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(unsigned int, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Int64:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_64BIT_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(long long, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_UInt64:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_64BIT_INTEGER, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(unsigned long long, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_SSize:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SSIZE_T, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(ssize_t, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Size:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SIZE_T, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(size_t, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Float:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_FLOAT, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(float, waveformData, nSamples, level->minMax);
 			break;
 			
 		case Waveform_Double:
-			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_DOUBLE, 1.0, 0.0, 0.0, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			DecimateSamples(double, waveformData, nSamples, level->minMax);
 			break;
 	}
 	
+	waveDisp->nDecimLevels = 1;
+	
+	//-----------------------------------------
+	// Next levels from previous level blocks
+	//-----------------------------------------
+	
+	while (waveDisp->nDecimLevels < MaxDecimationLevels && waveDisp->decimLevels[waveDisp->nDecimLevels - 1].nBlocks > 1) {
+		prevLevel 	= &waveDisp->decimLevels[waveDisp->nDecimLevels - 1];
+		level 		= &waveDisp->decimLevels[waveDisp->nDecimLevels];
+		nBlocks 	= (prevLevel->nBlocks + DecimationFactor - 1) / DecimationFactor;
+		
+		nullChk( newMinMax = realloc(level->minMax, 2 * nBlocks * sizeof(double)) );
+		level->minMax 		= newMinMax;
+		level->nBlocks		= nBlocks;
+		level->blockSize	= prevLevel->blockSize * DecimationFactor;
+		
+		for (size_t i = 0; i < nBlocks; i++) {
+			lastBlock 	= (i + 1) * DecimationFactor;
+			if (lastBlock > prevLevel->nBlocks)
+				lastBlock = prevLevel->nBlocks;
+			
+			minVal 		= prevLevel->minMax[2 * i * DecimationFactor];
+			maxVal 		= prevLevel->minMax[2 * i * DecimationFactor + 1];
+			for (size_t j = i * DecimationFactor + 1; j < lastBlock; j++) {
+				if (prevLevel->minMax[2 * j] < minVal) minVal = prevLevel->minMax[2 * j];
+				if (prevLevel->minMax[2 * j + 1] > maxVal) maxVal = prevLevel->minMax[2 * j + 1];
+			}
+			
+			level->minMax[2 * i] 		= minVal;
+			level->minMax[2 * i + 1]	= maxVal;
+		}
+		
+		waveDisp->nDecimLevels++;
+	}
+	
+	return 0;
+	
+Error:
+	
+	// plot waveform samples without decimation
+	waveDisp->nDecimLevels = 0;
+	return errorInfo.error;
+}
+
+static int AddWaveformToGraph (WaveformDisplay_type* waveDisp, Waveform_type* waveform)
+{
+INIT_ERR
+	
+	int				panel				= waveDisp->plotPanHndl;
+	int				control				= TSPan_GraphPlot;
+	size_t			nSamples			= GetWaveformNumSamples(waveform);
+	double			samplingRate		= GetWaveformSamplingRate(waveform);
+	char*			waveformName		= GetWaveformName(waveform);
+	char*			waveformUnit		= GetWaveformPhysicalUnit(waveform);
+	double			xIncrement			= 1.0;
+	
+	// build min/max decimation pyramid for a new waveform
+	if (waveform != waveDisp->decimWaveform)
+		BuildDecimationPyramid(waveDisp, waveform);
+	
+	waveDisp->plotWaveform = waveform;
+	
+	// set X axis increment
+	if (samplingRate == 0.0)
+		xIncrement = 1.0;
+	else
+		xIncrement = 1/samplingRate;
+	
+	// set Y axis label
+	if (waveformName && waveformName[0]) {
+		// add unit to waveform name if there is one
+		if (waveformUnit && waveformUnit[0]) {
+			nullChk( AppendString(&waveformName, " (", -1) );
+			nullChk( AppendString(&waveformName, waveformUnit, -1) );
+			nullChk( AppendString(&waveformName, ")", -1) );
+		}
+		
+		SetCtrlAttribute(panel, control, ATTR_YNAME, waveformName);
+	}
+	
+	// set plot title
+	//SetCtrlAttribute(panel, control, ATTR_LABEL_TEXT, plotTitle);
+	
 	// adjust X axis label
 	if (samplingRate == 0.0)
 		SetCtrlAttribute(panel, control, ATTR_XNAME, "Samples");
@@ -510,8 +737,8 @@ INIT_ERR
 					SetCtrlAttribute(panel, control, ATTR_XAXIS_GAIN, 1e6);
 				}
 		
-	// refresh plot
-	RefreshGraph(panel, control); 
+	// plot waveform
+	errChk( PlotWaveformRange(waveDisp) );
 	
 	// update cursors
 	UpdateGraphCursors(panel, control);
@@ -524,6 +751,149 @@ Error:
 	return errorInfo.error;
 }
 
+static int PlotWaveformRange (WaveformDisplay_type* waveDisp)
+{
+INIT_ERR
+
+	int						panel				= waveDisp->plotPanHndl;
+	int						control				= TSPan_GraphPlot;
+	Waveform_type*			waveform			= waveDisp->plotWaveform;
+	size_t					nSamples			= 0;
+	double					samplingRate		= 0;
+	double					xIncrement			= 1.0;
+	int						xScalingMode		= 0;
+	double					xMin				= 0;
+	double					xMax				= 0;
+	size_t					firstSample			= 0;
+	size_t					lastSample			= 0;
+	int						plotWidth			= 0;
+	size_t					maxPoints			= 0;
+	int						levelIdx			= 0;
+	DecimationLevel_type*	level				= NULL;
+	size_t					firstBlock			= 0;
+	size_t					lastBlock			= 0;
+	
+	if (!waveform) return 0;
+	
+	errChk( DeleteGraphPlot(panel, control, -1, VAL_DELAYED_DRAW) );
+	
+	nSamples 		= GetWaveformNumSamples(waveform);
+	samplingRate	= GetWaveformSamplingRate(waveform);
+	if (samplingRate != 0.0)
+		xIncrement = 1/samplingRate;
+	
+	// samples within the X axis range, or all samples if the X axis is autoscaled
+	lastSample = nSamples;
+	GetAxisScalingMode(panel, control, VAL_BOTTOM_XAXIS, &xScalingMode, &xMin, &xMax);
+	if (xScalingMode == VAL_MANUAL) {
+		if (xMin > 0)
+			firstSample = (xMin/xIncrement < nSamples) ? (size_t)(xMin/xIncrement) : nSamples;
+		if (xMax < 0)
+			lastSample = 0;
+		else if (xMax/xIncrement + 2 < nSamples)
+			lastSample = (size_t)(xMax/xIncrement) + 2;
+	}
+	
+	if (firstSample >= lastSample) goto Refresh;
+	
+	// plot at most about twice as many points as the plot area is wide in pixels
+	GetCtrlAttribute(panel, control, ATTR_PLOT_AREA_WIDTH, &plotWidth);
+	maxPoints = 2 * (size_t)((plotWidth > 0) ? plotWidth : 1);
+	
+	if (lastSample - firstSample <= maxPoints || !waveDisp->nDecimLevels) {
+		errChk( PlotWaveformSamples(panel, control, waveform, firstSample, lastSample - firstSample, xIncrement) );
+		goto Refresh;
+	}
+	
+	// select the finest decimation level with at most one min/max pair per pixel
+	while (levelIdx < waveDisp->nDecimLevels - 1 && (lastSample - firstSample) / waveDisp->decimLevels[levelIdx].blockSize > maxPoints/2)
+		levelIdx++;
+	
+	level 		= &waveDisp->decimLevels[levelIdx];
+	firstBlock	= firstSample / level->blockSize;
+	lastBlock	= (lastSample + level->blockSize - 1) / level->blockSize;
+	if (lastBlock > level->nBlocks)
+		lastBlock = level->nBlocks;
+	
+	// min/max pairs of each block are plotted as two points spanning the block
+	errChk( PlotWaveform(panel, control, level->minMax + 2 * firstBlock, 2 * (lastBlock - firstBlock), VAL_DOUBLE, 1.0, 0.0, firstBlock * level->blockSize * xIncrement, 
+						 level->blockSize * xIncrement / 2, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, GetWaveformColor(waveform)) );
+	
+Refresh:
+	
+	// refresh plot
+	RefreshGraph(panel, control);
+	
+Error:
+	
+	return errorInfo.error;
+}
+
+static int PlotWaveformSamples (int panel, int control, Waveform_type* waveform, size_t firstSample, size_t nSamples, double xIncrement)
+{
+INIT_ERR
+
+	size_t			nWaveformSamples	= 0;
+	void*			waveformData		= (char*)*(void**)GetWaveformPtrToData(waveform, &nWaveformSamples) + firstSample * GetWaveformSizeofData(waveform);
+	WaveformColors	waveformColor		= GetWaveformColor(waveform);
+	double			initialX			= firstSample * xIncrement;
+	
+	switch (GetWaveformDataType(waveform)) {
+			
+		case Waveform_Char:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_CHAR, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_UChar:  
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_CHAR, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Short:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SHORT_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_UShort:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_SHORT_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Int:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_UInt:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Int64:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_64BIT_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_UInt64:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_UNSIGNED_64BIT_INTEGER, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_SSize:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SSIZE_T, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Size:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_SIZE_T, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Float:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_FLOAT, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+			
+		case Waveform_Double:
+			errChk( PlotWaveform(panel, control, waveformData, nSamples, VAL_DOUBLE, 1.0, 0.0, initialX, xIncrement, VAL_THIN_LINE, VAL_NO_POINT, VAL_SOLID, 1, waveformColor) );
+			break;
+	}
+	
+Error:
+	
+	return errorInfo.error;
+}
+
 static void UpdateGraphCursors (int panel, int control)
 {
 	double 	cursorX		= 0;
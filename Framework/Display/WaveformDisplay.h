@@ -27,6 +27,9 @@
 //==============================================================================
 // Constants
 
+#define Default_WaveformDisplay_MaxWaveforms	1000		// Default maximum number of waveforms kept by a waveform display.
+#define Default_WaveformDisplay_MaxSamples		50000000	// Default maximum total number of waveform samples kept by a waveform display.
+
 //==============================================================================
 // Types
 		
@@ -52,6 +55,7 @@ WaveformDisplay_type*		init_WaveformDisplay_type		(int parentPanHndl, char displ
 void						discard_WaveformDisplay_type	(WaveformDisplay_type** waveDispPtr);
 
 // Adds a waveform to display. Multiple waveforms can be added to the same waveform display and the user can make use of a scrollbar to view each waveform.
+// If the memory limits of the display are exceeded, the oldest waveforms are discarded.
 int							DisplayWaveform					(WaveformDisplay_type* waveDisp, Waveform_type** waveformPtr);
 
 // Discards waveforms from display and hides panel. Note: this does not discard the waveform display
@@ -66,6 +70,9 @@ void						SetWaveformDisplayCB			(WaveformDisplay_type* waveDisp, WaveformDispla
 	// Returns a list of Waveform_type* elements used for display. Do not modify this list directly.
 ListType					GetDisplayWaveformList				(WaveformDisplay_type* waveDisp);
 
+	// Sets the maximum number of waveforms and the maximum total number of samples kept by the display. Set a limit to 0 to disable it. The latest waveform is always kept.
+int							SetWaveformDisplayMemoryLimits		(WaveformDisplay_type* waveDisp, size_t maxWaveforms, size_t maxSamples);
+
 #ifdef __cplusplus
     }
 #endif
@@ -15,7 +15,6 @@
 // Include files
 #include <windows.h>  
 #include "DAQLabErrHandling.h"
-#include "asynctmr.h"
 #include <formatio.h>
 #include "TaskController.h"
 #include "VChannel.h"
@@ -27,7 +26,15 @@
 //==============================================================================
 // Constants
 
-#define EVENT_BUFFER_SIZE 10											// Number of maximum events read at once from the Task Controller TSQs
+#define EVENT_BUFFER_SIZE 10											// Size of the event buffer processed by the Task Controller event handler, including iteration events added with priority.
+#define TC_TraceBufferSize		16384									// Number of records in the execution trace ring buffer. Must be a power of 2.
+#define TC_TraceNameLength		32										// Maximum number of characters of Task Controller names stored in the execution trace, including the null character.
+#define TC_TimerRetryInterval	0.001									// Time in [s] after which a timer event is posted again if the event queue of the Task Controller was full.
+#define TC_TimerNotStarted		((size_t)-1)							// Timer heap index of timers that are not started.
+#define TC_CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	0x00000002			// Same as CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, which older SDK headers do not define.
+#define TC_TIMER_ALL_ACCESS		0x001F0003								// Same as TIMER_ALL_ACCESS.
+#define TC_StateSnapshotBits	4										// Number of low bits of the published state snapshot holding the TCStates value. The remaining bits hold the state version.
+#define TC_StateSnapshotMask	((1UL << TC_StateSnapshotBits) - 1)
 
 #ifndef TC_WRONG_EVENT_STATE_ERROR
 #define TC_WRONG_EVENT_STATE_ERROR \
@@ -61,46 +68,107 @@ typedef struct {
 	DiscardFptr_type   				discardEventDataFptr;   			// Function pointer to dispose of the eventData
 } EventPacket_type;
 
+// Task Controller event queue lanes in order of processing priority
+typedef enum {
+	TC_EventLane_Control,												// Events controlling the execution of the Task Controller, e.g. start, stop, configure and child TC state updates.
+	TC_EventLane_Iteration,												// TC_Event_Iterate, TC_Event_IterationDone and TC_Event_IterationTimeout.
+	TC_EventLane_Data,													// TC_Event_DataReceived.
+	TC_NEventLanes
+} TCEventLanes;
+
+typedef struct {
+	volatile LONG					seq;								// Lane position for which the cell can be written, or lane position + 1 when the cell holds an event to be read.
+	double							queuedTime;							// Time in [s] given by Timer() when the event was queued.
+	EventPacket_type				eventPacket;
+} TCEventCell_type;
+
+// Bounded lock-free event queue lane. Events are written without locking from multiple threads and read only by the Task Controller event handler.
+typedef struct {
+	TCEventCell_type*				cells;								// Array of TC_NEventQueueItems cells.
+	volatile LONG					writePos;							// Lane position of the next event to be written.
+	volatile LONG					readPos;							// Lane position of the next event to be read.
+	volatile LONG					nEvents;							// Number of events in the lane, including events for which room was reserved and that are not yet written.
+} TCEventLane_type;
+
+// Task Controller timers started with the timer service
+typedef enum {
+	TC_Timer_IterationWait,												// Starts the next iteration at its deadline when waiting between iterations. Posts TC_Event_Iterate.
+	TC_Timer_IterationTimeout,											// Iteration function timeout. Posts TC_Event_IterationTimeout.
+	TC_NTimers
+} TCTimers;
+
+// Started timer in the timer service heap
+typedef struct {
+	TaskControl_type*				taskControl;
+	TCTimers						timer;
+	LONG							generation;							// Timer generation when the timer was started. The timer is cancelled if the Task Controller timer generation changes.
+	LONGLONG						deadline;							// Absolute deadline in performance counter ticks.
+} TCTimerEntry_type;
+
 typedef struct {
 	TCStates						childTCState;						// Updated by parent task when informed by childTC that a state change occured.
 	TCStates						previousChildTCState;				// Previous child TC state used for logging and debuging.
 	TaskControl_type*				childTC;							// Pointer to child TC.
 	BOOL							isOutOfDate;						// If True, state of child is not known to the parent and the parent must be updated by its child.
+	BOOL							barrierPending;						// If True, the child TC did not yet reach the state of the armed completion barrier of the parent.
 } ChildTCInfo_type;
 
 typedef enum {
 	STATE_CHANGE,
 	FUNCTION_CALL,
-	CHILD_TASK_STATE_UPDATE
+	FUNCTION_CALL_DONE,
+	CHILD_TASK_STATE_UPDATE,
+	ITERATION_START,
+	ITERATION_DONE
 } TaskControllerActions;
 
+// Execution trace record. Records are written without locking by the thread performing the action in a ring buffer shared by all Task Controllers.
+typedef struct {
+	volatile LONG					seq;								// 1-based trace position of the record when complete, 0 while the record is being written.
+	double							time;								// Time in [s] given by Timer() when the action was taken.
+	LONG							traceID;							// Unique ID of the Task Controller taking the action.
+	unsigned int					threadID;							// Thread in which the action was taken.
+	TaskControllerActions			action;								
+	BOOL							hasEvent;							// If TRUE, the action was taken while processing event.
+	TCEvents						event;								
+	TCStates						oldState;							// Previous Task Controller state, or previous child TC state for CHILD_TASK_STATE_UPDATE.
+	TCStates						newState;							// Current Task Controller state, or new child TC state for CHILD_TASK_STATE_UPDATE.
+	int								info;								// Callback ID of TCCallbacks for FUNCTION_CALL and FUNCTION_CALL_DONE, 1-based child TC index for CHILD_TASK_STATE_UPDATE.
+	size_t							iterIdx;							// Iteration index of the Task Controller.
+	char							tcName[TC_TraceNameLength];			// Task Controller name.
+	char							childName[TC_TraceNameLength];		// Child TC name for CHILD_TASK_STATE_UPDATE.
+} TCTraceRecord_type;
+
 // Structure binding Task Controller and VChan data for passing to TSQ callback	
 typedef struct {
 	TaskControl_type* 				taskControl;
 	SinkVChan_type* 				sinkVChan;
 	DataReceivedFptr_type			DataReceivedFptr;
 	CmtTSQCallbackID				itemsInQueueCBID;
+	volatile LONG					dataEventPending;					// TRUE while a TC_Event_DataReceived event for the Sink VChan is queued or being processed. Further data packets only set dataArrived.
+	volatile LONG					dataArrived;						// TRUE if data packets arrived while a TC_Event_DataReceived event for the Sink VChan was pending.
+	int								nQueuedPackets;						// For TC_Event_DataReceived event data, number of packets in the Sink VChan queue before calling DataReceivedFptr, or -1 if it was not called.
 } VChanCallbackData_type;
 
 struct TaskControl {
 	// Task control data
 	char*							taskName;							// Name of Task Controller
 	size_t							childTCIdx;							// 1-based index of childTC from parent Task childTCs list. If task doesn't have a parent task then index is 0.
-	CmtTSQHandle					eventQ;								// Event queue to which the state machine reacts.
-	CmtThreadLockHandle				eventQThreadLock;					// Thread lock used to coordinate multiple writing threads sending events to the queue.
+	TCEventLane_type				eventLanes[TC_NEventLanes];			// Event queue lanes to which the state machine reacts. Events in a lane are processed only if higher priority lanes are empty.
+	volatile LONG					eventHandlerActive;					// TRUE while the event handler is scheduled or running. Ensures that a single event handler processes the event queue.
 	ListType						dataQs;								// Incoming data queues, list of VChanCallbackData_type*.
 	ListType						sourceVChans;						// Source VChans associated with the task controller of SourceVChan_type*.
-	unsigned int					eventQThreadID;						// Thread ID in which queue events are processed.
-	CmtThreadFunctionID				threadFunctionID;					// ID of ScheduleTaskEventHandler that is executed in a separate thread from the main thread.
+	unsigned int					eventQThreadID;						// Thread ID in which Sink VChan queue events are processed.
 	CmtThreadPoolHandle				threadPoolHndl;						// Thread pool handle used to launch task controller threads.
 	CmtTSVHandle					stateTSV;							// Task Controller state, thread safe variable of TCStates.
 	int								stateTSVLineNumDebug;				// Used to find out where in the code the state TSV is obtained and is not released.
 	char							stateTSVFileName[200];				// Used to find out where in the code the state TSV is obtained and is not released. 
 	BOOL							stateTSVLockObtained;				// Status of stateTSV lock.
 	TCStates						currentState;						// Current Task Controller state for internal use. Its value is updated from stateTSV before processing an event.
+	volatile LONG					stateSnapshot;						// Published state and state version which can be read without obtaining the stateTSV lock. Written only while holding the stateTSV lock.
 	TCStates 						oldState;							// Previous Task Controller state used for logging.
 	size_t							repeat;								// Total number of repeats. If repeat is 0, then the iteration function is not called. 
-	int								iterTimeout;						// Timeout in [s] until when TaskControlIterationDone can be called. 
+	int								iterTimeout;						// Timeout in [s] until when TaskControlIterationDone can be called. If 0, there is no timeout.
 	
 	TCExecutionModes				executionMode;						// Determines how the iteration block of a Task Controller is executed with respect to its childTCs if any.
 	TaskMode_type					mode;								// Finite or continuous type of task controller
@@ -108,19 +176,34 @@ struct TaskControl {
 	TaskControl_type*				parentTC;							// Pointer to parent task that own this childTC. 
 																		// If this is the main task, it has no parent and this is NULL. 
 	ListType						childTCs;							// List of childTCs of ChildTCInfo_type.
+	BOOL							childTCsBarrierArmed;				// If True, the child TCs completion barrier is armed and childTCsBarrierState is checked by counting instead of checking each child TC.
+	TCStates						childTCsBarrierState;				// State to which all child TCs must switch to pass the completion barrier.
+	volatile LONG					nChildTCsBarrierPending;			// Number of child TCs that did not yet switch to childTCsBarrierState since the barrier was armed.
 	void*							moduleData;							// Reference to module specific data that is controlled by the task.
-	int								logPanHandle;						// Panel handle in which there is a box control for printing Task Controller execution info useful for debugging. If not used, it is set to 0
-	int								logBoxControlID;					// Box control ID for printing Task Controller execution info useful for debugging. If not used, it is set to 0.  
-	BOOL							loggingEnabled;						// If True, logging info is printed to the provided Box control.
+	BOOL							loggingEnabled;						// If True, the execution of the Task Controller is recorded in the execution trace even if tracing is not enabled for all Task Controllers.
+	LONG							traceID;							// Unique ID identifying the Task Controller in the execution trace.
 	char*							errorMsg;							// When switching to an error state, additional error info is written here.
 	int								errorID;							// Error code encountered when switching to an error state.
-	double							waitBetweenIterations;				// During a RUNNING state, waits specified ammount in seconds between iterations
+	double							waitBetweenIterations;				// During a RUNNING state, iterations start at this interval in seconds.
+	LONGLONG						iterationDeadline;					// Scheduled start of the last or next iteration in performance counter ticks, used to iterate periodically without drift.
+	volatile LONG					timerGeneration[TC_NTimers];		// Incremented each time a timer is started or cancelled. Timer events from an older generation are ignored.
+	size_t							timerHeapIdx[TC_NTimers];			// Index of the started timer in the timer service heap, or TC_TimerNotStarted. Changed only while holding the heap lock.
+	BOOL							timerServiceStarted;				// TRUE if the Task Controller is a user of the timer service.
 	BOOL							abortFlag;							// If True, it signals the provided callback functions that they must terminate.
 	BOOL							stopIterationsFlag;					// if True, no further TC iterations are performed.
 	int								nIterationsFlag;					// When -1, the Task Controller is iterated continuously, 0 iteration stops and 1 one iteration.
-	int								iterationTimerID;					// Keeps track of the timeout timer when iteration is performed in another thread.
 	BOOL							UITCFlag;							// If TRUE, the Task Controller is meant to be used as an User Interface Task Controller that allows the user to control a Task Tree.
 	
+	// Metrics
+	// Note: each histogram is updated from a single thread at a time, i.e. the iteration function thread or the Task Controller thread, and is read without locking.
+	double							iterationStartTime;					// Time in [s] given by Timer() when the iteration function was launched, 0 if no iteration is in progress.
+	TCLatencyHistogram_type			iterationLatency;					// Time from launching the iteration function until TaskControlIterationDone is called.
+	TCLatencyHistogram_type			dataReceivedLatency;				// Execution time of DataReceivedFptr callbacks.
+	TCLatencyHistogram_type			controlEventLatency;				// Time control events wait in the event queue before being processed.
+	TCLatencyHistogram_type			iterationJitter;					// Delay of iteration starts from their scheduled time when waiting between iterations.
+	unsigned long long				nDataEvents;						// Number of TC_Event_DataReceived events generated for Sink VChans.
+	unsigned long long				nCoalescedDataEvents;				// Number of Sink VChan data arrivals that did not generate a TC_Event_DataReceived event because one was pending.
+	
 	// Event handler function pointers
 	ConfigureFptr_type				ConfigureFptr;
 	UnconfigureFptr_type			UnconfigureFptr;
@@ -134,27 +217,96 @@ struct TaskControl {
 	SetUITCModeFptr_type			SetUITCModeFptr;
 	ModuleEventFptr_type			ModuleEventFptr;
 	ErrorFptr_type					ErrorFptr;
+	EstimateIterationFptr_type		EstimateIterationFptr;				// Optional, used for dry-run estimates of the task tree.
 };
 
 //==============================================================================
 // Static global variables
 
+static TCTraceRecord_type			TCTraceBuffer[TC_TraceBufferSize];	// Execution trace ring buffer shared by all Task Controllers.
+static volatile LONG				TCTraceWritePos			= 0;		// Number of trace records reserved so far. The next record is written at this 0-based trace position.
+static volatile LONG				TCTraceNextID			= 0;		// Last assigned Task Controller trace ID.
+static BOOL							TCTracingEnabled		= FALSE;	// If True, the execution of all Task Controllers is recorded in the execution trace.
+
+static CmtThreadLockHandle			TCTimerLock				= 0;		// Protects the timer service heap.
+static HANDLE						TCTimerWakeEvent		= NULL;		// Wakes up the timer thread when a timer with an earlier deadline is started or when the thread must exit.
+static CmtThreadPoolHandle			TCTimerThreadPool		= 0;		// Thread pool with a single thread reserved for the timer thread.
+static CmtThreadFunctionID			TCTimerThreadID			= 0;		// Timer thread.
+static HANDLE						TCTimerWaitableTimer	= NULL;		// Waitable timer set to the next deadline, on which the timer thread waits.
+static TCTimerEntry_type*			TCTimerHeap				= NULL;		// Min-heap of started timers ordered by deadline.
+static size_t						TCTimerHeapSize			= 0;		// Number of allocated heap entries.
+static size_t						TCTimerHeapCount		= 0;		// Number of started timers in the heap.
+static LONG							TCTimerNUsers			= 0;		// Number of Task Controllers using the timer service. The service runs while there are users.
+static volatile LONG				TCTimerQuit				= FALSE;	// If TRUE, the timer thread exits.
+static LONGLONG						TCTimerFrequency		= 0;		// Performance counter ticks per second.
+
 //==============================================================================
 // Static functions
 
 static void 								TaskEventHandler 						(TaskControl_type* taskControl); 
 static void 								AddIterationEventWithPriority 			(EventPacket_type* eventPackets, int* nEventPackets, int currentEventIdx);
 
+// Event queue lanes
+static BOOL									InitTCEventLane							(TCEventLane_type* lane);
+static void									DiscardTCEventLane						(TCEventLane_type* lane);
+static BOOL									WriteTCEventLane						(TCEventLane_type* lane, EventPacket_type* eventPacket);
+static BOOL									ReserveTCEventLane						(TCEventLane_type* lane);
+static void									CancelTCEventLaneReservation			(TCEventLane_type* lane);
+static void									WriteReservedTCEventLane				(TCEventLane_type* lane, EventPacket_type* eventPacket);
+static BOOL									ReadTCEventLane							(TCEventLane_type* lane, EventPacket_type* eventPacket, double* queuedTimePtr);
+static BOOL									TCEventLaneIsEmpty						(TCEventLane_type* lane);
+static TCEventLanes							GetTCEventLane							(TCEvents event);
+
+// Places an event in the event queue of a Task Controller. Returns FALSE if the event queue lane is full.
+static BOOL									QueueTaskControlEvent					(TaskControl_type* taskControl, EventPacket_type* eventPacket);
+// Reads the next event with the highest priority from the event queue of a Task Controller. Returns FALSE if there are no events.
+static BOOL									ReadTaskControlEvent					(TaskControl_type* taskControl, EventPacket_type* eventPacket);
+static BOOL									TaskControlEventPending					(TaskControl_type* taskControl);
+// Timer service. A single high priority thread posts timer events to Task Controllers at their deadlines so that no thread is blocked while waiting.
+static int									StartTCTimerService						(void);
+static void									StopTCTimerService						(void);
+static HANDLE								CreateTCWaitableTimer					(void);
+static LONGLONG								GetTCTimerTicks							(void);
+static int									StartTCTimer							(TaskControl_type* taskControl, TCTimers timer, LONGLONG deadline);
+static void									CancelTCTimer							(TaskControl_type* taskControl, TCTimers timer);
+static void									SetTCTimerHeapEntry						(size_t idx, TCTimerEntry_type* entry);
+static void									PushTCTimerHeap							(TCTimerEntry_type* entry);
+static void									RemoveTCTimerHeap						(size_t idx);
+static BOOL									IsStaleTCTimerEvent						(TaskControl_type* taskControl, EventPacket_type* eventPacket);
+int CVICALLBACK								TCTimerThread							(void* functionData);
+
+// Schedules the event handler of a Task Controller in its thread pool if the event handler is not active.
+static void									LaunchTaskEventHandler					(TaskControl_type* taskControl);
+
 // Use this function to change the state of a Task Controller
 static void 								ChangeState 							(TaskControl_type* taskControl, EventPacket_type* eventPacket, TCStates newState);
 // If True, the state of all child TCs is up to date and the same as the given state.
 static BOOL 								AllChildTCsInState 						(TaskControl_type* taskControl, TCStates state); 
+
+// Publishes the state of a Task Controller to lock-free readers and increments the state version if the state changed. Call only while holding the stateTSV lock.
+static void									PublishTaskControlState					(TaskControl_type* taskControl, TCStates state);
+
+// Returns TRUE if the given state is one of the states in which a Task Controller is in use: Idle, Running, IterationFunctionActive or Stopping.
+static BOOL									IsTaskControlStateInUse					(TCStates state);
+
+// Arms the child TCs completion barrier for the state to which the child TCs switch after receiving the given event from their parent.
+static void									ArmChildTCsBarrier						(TaskControl_type* taskControl, TCEvents event);
+
+// Counts a child TC state change reported by a TC_Event_UpdateChildTCState event towards the completion barrier and disarms the barrier once all child TCs
+// passed it. Call before updating the child TC state.
+static void									UpdateChildTCsBarrier					(TaskControl_type* taskControl, ChildTCEventInfo_type* childTCEventInfo);
 // Use this function to carry out a Task Controller action using provided function pointers
 static int									FunctionCall 							(TaskControl_type* taskControl, EventPacket_type* eventPacket, TCCallbacks fID, void* fCallData, char** errorMsg); 
 
-// Formats a Task Controller log entry based on the action taken
+// Records a Task Controller action in the execution trace if tracing or logging is enabled. eventPacket may be NULL if the action is not taken while processing an event.
 static void									ExecutionLogEntry						(TaskControl_type* taskControl, EventPacket_type* eventPacket, TaskControllerActions action, void* info);
 
+// Execution trace reading and formatting
+static BOOL									ReadTraceRecord							(size_t tracePos, TCTraceRecord_type* record);
+static BOOL									TraceRecordPending						(size_t tracePos);
+static char*								FormatTraceRecord						(TCTraceRecord_type* record, double startTime);
+static void									WriteJSONString							(FILE* file, char string[]);
+
 static char*								EventToString							(TCEvents event);
 static char*								FCallToString							(TCCallbacks fcall);
 
@@ -166,6 +318,10 @@ static void									discard_ChildTCEventInfo_type 			(ChildTCEventInfo_type** ev
 static VChanCallbackData_type*				init_VChanCallbackData_type				(TaskControl_type* taskControl, SinkVChan_type* sinkVChan, DataReceivedFptr_type DataReceivedFptr, CmtTSQCallbackID itemsInQueueCBID);
 static void									discard_VChanCallbackData_type			(VChanCallbackData_type** VChanCBDataPtr);
 
+// Allows a new TC_Event_DataReceived event to be generated for a Sink VChan after processing the pending event given by its event data. 
+// Generates a new event if data packets arrived meanwhile or if DataReceivedFptr processed only some of the queued data packets.
+static void									DataReceivedEventDone					(TaskControl_type* taskControl, VChanCallbackData_type* eventCBData);
+
 // Informs recursively Task Controllers about the Task Tree status when it changes (active/inactive).
 static int									TaskTreeStateChange		 				(TaskControl_type* taskControl, EventPacket_type* eventPacket, TaskTreeStates state, char** errorMsg);
 
@@ -177,6 +333,12 @@ static void									SetChildTCsOutOfDate					(TaskControl_type* taskControl);
 // macro for debugging where certain events are generated
 static int*									NumTag									(int num);
 
+// Adds an execution time in [s] to a latency histogram
+static void									RecordTCLatency							(TCLatencyHistogram_type* histogram, double time);
+
+// Estimates the duration of a Task Controller and its child TCs, adding their data and report lines to the task tree estimate. nParentIterations is the number of times the Task Controller is run.
+static int									EstimateTaskTreeBranch					(TaskControl_type* taskControl, double nParentIterations, size_t depth, TCTreeEstimate_type* estimate, double* branchDuration, char** errorMsg);
+
 //==============================================================================
 // Global variables
 
@@ -185,8 +347,6 @@ int 	mainThreadID;			// Main thread ID where UI callbacks are processed
 //==============================================================================
 // Global functions
 
-void CVICALLBACK 							TaskEventItemsInQueue 					(CmtTSQHandle queueHandle, unsigned int event, int value, void *callbackData);
-
 void CVICALLBACK 							TaskDataItemsInQueue 					(CmtTSQHandle queueHandle, unsigned int event, int value, void *callbackData);
 
 int CVICALLBACK 							ScheduleTaskEventHandler 				(void* functionData);
@@ -195,8 +355,6 @@ int CVICALLBACK 							ScheduleIterateFunction 				(void* functionData);
 
 //void CVICALLBACK 							TaskEventHandlerExecutionCallback 		(CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void *callbackData);
 
-int CVICALLBACK 							TaskControlIterTimeout 					(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2); 
-
 //------------------------------------------------------------------------------------------------------------------------------------------------------
 // Task Controller creation / destruction functions
 //------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -233,14 +391,16 @@ INIT_ERR
 	//--------------------------------------
 	// task controller data
 	
-	tc->eventQ								= 0;
-	tc->eventQThreadLock					= 0;
+	memset(tc->eventLanes, 0, sizeof(tc->eventLanes));
+	tc->eventHandlerActive					= FALSE;
 	tc->dataQs								= 0;
 	tc->sourceVChans						= 0;
 	tc->childTCs							= 0;
+	tc->childTCsBarrierArmed				= FALSE;
+	tc->childTCsBarrierState				= TC_State_Done;
+	tc->nChildTCsBarrierPending				= 0;
 	tc->taskName							= NULL;
 	tc->eventQThreadID						= CmtGetCurrentThreadID ();
-	tc->threadFunctionID					= 0;
 	tc->moduleData							= moduleData;
 	tc->threadPoolHndl						= tcThreadPoolHndl;
 	tc->childTCIdx							= 0;
@@ -249,24 +409,35 @@ INIT_ERR
 	tc->stateTSVFileName[0]					= 0;
 	tc->stateTSVLockObtained				= FALSE;
 	tc->currentState						= TC_State_Unconfigured;
+	tc->stateSnapshot						= TC_State_Unconfigured;
 	tc->oldState							= TC_State_Unconfigured;
 	tc->repeat								= 1;
-	tc->iterTimeout							= 10;								
+	tc->iterTimeout							= 0;								
 	tc->executionMode						= TC_Execute_BeforeChildTCs;
 	tc->mode								= TASK_FINITE;
 	tc->currentIter							= NULL;
 	tc->parentTC							= NULL;
-	tc->logPanHandle						= 0;
-	tc->logBoxControlID						= 0;
 	tc->loggingEnabled						= FALSE;
+	tc->traceID								= InterlockedIncrement(&TCTraceNextID);
 	tc->errorMsg							= NULL;
 	tc->errorID								= 0;
 	tc->waitBetweenIterations				= 0;
+	tc->iterationDeadline					= 0;
+	memset((void*)tc->timerGeneration, 0, sizeof(tc->timerGeneration));
+	for (int i = 0; i < TC_NTimers; i++)
+		tc->timerHeapIdx[i]					= TC_TimerNotStarted;
+	tc->timerServiceStarted					= FALSE;
 	tc->abortFlag							= FALSE;
 	tc->stopIterationsFlag					= FALSE;
 	tc->nIterationsFlag						= -1;
-	tc->iterationTimerID					= 0;
 	tc->UITCFlag							= FALSE;
+	tc->iterationStartTime					= 0;
+	memset(&tc->iterationLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&tc->dataReceivedLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&tc->controlEventLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&tc->iterationJitter, 0, sizeof(TCLatencyHistogram_type));
+	tc->nDataEvents							= 0;
+	tc->nCoalescedDataEvents				= 0;
 	
 	//--------------------------------------
 	// task controller callbacks
@@ -283,21 +454,22 @@ INIT_ERR
 	tc -> SetUITCModeFptr					= SetUITCModeFptr;
 	tc -> ModuleEventFptr					= ModuleEventFptr;
 	tc -> ErrorFptr							= ErrorFptr;
+	tc -> EstimateIterationFptr				= NULL;
 	
 	//-------------------------------------------------------------------------------------------------------------------
 	// Allocation (may fail)
 	//-------------------------------------------------------------------------------------------------------------------
 	
 	errChk( CmtNewTSV(sizeof(TCStates), &tc->stateTSV) );
-	errChk( CmtNewTSQ(TC_NEventQueueItems, sizeof(EventPacket_type), 0, &tc->eventQ) );
-	errChk( CmtNewLock(NULL, 0, &tc->eventQThreadLock) );
+	for (int i = 0; i < TC_NEventLanes; i++)
+		nullChk( InitTCEventLane(&tc->eventLanes[i]) );
 	nullChk( tc->dataQs						= ListCreate(sizeof(VChanCallbackData_type*)) );
 	nullChk( tc->sourceVChans				= ListCreate(sizeof(SourceVChan_type*)) );
 	nullChk( tc->childTCs					= ListCreate(sizeof(ChildTCInfo_type)) );
-	// process items in queue events in the same thread that is used to initialize the task control (generally main thread)
-	errChk( CmtInstallTSQCallback(tc->eventQ, EVENT_TSQ_ITEMS_IN_QUEUE, 1, TaskEventItemsInQueue, tc, tc->eventQThreadID, NULL) ); 
 	nullChk( tc->taskName 					= StrDup(taskControllerName) );
 	nullChk( tc->currentIter				= init_Iterator_type(taskControllerName) );
+	errChk( StartTCTimerService() );
+	tc->timerServiceStarted					= TRUE;
 	
 	//--------------------------------------------------------------------------------------------------------------------
 	// Initialize task controller state
@@ -346,6 +518,14 @@ void discard_TaskControl_type(TaskControl_type** taskControllerPtr)
 		OKfreeList(&tc->dataQs, NULL);
 	}
 	
+	// timers
+	if (tc->timerServiceStarted) {
+		for (int i = 0; i < TC_NTimers; i++)
+			CancelTCTimer(tc, i);
+		StopTCTimerService();
+		tc->timerServiceStarted = FALSE;
+	}
+	
 	// discard state TSV
 	if (tc->stateTSV) {
 		CmtDiscardTSV(tc->stateTSV); 
@@ -353,29 +533,18 @@ void discard_TaskControl_type(TaskControl_type** taskControllerPtr)
 	}
 	
 	// event queue
-	if (tc->eventQ) {
-		CmtDiscardTSQ(tc->eventQ);
-		tc->eventQ = 0;
-	}
+	for (int i = 0; i < TC_NEventLanes; i++)
+		DiscardTCEventLane(&tc->eventLanes[i]);
 	
 	// name
 	OKfree(tc->taskName);
 	
-	// event queue thread lock
-	if (tc->eventQThreadLock) {
-		CmtDiscardLock(tc->eventQThreadLock); 
-		tc->eventQThreadLock = 0;
-	}
-	
 	// source VChan list
 	OKfreeList(&tc->sourceVChans, NULL);
 	
 	// child Task Controllers list
 	OKfreeList(&tc->childTCs, NULL);
 	
-	// release thread
-	if (tc->threadFunctionID) CmtReleaseThreadPoolFunctionID(tc->threadPoolHndl, tc->threadFunctionID);   
-	
 	// error message storage 
 	OKfree(tc->errorMsg);
 	
@@ -404,10 +573,153 @@ void EnableTaskControlLogging (TaskControl_type* taskControl, BOOL enableLogging
 	taskControl->loggingEnabled =  enableLogging;
 }
 
-void SetTaskControlUILoggingInfo (TaskControl_type* taskControl, int logPanHandle, int logBoxControlID)
+void EnableTaskControlTracing (BOOL enableTracing)
+{
+	TCTracingEnabled = enableTracing;
+}
+
+BOOL GetTaskControlTracingEnabled (void)
+{
+	return TCTracingEnabled;
+}
+
+size_t GetTaskControlTracePosition (void)
 {
-	taskControl->logPanHandle 		= logPanHandle;
-	taskControl->logBoxControlID	= logBoxControlID;
+	return (size_t)(ULONG)TCTraceWritePos;
+}
+
+char* FormatTaskControlTraceLog (size_t* tracePosPtr, double startTime)
+{
+	size_t					endPos			= (size_t)(ULONG)TCTraceWritePos;
+	size_t					tracePos		= *tracePosPtr;
+	char*					log				= NULL;
+	char*					line			= NULL;
+	char					msg[100]		= "";
+	TCTraceRecord_type		record;
+	
+	if (tracePos == endPos) return NULL;
+	
+	if (!(log = StrDup(""))) return NULL;
+	
+	// skip records that were overwritten in the meantime
+	if (endPos - tracePos > TC_TraceBufferSize) {
+		snprintf(msg, sizeof(msg), "... %llu execution trace records were overwritten ...\n", (unsigned long long)(endPos - TC_TraceBufferSize - tracePos));
+		AppendString(&log, msg, -1);
+		tracePos = endPos - TC_TraceBufferSize;
+	}
+	
+	for (; tracePos < endPos; tracePos++) {
+		if (!ReadTraceRecord(tracePos, &record)) {
+			if (TraceRecordPending(tracePos)) break;	// continue from this record next time
+			continue;									// overwritten
+		}
+		
+		if (!(line = FormatTraceRecord(&record, startTime))) break;
+		AppendString(&log, line, -1);
+		OKfree(line);
+	}
+	
+	*tracePosPtr = tracePos;
+	
+	return log;
+}
+
+int ExportTaskControlTrace (char fileName[], char** errorMsg)
+{
+#define ExportTaskControlTrace_Err_OpenFile		-1
+INIT_ERR
+	
+	FILE*					file			= NULL;
+	size_t					endPos			= (size_t)(ULONG)TCTraceWritePos;
+	size_t					startPos		= (endPos > TC_TraceBufferSize) ? endPos - TC_TraceBufferSize : 0;
+	ListType				traceIDs		= 0;		// Task Controller trace IDs for which a timeline name was written, of LONG type
+	double					startTime		= 0;
+	BOOL					firstEvent		= TRUE;
+	char*					name			= NULL;
+	char*					stateName		= NULL;
+	TCTraceRecord_type		record;
+	
+	nullChk( traceIDs = ListCreate(sizeof(LONG)) );
+	
+	if (!(file = fopen(fileName, "w")))
+		SET_ERR(ExportTaskControlTrace_Err_OpenFile, "Could not open execution trace file for writing.");
+	
+	fprintf(file, "{\"traceEvents\":[\n");
+	
+	// each Task Controller has its own timeline, iterations are shown as asynchronous events since they may complete in another thread
+	for (size_t tracePos = startPos; tracePos < endPos; tracePos++) {
+		if (!ReadTraceRecord(tracePos, &record)) continue;
+		
+		if (firstEvent)
+			startTime = record.time;
+		
+		// name Task Controller timeline
+		if (!ListFindItem(traceIDs, &record.traceID, FRONT_OF_LIST, IntCompare)) {
+			nullChk( ListInsertItem(traceIDs, &record.traceID, END_OF_LIST) );
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%ld,\"args\":{\"name\":", (firstEvent) ? "" : ",\n", (long)record.traceID);
+			WriteJSONString(file, record.tcName);
+			fprintf(file, "}}");
+			firstEvent = FALSE;
+		}
+		
+		switch (record.action) {
+				
+			case STATE_CHANGE:
+			case CHILD_TASK_STATE_UPDATE:
+				
+				// build the whole event name first so that the child name is escaped along with the states
+				if (record.action == CHILD_TASK_STATE_UPDATE) {
+					nullChk( AppendString(&name, record.childName, -1) );
+					nullChk( AppendString(&name, ": ", -1) );
+				}
+				nullChk( stateName = TaskControlStateToString(record.oldState) );
+				nullChk( AppendString(&name, stateName, -1) );
+				OKfree(stateName);
+				nullChk( AppendString(&name, "->", -1) );
+				nullChk( stateName = TaskControlStateToString(record.newState) );
+				nullChk( AppendString(&name, stateName, -1) );
+				OKfree(stateName);
+				
+				fprintf(file, ",\n{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"%s\",\"name\":", (record.action == STATE_CHANGE) ? "state" : "child");
+				WriteJSONString(file, name);
+				OKfree(name);
+				break;
+				
+			case FUNCTION_CALL:
+			case FUNCTION_CALL_DONE:
+				
+				fprintf(file, ",\n{\"ph\":\"%s\",\"cat\":\"callback\",\"name\":", (record.action == FUNCTION_CALL) ? "B" : "E");
+				WriteJSONString(file, (name = FCallToString(record.info)));
+				OKfree(name);
+				break;
+				
+			case ITERATION_START:
+			case ITERATION_DONE:
+				
+				fprintf(file, ",\n{\"ph\":\"%s\",\"cat\":\"iteration\",\"name\":\"Iteration\",\"id\":%ld", (record.action == ITERATION_START) ? "b" : "e", (long)record.traceID);
+				break;
+		}
+		
+		fprintf(file, ",\"ts\":%.3f,\"pid\":1,\"tid\":%ld,\"args\":{\"thread\":%u,\"iteration\":%llu", (record.time - startTime) * 1e6, (long)record.traceID, 
+				record.threadID, (unsigned long long)record.iterIdx);
+		if (record.hasEvent) {
+			fprintf(file, ",\"event\":");
+			WriteJSONString(file, (name = EventToString(record.event)));
+			OKfree(name);
+		}
+		fprintf(file, "}}");
+	}
+	
+	fprintf(file, "\n]}\n");
+	
+Error:
+	
+	if (file) fclose(file);
+	OKfreeList(&traceIDs, NULL);
+	OKfree(name);
+	OKfree(stateName);
+	
+RETURN_ERR
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -455,6 +767,16 @@ Error:
 RETURN_ERR
 }
 
+TCStates GetTaskControlState (TaskControl_type* taskControl, unsigned int* stateVersion)
+{
+	// state and version are published together in a single aligned LONG, so one read returns a consistent pair
+	ULONG	snapshot = (ULONG)taskControl->stateSnapshot;
+	
+	if (stateVersion) *stateVersion = (unsigned int)(snapshot >> TC_StateSnapshotBits);
+	
+	return (TCStates)(snapshot & TC_StateSnapshotMask);
+}
+
 int GetTaskControlState_ReleaseLock (TaskControl_type* taskControl, BOOL* lockObtained, char** errorMsg)
 {
 INIT_ERR
@@ -626,7 +948,7 @@ INIT_ERR
 	strcpy(taskControl->stateTSVFileName, fileNameDebug);
 	//--------------------------------------------------------
 	
-	*inUsePtr = (*tcStateTSVPtr == TC_State_Idle || *tcStateTSVPtr == TC_State_Running || *tcStateTSVPtr == TC_State_IterationFunctionActive || *tcStateTSVPtr == TC_State_Stopping);
+	*inUsePtr = IsTaskControlStateInUse(*tcStateTSVPtr);
 	if (tcState) *tcState = *tcStateTSVPtr;
 	
 CmtError:
@@ -689,7 +1011,7 @@ int IsTaskTreeInUse_GetLock (TaskControl_type* taskControl, BOOL* inUsePtr, TCSt
 	strcpy(taskTreeRootTC->stateTSVFileName, fileNameDebug);
 	//--------------------------------------------------------
 	
-	*inUsePtr = (*tcStateTSVPtr == TC_State_Idle || *tcStateTSVPtr == TC_State_Running || *tcStateTSVPtr == TC_State_IterationFunctionActive || *tcStateTSVPtr == TC_State_Stopping);
+	*inUsePtr = IsTaskControlStateInUse(*tcStateTSVPtr);
 	if (tcState) *tcState = *tcStateTSVPtr;
 	
 CmtError:
@@ -732,6 +1054,312 @@ Error:
 RETURN_ERR
 }
 
+BOOL IsTaskControllerInUse (TaskControl_type* taskControl, TCStates* tcState)
+{
+	TCStates	state = GetTaskControlState(taskControl, NULL);
+	
+	if (tcState) *tcState = state;
+	
+	return IsTaskControlStateInUse(state);
+}
+
+BOOL IsTaskTreeInUse (TaskControl_type* taskControl, TCStates* tcState)
+{
+	return IsTaskControllerInUse(GetTaskControlRootParent(taskControl), tcState);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller metrics
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void RecordTCLatency (TCLatencyHistogram_type* histogram, double time)
+{
+	double	timeMs		= time * 1e3;
+	double	binEdge		= 1e-3;		// upper edge of bin 0 in [ms]
+	int		binIdx		= 0;
+	
+	while (binIdx < TC_NLatencyBins - 1 && timeMs >= binEdge) {
+		binIdx++;
+		binEdge *= 2;
+	}
+	
+	histogram->bins[binIdx]++;
+	histogram->nCalls++;
+	histogram->totalTime += timeMs;
+	if (timeMs > histogram->maxTime)
+		histogram->maxTime = timeMs;
+}
+
+void GetTaskControlMetrics (TaskControl_type* taskControl, TCLatencyHistogram_type* iterationLatency, TCLatencyHistogram_type* dataReceivedLatency,
+							TCLatencyHistogram_type* controlEventLatency, TCLatencyHistogram_type* iterationJitter)
+{
+	if (iterationLatency)
+		*iterationLatency = taskControl->iterationLatency;
+	
+	if (dataReceivedLatency)
+		*dataReceivedLatency = taskControl->dataReceivedLatency;
+	
+	if (controlEventLatency)
+		*controlEventLatency = taskControl->controlEventLatency;
+	
+	if (iterationJitter)
+		*iterationJitter = taskControl->iterationJitter;
+}
+
+void GetTaskControlDataEventCounts (TaskControl_type* taskControl, unsigned long long* nDataEventsPtr, unsigned long long* nCoalescedDataEventsPtr)
+{
+	if (nDataEventsPtr)
+		*nDataEventsPtr = taskControl->nDataEvents;
+	
+	if (nCoalescedDataEventsPtr)
+		*nCoalescedDataEventsPtr = taskControl->nCoalescedDataEvents;
+}
+
+void ResetTaskControlMetrics (TaskControl_type* taskControl)
+{
+	memset(&taskControl->iterationLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&taskControl->dataReceivedLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&taskControl->controlEventLatency, 0, sizeof(TCLatencyHistogram_type));
+	memset(&taskControl->iterationJitter, 0, sizeof(TCLatencyHistogram_type));
+	taskControl->nDataEvents			= 0;
+	taskControl->nCoalescedDataEvents	= 0;
+}
+
+double GetTCLatencyPercentile (TCLatencyHistogram_type* histogram, double percentile)
+{
+	size_t	nCalls		= 0;
+	double	threshold	= 0;
+	double	binEdge		= 1e-3;		// upper edge of bin 0 in [ms]
+	
+	for (int i = 0; i < TC_NLatencyBins; i++)
+		nCalls += histogram->bins[i];
+	
+	if (!nCalls) return 0;
+	
+	threshold = percentile/100 * nCalls;
+	nCalls = 0;
+	for (int i = 0; i < TC_NLatencyBins - 1; i++) {
+		nCalls += histogram->bins[i];
+		if (nCalls >= threshold) 
+			return (binEdge < histogram->maxTime) ? binEdge : histogram->maxTime;
+		
+		binEdge *= 2;
+	}
+	
+	// last bin has no upper edge
+	return histogram->maxTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Tree dry-run estimate
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void SetTaskControlEstimateIterationFptr (TaskControl_type* taskControl, EstimateIterationFptr_type EstimateIterationFptr)
+{
+	taskControl->EstimateIterationFptr = EstimateIterationFptr;
+}
+
+int EstimateTaskTree (TaskControl_type* taskControl, TCTreeEstimate_type** estimatePtr, char** errorMsg)
+{
+INIT_ERR
+
+	TCTreeEstimate_type*		estimate		= NULL;
+	TCVChanDataEstimate_type*	VChanDataPtr	= NULL;
+	size_t						nVChans			= 0;
+	double						totalBytes		= 0;
+	char*						VChanName		= NULL;
+	char						buff[500]		= "";
+	
+	nullChk( estimate = malloc(sizeof(TCTreeEstimate_type)) );
+	estimate->duration			= 0;
+	estimate->continuous		= FALSE;
+	estimate->VChanData			= 0;
+	estimate->storageBandwidth	= 0;
+	estimate->nOverruns			= 0;
+	estimate->report			= NULL;
+	
+	nullChk( estimate->VChanData = ListCreate(sizeof(TCVChanDataEstimate_type)) );
+	nullChk( estimate->report = StrDup("") );
+	
+	errChk( EstimateTaskTreeBranch(taskControl, 1, 0, estimate, &estimate->duration, &errorInfo.errMsg) );
+	
+	// data volume per Source VChan
+	nVChans = ListNumItems(estimate->VChanData);
+	if (nVChans)
+		nullChk( AppendString(&estimate->report, "\nData per Source VChan:\n", -1) );
+	
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChanDataPtr = ListGetPtrToItem(estimate->VChanData, i);
+		totalBytes += VChanDataPtr->nBytes;
+		nullChk( VChanName = GetVChanName((VChan_type*)VChanDataPtr->srcVChan) );
+		snprintf(buff, sizeof(buff), "%s = %.3f MB\n", VChanName, VChanDataPtr->nBytes/1e6);
+		nullChk( AppendString(&estimate->report, buff, -1) );
+		OKfree(VChanName);
+	}
+	
+	if (estimate->duration > 0)
+		estimate->storageBandwidth = totalBytes/estimate->duration;
+	
+	// summary
+	snprintf(buff, sizeof(buff), "\nTotal duration = %.3f s%s, total data = %.3f MB, storage bandwidth = %.3f MB/s, expected overruns = %u\n", estimate->duration, 
+			 (estimate->continuous)? " (one iteration of continuous TCs)" : "", totalBytes/1e6, estimate->storageBandwidth/1e6, (unsigned int)estimate->nOverruns);
+	nullChk( AppendString(&estimate->report, buff, -1) );
+	
+	*estimatePtr = estimate;
+	return 0;
+	
+Error:
+	
+	OKfree(VChanName);
+	discard_TCTreeEstimate_type(&estimate);
+	
+RETURN_ERR
+}
+
+static int EstimateTaskTreeBranch (TaskControl_type* taskControl, double nParentIterations, size_t depth, TCTreeEstimate_type* estimate, double* branchDuration, char** errorMsg)
+{
+INIT_ERR
+
+	// a finite TC performs at least one iteration, since the executor checks whether all iterations were done only after each iteration
+	double						nIterations			= (taskControl->repeat)? (double)taskControl->repeat : 1;
+	double						iterationDuration	= 0;	// Duration of the iteration function in [s].
+	double						childTCsDuration	= 0;	// Duration in [s] until all child TCs are done.
+	double						childTCDuration		= 0;
+	double						blockDuration		= 0;	// Duration in [s] of the iteration function together with the child TCs.
+	double						iterationPeriod		= 0;	// Time in [s] between the start of consecutive iterations.
+	size_t						nChildTCs			= ListNumItems(taskControl->childTCs);
+	size_t						reportPos			= 0;
+	ListType					VChanData			= 0;
+	TCVChanDataEstimate_type*	VChanDataPtr		= NULL;
+	ChildTCInfo_type*			childTCPtr			= NULL;
+	char*						tcLines				= NULL;
+	char						buff[500]			= "";
+	
+	*branchDuration = 0;
+	
+	// iteration function estimate provided by the module
+	nullChk( VChanData = ListCreate(sizeof(TCVChanDataEstimate_type)) );
+	if (taskControl->EstimateIterationFptr)
+		errChk( (*taskControl->EstimateIterationFptr)(taskControl, &iterationDuration, VChanData, &errorInfo.errMsg) );
+	
+	// a single iteration is estimated for continuous TCs
+	if (taskControl->mode == TASK_CONTINUOUS) {
+		nIterations 			= 1;
+		estimate->continuous	= TRUE;
+	}
+	
+	// child TCs are started with each iteration and run in parallel until they are done
+	reportPos = strlen(estimate->report);
+	for (size_t i = 1; i <= nChildTCs; i++) {
+		childTCPtr = ListGetPtrToItem(taskControl->childTCs, i);
+		errChk( EstimateTaskTreeBranch(childTCPtr->childTC, nParentIterations * nIterations, depth + 1, estimate, &childTCDuration, &errorInfo.errMsg) );
+		if (childTCDuration > childTCsDuration)
+			childTCsDuration = childTCDuration;
+	}
+	
+	switch (taskControl->executionMode) {
+			
+		case TC_Execute_BeforeChildTCs:
+		case TC_Execute_AfterChildTCsComplete:
+			
+			blockDuration = iterationDuration + childTCsDuration;
+			break;
+			
+		case TC_Execute_InParallelWithChildTCs:
+			
+			blockDuration = (iterationDuration > childTCsDuration)? iterationDuration : childTCsDuration;
+			break;
+	}
+	
+	// iterations start at multiples of the wait between iterations from the first iteration, or right away if the previous iteration takes longer
+	iterationPeriod = (blockDuration > taskControl->waitBetweenIterations)? blockDuration : taskControl->waitBetweenIterations;
+	if (nIterations > 0)
+		*branchDuration = (nIterations - 1) * iterationPeriod + blockDuration;
+	
+	// data generated over all runs of the Task Controller
+	for (size_t i = 1; i <= ListNumItems(VChanData); i++) {
+		VChanDataPtr = ListGetPtrToItem(VChanData, i);
+		errChk( AddTCVChanDataEstimate(estimate->VChanData, VChanDataPtr->srcVChan, VChanDataPtr->nBytes * nIterations * nParentIterations) );
+	}
+	
+	//--------------------------------------------------
+	// report
+	//--------------------------------------------------
+	
+	// Task Controller estimate, indented by its depth in the task tree
+	nullChk( tcLines = StrDup("") );
+	for (size_t i = 0; i < depth; i++)
+		nullChk( AppendString(&tcLines, "   ", -1) );
+	
+	if (taskControl->mode == TASK_CONTINUOUS)
+		snprintf(buff, sizeof(buff), "%s: continuous, iteration = %.6g s, child TCs = %.6g s\n", taskControl->taskName, blockDuration, childTCsDuration);
+	else
+		snprintf(buff, sizeof(buff), "%s: %.0f x %.6g s iterations = %.6g s, child TCs = %.6g s\n", taskControl->taskName, nIterations, blockDuration, *branchDuration, childTCsDuration);
+	nullChk( AppendString(&tcLines, buff, -1) );
+	
+	// overruns
+	if (nIterations > 1 && taskControl->waitBetweenIterations > 0 && blockDuration > taskControl->waitBetweenIterations) {
+		estimate->nOverruns++;
+		snprintf(buff, sizeof(buff), "   WARNING: %s iterations take %.6g s which is longer than the %.6g s wait between iterations.\n", taskControl->taskName, blockDuration, taskControl->waitBetweenIterations);
+		nullChk( AppendString(&tcLines, buff, -1) );
+	}
+	
+	if (taskControl->iterTimeout > 0 && iterationDuration > taskControl->iterTimeout) {
+		estimate->nOverruns++;
+		snprintf(buff, sizeof(buff), "   WARNING: %s iteration function takes %.6g s which is longer than its %d s timeout.\n", taskControl->taskName, iterationDuration, taskControl->iterTimeout);
+		nullChk( AppendString(&tcLines, buff, -1) );
+	}
+	
+	if (taskControl->mode == TASK_CONTINUOUS && taskControl->parentTC) {
+		snprintf(buff, sizeof(buff), "   WARNING: %s is continuous and iterations of its parent TC will not complete until it is stopped.\n", taskControl->taskName);
+		nullChk( AppendString(&tcLines, buff, -1) );
+	}
+	
+	// insert Task Controller lines before the lines of its child TCs
+	nullChk( AppendString(&tcLines, estimate->report + reportPos, -1) );
+	estimate->report[reportPos] = 0;
+	nullChk( AppendString(&estimate->report, tcLines, -1) );
+	
+Error:
+	
+	OKfree(tcLines);
+	OKfreeList(&VChanData, NULL);
+	
+RETURN_ERR
+}
+
+void discard_TCTreeEstimate_type (TCTreeEstimate_type** estimatePtr)
+{
+	TCTreeEstimate_type*	estimate = *estimatePtr;
+	
+	if (!estimate) return;
+	
+	OKfreeList(&estimate->VChanData, NULL);
+	OKfree(estimate->report);
+	
+	OKfree(*estimatePtr);
+}
+
+int AddTCVChanDataEstimate (ListType VChanData, SourceVChan_type* srcVChan, double nBytes)
+{
+	size_t						nVChans			= ListNumItems(VChanData);
+	TCVChanDataEstimate_type*	VChanDataPtr	= NULL;
+	TCVChanDataEstimate_type	newVChanData	= {.srcVChan = srcVChan, .nBytes = nBytes};
+	
+	for (size_t i = 1; i <= nVChans; i++) {
+		VChanDataPtr = ListGetPtrToItem(VChanData, i);
+		if (VChanDataPtr->srcVChan == srcVChan) {
+			VChanDataPtr->nBytes += nBytes;
+			return 0;
+		}
+	}
+	
+	if (!ListInsertItem(VChanData, &newVChanData, END_OF_LIST))
+		return -1;
+	
+	return 0;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------------------
 // Task Controller data queue and data exchange functions
 //------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1305,6 +1933,9 @@ static VChanCallbackData_type*	init_VChanCallbackData_type	(TaskControl_type* ta
 	VChanCB->taskControl  			= taskControl;
 	VChanCB->DataReceivedFptr		= DataReceivedFptr;
 	VChanCB->itemsInQueueCBID		= itemsInQueueCBID;
+	VChanCB->dataEventPending		= FALSE;
+	VChanCB->dataArrived			= FALSE;
+	VChanCB->nQueuedPackets			= -1;
 	
 	return VChanCB;
 }
@@ -1431,207 +2062,706 @@ static char* EventToString (TCEvents event)
 	
 }
 
-static char* FCallToString (TCCallbacks fcall)
+static char* FCallToString (TCCallbacks fcall)
+{
+	switch (fcall) {
+		
+		case TC_Callback_Configure:
+			
+			return StrDup("FCall Configure");
+			
+		case TC_Callback_Unconfigure:
+			
+			return StrDup("FCall Unconfigure");
+		
+		case TC_Callback_Iterate:
+			
+			return StrDup("FCall Iterate");
+			
+		case TC_Callback_Start:
+			
+			return StrDup("FCall Start");
+			
+		case TC_Callback_Reset:
+			
+			return StrDup("FCall Reset");
+			
+		case TC_Callback_Done:
+			
+			return StrDup("FCall Done");
+			
+		case TC_Callback_Stopped:
+			
+			return StrDup("FCall Stopped");
+			
+		case TC_Callback_IterationStop:
+			
+			return StrDup("FCall Iteration Stop");
+			
+		case TASK_FCALL_TASK_TREE_STATUS:
+			
+			return StrDup("FCall Task Tree Status");
+			
+		case TASK_FCALL_SET_UITC_MODE:
+			
+			return StrDup("FCall Set UITC Mode");
+			
+		case TC_Callback_DataReceived:
+			
+			return StrDup("FCall Data Received");
+			
+		case TC_Callback_CustomEvent:
+			
+			return StrDup("FCall Module Event");
+			
+		case TC_Callback_Error:
+			
+			return StrDup("FCall Error");
+			
+	}
+	
+}
+
+static void ExecutionLogEntry (TaskControl_type* taskControl, EventPacket_type* eventPacket, TaskControllerActions action, void* info)
+{
+	TCTraceRecord_type*		record			= NULL;
+	ChildTCInfo_type*		childTCPtr		= NULL;
+	size_t					tracePos		= 0;
+	
+	if (!TCTracingEnabled && !taskControl->loggingEnabled) return;
+	
+	// reserve a trace record
+	tracePos 	= (size_t)(ULONG)InterlockedIncrement(&TCTraceWritePos) - 1;
+	record		= &TCTraceBuffer[tracePos & (TC_TraceBufferSize - 1)];
+	
+	// mark record as being written
+	record->seq = 0;
+	MemoryBarrier();
+	
+	record->time			= Timer();
+	record->traceID			= taskControl->traceID;
+	record->threadID		= CmtGetCurrentThreadID();
+	record->action			= action;
+	record->hasEvent		= (eventPacket != NULL);
+	record->event			= (eventPacket) ? eventPacket->event : TC_Event_Unconfigure;
+	record->oldState		= taskControl->oldState;
+	record->newState		= taskControl->currentState;
+	record->info			= 0;
+	record->iterIdx			= GetCurrentIterIndex(taskControl->currentIter);
+	record->childName[0]	= 0;
+	strncpy(record->tcName, (taskControl->taskName) ? taskControl->taskName : "No name", TC_TraceNameLength - 1);
+	record->tcName[TC_TraceNameLength - 1] = 0;
+	
+	switch (action) {
+			
+		case FUNCTION_CALL:
+		case FUNCTION_CALL_DONE:
+			
+			record->info = *(TCCallbacks*)info;
+			break;
+			
+		case CHILD_TASK_STATE_UPDATE:
+			
+			// the child TC state change is recorded instead of the state of this Task Controller
+			record->info	= (int)((ChildTCEventInfo_type*)eventPacket->eventData)->childTCIdx;
+			childTCPtr		= ListGetPtrToItem(taskControl->childTCs, record->info);
+			record->oldState = childTCPtr->previousChildTCState;
+			record->newState = childTCPtr->childTCState;
+			strncpy(record->childName, (childTCPtr->childTC->taskName) ? childTCPtr->childTC->taskName : "No name", TC_TraceNameLength - 1);
+			record->childName[TC_TraceNameLength - 1] = 0;
+			break;
+			
+		default:
+			
+			break;
+	}
+	
+	// mark record as complete
+	MemoryBarrier();
+	record->seq = (LONG)(ULONG)(tracePos + 1);
+}
+
+/// HIFN Copies a complete trace record from a given 0-based trace position. Returns TRUE if successful, and FALSE if the record is being written or has been overwritten.
+static BOOL ReadTraceRecord (size_t tracePos, TCTraceRecord_type* record)
+{
+	TCTraceRecord_type*		slot	= &TCTraceBuffer[tracePos & (TC_TraceBufferSize - 1)];
+	LONG					seq		= slot->seq;
+	
+	if ((size_t)(ULONG)seq != tracePos + 1) return FALSE;
+	
+	MemoryBarrier();
+	memcpy((void*)record, (void*)slot, sizeof(TCTraceRecord_type));
+	MemoryBarrier();
+	
+	return (slot->seq == seq);
+}
+
+/// HIFN Returns TRUE if the trace record at a given 0-based trace position has not yet been completed by the thread writing it.
+static BOOL TraceRecordPending (size_t tracePos)
+{
+	ULONG	seq = (ULONG)TCTraceBuffer[tracePos & (TC_TraceBufferSize - 1)].seq;
+	
+	// records are numbered consecutively, an older sequence number means that the record was reserved but not yet written
+	return ((size_t)seq < tracePos + 1);
+}
+
+static char* FormatTraceRecord (TCTraceRecord_type* record, double startTime)
+{
+	char*	oldStateName	= TaskControlStateToString(record->oldState);
+	char*	newStateName	= TaskControlStateToString(record->newState);
+	char*	eventName		= (record->hasEvent) ? EventToString(record->event) : StrDup("none");
+	char*	actionName		= NULL;
+	char*	fCallName		= NULL;
+	char*	line			= NULL;
+	int		nChars			= 0;
+	
+	switch (record->action) {
+			
+		case STATE_CHANGE:
+			actionName = StrDup("State change");
+			break;
+			
+		case FUNCTION_CALL:
+			actionName = FCallToString(record->info);
+			break;
+			
+		case FUNCTION_CALL_DONE:
+			fCallName = FCallToString(record->info);
+			nChars = snprintf(NULL, 0, "%s done", fCallName);
+			if ( (actionName = malloc((nChars + 1) * sizeof(char))) )
+				snprintf(actionName, nChars + 1, "%s done", fCallName);
+			OKfree(fCallName);
+			break;
+			
+		case CHILD_TASK_STATE_UPDATE:
+			nChars = snprintf(NULL, 0, "Child state change, %s", record->childName);
+			if ( (actionName = malloc((nChars + 1) * sizeof(char))) )
+				snprintf(actionName, nChars + 1, "Child state change, %s", record->childName);
+			break;
+			
+		case ITERATION_START:
+			actionName = StrDup("Iteration start");
+			break;
+			
+		case ITERATION_DONE:
+			actionName = StrDup("Iteration done");
+			break;
+	}
+	
+	if (!oldStateName || !newStateName || !eventName || !actionName) goto Error;
+	
+	nChars = snprintf(NULL, 0, "%.6f  %s,  (iteration: %llu), (state: %s->%s),  (event: %s),  (action: %s)\n", record->time - startTime, record->tcName, 
+					  (unsigned long long)record->iterIdx, oldStateName, newStateName, eventName, actionName);
+	if ( (line = malloc((nChars + 1) * sizeof(char))) )
+		snprintf(line, nChars + 1, "%.6f  %s,  (iteration: %llu), (state: %s->%s),  (event: %s),  (action: %s)\n", record->time - startTime, record->tcName, 
+				 (unsigned long long)record->iterIdx, oldStateName, newStateName, eventName, actionName);
+	
+Error:
+	
+	OKfree(oldStateName);
+	OKfree(newStateName);
+	OKfree(eventName);
+	OKfree(actionName);
+	
+	return line;
+}
+
+/// HIFN Writes a string to a JSON file as a quoted and escaped JSON string.
+static void WriteJSONString (FILE* file, char string[])
+{
+	fputc('"', file);
+	for (char* c = string; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			fputc('\\', file);
+		
+		if ((unsigned char)*c >= 0x20)
+			fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller event queue
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static BOOL InitTCEventLane (TCEventLane_type* lane)
+{
+	if (!(lane->cells = malloc(TC_NEventQueueItems * sizeof(TCEventCell_type)))) return FALSE;
+	
+	for (LONG i = 0; i < TC_NEventQueueItems; i++)
+		lane->cells[i].seq = i;
+	
+	lane->writePos	= 0;
+	lane->readPos	= 0;
+	lane->nEvents	= 0;
+	
+	return TRUE;
+}
+
+static void DiscardTCEventLane (TCEventLane_type* lane)
+{
+	EventPacket_type	eventPacket;
+	
+	if (!lane->cells) return;
+	
+	// discard data of events that were not processed
+	while (ReadTCEventLane(lane, &eventPacket, NULL))
+		if (eventPacket.eventData && eventPacket.discardEventDataFptr)
+			(*eventPacket.discardEventDataFptr)(&eventPacket.eventData);
+		else
+			OKfree(eventPacket.eventData);
+	
+	OKfree(lane->cells);
+}
+
+static BOOL WriteTCEventLane (TCEventLane_type* lane, EventPacket_type* eventPacket)
+{
+	if (!ReserveTCEventLane(lane)) return FALSE;
+	
+	WriteReservedTCEventLane(lane, eventPacket);
+	
+	return TRUE;
+}
+
+/// HIFN Reserves room for one event in the lane. Returns FALSE if the lane is full. The reserved room must be used by WriteReservedTCEventLane or released by CancelTCEventLaneReservation.
+static BOOL ReserveTCEventLane (TCEventLane_type* lane)
+{
+	if (InterlockedIncrement(&lane->nEvents) <= TC_NEventQueueItems) return TRUE;
+	
+	InterlockedDecrement(&lane->nEvents);
+	return FALSE;
+}
+
+static void CancelTCEventLaneReservation (TCEventLane_type* lane)
+{
+	InterlockedDecrement(&lane->nEvents);
+}
+
+static void WriteReservedTCEventLane (TCEventLane_type* lane, EventPacket_type* eventPacket)
+{
+	TCEventCell_type*	cell	= NULL;
+	LONG				pos		= lane->writePos;
+	
+	// take the cell at the write position by advancing the write position once the cell was read
+	// Note: since room was reserved, the cell at the write position is read or is about to be released by the reader.
+	// Lane positions wrap around and are compared using unsigned arithmetic.
+	for (;;) {
+		cell = &lane->cells[(ULONG)pos & (TC_NEventQueueItems - 1)];
+		MemoryBarrier();
+		if (cell->seq == pos && InterlockedCompareExchange(&lane->writePos, (LONG)((ULONG)pos + 1), pos) == pos) break;
+		
+		pos = lane->writePos;
+	}
+	
+	cell->queuedTime	= Timer();
+	cell->eventPacket	= *eventPacket;
+	
+	// publish event
+	MemoryBarrier();
+	cell->seq = (LONG)((ULONG)pos + 1);
+}
+
+static BOOL ReadTCEventLane (TCEventLane_type* lane, EventPacket_type* eventPacket, double* queuedTimePtr)
+{
+	LONG				pos		= lane->readPos;
+	TCEventCell_type*	cell	= &lane->cells[(ULONG)pos & (TC_NEventQueueItems - 1)];
+	
+	MemoryBarrier();
+	if ((LONG)((ULONG)cell->seq - ((ULONG)pos + 1)) < 0) return FALSE; // no event was published at the read position
+	
+	*eventPacket = cell->eventPacket;
+	if (queuedTimePtr)
+		*queuedTimePtr = cell->queuedTime;
+	
+	// release cell for writing after the lane wraps around
+	MemoryBarrier();
+	cell->seq 		= (LONG)((ULONG)pos + TC_NEventQueueItems);
+	lane->readPos	= (LONG)((ULONG)pos + 1);
+	InterlockedDecrement(&lane->nEvents);
+	
+	return TRUE;
+}
+
+static BOOL TCEventLaneIsEmpty (TCEventLane_type* lane)
+{
+	LONG	pos	= lane->readPos;
+	
+	MemoryBarrier();
+	return (LONG)((ULONG)lane->cells[(ULONG)pos & (TC_NEventQueueItems - 1)].seq - ((ULONG)pos + 1)) < 0;
+}
+
+static TCEventLanes GetTCEventLane (TCEvents event)
+{
+	switch (event) {
+			
+		case TC_Event_Iterate:
+		case TC_Event_IterationDone:
+		case TC_Event_IterationTimeout:
+			return TC_EventLane_Iteration;
+			
+		case TC_Event_DataReceived:
+			return TC_EventLane_Data;
+			
+		default:
+			return TC_EventLane_Control;
+	}
+}
+
+static BOOL QueueTaskControlEvent (TaskControl_type* taskControl, EventPacket_type* eventPacket)
+{
+	if (!WriteTCEventLane(&taskControl->eventLanes[GetTCEventLane(eventPacket->event)], eventPacket)) return FALSE;
+	
+	LaunchTaskEventHandler(taskControl);
+	
+	return TRUE;
+}
+
+static BOOL ReadTaskControlEvent (TaskControl_type* taskControl, EventPacket_type* eventPacket)
+{
+	double	queuedTime	= 0;
+	
+	// read from the lane with the highest priority that has events
+	for (int i = 0; i < TC_NEventLanes; i++)
+		if (ReadTCEventLane(&taskControl->eventLanes[i], eventPacket, &queuedTime)) {
+			if (i == TC_EventLane_Control)
+				RecordTCLatency(&taskControl->controlEventLatency, Timer() - queuedTime);
+			
+			return TRUE;
+		}
+	
+	return FALSE;
+}
+
+static BOOL TaskControlEventPending (TaskControl_type* taskControl)
+{
+	for (int i = 0; i < TC_NEventLanes; i++)
+		if (!TCEventLaneIsEmpty(&taskControl->eventLanes[i])) return TRUE;
+	
+	return FALSE;
+}
+
+static void LaunchTaskEventHandler (TaskControl_type* taskControl)
+{
+	// launch event handler in new thread if it is not active already
+	if (InterlockedCompareExchange(&taskControl->eventHandlerActive, TRUE, FALSE) != FALSE) return;
+	
+	if (CmtScheduleThreadPoolFunctionAdv(taskControl->threadPoolHndl, ScheduleTaskEventHandler, taskControl, DEFAULT_THREAD_PRIORITY, DLThreadPoolFunctionCallback, 
+										 EVENT_TP_THREAD_FUNCTION_BEGIN, NULL, RUN_IN_SCHEDULED_THREAD, NULL) < 0)
+		InterlockedExchange(&taskControl->eventHandlerActive, FALSE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller timer service
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/// HIFN Adds a user to the timer service and starts the timer thread for the first user.
+static int StartTCTimerService (void)
+{
+INIT_ERR
+
+	LARGE_INTEGER	frequency;
+	
+	if (++TCTimerNUsers > 1) return 0;
+	
+	QueryPerformanceFrequency(&frequency);
+	TCTimerFrequency	= frequency.QuadPart;
+	TCTimerQuit			= FALSE;
+	
+	errChk( CmtNewLock(NULL, 0, &TCTimerLock) );
+	nullChk( TCTimerWakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL) );
+	nullChk( TCTimerWaitableTimer = CreateTCWaitableTimer() );
+	// the timer thread waits most of the time, but it runs for as long as the timer service is used, thus it gets its own thread instead of occupying a thread of the default thread pool
+	errChk( CmtNewThreadPool(1, &TCTimerThreadPool) );
+	errChk( CmtScheduleThreadPoolFunctionAdv(TCTimerThreadPool, TCTimerThread, NULL, THREAD_PRIORITY_HIGHEST, NULL, 0, NULL, RUN_IN_SCHEDULED_THREAD, &TCTimerThreadID) );
+	
+	return 0;
+	
+Error:
+	
+	StopTCTimerService();
+	
+	return errorInfo.error;
+}
+
+/// HIFN Removes a user from the timer service and stops the timer thread when there are no more users.
+static void StopTCTimerService (void)
+{
+	if (--TCTimerNUsers > 0) return;
+	
+	if (TCTimerThreadID) {
+		InterlockedExchange(&TCTimerQuit, TRUE);
+		SetEvent(TCTimerWakeEvent);
+		CmtWaitForThreadPoolFunctionCompletion(TCTimerThreadPool, TCTimerThreadID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+		CmtReleaseThreadPoolFunctionID(TCTimerThreadPool, TCTimerThreadID);
+		TCTimerThreadID = 0;
+	}
+	
+	if (TCTimerThreadPool) {
+		CmtDiscardThreadPool(TCTimerThreadPool);
+		TCTimerThreadPool = 0;
+	}
+	
+	if (TCTimerWaitableTimer) {
+		CloseHandle(TCTimerWaitableTimer);
+		TCTimerWaitableTimer = NULL;
+	}
+	
+	if (TCTimerWakeEvent) {
+		CloseHandle(TCTimerWakeEvent);
+		TCTimerWakeEvent = NULL;
+	}
+	
+	if (TCTimerLock) {
+		CmtDiscardLock(TCTimerLock);
+		TCTimerLock = 0;
+	}
+	
+	OKfree(TCTimerHeap);
+	TCTimerHeapSize		= 0;
+	TCTimerHeapCount	= 0;
+	TCTimerNUsers		= 0;
+}
+
+/// HIFN Creates the waitable timer of the timer thread. High resolution waitable timers, available from Windows 10 version 1803, elapse within about 0.5 ms of
+/// HIFN their due time. On older systems a regular waitable timer is created, whose resolution is that of the system timer.
+static HANDLE CreateTCWaitableTimer (void)
+{
+	typedef HANDLE (WINAPI *CreateWaitableTimerExWFptr_type) (LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD, DWORD);
+	
+	CreateWaitableTimerExWFptr_type		CreateWaitableTimerExWFptr	= (CreateWaitableTimerExWFptr_type) GetProcAddress(GetModuleHandleA("kernel32.dll"), "CreateWaitableTimerExW");
+	HANDLE								waitableTimer				= NULL;
+	
+	if (CreateWaitableTimerExWFptr)
+		waitableTimer = (*CreateWaitableTimerExWFptr) (NULL, NULL, TC_CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TC_TIMER_ALL_ACCESS);
+	
+	if (!waitableTimer)
+		waitableTimer = CreateWaitableTimer(NULL, FALSE, NULL);
+	
+	return waitableTimer;
+}
+
+static LONGLONG GetTCTimerTicks (void)
+{
+	LARGE_INTEGER	ticks;
+	
+	QueryPerformanceCounter(&ticks);
+	
+	return ticks.QuadPart;
+}
+
+/// HIFN Starts a Task Controller timer that elapses at the given deadline in performance counter ticks. If the timer was already started, it is restarted.
+/// HIFN Must be called from the Task Controller event handler. Starting and cancelling a timer takes O(log n) time for n started timers.
+static int StartTCTimer (TaskControl_type* taskControl, TCTimers timer, LONGLONG deadline)
 {
-	switch (fcall) {
-		
-		case TC_Callback_Configure:
-			
-			return StrDup("FCall Configure");
-			
-		case TC_Callback_Unconfigure:
-			
-			return StrDup("FCall Unconfigure");
+#define StartTCTimer_Err_OutOfMemory	-1
+INIT_ERR
+
+	TCTimerEntry_type	entry;
+	TCTimerEntry_type*	heap			= NULL;
+	BOOL				lockObtained	= FALSE;
+	
+	entry.taskControl	= taskControl;
+	entry.timer			= timer;
+	entry.generation	= InterlockedIncrement(&taskControl->timerGeneration[timer]);
+	entry.deadline		= deadline;
+	
+	CmtErrChk( CmtGetLock(TCTimerLock) );
+	lockObtained = TRUE;
+	
+	// remove timer if it was already started
+	if (taskControl->timerHeapIdx[timer] != TC_TimerNotStarted)
+		RemoveTCTimerHeap(taskControl->timerHeapIdx[timer]);
+	
+	if (TCTimerHeapCount == TCTimerHeapSize) {
+		if (!(heap = realloc(TCTimerHeap, (2 * TCTimerHeapSize + 16) * sizeof(TCTimerEntry_type))))
+			SET_ERR(StartTCTimer_Err_OutOfMemory, "Out of memory.");
 		
-		case TC_Callback_Iterate:
-			
-			return StrDup("FCall Iterate");
-			
-		case TC_Callback_Start:
-			
-			return StrDup("FCall Start");
-			
-		case TC_Callback_Reset:
-			
-			return StrDup("FCall Reset");
-			
-		case TC_Callback_Done:
-			
-			return StrDup("FCall Done");
-			
-		case TC_Callback_Stopped:
-			
-			return StrDup("FCall Stopped");
-			
-		case TC_Callback_IterationStop:
-			
-			return StrDup("FCall Iteration Stop");
-			
-		case TASK_FCALL_TASK_TREE_STATUS:
-			
-			return StrDup("FCall Task Tree Status");
-			
-		case TASK_FCALL_SET_UITC_MODE:
-			
-			return StrDup("FCall Set UITC Mode");
-			
-		case TC_Callback_DataReceived:
-			
-			return StrDup("FCall Data Received");
-			
-		case TC_Callback_CustomEvent:
-			
-			return StrDup("FCall Module Event");
-			
-		case TC_Callback_Error:
-			
-			return StrDup("FCall Error");
-			
+		TCTimerHeap		= heap;
+		TCTimerHeapSize	= 2 * TCTimerHeapSize + 16;
 	}
 	
+	PushTCTimerHeap(&entry);
+	
+	// wake up the timer thread if this is the earliest deadline
+	if (!taskControl->timerHeapIdx[timer])
+		SetEvent(TCTimerWakeEvent);
+	
+CmtError:
+	
+Cmt_ERR
+
+Error:
+	
+	if (lockObtained)
+		CmtReleaseLock(TCTimerLock);
+	
+	return errorInfo.error;
 }
 
-static void ExecutionLogEntry (TaskControl_type* taskControl, EventPacket_type* eventPacket, TaskControllerActions action, void* info)
+/// HIFN Cancels a Task Controller timer. Timer events that were already posted by the cancelled timer are ignored by the event handler.
+static void CancelTCTimer (TaskControl_type* taskControl, TCTimers timer)
 {
-	if (!taskControl->loggingEnabled) return;
-		
-	ChildTCInfo_type*	childTCPtr		= NULL;
-	char* 				output 			= StrDup("");
-	char*				eventName		= NULL;
-	char*				stateName		= NULL;
-	char*				fCallName		= NULL;
-	char    			buf[50]			= "";
-	
-	//---------------------------------------------------------------
-	// Task Controller Name
-	//---------------------------------------------------------------
-	if (taskControl->taskName)
-		AppendString(&output, taskControl->taskName, -1);
-	else
-		AppendString(&output, "No name", -1);
-	
-	//---------------------------------------------------------------  
-	// Iteration index
-	//---------------------------------------------------------------  
-	AppendString(&output, ",  ", -1);
-	Fmt(buf, "%s<(iteration: %d)", GetCurrentIterIndex(taskControl->currentIter));
-	AppendString(&output, buf, -1);
-	
-	//---------------------------------------------------------------
-	// Task Controller state
-	//---------------------------------------------------------------
-	AppendString(&output, ", (state: ", -1);
-	// if this is a state change, then print old state as well
-	if (action == STATE_CHANGE) {
-		AppendString(&output, (stateName = TaskControlStateToString(taskControl->oldState)), -1);
-		OKfree(stateName);
-		AppendString(&output, "->", -1);
-	}
-	AppendString(&output, (stateName = TaskControlStateToString(taskControl->currentState)), -1);
-	OKfree(stateName);
-	AppendString(&output, ")", -1);
+	InterlockedIncrement(&taskControl->timerGeneration[timer]);
 	
-	//---------------------------------------------------------------
-	// Event Name
-	//---------------------------------------------------------------
-	AppendString(&output, ",  (event: ", -1);
+	// the timer thread may only remove the timer from the heap meanwhile, therefore the heap needs to be locked only if the timer was started
+	if (taskControl->timerHeapIdx[timer] == TC_TimerNotStarted) return;
 	
-	AppendString(&output, (eventName = EventToString(eventPacket->event)), -1);
-	OKfree(eventName);
-	AppendString(&output, ")", -1);
+	CmtGetLock(TCTimerLock);
+	if (taskControl->timerHeapIdx[timer] != TC_TimerNotStarted)
+		RemoveTCTimerHeap(taskControl->timerHeapIdx[timer]);
+	CmtReleaseLock(TCTimerLock);
+}
+
+/// HIFN Places a timer entry in the heap at the given index and updates the heap index of the timer.
+static void SetTCTimerHeapEntry (size_t idx, TCTimerEntry_type* entry)
+{
+	TCTimerHeap[idx] = *entry;
+	entry->taskControl->timerHeapIdx[entry->timer] = idx;
+}
+
+static void PushTCTimerHeap (TCTimerEntry_type* entry)
+{
+	size_t				idx		= TCTimerHeapCount++;
+	size_t				parent	= 0;
+	
+	while (idx) {
+		parent = (idx - 1) / 2;
+		if (TCTimerHeap[parent].deadline <= entry->deadline) break;
+		SetTCTimerHeapEntry(idx, &TCTimerHeap[parent]);
+		idx = parent;
+	}
 	
-	//---------------------------------------------------------------  
-	// Action
-	//---------------------------------------------------------------  
-	AppendString(&output, ",  (action: ", -1);
-	switch (action) {
-		
-		case STATE_CHANGE:		  
+	SetTCTimerHeapEntry(idx, entry);
+}
+
+static void RemoveTCTimerHeap (size_t idx)
+{
+	TCTimerEntry_type	last	= TCTimerHeap[--TCTimerHeapCount];
+	size_t				parent	= 0;
+	size_t				child	= 0;
 	
-			AppendString(&output, "State change", -1);
-			break;
-		
-		case FUNCTION_CALL:
-			
-			AppendString(&output, (fCallName = FCallToString(*(TCCallbacks*)info)), -1);
-			OKfree(fCallName)
-			break;
-			
-		case CHILD_TASK_STATE_UPDATE:
-			
-			AppendString(&output, "Child state change", -1); 
-			break;
-	}
-	AppendString(&output, ")", -1);  
+	TCTimerHeap[idx].taskControl->timerHeapIdx[TCTimerHeap[idx].timer] = TC_TimerNotStarted;
 	
-	//---------------------------------------------------------------
-	// ChildTC Controller States
-	//---------------------------------------------------------------
-	AppendString(&output, ",  (child states: {", -1);
-	size_t	nChildTCs	= ListNumItems(taskControl->childTCs);
-	for (size_t i = 1; i <= nChildTCs; i++) {
-		childTCPtr = ListGetPtrToItem(taskControl->childTCs, i);
-		AppendString(&output, "(", -1);
-		// Task Controller Name
-		if (childTCPtr->childTC->taskName)
-			AppendString(&output, childTCPtr->childTC->taskName, -1);
-		else
-			AppendString(&output, "No name", -1);
-		
-		AppendString(&output, ", ", -1);
-		// if childTC state change event occurs, print also previous state of the childTC that changed
-		if (action == CHILD_TASK_STATE_UPDATE)
-			if (((ChildTCEventInfo_type*)eventPacket->eventData)->childTCIdx == i){
-				AppendString(&output, (stateName = TaskControlStateToString(childTCPtr->previousChildTCState)), -1);
-				OKfree(stateName);
-				AppendString(&output, "->", -1);
-			}
-				
-		AppendString(&output, (stateName = TaskControlStateToString(childTCPtr->childTCState)), -1);
-		OKfree(stateName);
-		AppendString(&output, ")", -1);
-		if (i < nChildTCs)
-			AppendString(&output, ", ", -1);
+	if (idx == TCTimerHeapCount) return;
+	
+	// move entries with later deadlines down until the last entry fits
+	while (idx) {
+		parent = (idx - 1) / 2;
+		if (TCTimerHeap[parent].deadline <= last.deadline) break;
+		SetTCTimerHeapEntry(idx, &TCTimerHeap[parent]);
+		idx = parent;
 	}
-	AppendString(&output, "})", -1);  	
 	
-	AppendString(&output, "\n", -1);
+	// move entries with earlier deadlines up until the last entry fits
+	while ((child = 2 * idx + 1) < TCTimerHeapCount) {
+		if (child + 1 < TCTimerHeapCount && TCTimerHeap[child + 1].deadline < TCTimerHeap[child].deadline)
+			child++;
+		if (last.deadline <= TCTimerHeap[child].deadline) break;
+		SetTCTimerHeapEntry(idx, &TCTimerHeap[child]);
+		idx = child;
+	}
 	
-	SetCtrlVal(taskControl->logPanHandle, taskControl->logBoxControlID, output);
-	OKfree(output);
+	SetTCTimerHeapEntry(idx, &last);
 }
 
-void CVICALLBACK TaskEventItemsInQueue (CmtTSQHandle queueHandle, unsigned int event, int value, void *callbackData)
+/// HIFN Returns TRUE if the event was posted by a timer that was cancelled or restarted after it elapsed.
+static BOOL IsStaleTCTimerEvent (TaskControl_type* taskControl, EventPacket_type* eventPacket)
 {
-	// Don't use the value parameter! It will be 0 when the function is called manually
-	//
-	// assigned to main thread which the same as the thread in which the Task Controller
-	// state machine was created.
+	TCTimers	timer;
 	
-	TaskControl_type* 	taskControl 		= callbackData;
-	int					ExecutionStatus		= kCmtThreadFunctionComplete;
+	switch (eventPacket->event) {
+		case TC_Event_Iterate:
+			timer = TC_Timer_IterationWait;
+			break;
+		case TC_Event_IterationTimeout:
+			timer = TC_Timer_IterationTimeout;
+			break;
+		default:
+			return FALSE;
+	}
 	
-	// launch event handler in new thread if it is not running already
-	if (taskControl->threadFunctionID)
-		CmtGetThreadPoolFunctionAttribute(taskControl->threadPoolHndl, taskControl->threadFunctionID, 
-									  ATTR_TP_FUNCTION_EXECUTION_STATUS, &ExecutionStatus);
+	// only timer events carry the timer generation
+	if (!eventPacket->eventData) return FALSE;
 	
-	if (ExecutionStatus == kCmtThreadFunctionComplete) {
-		if (taskControl->threadFunctionID) CmtReleaseThreadPoolFunctionID(taskControl->threadPoolHndl, taskControl->threadFunctionID);
-		CmtScheduleThreadPoolFunctionAdv(taskControl->threadPoolHndl, ScheduleTaskEventHandler, taskControl, 
-									 	 DEFAULT_THREAD_PRIORITY, NULL, 
-									 	 (EVENT_TP_THREAD_FUNCTION_BEGIN | EVENT_TP_THREAD_FUNCTION_END), 
-										 taskControl, RUN_IN_SCHEDULED_THREAD, &taskControl->threadFunctionID);	
+	return *(LONG*)eventPacket->eventData != taskControl->timerGeneration[timer];
+}
+
+/// HIFN Posts timer events to Task Controllers when their deadlines elapse. Between deadlines the thread waits on a waitable timer set to the next deadline
+/// HIFN and on the wake event signalled when an earlier deadline is started. A timer event that does not fit in the event queue of its Task Controller is
+/// HIFN posted again after TC_TimerRetryInterval for as long as the timer is not cancelled, so that the iteration it starts or the timeout it reports is not lost.
+int CVICALLBACK TCTimerThread (void* functionData)
+{
+	HANDLE				waitHandles[2]	= {TCTimerWakeEvent, TCTimerWaitableTimer};
+	TCTimerEntry_type	entry;
+	LONG*				generationPtr	= NULL;
+	LONGLONG			now				= 0;
+	LONGLONG			remaining		= 0;
+	LARGE_INTEGER		dueTime;
+	
+	while (!TCTimerQuit) {
+		
+		CmtGetLock(TCTimerLock);
+		
+		// post events for elapsed timers
+		now = GetTCTimerTicks();
+		while (TCTimerHeapCount && TCTimerHeap[0].deadline <= now) {
+			entry = TCTimerHeap[0];
+			RemoveTCTimerHeap(0);
+			
+			if (entry.generation != entry.taskControl->timerGeneration[entry.timer]) continue;
+			
+			if ( (generationPtr = malloc(sizeof(LONG))) ) {
+				*generationPtr = entry.generation;
+				if (TaskControlEvent(entry.taskControl, (entry.timer == TC_Timer_IterationWait) ? TC_Event_Iterate : TC_Event_IterationTimeout, 
+									 (void**)&generationPtr, NULL, NULL) >= 0) continue;
+			}
+			
+			// retry later, there is room in the heap for the timer since it was just removed
+			entry.deadline = now + (LONGLONG)(TC_TimerRetryInterval * TCTimerFrequency);
+			PushTCTimerHeap(&entry);
+		}
+		
+		remaining = TCTimerHeapCount ? TCTimerHeap[0].deadline - now : -1;
+		
+		CmtReleaseLock(TCTimerLock);
+		
+		if (remaining < 0) {
+			WaitForSingleObject(TCTimerWakeEvent, INFINITE);
+			continue;
+		}
+		
+		// due time in 100 ns units, negative values being relative to the current time
+		dueTime.QuadPart = -(LONGLONG)((double)remaining * 1e7 / TCTimerFrequency);
+		if (!dueTime.QuadPart) dueTime.QuadPart = -1;
+		
+		if (SetWaitableTimer(TCTimerWaitableTimer, &dueTime, 0, NULL, NULL, FALSE))
+			WaitForMultipleObjects(NumElem(waitHandles), waitHandles, FALSE, INFINITE);
+		else
+			WaitForSingleObject(TCTimerWakeEvent, (DWORD)(remaining * 1e3 / TCTimerFrequency) + 1);
 	}
+	
+	return 0;
 }
 
 void CVICALLBACK TaskDataItemsInQueue (CmtTSQHandle queueHandle, unsigned int event, int value, void *callbackData)
 {
 INIT_ERR
 
+	// Don't use the value parameter! It will be 0 when the function is called manually
+	
 	VChanCallbackData_type*		VChanTSQData		= callbackData;
 	VChanCallbackData_type*		VChanTSQDataCopy	= NULL;
 	
+	// coalesce data received events: if an event for this Sink VChan is pending, only flag that new data arrived
+	InterlockedExchange(&VChanTSQData->dataArrived, TRUE);
+	if (InterlockedCompareExchange(&VChanTSQData->dataEventPending, TRUE, FALSE) != FALSE) {
+		VChanTSQData->taskControl->nCoalescedDataEvents++;
+		return;
+	}
+	
+	InterlockedExchange(&VChanTSQData->dataArrived, FALSE);
+	VChanTSQData->taskControl->nDataEvents++;
+	
 	nullChk( VChanTSQDataCopy = init_VChanCallbackData_type(VChanTSQData->taskControl, VChanTSQData->sinkVChan, VChanTSQData->DataReceivedFptr, VChanTSQData->itemsInQueueCBID) );
 	
 	// inform Task Controller that data was placed in an otherwise empty data queue
@@ -1644,20 +2774,52 @@ Error:
 	// flush queue
 	discard_VChanCallbackData_type(&VChanTSQDataCopy);
 	CmtFlushTSQ(GetSinkVChanTSQHndl(VChanTSQData->sinkVChan), TSQ_FLUSH_ALL, NULL);
+	InterlockedExchange(&VChanTSQData->dataEventPending, FALSE);
 	VChanTSQData->taskControl->errorMsg = FormatMsg(errorInfo.error, __FILE__, __func__, errorInfo.line, "Out of memory.");
 	VChanTSQData->taskControl->errorID	= errorInfo.error;
 	EventPacket_type	eventPacket = {.event = TC_Event_DataReceived, .eventData = NULL, .discardEventDataFptr = NULL};
 	ChangeState(VChanTSQData->taskControl, &eventPacket, TC_State_Error); 
 }
 
+static void DataReceivedEventDone (TaskControl_type* taskControl, VChanCallbackData_type* eventCBData)
+{
+	size_t						nItems			= ListNumItems(taskControl->dataQs);
+	VChanCallbackData_type*		VChanCBData		= NULL;
+	CmtTSQHandle				tsqID			= GetSinkVChanTSQHndl(eventCBData->sinkVChan);
+	int							nPackets		= 0;
+	BOOL						dataArrived		= FALSE;
+	
+	for (size_t i = 1; i <= nItems; i++) {
+		VChanCBData = *(VChanCallbackData_type**)ListGetPtrToItem(taskControl->dataQs, i);
+		if (VChanCBData->sinkVChan != eventCBData->sinkVChan) continue;
+		
+		InterlockedExchange(&VChanCBData->dataEventPending, FALSE);
+		dataArrived = InterlockedExchange(&VChanCBData->dataArrived, FALSE);
+		CmtGetTSQAttribute(tsqID, ATTR_TSQ_ITEMS_IN_QUEUE, &nPackets);
+		
+		if (nPackets && (dataArrived || (eventCBData->nQueuedPackets >= 0 && nPackets < eventCBData->nQueuedPackets)))
+			TaskDataItemsInQueue(tsqID, EVENT_TSQ_ITEMS_IN_QUEUE, 0, VChanCBData);
+		
+		break;
+	}
+}
+
 int CVICALLBACK ScheduleTaskEventHandler (void* functionData)
 {
 	TaskControl_type* 	taskControl = functionData;
 	
 	// set thread sleep policy
 	SetSleepPolicy(VAL_SLEEP_SOME);
-	// dispatch event
-	TaskEventHandler(taskControl);
+	
+	do {
+		// dispatch events
+		TaskEventHandler(taskControl);
+		
+		// allow the event handler to be launched again and process events that were queued meanwhile without launching it
+		InterlockedExchange(&taskControl->eventHandlerActive, FALSE);
+		
+	} while (TaskControlEventPending(taskControl) && InterlockedCompareExchange(&taskControl->eventHandlerActive, TRUE, FALSE) == FALSE);
+	
 	return 0;
 }
 
@@ -1666,15 +2828,18 @@ void CVICALLBACK IterationFunctionThreadCallback (CmtThreadPoolHandle poolHandle
 {
 	// change the default thread sleep from more to some, thisgives optimal performance
 	SetSleepPolicy(VAL_SLEEP_SOME);
+	
+	// apply thread pool CPU affinity
+	DLThreadPoolFunctionCallback(poolHandle, functionID, event, value, NULL);
 }
 
 int TaskControlEvent (TaskControl_type* RecipientTaskControl, TCEvents event, void** eventDataPtr, DiscardFptr_type discardEventDataFptr, char** errorMsg)
 {
+#define TaskControlEvent_Err_EventQueueFull		-1
 INIT_ERR	
 	
 	EventPacket_type 	eventPacket;
 	ChildTCInfo_type*	subTask				= NULL;
-	int 				lockObtainedFlag 	= FALSE;
 	
 	// init event packet
 	eventPacket.event 					= event;
@@ -1686,27 +2851,17 @@ INIT_ERR
 	
 	eventPacket.discardEventDataFptr	= discardEventDataFptr;	
 
-	// get event TSQ thread lock
-	CmtErrChk( CmtGetLockEx(RecipientTaskControl->eventQThreadLock, 0, CMT_WAIT_FOREVER, &lockObtainedFlag) );
-	
 	// set out of date flag for the parent's record of this child task controller state
 	if (RecipientTaskControl->parentTC) {
 		subTask = ListGetPtrToItem(RecipientTaskControl->parentTC->childTCs, RecipientTaskControl->childTCIdx);
 		subTask->isOutOfDate = TRUE;
 	}
 	
-	CmtErrChk( CmtWriteTSQData(RecipientTaskControl->eventQ, &eventPacket, 1, 0, NULL) );
-	
-	// release event TSQ thread lock
-	if (lockObtainedFlag)
-		CmtReleaseLock(RecipientTaskControl->eventQThreadLock);
+	if (!QueueTaskControlEvent(RecipientTaskControl, &eventPacket))
+		SET_ERR(TaskControlEvent_Err_EventQueueFull, "Task Controller event queue is full.");
 	
 	return 0;
 	
-CmtError:
-	
-Cmt_ERR
-
 Error:
 
 	// cleanup event data
@@ -1715,10 +2870,6 @@ Error:
 	else
 		OKfree(eventPacket.eventData);
 	
-	// release event TSQ thread lock
-	if (lockObtainedFlag)
-		CmtReleaseLock(RecipientTaskControl->eventQThreadLock);
-	
 RETURN_ERR
 }
 
@@ -1728,6 +2879,14 @@ INIT_ERR
 
 	FCallReturn_type*	fCallReturn = NULL;
 	
+	ExecutionLogEntry(taskControl, NULL, ITERATION_DONE, NULL);
+	
+	// record iteration latency
+	if (taskControl->iterationStartTime > 0) {
+		RecordTCLatency(&taskControl->iterationLatency, Timer() - taskControl->iterationStartTime);
+		taskControl->iterationStartTime = 0;
+	}
+	
 	if (errorID) {
 		
 		nullChk( fCallReturn = init_FCallReturn_type(errorID, "External Task Control Iteration", errorInfoString) );
@@ -1759,16 +2918,43 @@ static void ChangeState (TaskControl_type* taskControl, EventPacket_type* eventP
 	taskControl->oldState   	= taskControl->currentState;
 	taskControl->currentState 	= newState;
 	
+	// cancel timers that apply only to the previous state
+	if (newState != TC_State_Running)
+		CancelTCTimer(taskControl, TC_Timer_IterationWait);
+	
+	if (newState != TC_State_IterationFunctionActive)
+		CancelTCTimer(taskControl, TC_Timer_IterationTimeout);
+	
 	// add log entry if enabled
 	ExecutionLogEntry(taskControl, eventPacket, STATE_CHANGE, NULL);
 }
 
+static void PublishTaskControlState (TaskControl_type* taskControl, TCStates state)
+{
+	ULONG	snapshot = (ULONG)taskControl->stateSnapshot;
+	
+	if ((TCStates)(snapshot & TC_StateSnapshotMask) == state) return;
+	
+	// increment version and publish it together with the new state, the version wraps around when it overflows
+	snapshot = (((snapshot >> TC_StateSnapshotBits) + 1) << TC_StateSnapshotBits) | (ULONG)state;
+	InterlockedExchange(&taskControl->stateSnapshot, (LONG)snapshot);
+}
+
+static BOOL IsTaskControlStateInUse (TCStates state)
+{
+	return (state == TC_State_Idle || state == TC_State_Running || state == TC_State_IterationFunctionActive || state == TC_State_Stopping);
+}
+
 static BOOL AllChildTCsInState (TaskControl_type* taskControl, TCStates state)
 {
 	size_t				nChildTCs 		= ListNumItems(taskControl->childTCs);
 	ChildTCInfo_type*   subTask			= NULL;
 	BOOL				allTCsInState	= TRUE;
 	
+	// use the completion barrier if it was armed for this state
+	if (taskControl->childTCsBarrierArmed && taskControl->childTCsBarrierState == state)
+		return !taskControl->nChildTCsBarrierPending;
+	
 	for (size_t i = 1; i <= nChildTCs; i++) {
 		subTask = ListGetPtrToItem(taskControl->childTCs, i);
 		if ((subTask->isOutOfDate) || (subTask->childTCState != state)) {
@@ -1780,6 +2966,62 @@ static BOOL AllChildTCsInState (TaskControl_type* taskControl, TCStates state)
 	return allTCsInState;
 }
 
+static void ArmChildTCsBarrier (TaskControl_type* taskControl, TCEvents event)
+{
+	size_t				nChildTCs 		= ListNumItems(taskControl->childTCs);
+	ChildTCInfo_type*   subTask			= NULL;
+	LONG				nPending		= 0;
+	
+	switch (event) {
+			
+		case TC_Event_Start:
+			
+			// all child TCs must complete their iterations, even if they are already done
+			taskControl->childTCsBarrierState = TC_State_Done;
+			break;
+			
+		case TC_Event_Reset:
+			
+			// child TCs that are already in their initial state remain so
+			taskControl->childTCsBarrierState = TC_State_Initial;
+			break;
+			
+		default:
+			
+			// child TCs may switch to different states, their states are checked individually
+			taskControl->childTCsBarrierArmed = FALSE;
+			return;
+	}
+	
+	for (size_t i = 1; i <= nChildTCs; i++) {
+		subTask = ListGetPtrToItem(taskControl->childTCs, i);
+		subTask->barrierPending = (event == TC_Event_Start || subTask->childTCState != taskControl->childTCsBarrierState);
+		if (subTask->barrierPending) nPending++;
+	}
+	
+	// the barrier is passed already if no child TC is pending
+	InterlockedExchange(&taskControl->nChildTCsBarrierPending, nPending);
+	taskControl->childTCsBarrierArmed = (nPending > 0);
+}
+
+static void UpdateChildTCsBarrier (TaskControl_type* taskControl, ChildTCEventInfo_type* childTCEventInfo)
+{
+	ChildTCInfo_type*   subTask			= NULL;
+	
+	if (!taskControl->childTCsBarrierArmed) return;
+	
+	subTask = ListGetPtrToItem(taskControl->childTCs, childTCEventInfo->childTCIdx);
+	
+	// count only switches to the barrier state, not repeated updates of a child TC that was already in this state before receiving the event
+	if (subTask->barrierPending && subTask->childTCState != taskControl->childTCsBarrierState && childTCEventInfo->newChildTCState == taskControl->childTCsBarrierState) {
+		subTask->barrierPending = FALSE;
+		
+		// disarm the barrier once passed so that later child TC state changes, e.g. errors or child TCs started on their own, are checked for each child TC
+		if (!InterlockedDecrement(&taskControl->nChildTCsBarrierPending))
+			taskControl->childTCsBarrierArmed = FALSE;
+	}
+}
+
 void AbortTaskControlExecution (TaskControl_type* taskControl)
 {
 	ChildTCInfo_type* 	childTCPtr	= NULL;
@@ -1800,6 +3042,8 @@ int CVICALLBACK ScheduleIterateFunction (void* functionData)
 {
 	TaskControl_type* taskControl = functionData;
 	
+	taskControl->iterationStartTime = Timer();
+	ExecutionLogEntry(taskControl, NULL, ITERATION_START, NULL);
 	(*taskControl->IterateFptr)(taskControl, taskControl->currentIter, &taskControl->abortFlag);
 	
 	return 0;
@@ -1816,11 +3060,11 @@ INIT_ERR
 	// call function
 	
 	BOOL	taskActive					= FALSE;
-	BOOL	taskActiveLockObtained		= FALSE;
+	double	callStartTime				= 0;
 	
 	// determine if task tree is active.
-	// Note: this should be better done through message passing if task controllers are not local
-	errChk( IsTaskControllerInUse_GetLock(GetTaskControlRootParent(taskControl), &taskActive, NULL, &taskActiveLockObtained, __LINE__, __FILE__, &errorInfo.errMsg) );
+	// Note: the state of the task tree is sampled without blocking state transitions of the root TC, this should be better done through message passing if task controllers are not local
+	taskActive = IsTaskTreeInUse(taskControl, NULL);
 	
 	// add log entry if enabled
 	ExecutionLogEntry(taskControl, eventPacket, FUNCTION_CALL, &fID);
@@ -1848,16 +3092,10 @@ INIT_ERR
 			
 			taskControl->stopIterationsFlag = FALSE;
 			
-			/* Taken out because DiscardAsyncTimer does not discard the timer and after creating 8 timers the function fails and the iteration function is not launched
-			
-			// call iteration function and set timeout if required to complete the iteration
-			if (taskControl->iterTimeout) {  
-				// set an iteration timeout async timer until which a TC_Event_IterationDone must be received 
-				// if timeout elapses without receiving a TC_Event_IterationDone, a TC_Event_IterationTimeout is generated 
-				if ( (taskControl->iterationTimerID = NewAsyncTimer(taskControl->iterTimeout, 1, 1, TaskControlIterTimeout, taskControl)) < 0)
-					SET_ERR(taskControl->iterationTimerID, "Async timer error.");	
-			}
-			*/
+			// set an iteration timeout until which a TC_Event_IterationDone must be received, otherwise a TC_Event_IterationTimeout is generated
+			// Note: the timer is cancelled when the Task Controller leaves the TC_State_IterationFunctionActive state
+			if (taskControl->iterTimeout > 0)
+				errChk( StartTCTimer(taskControl, TC_Timer_IterationTimeout, GetTCTimerTicks() + (LONGLONG)taskControl->iterTimeout * TCTimerFrequency) );
 			
 			// launch provided iteration function pointer in a separate thread
 			CmtErrChk( CmtScheduleThreadPoolFunctionAdv(taskControl->threadPoolHndl, ScheduleIterateFunction, taskControl, DEFAULT_THREAD_PRIORITY,
@@ -1912,7 +3150,10 @@ INIT_ERR
 			VChanCallbackData_type*	VChanCBData = fCallData;
 			
 			if (!VChanCBData->DataReceivedFptr) break;	// function not provided 
+			CmtGetTSQAttribute(GetSinkVChanTSQHndl(VChanCBData->sinkVChan), ATTR_TSQ_ITEMS_IN_QUEUE, &VChanCBData->nQueuedPackets);
+			callStartTime = Timer();
 			errChk( (*VChanCBData->DataReceivedFptr)(taskControl, taskControl->currentState, taskActive, VChanCBData->sinkVChan, &taskControl->abortFlag, &errorInfo.errMsg) );
+			RecordTCLatency(&taskControl->dataReceivedLatency, Timer() - callStartTime);
 			break;
 			
 		case TC_Callback_CustomEvent:
@@ -1942,21 +3183,21 @@ Cmt_ERR
 
 Error:
 	
-	// release lock
-	if (taskActiveLockObtained)
-		IsTaskControllerInUse_ReleaseLock(GetTaskControlRootParent(taskControl), &taskActiveLockObtained, NULL);
-		
+	// add log entry if enabled
+	ExecutionLogEntry(taskControl, eventPacket, FUNCTION_CALL_DONE, &fID);
+	
 RETURN_ERR	
 }
 
 int	TaskControlEventToChildTCs (TaskControl_type* SenderTaskControl, TCEvents event, void** eventDataPtr, DiscardFptr_type discardEventDataFptr, char** errorMsg)
 {
+#define TaskControlEventToChildTCs_Err_EventQueueFull		-1
 INIT_ERR
 
 	EventPacket_type 		eventPacket;
 	ChildTCInfo_type* 		subTask				= NULL;
 	size_t					nChildTCs 			= ListNumItems(SenderTaskControl->childTCs);
-	int*		 			lockObtainedFlags	= NULL;
+	TCEventLanes			laneIdx				= GetTCEventLane(event);
 	
 	// init event packet
 	eventPacket.event					= event;
@@ -1972,36 +3213,38 @@ INIT_ERR
 	// do nothing if there are no child TCs
 	if (!nChildTCs) return 0;
 	
-	// init lock obtained flags
-	nullChk( lockObtainedFlags = calloc(nChildTCs, sizeof(int)) );
-	
-	// get all childTC eventQ thread locks to place event in all queues before other events can be placed by other threads
-	for (size_t i = 0; i < nChildTCs; i++) { 
-		subTask = ListGetPtrToItem(SenderTaskControl->childTCs, i+1);
-		CmtErrChk( CmtGetLockEx(subTask->childTC->eventQThreadLock, 0, CMT_WAIT_FOREVER, &lockObtainedFlags[i]) );
+	// reserve room for the event in the event queues of all child TCs so that either all of them or none receive the event
+	for (size_t i = 1; i <= nChildTCs; i++) {
+		subTask = ListGetPtrToItem(SenderTaskControl->childTCs, i);
+		if (!ReserveTCEventLane(&subTask->childTC->eventLanes[laneIdx])) {
+			for (size_t j = 1; j < i; j++) {
+				subTask = ListGetPtrToItem(SenderTaskControl->childTCs, j);
+				CancelTCEventLaneReservation(&subTask->childTC->eventLanes[laneIdx]);
+			}
+			SET_ERR(TaskControlEventToChildTCs_Err_EventQueueFull, "Child Task Controller event queue is full.");
+		}
 	}
 	
 	// dispatch event to all childTCs
+	// Note: child TCs are marked out of date and the completion barrier is armed before any of them receives the event so that the parent cannot find all of
+	// them in the same state before they processed it. The event handlers of the child TCs are scheduled without waiting and process the event in parallel.
+	SetChildTCsOutOfDate(SenderTaskControl);
+	ArmChildTCsBarrier(SenderTaskControl, event);
 	for (size_t i = 1; i <= nChildTCs; i++) { 
 		subTask = ListGetPtrToItem(SenderTaskControl->childTCs, i);
-		subTask->isOutOfDate = TRUE;
-		CmtErrChk( CmtWriteTSQData(subTask->childTC->eventQ, &eventPacket, 1, 0, NULL) );
+		WriteReservedTCEventLane(&subTask->childTC->eventLanes[laneIdx], &eventPacket);
+		LaunchTaskEventHandler(subTask->childTC);
 	}
 	
-CmtError:
+	return 0;
 	
-Cmt_ERR
-
 Error:
 	
-	// release all child TC eventQ thread locks
-	if (lockObtainedFlags)
-		for (size_t i = 0; i < nChildTCs; i++) { 
-			subTask = ListGetPtrToItem(SenderTaskControl->childTCs, i+1);
-			if (lockObtainedFlags[i])
-				CmtReleaseLock(subTask->childTC->eventQThreadLock);  
-		}
-	OKfree(lockObtainedFlags);
+	// cleanup event data, since none of the child TCs received the event
+	if (eventPacket.eventData && eventPacket.discardEventDataFptr)
+		(*eventPacket.discardEventDataFptr) (&eventPacket.eventData);
+	else
+		OKfree(eventPacket.eventData);
 	
 RETURN_ERR
 }
@@ -2038,7 +3281,7 @@ INIT_ERR
 		SET_ERR(AddChildTCToParent_Err_TaskControllerIsInUse, msgBuff);
 	}
 	
-	ChildTCInfo_type	childTCItem	= {.childTC = childTC, .childTCState = childTCState, .previousChildTCState = childTCState, .isOutOfDate = FALSE};
+	ChildTCInfo_type	childTCItem	= {.childTC = childTC, .childTCState = childTCState, .previousChildTCState = childTCState, .isOutOfDate = FALSE, .barrierPending = FALSE};
 	
 	// call UITC Active function to dim/undim UITC Task Control execution
 	if (childTC->UITCFlag) {
@@ -2047,6 +3290,7 @@ INIT_ERR
 	}
 	// insert childTC
 	nullChk( ListInsertItem(parentTC->childTCs, &childTCItem, END_OF_LIST) );
+	parentTC->childTCsBarrierArmed = FALSE;
 
 	// add parent pointer to childTC
 	childTC->parentTC = parentTC;
@@ -2121,6 +3365,7 @@ INIT_ERR
 	
 	if (childTCIdx) {
 		ListRemoveItem(childTC->parentTC->childTCs, 0, childTCIdx);
+		childTC->parentTC->childTCsBarrierArmed = FALSE;
 		// remove child iterator from parent
 		RemoveFromParentIterator(GetTaskControlIterator(childTC));
 		// update childTC indices
@@ -2261,22 +3506,6 @@ Error:
 RETURN_ERR
 }
 
-/// HIFN Called after a certain timeout if a TC_Event_IterationTimeout is not received
-int CVICALLBACK TaskControlIterTimeout (int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2)
-{
-INIT_ERR
-
-	TaskControl_type* 	taskControl = callbackData;
-	
-	if (event == EVENT_TIMER_TICK) {
-		errChk( TaskControlEvent(taskControl, TC_Event_IterationTimeout, NULL, NULL, NULL) );
-	}
-	
-Error:
-	
-	return 0;
-}
-
 static void AddIterationEventWithPriority (EventPacket_type* eventPackets, int* nEventPackets, int currentEventIdx) 
 {
 	EventPacket_type	iterEvent = {.event = TC_Event_Iterate, .eventData = NULL, .discardEventDataFptr = NULL};
@@ -2311,14 +3540,27 @@ INIT_ERR
 	size_t					nChars				= 0;
 	size_t					nItems				= 0;
 	int						nEventItems			= 0;
+	LONGLONG				now					= 0;
 	BOOL					stateLockObtained   = FALSE;
 	TCStates*				tcStateTSVPtr 		= NULL; 
 	
-	// get all Task Controller events in the queue
-	while ((nEventItems = CmtReadTSQData(taskControl->eventQ, eventPackets, EVENT_BUFFER_SIZE - 1, 0, 0)) > 0) {
+	// get all Task Controller events in the queue one at a time so that control events are processed before other events that are already queued
+	while (ReadTaskControlEvent(taskControl, &eventPackets[0])) {
+		
+		nEventItems = 1;
 		
 		for (int i = 0; i < nEventItems; i++) {
 		
+			// ignore events of timers that were cancelled after they elapsed
+			if (IsStaleTCTimerEvent(taskControl, &eventPackets[i])) {
+				OKfree(eventPackets[i].eventData);
+				continue;
+			}
+			
+			// count child TC state changes towards the completion barrier before the recorded child TC state is updated
+			if (eventPackets[i].event == TC_Event_UpdateChildTCState)
+				UpdateChildTCsBarrier(taskControl, eventPackets[i].eventData);
+			
 			// reset abort flag
 			taskControl->abortFlag = FALSE;
 			
@@ -2760,11 +4002,28 @@ INIT_ERR
 							}
 						
 							//---------------------------------------------------------------------------------------------------------------
-							// If not first iteration, then wait given number of seconds before iterating    
+							// If not first iteration, wait until the next iteration is due. Iterations are due at multiples of the wait
+							// time from the first iteration, unless an iteration took longer, in which case the next iteration starts
+							// right away. The wait timer posts another TC_Event_Iterate event, carrying the timer generation, when due.
 							//---------------------------------------------------------------------------------------------------------------
-					
-							if (GetCurrentIterIndex(taskControl->currentIter) && taskControl->nIterationsFlag < 0)
-								SyncWait(Timer(), taskControl->waitBetweenIterations);
+							
+							now = GetTCTimerTicks();
+							if (eventPackets[i].eventData) {
+								// iteration due, record delay from the scheduled start
+								RecordTCLatency(&taskControl->iterationJitter, (double)(now - taskControl->iterationDeadline) / TCTimerFrequency);
+								
+							} else
+								if (GetCurrentIterIndex(taskControl->currentIter) && taskControl->nIterationsFlag < 0 && taskControl->waitBetweenIterations > 0) {
+									taskControl->iterationDeadline += (LONGLONG)(taskControl->waitBetweenIterations * TCTimerFrequency);
+									if (taskControl->iterationDeadline > now) {
+										errChk( StartTCTimer(taskControl, TC_Timer_IterationWait, taskControl->iterationDeadline) );
+										break; // stay in TC_State_Running until the iteration is due
+									}
+									
+									taskControl->iterationDeadline = now;
+									
+								} else
+									taskControl->iterationDeadline = now;
 					
 							//---------------------------------------------------------------------------------------------------------------
 							// Iterate Task Controller
@@ -2973,14 +4232,6 @@ INIT_ERR
 				
 						case TC_Event_IterationDone:
 					
-							//---------------------------------------------------------------------------------------------------------------   
-							// Remove timeout timer if one was set
-							//---------------------------------------------------------------------------------------------------------------   
-							if (taskControl->iterationTimerID > 0) {
-								DiscardAsyncTimer(taskControl->iterationTimerID);
-								taskControl->iterationTimerID = 0;
-							}
-					
 							//---------------------------------------------------------------------------------------------------------------   
 							// Check if error occured during iteration 
 							// (which may be also because it was aborted and this caused an error for the TC)
@@ -3460,6 +4711,7 @@ INIT_ERR
 
 			// assign new state and release state lock
 			*tcStateTSVPtr = taskControl->currentState;
+			PublishTaskControlState(taskControl, taskControl->currentState);
 			stateLockObtained = TRUE;
 			CmtErrChk( CmtReleaseTSVPtr(taskControl->stateTSV) );
 			tcStateTSVPtr = NULL;
@@ -3467,6 +4719,10 @@ INIT_ERR
 			taskControl->stateTSVLineNumDebug = 0;
 			strcpy(taskControl->stateTSVFileName, "");
 			
+			// allow new data received events for the Sink VChan
+			if (eventPackets[i].event == TC_Event_DataReceived && eventPackets[i].eventData)
+				DataReceivedEventDone(taskControl, eventPackets[i].eventData);
+			
 			// free memory for extra eventData if any
 			if (eventPackets[i].eventData && eventPackets[i].discardEventDataFptr)
 				(*eventPackets[i].discardEventDataFptr)(&eventPackets[i].eventData);
@@ -3487,18 +4743,13 @@ INIT_ERR
 	
 			discard_ChildTCEventInfo_type(&childTCEventInfo);
 		
-			// remove iteration timeout timer
-			if (taskControl->iterationTimerID > 0) {
-				DiscardAsyncTimer(taskControl->iterationTimerID);
-				taskControl->iterationTimerID = 0;
-			}
-		
 			// change state
 			ChangeState(taskControl, &eventPackets[i], TC_State_Error);
 			
 			// assign new state and try to release lock if obtained
 			if (stateLockObtained) {
 				*tcStateTSVPtr = taskControl->currentState;
+				PublishTaskControlState(taskControl, taskControl->currentState);
 				CmtReleaseTSVPtr(taskControl->stateTSV);
 				tcStateTSVPtr = NULL;
 				stateLockObtained = FALSE;
@@ -3531,6 +4782,10 @@ INIT_ERR
 				TaskControlEvent(taskControl->parentTC, TC_Event_UpdateChildTCState, (void**)&childTCEventInfo, (DiscardFptr_type)discard_ChildTCEventInfo_type, &errorInfo.errMsg);
 			}
 
+			// allow new data received events for the Sink VChan
+			if (eventPackets[i].event == TC_Event_DataReceived && eventPackets[i].eventData)
+				DataReceivedEventDone(taskControl, eventPackets[i].eventData);
+			
 			// free memory for extra eventData if any
 			if (eventPackets[i].eventData && eventPackets[i].discardEventDataFptr)
 				(*eventPackets[i].discardEventDataFptr)(&eventPackets[i].eventData);
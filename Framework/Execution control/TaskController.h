@@ -24,7 +24,7 @@
 #include "Iterator.h"
 
 #define TaskControllerUI		"./Framework/Execution control/UI_TaskController.uir" 
-#define TC_NEventQueueItems		1000			// Number of events waiting to be processed by the state machine.
+#define TC_NEventQueueItems		1024			// Number of events waiting to be processed by the state machine in each event queue lane. Must be a power of 2.
 
 // Handy return type for functions that produce error descriptions
 
@@ -107,6 +107,41 @@ typedef enum {
 	TC_Execute_InParallelWithChildTCs  			// The iteration function of the TC is carried out in parallel with the iterations of the child TCs.
 } TCExecutionModes;
 
+//---------------------------------------------------------------
+// Task Controller Metrics
+//---------------------------------------------------------------
+#define TC_NLatencyBins			24				// Number of bins of a Task Controller latency histogram.
+
+// Histogram of the execution times of a Task Controller callback. Bin 0 counts execution times below 1 us, bin k counts execution times
+// in the [2^(k-1), 2^k) us interval and the last bin also counts all longer execution times.
+typedef struct {
+	size_t		nCalls;							// Number of recorded callback executions.
+	double		totalTime;						// Total execution time in [ms].
+	double		maxTime;						// Longest execution time in [ms].
+	size_t		bins[TC_NLatencyBins];			// Histogram bins.
+} TCLatencyHistogram_type;
+
+
+//---------------------------------------------------------------
+// Task Tree Dry-Run Estimate
+//---------------------------------------------------------------
+
+// Expected amount of data generated on a Source VChan.
+typedef struct {
+	SourceVChan_type*	srcVChan;						// Source VChan generating the data.
+	double				nBytes;							// Expected number of bytes.
+} TCVChanDataEstimate_type;
+
+// Expected timing and data volume of a task tree, obtained from the Task Controller and module settings without running the task tree.
+typedef struct {
+	double		duration;								// Expected duration in [s] of running the task tree from its Initial state until Done.
+	BOOL		continuous;								// TRUE if the task tree has continuous TCs which do not complete on their own. In this case a single iteration is estimated for each continuous TC.
+	ListType	VChanData;								// Expected data generated on each Source VChan over the estimated duration, list of TCVChanDataEstimate_type elements.
+	double		storageBandwidth;						// Expected average data rate in [bytes/s] summed over all Source VChans.
+	size_t		nOverruns;								// Number of TCs expected to take longer to iterate than their wait between iterations or iteration function timeout.
+	char*		report;									// Human readable report of the estimates for each TC and expected overruns.
+} TCTreeEstimate_type;
+
 
 typedef struct TaskControl 		TaskControl_type;
 
@@ -172,6 +207,11 @@ typedef int				(*DataReceivedFptr_type)			(TaskControl_type* taskControl, TCStat
 // Called for passing custom module or device events that are not handled directly by the Task Controller.
 typedef int				(*ModuleEventFptr_type)				(TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, void* eventData, BOOL const* abortFlag, char** errorMsg);
 
+// Called when a dry-run estimate of a task tree is made. Based only on the current module or device settings and without accessing hardware, return the expected
+// time in [s] from the start of the iteration function until TaskControlIterationDone is called and add with AddTCVChanDataEstimate the data expected on each
+// Source VChan during one iteration.
+typedef int				(*EstimateIterationFptr_type)		(TaskControl_type* taskControl, double* iterationDuration, ListType VChanData, char** errorMsg);
+
 
 //--------------------------------------------------------------------------------
 
@@ -208,9 +248,7 @@ void					discard_TaskTreeBranch				(TaskControl_type** taskControllerPtr);
 // Task Controller Set/Get functions
 //------------------------------------------------------------------------------------------------------------------------------------------------------
 
-	// Sets UI resources for Task Controller logging. Multiple Task Controllers may share the same UI logging resources. 
-void					SetTaskControlUILoggingInfo			(TaskControl_type* taskControl, int logPanHandle, int logBoxControlID);
-
+	// Records the execution of a Task Controller in the execution trace even if tracing is not enabled for all Task Controllers.
 void					EnableTaskControlLogging			(TaskControl_type* taskControl, BOOL enableLogging);
 
 void 					SetTaskControlName 					(TaskControl_type* taskControl, char newName[]);
@@ -222,6 +260,10 @@ char*					GetTaskControlName					(TaskControl_type* taskControl);
 int 					GetTaskControlState_GetLock 		(TaskControl_type* taskControl, TCStates* tcStatePtr, BOOL* lockObtained, int lineNumDebug, char fileNameDebug[], char** errorMsg);
 	// Releases GetTaskControlState lock so state transitions may resume. On success returns 0 and lockObtained is set back to FALSE. On failure returns a negative value and lockObtained remains TRUE. 
 int						GetTaskControlState_ReleaseLock		(TaskControl_type* taskControl, BOOL* lockObtained, char** errorMsg);
+	// Returns the last published state of a Task Controller without obtaining the state lock and without blocking state transitions. The state may change right
+	// after it was read, use GetTaskControlState_GetLock if the state must not change while acting upon it. If stateVersion is not NULL, it is set to a counter 
+	// incremented on each state change, which may be compared between calls to find out if the state changed in the meantime.
+TCStates				GetTaskControlState					(TaskControl_type* taskControl, unsigned int* stateVersion);
 
 														
 	// repeats = 1 by default
@@ -229,7 +271,7 @@ void					SetTaskControlIterations			(TaskControl_type* taskControl, size_t repea
 size_t					GetTaskControlIterations			(TaskControl_type* taskControl);
 
 
-	// Task Controller Iteration Function completion timeout. Default timeout = 10 sec. If timeout < 0, the Task Controller will wait indefinitely to
+	// Task Controller Iteration Function completion timeout. Default timeout = 0. If timeout = 0, the Task Controller will wait indefinitely to
 	// receive TC_Event_IterationDone. If timeout > 0, a timeout error is generated if after timeout seconds TC_Event_IterationDone is not received.
 void					SetTaskControlIterationTimeout		(TaskControl_type* taskControl, unsigned int timeout);
 unsigned int			GetTaskControlIterationTimeout		(TaskControl_type* taskControl);
@@ -247,8 +289,9 @@ Iterator_type* 			GetTaskControlIterator 				(TaskControl_type* taskControl);
 void					SetTaskControlMode					(TaskControl_type* taskControl, TaskMode_type mode);
 TaskMode_type			GetTaskControlMode					(TaskControl_type* taskControl);
 
-	// Number of seconds to wait between iterations
-	// wait = 0 by default
+	// Number of seconds between the start of consecutive iterations while the Task Controller is running. Iterations start at multiples of this
+	// interval from the first iteration without accumulating drift. If an iteration takes longer, the next iteration starts right away.
+	// The wait does not block a thread. wait = 0 by default
 void					SetTaskControlIterationsWait		(TaskControl_type* taskControl, double waitBetweenIterations);
 double					GetTaskControlIterationsWait		(TaskControl_type* taskControl);
 
@@ -286,6 +329,8 @@ BOOL					GetTaskControlIterationStopFlag		(TaskControl_type* taskControl);
 int 					IsTaskControllerInUse_GetLock 		(TaskControl_type* taskControl, BOOL* inUsePtr, TCStates* tcState, BOOL* lockObtained, int lineNumDebug, char fileNameDebug[], char** errorMsg);
 	// Releases IsTaskControllerInUse lock so state transitions maye resume. On success returns 0 and lockObtained is set back to FALSE. On failure returns a negative value and lockObtained remains TRUE. 
 int 					IsTaskControllerInUse_ReleaseLock 	(TaskControl_type* taskControl, BOOL* lockObtained, char** errorMsg);
+	// Lock-free version of IsTaskControllerInUse_GetLock which returns TRUE if the Task Controller is in use based on its last published state. tcState is optional.
+BOOL					IsTaskControllerInUse				(TaskControl_type* taskControl, TCStates* tcState);
 
 	// Check if the task tree of a given task controller is in use, i.e. if the root task controller is in any of the following states: Idle, Running, IterationFunctionActive, Stopping.
 	// A call to this function blocks ongoing state transitions and if task tree state knowledge is not needed anymore, this call must be followed each time 
@@ -293,10 +338,67 @@ int 					IsTaskControllerInUse_ReleaseLock 	(TaskControl_type* taskControl, BOOL
 int 					IsTaskTreeInUse_GetLock 			(TaskControl_type* taskControl, BOOL* inUsePtr, TCStates* tcState, BOOL* lockObtained, int lineNumDebug, char fileNameDebug[], char** errorMsg);
 	// Releases IsTaskTreeInUse lock so state transitions maye resume. On success returns 0 and lockObtained is set back to FALSE. On failure returns a negative value and lockObtained remains TRUE.
 int 					IsTaskTreeInUse_ReleaseLock 		(TaskControl_type* taskControl, BOOL* lockObtained, char** errorMsg);
+	// Lock-free version of IsTaskTreeInUse_GetLock which returns TRUE if the task tree is in use based on the last published state of its root Task Controller. tcState is optional.
+BOOL					IsTaskTreeInUse						(TaskControl_type* taskControl, TCStates* tcState);
 
 	// Converts a task Controller state ID into a string
 char*					TaskControlStateToString			(TCStates state);
 
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller execution trace
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+	// Records state transitions, events, callbacks, iterations and child TC state changes of all Task Controllers in a ring buffer shared by all threads.
+	// Recording does not lock and stores only binary data, formatting is done only when the trace is read. Default: disabled.
+void					EnableTaskControlTracing			(BOOL enableTracing);
+BOOL					GetTaskControlTracingEnabled		(void);
+
+	// Returns the current trace position. Pass it to FormatTaskControlTraceLog to format only the records added afterwards.
+size_t					GetTaskControlTracePosition			(void);
+
+	// Formats the trace records from a given trace position as text log lines, with times in [s] relative to startTime given by Timer(), and updates the trace position.
+	// Returns a dynamically allocated string, or NULL if there are no new records or out of memory.
+char*					FormatTaskControlTraceLog			(size_t* tracePosPtr, double startTime);
+
+	// Exports the records in the trace buffer as a Chrome trace event JSON timeline with one timeline per Task Controller.
+int						ExportTaskControlTrace				(char fileName[], char** errorMsg);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller metrics
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+	// Copies the latency histograms of a Task Controller. The iteration latency is the time from launching the iteration function until TaskControlIterationDone 
+	// is called, the data received latency is the execution time of the DataReceivedFptr callbacks and the control event latency is the time control events 
+	// such as TC_Event_Stop wait in the event queue before being processed. The iteration jitter is the delay of iterations from their scheduled start when 
+	// waiting between iterations. Pass NULL for histograms that are not needed.
+void					GetTaskControlMetrics				(TaskControl_type* taskControl, TCLatencyHistogram_type* iterationLatency, TCLatencyHistogram_type* dataReceivedLatency,
+															 TCLatencyHistogram_type* controlEventLatency, TCLatencyHistogram_type* iterationJitter);
+void					ResetTaskControlMetrics				(TaskControl_type* taskControl);
+
+	// Returns the number of TC_Event_DataReceived events generated for the Sink VChans of a Task Controller and the number of data arrivals that were coalesced
+	// into an already pending event. Pass NULL for counts that are not needed.
+void					GetTaskControlDataEventCounts		(TaskControl_type* taskControl, unsigned long long* nDataEventsPtr, unsigned long long* nCoalescedDataEventsPtr);
+
+	// Returns an upper estimate in [ms] of the given percentile (0 - 100) of the execution times in a latency histogram, or 0 if the histogram is empty.
+double					GetTCLatencyPercentile				(TCLatencyHistogram_type* histogram, double percentile);
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Tree dry-run estimate
+//------------------------------------------------------------------------------------------------------------------------------------------------------
+
+	// Sets the callback used by EstimateTaskTree to obtain the iteration duration and data volume of a Task Controller. By default there is no callback
+	// and the iteration function of the Task Controller is assumed to complete right away without generating data.
+void					SetTaskControlEstimateIterationFptr	(TaskControl_type* taskControl, EstimateIterationFptr_type EstimateIterationFptr);
+
+	// Estimates the duration, data volume per Source VChan and storage bandwidth of a task tree starting with the given Task Controller, without running it.
+	// Iterations are simulated from the number of iterations, wait between iterations, execution mode and iteration function durations given by the
+	// EstimateIterationFptr callbacks. Call this only while the task tree is not in use. Discard the estimate with discard_TCTreeEstimate_type.
+int						EstimateTaskTree					(TaskControl_type* taskControl, TCTreeEstimate_type** estimatePtr, char** errorMsg);
+void					discard_TCTreeEstimate_type			(TCTreeEstimate_type** estimatePtr);
+
+	// Adds data expected on a Source VChan to a list of TCVChanDataEstimate_type elements. Data for the same Source VChan is summed.
+int						AddTCVChanDataEstimate				(ListType VChanData, SourceVChan_type* srcVChan, double nBytes);
+
 //------------------------------------------------------------------------------------------------------------------------------------------------------
 // Task Controller composition functions
 //------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -14,7 +14,9 @@
 //==============================================================================
 // Include files
 
+#include <windows.h>
 #include <formatio.h>
+#include <utility.h>
 #include "Iterator.h"
 #include "toolbox.h"
 #include "DAQLabErrHandling.h"
@@ -37,6 +39,9 @@ struct Iterator {
 	size_t					totalIter;				// Total number of iterations
 	DiscardDataFptr_type 	discardDataFptr;		// For data type iterators only, function callback to discard data from an iterator.
 	ListType				iterObjects;			// List of iteratable data objects such as Waveform_type* or Iterator_type* elements specified by iterType.
+	DSInfo_type*			dsInfo;					// Cached DSInfo for the current iteration state, NULL if not built yet or out of date.
+	unsigned int			dsInfoDatarank;			// Data rank for which dsInfo was built.
+	CmtThreadLockHandle		dsInfoLock;				// Protects dsInfo and dsInfoDatarank.
 	BOOL					stackdata;				// Combine generated data into a one-dimension higher stack of datasets  
 													// TEMPORARY, must be removed! It is the resposibility of the root iterator to stack the data or not.
 													
@@ -49,6 +54,7 @@ struct DSInfo{
 	unsigned int 			datasetrank;			// Dataset rank, i.e. # dimensions 
 	unsigned int 			datarank;				// Data element rank (1 for waveform, 2 for Images), i.e. # dimensions
 	unsigned int*			iterIndices;   			// Dataset index array.
+	volatile LONG			refCount;				// Number of owners of this DSInfo, i.e. the iterator cache and data packets. Memory is freed when it reaches 0.
 };
 
    
@@ -58,7 +64,10 @@ struct DSInfo{
 //==============================================================================
 // Static functions
 
-static DSInfo_type* 			init_DSInfo_type						(void);       
+static DSInfo_type*				BuildIteratorDSData						(Iterator_type* iterator, unsigned int datarank);
+
+	// Releases the cached DSInfo of an iterator and of all its child iterators recursively.
+static void						InvalidateIteratorDSData				(Iterator_type* iterator);
 
 //==============================================================================
 // Global variables
@@ -82,13 +91,18 @@ Iterator_type* init_Iterator_type (char name[])
 	iterator->discardDataFptr		= NULL;
 	iterator->parent				= NULL;
 	iterator->stackdata				= FALSE;
+	iterator->dsInfo				= NULL;
+	iterator->dsInfoDatarank		= 0;
+	iterator->dsInfoLock			= 0;
 	
 	if ( !(iterator->iterObjects   	= ListCreate(sizeof(void*))) )	goto Error;
+	if (CmtNewLock(NULL, 0, &iterator->dsInfoLock) < 0) goto Error;
 	
 	return iterator;
 	
 Error:
 	if (iterator->iterObjects) ListDispose(iterator->iterObjects);
+	OKfree(iterator->name);
 	free(iterator);
 	return NULL;
 }
@@ -115,6 +129,9 @@ void discard_Iterator_type (Iterator_type** iteratorPtr)
 		
 	ListDispose(iterator->iterObjects); 
 	
+	discard_DSInfo_type(&iterator->dsInfo);
+	if (iterator->dsInfoLock) CmtDiscardLock(iterator->dsInfoLock);
+	
 	OKfree(*iteratorPtr);
 }   
 
@@ -132,6 +149,7 @@ void RemoveFromParentIterator(Iterator_type* iterator)
 			if (*iterObjectPtr == iterator) {
 				ListRemoveItem(iterator->parent->iterObjects, 0, i);
 				iterator->parent = NULL;
+				InvalidateIteratorDSData(iterator);
 				break;
 			}
 			
@@ -177,6 +195,7 @@ size_t GetCurrentIterIndex(Iterator_type* iterator)
 void SetIteratorStackData (Iterator_type* iterator, BOOL stackdata)
 {
 	iterator->stackdata = stackdata;
+	InvalidateIteratorDSData(iterator);
 }
 
 BOOL GetIteratorStackData(Iterator_type* iterator)
@@ -193,11 +212,15 @@ void SetCurrentIterName(Iterator_type* iterator, char name[])
 {
 	OKfree(iterator->name);
 	iterator->name = StrDup(name);
+	InvalidateIteratorDSData(iterator);
 }
 
 void  SetCurrentIterIndex	(Iterator_type* iterator, size_t index)
 {
+	if (iterator->currentIterIdx == index) return;
+	
 	iterator->currentIterIdx = index;
+	InvalidateIteratorDSData(iterator);
 }
 
 ListType GetCurrentIteratorSet	(Iterator_type* iterator)
@@ -277,6 +300,7 @@ INIT_ERR
 	
 	// add parent iterator to child iterator
 	iteratorToAdd->parent = iterator;
+	InvalidateIteratorDSData(iteratorToAdd);
 	
 Error:
 	
@@ -297,6 +321,7 @@ void ResetIterators (Iterator_type* iterator)
 	
 	// reset current iteration index of this iterator (regardless of iterator type)
 	iterator->currentIterIdx = 0;
+	InvalidateIteratorDSData(iterator);
 }
 
 ListType IterateOverIterators (Iterator_type* iterator)
@@ -323,6 +348,7 @@ ListType IterateOverIterators (Iterator_type* iterator)
 		return 0;
 	else {
 		(*iteratorPtr)->currentIterIdx++;
+		InvalidateIteratorDSData(*iteratorPtr);
 		return GetCurrentIteratorSet(iterator);
 	}
 	
@@ -330,6 +356,32 @@ ListType IterateOverIterators (Iterator_type* iterator)
 
 // get DataStorage data from the iterator
 DSInfo_type* GetIteratorDSData (Iterator_type* iterator, unsigned int datarank)
+{
+	DSInfo_type*	dsInfo	= NULL;
+	
+	if (!iterator) return NULL;
+	
+	CmtGetLock(iterator->dsInfoLock);
+	
+	// rebuild cache if invalidated or if requested for a different data rank
+	if (!iterator->dsInfo || iterator->dsInfoDatarank != datarank) {
+		discard_DSInfo_type(&iterator->dsInfo);
+		iterator->dsInfo 			= BuildIteratorDSData(iterator, datarank);
+		iterator->dsInfoDatarank	= datarank;
+	}
+	
+	// add a reference for the caller
+	if (iterator->dsInfo) {
+		InterlockedIncrement(&iterator->dsInfo->refCount);
+		dsInfo = iterator->dsInfo;
+	}
+	
+	CmtReleaseLock(iterator->dsInfoLock);
+	
+	return dsInfo;
+}
+
+static DSInfo_type* BuildIteratorDSData (Iterator_type* iterator, unsigned int datarank)
 {
 INIT_ERR
 
@@ -346,8 +398,6 @@ INIT_ERR
 	size_t				totalIter					= 0;
 	BOOL				stackData					= FALSE;
 	
-	if (!iterator) return NULL;
-	
 	nullChk( ds_data = init_DSInfo_type() );
 
 	parentIterator = GetIteratorParent(iterator);
@@ -428,12 +478,34 @@ INIT_ERR
 	
 Error:
 	
-	OKfree(ds_data);
+	OKfree(tcName);
+	OKfree(name);
+	OKfree(fullGroupName);
+	discard_DSInfo_type(&ds_data);
 	return NULL;
 }
 
+static void InvalidateIteratorDSData (Iterator_type* iterator)
+{
+	size_t 				nObjects 		= 0;
+	Iterator_type**		iterObjectPtr	= NULL;
+	
+	CmtGetLock(iterator->dsInfoLock);
+	discard_DSInfo_type(&iterator->dsInfo);
+	CmtReleaseLock(iterator->dsInfoLock);
+	
+	// group names and dataset indices of child iterators depend on this iterator as well
+	if (iterator->iterType != Iterator_Iterator) return;
+	
+	nObjects = ListNumItems(iterator->iterObjects);
+	for (size_t i = 1; i <= nObjects; i++) {
+		iterObjectPtr = ListGetPtrToItem(iterator->iterObjects, i);
+		InvalidateIteratorDSData(*iterObjectPtr);
+	}
+}
 
-static DSInfo_type* init_DSInfo_type(void)
+
+DSInfo_type* init_DSInfo_type(void)
 {
 	DSInfo_type* ds_data		= malloc(sizeof(DSInfo_type));
 	if (!ds_data) return NULL;
@@ -443,6 +515,7 @@ static DSInfo_type* init_DSInfo_type(void)
 	ds_data->datasetrank		= 0;
 	ds_data->datarank			= 0;
 	ds_data->iterIndices		= NULL;
+	ds_data->refCount			= 1;
 	
 	return ds_data;
 }
@@ -452,10 +525,22 @@ void discard_DSInfo_type (DSInfo_type** dsInfoPtr)
 	DSInfo_type*	dsInfo = *dsInfoPtr;
 	if (!dsInfo) return;
 	
+	// drop only this reference if the DSInfo is still shared
+	*dsInfoPtr = NULL;
+	if (InterlockedDecrement(&dsInfo->refCount) > 0) return;
+	
 	OKfree(dsInfo->groupName);
 	OKfree(dsInfo->iterIndices); 
 	
-	OKfree(*dsInfoPtr);
+	free(dsInfo);
+}
+
+DSInfo_type* GetDSInfoReference (DSInfo_type* dsInfo)
+{
+	if (dsInfo)
+		InterlockedIncrement(&dsInfo->refCount);
+	
+	return dsInfo;
 }   
 
 void SetDSInfoGroupName	(DSInfo_type* dsInfo, char groupName[])
@@ -500,6 +585,11 @@ BOOL GetDSInfoStackData (DSInfo_type* dsInfo)
 	return dsInfo->stackeddata;
 }
 
+void SetDSDataRank (DSInfo_type* dsInfo, unsigned int datarank)
+{
+	dsInfo->datarank = datarank;
+}
+
 unsigned int GetDSDataRank (DSInfo_type* dsInfo)
 {
 	return dsInfo->datarank;
@@ -142,10 +142,20 @@ ListType				IterateOverIterators		(Iterator_type* iterator);
 //---------------------------------------------------------------------------------------------------------------------------
 
 
-	// get DataStorage data from the iterator
+	// Returns a reference to the DataStorage info for the current iteration state of the iterator. The info is built once per iteration state
+	// and shared between all callers until the iteration index, name or structure of the iterator or one of its parents changes. The returned
+	// info must not be modified and must be released with discard_DSInfo_type. Returns NULL if out of memory.
 DSInfo_type*			GetIteratorDSData			(Iterator_type* iterator, unsigned int datarank);
+
+	// Creates an empty DataStorage info holding one reference, e.g. for data that is not generated by iterating. Release it with discard_DSInfo_type.
+DSInfo_type*			init_DSInfo_type			(void);
+
+	// Releases a reference to a DataStorage info and discards it when no more references are held.
 void 					discard_DSInfo_type 		(DSInfo_type** dsInfoPtr);
 
+	// Adds a reference to a DataStorage info so that it can be shared, e.g. between several data packets. Release each reference with discard_DSInfo_type.
+DSInfo_type*			GetDSInfoReference			(DSInfo_type* dsInfo);
+
 void					SetDSInfoGroupName			(DSInfo_type* dsInfo, char groupName[]);
 
 char*					GetDSInfoGroupName			(DSInfo_type* dsInfo); 
@@ -158,6 +168,8 @@ void 					SetDSInfoDatasetRank		(DSInfo_type* dsInfo,unsigned int rank);
 
 unsigned int 			GetDSInfoDatasetRank 		(DSInfo_type* dsInfo);
 
+void 					SetDSDataRank 				(DSInfo_type* dsInfo, unsigned int datarank);
+
 unsigned int 			GetDSDataRank 				(DSInfo_type* dsInfo);
 
 void 					SetDSInfoStackData			(DSInfo_type* dsInfo,BOOL stackdata);
@@ -24,15 +24,38 @@
 //==============================================================================
 // Constants
 
+#define NameRegistry_InitNBuckets		64				// Initial number of hash table buckets. Must be a power of 2.
+
 //==============================================================================
 // Types
 
+typedef struct NameRegistryEntry	NameRegistryEntry_type;
+
+struct NameRegistryEntry {
+	char*						name;					// Registered name.
+	unsigned int				hash;					// Hash of the registered name.
+	void*						object;					// Object registered under the name.
+	NameRegistryEntry_type*		next;					// Next entry in the same bucket or NULL.
+};
+
+struct NameRegistry {
+	NameRegistryEntry_type**	buckets;				// Array of nBuckets singly linked lists of entries.
+	size_t						nBuckets;				// Number of buckets, a power of 2.
+	size_t						nEntries;				// Number of registered names.
+};
+
 //==============================================================================
 // Static global variables
 
 //==============================================================================
 // Static functions
 
+static unsigned int					NameRegistryHash					(char name[]);
+
+static NameRegistryEntry_type**		NameRegistryFindEntry				(NameRegistry_type* registry, char name[], unsigned int hash);
+
+static void							NameRegistryGrow					(NameRegistry_type* registry);
+
 //==============================================================================
 // Global variables
 
@@ -112,3 +135,179 @@ Error:
 	OKfree(catStrings);
 	return NULL;
 }
+
+//------------------------------------------------------------------------------
+// Name registry
+//------------------------------------------------------------------------------
+
+NameRegistry_type* init_NameRegistry_type (void)
+{
+	NameRegistry_type*	registry = malloc(sizeof(NameRegistry_type));
+	
+	if (!registry) return NULL;
+	
+	registry->nBuckets	= NameRegistry_InitNBuckets;
+	registry->nEntries	= 0;
+	registry->buckets	= calloc(registry->nBuckets, sizeof(NameRegistryEntry_type*));
+	
+	if (!registry->buckets) {
+		OKfree(registry);
+		return NULL;
+	}
+	
+	return registry;
+}
+
+void discard_NameRegistry_type (NameRegistry_type** registryPtr)
+{
+	NameRegistry_type*			registry	= *registryPtr;
+	NameRegistryEntry_type*		entry		= NULL;
+	NameRegistryEntry_type*		nextEntry	= NULL;
+	
+	if (!registry) return;
+	
+	for (size_t i = 0; i < registry->nBuckets; i++)
+		for (entry = registry->buckets[i]; entry; entry = nextEntry) {
+			nextEntry = entry->next;
+			OKfree(entry->name);
+			OKfree(entry);
+		}
+	
+	OKfree(registry->buckets);
+	OKfree(*registryPtr);
+}
+
+int NameRegistryAdd (NameRegistry_type* registry, char name[], void* object)
+{
+	unsigned int				hash		= NameRegistryHash(name);
+	NameRegistryEntry_type*		entry		= NULL;
+	size_t						bucketIdx	= 0;
+	
+	if (*NameRegistryFindEntry(registry, name, hash)) return NameRegistry_Err_NameExists;
+	
+	if (!(entry = malloc(sizeof(NameRegistryEntry_type)))) return NameRegistry_Err_OutOfMemory;
+	if (!(entry->name = StrDup(name))) {
+		OKfree(entry);
+		return NameRegistry_Err_OutOfMemory;
+	}
+	
+	entry->hash		= hash;
+	entry->object	= object;
+	
+	bucketIdx					= hash & (registry->nBuckets - 1);
+	entry->next					= registry->buckets[bucketIdx];
+	registry->buckets[bucketIdx]	= entry;
+	registry->nEntries++;
+	
+	// keep on average at most one entry per bucket
+	if (registry->nEntries > registry->nBuckets)
+		NameRegistryGrow(registry);
+	
+	return 0;
+}
+
+void* NameRegistryRemove (NameRegistry_type* registry, char name[])
+{
+	NameRegistryEntry_type**	entryPtr	= NameRegistryFindEntry(registry, name, NameRegistryHash(name));
+	NameRegistryEntry_type*		entry		= *entryPtr;
+	void*						object		= NULL;
+	
+	if (!entry) return NULL;
+	
+	*entryPtr 	= entry->next;
+	object		= entry->object;
+	OKfree(entry->name);
+	OKfree(entry);
+	registry->nEntries--;
+	
+	return object;
+}
+
+void* NameRegistryFind (NameRegistry_type* registry, char name[])
+{
+	NameRegistryEntry_type*		entry = *NameRegistryFindEntry(registry, name, NameRegistryHash(name));
+	
+	if (!entry) return NULL;
+	
+	return entry->object;
+}
+
+int NameRegistryRename (NameRegistry_type* registry, char oldName[], char newName[])
+{
+	NameRegistryEntry_type**	entryPtr	= NameRegistryFindEntry(registry, oldName, NameRegistryHash(oldName));
+	NameRegistryEntry_type*		entry		= *entryPtr;
+	unsigned int				newHash		= NameRegistryHash(newName);
+	char*						name		= NULL;
+	size_t						bucketIdx	= 0;
+	
+	if (!entry) return NameRegistry_Err_NameNotFound;
+	if (!strcmp(oldName, newName)) return 0;
+	if (*NameRegistryFindEntry(registry, newName, newHash)) return NameRegistry_Err_NameExists;
+	if (!(name = StrDup(newName))) return NameRegistry_Err_OutOfMemory;
+	
+	// unlink entry and add it again to the bucket of the new name
+	*entryPtr	= entry->next;
+	OKfree(entry->name);
+	entry->name	= name;
+	entry->hash	= newHash;
+	
+	bucketIdx					= newHash & (registry->nBuckets - 1);
+	entry->next					= registry->buckets[bucketIdx];
+	registry->buckets[bucketIdx]	= entry;
+	
+	return 0;
+}
+
+size_t GetNameRegistrySize (NameRegistry_type* registry)
+{
+	return registry->nEntries;
+}
+
+/// HIFN FNV-1a hash of a null-terminated string.
+static unsigned int NameRegistryHash (char name[])
+{
+	unsigned int	hash = 2166136261U;
+	
+	for (unsigned char* c = (unsigned char*)name; *c; c++) {
+		hash ^= *c;
+		hash *= 16777619U;
+	}
+	
+	return hash;
+}
+
+/// HIFN Returns the address of the pointer to the entry with the given name, which points to NULL if the name is not registered. 
+/// HIFN The returned address may be used to insert or unlink the entry.
+static NameRegistryEntry_type** NameRegistryFindEntry (NameRegistry_type* registry, char name[], unsigned int hash)
+{
+	NameRegistryEntry_type**	entryPtr = &registry->buckets[hash & (registry->nBuckets - 1)];
+	
+	while (*entryPtr && ((*entryPtr)->hash != hash || strcmp((*entryPtr)->name, name)))
+		entryPtr = &(*entryPtr)->next;
+	
+	return entryPtr;
+}
+
+/// HIFN Doubles the number of buckets and redistributes the entries. If there is not enough memory, the registry keeps working with longer buckets.
+static void NameRegistryGrow (NameRegistry_type* registry)
+{
+	size_t						nBuckets	= 2 * registry->nBuckets;
+	NameRegistryEntry_type**	buckets		= calloc(nBuckets, sizeof(NameRegistryEntry_type*));
+	NameRegistryEntry_type*		entry		= NULL;
+	NameRegistryEntry_type*		nextEntry	= NULL;
+	size_t						bucketIdx	= 0;
+	
+	if (!buckets) return;
+	
+	for (size_t i = 0; i < registry->nBuckets; i++)
+		for (entry = registry->buckets[i]; entry; entry = nextEntry) {
+			nextEntry		= entry->next;
+			bucketIdx		= entry->hash & (nBuckets - 1);
+			entry->next		= buckets[bucketIdx];
+			buckets[bucketIdx]	= entry;
+		}
+	
+	OKfree(registry->buckets);
+	registry->buckets	= buckets;
+	registry->nBuckets	= nBuckets;
+}
@@ -26,6 +26,9 @@
 //==============================================================================
 // Constants
 
+#define NameRegistry_Err_NameExists			-1			// Another object is already registered under the given name.
+#define NameRegistry_Err_NameNotFound		-2			// There is no object registered under the given name.
+#define NameRegistry_Err_OutOfMemory		-3
 
 //==============================================================================
 // Types
@@ -33,6 +36,9 @@
 // Function pointer type to validate user input, return TRUE for valid input
 typedef BOOL 		(*ValidateInputFptr_type) 			(char inputStr[], void* callbackData); 
 
+// Hash table of unique names, each associated with an object, for looking up objects by name in constant time.
+typedef struct NameRegistry	NameRegistry_type;
+
 //==============================================================================
 // External variables
 
@@ -47,6 +53,32 @@ char*				DLGetUINameInput					(char popupWndName[], size_t maxInputLength, Valid
 #define 			DLDynStringCat(string1, ...)		DL_DynStringCat(string1, __VA_ARGS__, NULL)
 char*				DL_DynStringCat						(char string1[], ...);
 
+//------------------------------------------------------------------------------
+// Name registry
+//------------------------------------------------------------------------------
+
+	// Creates an empty name registry. Returns NULL if out of memory.
+NameRegistry_type*	init_NameRegistry_type				(void);
+
+	// Discards a name registry. The registered objects are not discarded.
+void				discard_NameRegistry_type			(NameRegistry_type** registryPtr);
+
+	// Registers an object under a copy of the given name. On success returns 0, otherwise NameRegistry_Err_NameExists or NameRegistry_Err_OutOfMemory.
+int					NameRegistryAdd						(NameRegistry_type* registry, char name[], void* object);
+
+	// Removes a name from the registry and returns the object registered under it, or NULL if the name was not found.
+void*				NameRegistryRemove					(NameRegistry_type* registry, char name[]);
+
+	// Returns the object registered under a name, or NULL if the name was not found.
+void*				NameRegistryFind					(NameRegistry_type* registry, char name[]);
+
+	// Registers the object found under oldName under newName instead. On success returns 0, otherwise NameRegistry_Err_NameNotFound, NameRegistry_Err_NameExists
+	// or NameRegistry_Err_OutOfMemory, in which case the registry is not changed.
+int					NameRegistryRename					(NameRegistry_type* registry, char oldName[], char newName[]);
+
+	// Returns the number of registered names.
+size_t				GetNameRegistrySize					(NameRegistry_type* registry);
+
 #ifdef __cplusplus
     }
 #endif
@@ -13,6 +13,7 @@
 
 //==============================================================================
 // Include files
+#include <windows.h>
 #include "DAQLabErrHandling.h"
 #include <ansi_c.h>
 #include <formatio.h> 
@@ -26,6 +27,9 @@
 
 #define DEFAULT_SinkVChan_QueueSize			1000
 #define DEFAULT_SinkVChan_QueueWriteTimeout	1000.0	// number of [ms] to wait while trying to add a data packet to a Sink VChan TSQ
+#define SinkVChan_WritePollInterval			1		// time in [ms] the writing thread sleeps between checks for room in a blocking Sink VChan
+#define VChanMetrics_RateSmoothing			0.1		// weight of the last data packet in the moving average of the time between data packets and data packet size
+#define VChanMetrics_MinIdleTime			1.0		// time in [s] without data packets after which a VChan is considered idle if it has a higher packet rate
 
 
 //==============================================================================
@@ -40,6 +44,16 @@ typedef BOOL	(* DisconnectVChanFptr_type)		(VChan_type* VChan);
 // Checks if a VChan is connected to other VChans
 typedef BOOL 	(* VChanIsConnectedFptr_type)		(VChan_type* VChan);  
 
+// Data packet flow recorded by a VChan. The data is updated only by the thread sending data packets and may be read from other threads
+// without locking, in which case the values are only approximate.
+typedef struct {
+	size_t							nPackets;				// Number of data packets that went through the VChan, excluding NULL packets.
+	unsigned long long				nBytes;					// Number of bytes of data that went through the VChan.
+	double							lastPacketTime;			// Time in [s] given by Timer() when the last data packet went through the VChan, 0 if none.
+	double							avgInterval;			// Moving average of the time in [s] between data packets.
+	double							avgPacketSize;			// Moving average of the data packet size in [bytes].
+} PacketFlow_type;
+
 
 //==============================================================================
 // Globals
@@ -105,6 +119,25 @@ struct SinkVChan {
 	SourceVChan_type*				sourceVChan;			// SourceVChan attached to this sink.
 	CmtTSQHandle       				tsqHndl; 				// Thread safe queue handle to receive incoming data.
 	
+	//-----------------------	
+	// Overflow handling
+	//-----------------------
+	
+	SinkVChanOverflowPolicies		overflowPolicy;			// Action taken when an incoming data packet does not fit in the TSQ. Default: SinkVChan_Block.
+	size_t							maxQueuedBytes;			// Maximum number of bytes of data held by the data packets in the TSQ. If 0, only the TSQ size limits the Sink VChan.
+	ListType						queuedPacketSizes;		// Data size in [bytes] of each data packet written to the TSQ and possibly not yet read, of size_t elements in FIFO order.
+	size_t							nQueuedBytes;			// Sum of queuedPacketSizes.
+	size_t							nDroppedPackets;		// Number of data packets dropped by the overflow policy.
+	unsigned long long				nDroppedBytes;			// Number of bytes of data dropped by the overflow policy.
+	CmtThreadLockHandle				writeLock;				// Serializes writing to the TSQ and access to the overflow handling data.
+	
+	//-----------------------	
+	// Metrics
+	//-----------------------
+	
+	PacketFlow_type					packetFlow;				// Data packets written to the TSQ.
+	size_t							maxNItemsInQueue;		// Largest number of data packets in the TSQ after a write since the metrics were reset.
+	
 	
 };
 
@@ -126,6 +159,12 @@ struct SourceVChan {
 	
 	DLDataTypes						dataType;				// Type of data packet which goes through the channel.
 	ListType						sinkVChans;				// Connected Sink VChans. List of SinkVChan_type*
+	
+	//-----------------------	
+	// Metrics
+	//-----------------------
+	
+	PacketFlow_type					packetFlow;				// Data packets sent.
 											
 };
 
@@ -138,6 +177,17 @@ static BOOL 				SinkVChanIsConnected 				(SinkVChan_type* sinkVChan);
 static size_t				GetNumActiveSinkVChans				(SourceVChan_type* srcVChan);
 static size_t				GetNumOpenSinkVChans				(SourceVChan_type* srcVChan);
 
+	// Sink VChan overflow handling
+static void					UpdateSinkVChanQueuedBytes			(SinkVChan_type* sinkVChan);
+static BOOL					SinkVChanHasRoom					(SinkVChan_type* sinkVChan, size_t packetSize, BOOL checkNItems);
+static void					DropDataPacket						(SinkVChan_type* sinkVChan, DataPacket_type** dataPacketPtr);
+static size_t				DropQueuedDataPackets				(SinkVChan_type* sinkVChan, BOOL allPackets);
+static int					WriteSinkVChanDataPacket			(SinkVChan_type* sinkVChan, DataPacket_type* dataPacket, char** errorMsg);
+
+	// Metrics
+static void					RecordPacketFlow					(PacketFlow_type* packetFlow, size_t packetSize);
+static void					GetPacketFlowRates					(PacketFlow_type* packetFlow, double* packetRatePtr, double* byteRatePtr);
+
 
 static BOOL SourceVChanIsConnected (SourceVChan_type* srcVChan)
 {
@@ -186,6 +236,236 @@ static size_t GetNumOpenSinkVChans (SourceVChan_type* srcVChan)
 	return nOpenSinkVChans;
 }
 
+/// HIFN Removes from the queued data size bookkeeping the data packets that were read from the Sink VChan TSQ since the last update.
+/// HIFN Since data packets leave the TSQ in FIFO order, the number of items left in the TSQ is sufficient to determine which ones were read, 
+/// HIFN regardless whether they were read with GetDataPacket or directly from the TSQ. Call only while holding the Sink VChan write lock.
+static void UpdateSinkVChanQueuedBytes (SinkVChan_type* sinkVChan)
+{
+	size_t	nItemsInQueue		= 0;
+	size_t	packetSize			= 0;
+	
+	if (CmtGetTSQAttribute(sinkVChan->tsqHndl, ATTR_TSQ_ITEMS_IN_QUEUE, &nItemsInQueue) < 0) return;
+	
+	while (ListNumItems(sinkVChan->queuedPacketSizes) > nItemsInQueue) {
+		ListRemoveItem(sinkVChan->queuedPacketSizes, &packetSize, FRONT_OF_LIST);
+		sinkVChan->nQueuedBytes -= packetSize;
+	}
+}
+
+/// HIFN Checks if a data packet of a given size fits in the Sink VChan without exceeding the maximum number of queued bytes and, if checkNItems is TRUE,
+/// HIFN the TSQ size. A data packet that exceeds on its own the maximum number of queued bytes fits only in an empty Sink VChan, while NULL packets and data packets
+/// HIFN without data are limited only by the TSQ size. Call only while holding the Sink VChan write lock.
+static BOOL SinkVChanHasRoom (SinkVChan_type* sinkVChan, size_t packetSize, BOOL checkNItems)
+{
+	size_t	nItemsInQueue		= 0;
+	size_t	queueSize			= 0;
+	
+	UpdateSinkVChanQueuedBytes(sinkVChan);
+	
+	if (checkNItems) {
+		CmtGetTSQAttribute(sinkVChan->tsqHndl, ATTR_TSQ_ITEMS_IN_QUEUE, &nItemsInQueue);
+		CmtGetTSQAttribute(sinkVChan->tsqHndl, ATTR_TSQ_QUEUE_SIZE, &queueSize);
+		if (nItemsInQueue >= queueSize) return FALSE;
+	}
+	
+	if (!sinkVChan->maxQueuedBytes || !sinkVChan->nQueuedBytes || !packetSize) return TRUE;
+	
+	return (sinkVChan->nQueuedBytes + packetSize <= sinkVChan->maxQueuedBytes);
+}
+
+/// HIFN Releases the Sink VChan reference to a data packet that will not be processed and updates the drop counters. Call only while holding the Sink VChan write lock.
+static void DropDataPacket (SinkVChan_type* sinkVChan, DataPacket_type** dataPacketPtr)
+{
+	sinkVChan->nDroppedPackets++;
+	sinkVChan->nDroppedBytes += GetDataPacketDataSize(*dataPacketPtr);
+	ReleaseDataPacket(dataPacketPtr);
+}
+
+/// HIFN Drops the oldest data packet, or if allPackets is TRUE all data packets, queued in the Sink VChan TSQ. NULL packets marking the end of a transmission are
+/// HIFN never dropped and stay queued in their order. Returns the number of dropped data packets. Call only while holding the Sink VChan write lock.
+static size_t DropQueuedDataPackets (SinkVChan_type* sinkVChan, BOOL allPackets)
+{
+	size_t				queueSize		= 0;
+	DataPacket_type**	dataPackets		= NULL;
+	int					nItemsRead		= 0;
+	int					nItemsKept		= 0;
+	size_t				nDropped		= 0;
+	size_t				packetSize		= 0;
+	
+	if (CmtGetTSQAttribute(sinkVChan->tsqHndl, ATTR_TSQ_QUEUE_SIZE, &queueSize) < 0 || !queueSize) return 0;
+	if (!(dataPackets = malloc(queueSize * sizeof(DataPacket_type*)))) return 0;
+	
+	// take out all queued data packets at once, since the TSQ can only be read from the front
+	if ((nItemsRead = CmtReadTSQData(sinkVChan->tsqHndl, dataPackets, (int)queueSize, 0, 0)) <= 0) {
+		OKfree(dataPackets);
+		return 0;
+	}
+	
+	// forget the sizes of data packets read by the sink before this point, so that queuedPacketSizes matches dataPackets
+	while (ListNumItems(sinkVChan->queuedPacketSizes) > (size_t)nItemsRead) {
+		ListRemoveItem(sinkVChan->queuedPacketSizes, &packetSize, FRONT_OF_LIST);
+		sinkVChan->nQueuedBytes -= packetSize;
+	}
+	
+	for (int i = 0; i < nItemsRead; i++) {
+		if (dataPackets[i] && (allPackets || !nDropped)) {
+			ListRemoveItem(sinkVChan->queuedPacketSizes, &packetSize, nItemsKept + 1);
+			sinkVChan->nQueuedBytes -= packetSize;
+			DropDataPacket(sinkVChan, &dataPackets[i]);
+			nDropped++;
+		} else
+			dataPackets[nItemsKept++] = dataPackets[i];
+	}
+	
+	// put back the remaining data packets in their order, there is room for them since only this Sink VChan writes to the TSQ
+	if (nItemsKept)
+		CmtWriteTSQData(sinkVChan->tsqHndl, dataPackets, nItemsKept, 0, NULL);
+	
+	OKfree(dataPackets);
+	
+	return nDropped;
+}
+
+/// HIFN Records a data packet going through a VChan. Call only from the thread sending data packets.
+static void RecordPacketFlow (PacketFlow_type* packetFlow, size_t packetSize)
+{
+	double	now		= Timer();
+	
+	if (packetFlow->lastPacketTime > 0.0) {
+		if (packetFlow->avgInterval > 0.0) {
+			packetFlow->avgInterval 	+= VChanMetrics_RateSmoothing * (now - packetFlow->lastPacketTime - packetFlow->avgInterval);
+			packetFlow->avgPacketSize	+= VChanMetrics_RateSmoothing * ((double)packetSize - packetFlow->avgPacketSize);
+		} else {
+			packetFlow->avgInterval		= now - packetFlow->lastPacketTime;
+			packetFlow->avgPacketSize	= (double)packetSize;
+		}
+	}
+	
+	packetFlow->lastPacketTime = now;
+	packetFlow->nPackets++;
+	packetFlow->nBytes += packetSize;
+}
+
+/// HIFN Returns the current data packet rate in [packets/s] and data rate in [bytes/s]. If no data packets went through the VChan for more than a few average
+/// HIFN intervals between data packets, the VChan is considered idle and both rates are 0.
+static void GetPacketFlowRates (PacketFlow_type* packetFlow, double* packetRatePtr, double* byteRatePtr)
+{
+	double	avgInterval		= packetFlow->avgInterval;
+	double	lastPacketTime	= packetFlow->lastPacketTime;
+	double	idleTime		= 4 * avgInterval;
+	
+	*packetRatePtr	= 0;
+	*byteRatePtr	= 0;
+	
+	if (avgInterval <= 0.0) return;
+	
+	if (idleTime < VChanMetrics_MinIdleTime) 
+		idleTime = VChanMetrics_MinIdleTime;
+	
+	if (Timer() - lastPacketTime > idleTime) return;
+	
+	*packetRatePtr	= 1/avgInterval;
+	*byteRatePtr	= packetFlow->avgPacketSize/avgInterval;
+}
+
+/// HIFN Writes a data packet to a Sink VChan TSQ applying the Sink VChan overflow policy. If the data packet is dropped, the reference to the data packet held
+/// HIFN for this Sink VChan is released. If the function fails, the reference is not released.
+/// HIRET 0 if successful, and negative error code otherwise.
+static int WriteSinkVChanDataPacket (SinkVChan_type* sinkVChan, DataPacket_type* dataPacket, char** errorMsg)
+{
+#define WriteSinkVChanDataPacket_Err_Timeout	-1
+INIT_ERR
+	
+	size_t				packetSize		= GetDataPacketDataSize(dataPacket);
+	int					nItemsWritten	= 0;
+	double				startTime		= Timer();
+	BOOL				lockObtained	= FALSE;
+	
+	CmtErrChk( CmtGetLock(sinkVChan->writeLock) );
+	lockObtained = TRUE;
+	
+	// NULL packets mark the end of a transmission and are never dropped
+	if (!dataPacket || sinkVChan->overflowPolicy == SinkVChan_Block) {
+		
+		// wait until the Sink VChan has room for the data packet, the write lock is released while waiting so that the drop counters and metrics can be read meanwhile
+		while (!SinkVChanHasRoom(sinkVChan, packetSize, TRUE) || !(nItemsWritten = CmtWriteTSQData(sinkVChan->tsqHndl, &dataPacket, 1, 0, NULL))) {
+			CmtErrChk( nItemsWritten );
+			
+			CmtReleaseLock(sinkVChan->writeLock);
+			lockObtained = FALSE;
+			
+			if ((Timer() - startTime) * 1e3 > sinkVChan->writeTimeout)
+				SET_ERR(WriteSinkVChanDataPacket_Err_Timeout, "Writing data packet to Sink VChan timed out. The Sink VChan queue is full or the queued data exceeds the maximum number of bytes.");
+			
+			Sleep(SinkVChan_WritePollInterval);
+			
+			CmtErrChk( CmtGetLock(sinkVChan->writeLock) );
+			lockObtained = TRUE;
+		}
+		
+	} else {
+		
+		switch (sinkVChan->overflowPolicy) {
+				
+			case SinkVChan_Block:
+				break;
+				
+			case SinkVChan_DropNewest:
+				
+				if (!SinkVChanHasRoom(sinkVChan, packetSize, TRUE)) {
+					DropDataPacket(sinkVChan, &dataPacket);
+					goto Done;
+				}
+				break;
+				
+			case SinkVChan_DropOldest:
+				
+				while (!SinkVChanHasRoom(sinkVChan, packetSize, TRUE))
+					if (!DropQueuedDataPackets(sinkVChan, FALSE)) break;
+				break;
+				
+			case SinkVChan_LatestOnly:
+				
+				DropQueuedDataPackets(sinkVChan, TRUE);
+				break;
+		}
+		
+		// the Sink VChan may have been filled in the meantime only if data packets are also written to the TSQ from elsewhere, in which case drop the incoming data packet
+		CmtErrChk( nItemsWritten = CmtWriteTSQData(sinkVChan->tsqHndl, &dataPacket, 1, 0, NULL) );
+		if (!nItemsWritten) {
+			DropDataPacket(sinkVChan, &dataPacket);
+			goto Done;
+		}
+	}
+	
+	// keep track of the queued data size
+	ListInsertItem(sinkVChan->queuedPacketSizes, &packetSize, END_OF_LIST);
+	sinkVChan->nQueuedBytes += packetSize;
+	
+	// metrics
+	if (dataPacket)
+		RecordPacketFlow(&sinkVChan->packetFlow, packetSize);
+	
+	if (ListNumItems(sinkVChan->queuedPacketSizes) > sinkVChan->maxNItemsInQueue)
+		sinkVChan->maxNItemsInQueue = ListNumItems(sinkVChan->queuedPacketSizes);
+	
+Done:
+	
+	CmtReleaseLock(sinkVChan->writeLock);
+	return 0;
+	
+CmtError:
+	
+Cmt_ERR
+
+Error:
+	
+	if (lockObtained)
+		CmtReleaseLock(sinkVChan->writeLock);
+	
+RETURN_ERR
+}
+
 
 static int 					init_VChan_type 					(VChan_type* 					vchan, 
 																char 							name[], 
@@ -252,6 +532,11 @@ static void discard_SinkVChan_type (SinkVChan_type** sinkVChanPtr)
 	
 	// discard Sink VChan specific data 
 	CmtDiscardTSQ(sinkVChan->tsqHndl);
+	OKfreeList(&sinkVChan->queuedPacketSizes, NULL);
+	if (sinkVChan->writeLock) {
+		CmtDiscardLock(sinkVChan->writeLock);
+		sinkVChan->writeLock = 0;
+	}
 	
 	// discard base VChan data
 	OKfree(sinkVChan->baseClass.name);
@@ -360,6 +645,9 @@ SourceVChan_type* init_SourceVChan_type (char 							name[],
 	// init data packet type
 	vchan->dataType = dataType;
 	
+	// init metrics
+	memset(&vchan->packetFlow, 0, sizeof(PacketFlow_type));
+	
 	return vchan;
 	
 Error:
@@ -380,7 +668,9 @@ SinkVChan_type* init_SinkVChan_type (char 							name[],
 	if (!vchan) return NULL;
 	
 	// init
-	vchan->dataTypes		= NULL;
+	vchan->dataTypes			= NULL;
+	vchan->queuedPacketSizes	= 0;
+	vchan->writeLock			= 0;
 	
 	// init base VChan type
 	if (init_VChan_type ((VChan_type*) vchan, name, VChan_Sink, VChanOwner, (DiscardVChanFptr_type)discard_SinkVChan_type, 
@@ -400,11 +690,26 @@ SinkVChan_type* init_SinkVChan_type (char 							name[],
 	// init write timeout (time to keep on trying to write a data packet to the queue)
 	vchan->writeTimeout 	= DEFAULT_SinkVChan_QueueWriteTimeout;
 	
+	// init overflow handling
+	vchan->overflowPolicy	= SinkVChan_Block;
+	vchan->maxQueuedBytes	= 0;
+	vchan->nQueuedBytes		= 0;
+	vchan->nDroppedPackets	= 0;
+	vchan->nDroppedBytes	= 0;
+	
+	// init metrics
+	memset(&vchan->packetFlow, 0, sizeof(PacketFlow_type));
+	vchan->maxNItemsInQueue	= 0;
+	
+	if (!(vchan->queuedPacketSizes = ListCreate(sizeof(size_t)))) goto Error;
+	if (CmtNewLock(NULL, 0, &vchan->writeLock) < 0) goto Error;
+	
 	return vchan;
 	
 Error:
 	
 	OKfree(vchan->dataTypes);
+	OKfreeList(&vchan->queuedPacketSizes, NULL);
 	discard_VChan_type ((VChan_type**)&vchan);  // do this last
 	return NULL;
 }
@@ -774,6 +1079,108 @@ double GetSinkVChanReadTimeout	(SinkVChan_type* sinkVChan)
 	return sinkVChan->readTimeout;
 }
 
+void SetSinkVChanOverflowPolicy (SinkVChan_type* sinkVChan, SinkVChanOverflowPolicies policy)
+{
+	CmtGetLock(sinkVChan->writeLock);
+	sinkVChan->overflowPolicy = policy;
+	CmtReleaseLock(sinkVChan->writeLock);
+}
+
+SinkVChanOverflowPolicies GetSinkVChanOverflowPolicy (SinkVChan_type* sinkVChan)
+{
+	return sinkVChan->overflowPolicy;
+}
+
+void SetSinkVChanMaxQueuedBytes (SinkVChan_type* sinkVChan, size_t nBytes)
+{
+	CmtGetLock(sinkVChan->writeLock);
+	sinkVChan->maxQueuedBytes = nBytes;
+	CmtReleaseLock(sinkVChan->writeLock);
+}
+
+size_t GetSinkVChanMaxQueuedBytes (SinkVChan_type* sinkVChan)
+{
+	return sinkVChan->maxQueuedBytes;
+}
+
+void GetSinkVChanDropCounters (SinkVChan_type* sinkVChan, size_t* nPacketsPtr, unsigned long long* nBytesPtr)
+{
+	CmtGetLock(sinkVChan->writeLock);
+	if (nPacketsPtr) *nPacketsPtr = sinkVChan->nDroppedPackets;
+	if (nBytesPtr) *nBytesPtr = sinkVChan->nDroppedBytes;
+	CmtReleaseLock(sinkVChan->writeLock);
+}
+
+void ResetSinkVChanDropCounters (SinkVChan_type* sinkVChan)
+{
+	CmtGetLock(sinkVChan->writeLock);
+	sinkVChan->nDroppedPackets	= 0;
+	sinkVChan->nDroppedBytes	= 0;
+	CmtReleaseLock(sinkVChan->writeLock);
+}
+
+void GetVChanMetrics (VChan_type* VChan, VChanMetrics_type* metrics)
+{
+	SourceVChan_type*	srcVChan	= NULL;
+	SinkVChan_type*		sinkVChan	= NULL;
+	
+	memset(metrics, 0, sizeof(VChanMetrics_type));
+	
+	switch (VChan->dataFlow) {
+			
+		case VChan_Source:
+			
+			srcVChan = (SourceVChan_type*) VChan;
+			metrics->nPackets	= srcVChan->packetFlow.nPackets;
+			metrics->nBytes		= srcVChan->packetFlow.nBytes;
+			GetPacketFlowRates(&srcVChan->packetFlow, &metrics->packetRate, &metrics->byteRate);
+			break;
+			
+		case VChan_Sink:
+			
+			sinkVChan = (SinkVChan_type*) VChan;
+			CmtGetLock(sinkVChan->writeLock);
+			UpdateSinkVChanQueuedBytes(sinkVChan);
+			metrics->nPackets			= sinkVChan->packetFlow.nPackets;
+			metrics->nBytes				= sinkVChan->packetFlow.nBytes;
+			GetPacketFlowRates(&sinkVChan->packetFlow, &metrics->packetRate, &metrics->byteRate);
+			metrics->nQueuedPackets		= ListNumItems(sinkVChan->queuedPacketSizes);
+			metrics->maxQueuedPackets	= sinkVChan->maxNItemsInQueue;
+			metrics->nQueuedBytes		= sinkVChan->nQueuedBytes;
+			metrics->nDroppedPackets	= sinkVChan->nDroppedPackets;
+			metrics->nDroppedBytes		= sinkVChan->nDroppedBytes;
+			CmtReleaseLock(sinkVChan->writeLock);
+			CmtGetTSQAttribute(sinkVChan->tsqHndl, ATTR_TSQ_QUEUE_SIZE, &metrics->queueSize);
+			break;
+	}
+}
+
+void ResetVChanMetrics (VChan_type* VChan)
+{
+	SourceVChan_type*	srcVChan	= NULL;
+	SinkVChan_type*		sinkVChan	= NULL;
+	
+	switch (VChan->dataFlow) {
+			
+		case VChan_Source:
+			
+			srcVChan = (SourceVChan_type*) VChan;
+			memset(&srcVChan->packetFlow, 0, sizeof(PacketFlow_type));
+			break;
+			
+		case VChan_Sink:
+			
+			sinkVChan = (SinkVChan_type*) VChan;
+			CmtGetLock(sinkVChan->writeLock);
+			memset(&sinkVChan->packetFlow, 0, sizeof(PacketFlow_type));
+			sinkVChan->maxNItemsInQueue	= 0;
+			sinkVChan->nDroppedPackets	= 0;
+			sinkVChan->nDroppedBytes	= 0;
+			CmtReleaseLock(sinkVChan->writeLock);
+			break;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Data Packet Management
 //------------------------------------------------------------------------------
@@ -817,8 +1224,10 @@ INIT_ERR
 	} else
 		nPacketRecipients = GetNumOpenSinkVChans(srcVChan);
 		
-	if (*dataPacketPtr)
+	if (*dataPacketPtr) {
 		SetDataPacketCounter(*dataPacketPtr, nPacketRecipients);
+		RecordPacketFlow(&srcVChan->packetFlow, GetDataPacketDataSize(*dataPacketPtr));
+	}
 		
 	// if there are no recipients then dispose of the data packet
 	if (!nPacketRecipients) {
@@ -830,18 +1239,14 @@ INIT_ERR
 	for (size_t i = 1; i <= nSinks; i++) {
 		sinkVChan = *(SinkVChan_type**)ListGetPtrToItem(srcVChan->sinkVChans,i);
 		if (!sinkVChan->baseClass.isOpen) continue; // forward packet only to open Sink VChans connected to this Source VChan
-		// put data packet into Sink VChan TSQ
-		CmtErrChk( CmtWriteTSQData(sinkVChan->tsqHndl, dataPacketPtr, 1, (int)sinkVChan->writeTimeout, NULL) );
+		// put data packet into Sink VChan TSQ, or drop it, depending on the Sink VChan overflow policy
+		errChk( WriteSinkVChanDataPacket(sinkVChan, *dataPacketPtr, &errorInfo.errMsg) );
 		nPacketsSent++;
 	}
 	
 	*dataPacketPtr = NULL; 	// Data packet is considered to be consumed even if sending to some Sink VChans did not succeed
 							// Sink VChans that did receive the data packet, can further process it and release it.
 	return 0;
-
-CmtError:
-	
-Cmt_ERR
 	
 Error:
 
@@ -48,6 +48,31 @@ typedef enum {
 	VChan_Open		= TRUE
 } VChanStates;
 
+// Action taken by a Sink VChan when a new data packet does not fit in its queue, i.e. when either the maximum number
+// of data packets or the maximum number of queued bytes would be exceeded. NULL packets marking the end of a transmission
+// are never dropped, neither when they arrive, in which case they are written as with SinkVChan_Block, nor while queued.
+typedef enum {
+	SinkVChan_Block,					// Wait for the Sink VChan to process data packets until the write timeout, then return an error. Default.
+	SinkVChan_DropNewest,				// Drop the incoming data packet.
+	SinkVChan_DropOldest,				// Drop the oldest queued data packets until the incoming data packet fits.
+	SinkVChan_LatestOnly				// Drop all queued data packets and keep only the incoming one. Meant for sinks that process each data packet on its own, e.g. displays.
+} SinkVChanOverflowPolicies;
+
+// Data flow metrics of a VChan. For a Source VChan these are the data packets sent and for a Sink VChan the data packets placed in its queue.
+// The queue fields apply only to Sink VChans.
+typedef struct {
+	size_t						nPackets;				// Number of data packets since the metrics were reset, excluding NULL packets.
+	unsigned long long			nBytes;					// Number of bytes of data since the metrics were reset.
+	double						packetRate;				// Current data packet rate in [packets/s], 0 if the VChan is idle.
+	double						byteRate;				// Current data rate in [bytes/s], 0 if the VChan is idle.
+	size_t						nQueuedPackets;			// Number of data packets waiting in the queue.
+	size_t						maxQueuedPackets;		// Largest number of data packets waiting in the queue since the metrics were reset.
+	size_t						queueSize;				// Maximum number of data packets the queue can hold.
+	size_t						nQueuedBytes;			// Number of bytes of data held by the queued data packets.
+	size_t						nDroppedPackets;		// Number of data packets dropped by the overflow policy since the metrics were reset.
+	unsigned long long			nDroppedBytes;			// Number of bytes of data dropped by the overflow policy since the metrics were reset.
+} VChanMetrics_type;
+
 // Callback when a VChan opens/closes.
 typedef void				(*VChanStateChangeCBFptr_type)		(VChan_type* self, void* VChanOwner, VChanStates state);
 
@@ -148,6 +173,23 @@ size_t						GetSinkVChanTSQSize					(SinkVChan_type* sinkVChan);
 void						SetSinkVChanReadTimeout				(SinkVChan_type* sinkVChan, double time);	
 double						GetSinkVChanReadTimeout				(SinkVChan_type* sinkVChan);
 
+	// Action taken when an incoming data packet does not fit in the Sink VChan queue
+void						SetSinkVChanOverflowPolicy			(SinkVChan_type* sinkVChan, SinkVChanOverflowPolicies policy);
+SinkVChanOverflowPolicies	GetSinkVChanOverflowPolicy			(SinkVChan_type* sinkVChan);
+
+	// Maximum number of bytes of data the queued data packets of a Sink VChan may hold. If 0, only the queue size limits the Sink VChan. 
+	// Note: a data packet larger than this limit is still accepted if the queue is empty.
+void						SetSinkVChanMaxQueuedBytes			(SinkVChan_type* sinkVChan, size_t nBytes);
+size_t						GetSinkVChanMaxQueuedBytes			(SinkVChan_type* sinkVChan);
+
+	// Number of data packets and bytes of data dropped by the Sink VChan overflow policy since the Sink VChan was created or the counters were reset.
+void						GetSinkVChanDropCounters			(SinkVChan_type* sinkVChan, size_t* nPacketsPtr, unsigned long long* nBytesPtr);
+void						ResetSinkVChanDropCounters			(SinkVChan_type* sinkVChan);
+
+	// Data flow metrics. Resetting the metrics of a Sink VChan also resets its drop counters.
+void						GetVChanMetrics						(VChan_type* VChan, VChanMetrics_type* metrics);
+void						ResetVChanMetrics					(VChan_type* VChan);
+
 //------------------------------------------------------------------------------
 // Data Packet Management
 //------------------------------------------------------------------------------
@@ -156,7 +198,7 @@ double						GetSinkVChanReadTimeout				(SinkVChan_type* sinkVChan);
 int							ReleaseAllDataPackets				(SinkVChan_type* sinkVChan, char** errorMsg);
 
 	// Sends a data packet from an open Source VChan to its active (and open) Sink VChans. If the Source VChan also needs to use the data packet after it was sent
-	// then set sourceNeedsPacket = TRUE.
+	// then set sourceNeedsPacket = TRUE. If a Sink VChan queue is full, the Sink VChan overflow policy determines whether the function waits or drops data packets.
 int				 			SendDataPacket 						(SourceVChan_type* srcVChan, DataPacket_type** dataPacketPtr, BOOL sourceNeedsPacket, char** errorMsg);
 
 	// Sends a NULL data packet to mark the end of a transmission.
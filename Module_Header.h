@@ -106,6 +106,16 @@
 #define	initalloc_DataStorage NULL
 #endif		
 
+//------------------------------------------------------
+// Data replay
+//------------------------------------------------------
+#ifdef DAQLabModule_DataReplay
+	#include "DataReplay.h"
+#else		// not defined
+	#define	MOD_DataReplay_NAME NULL
+	#define	initalloc_DataReplay NULL
+#endif
+
 //------------------------------------------------------
 // Coherent Chameleon Laser
 //------------------------------------------------------
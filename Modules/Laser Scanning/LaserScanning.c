@@ -33,6 +33,8 @@
 #include "ImageDisplayNIVision.h"
 // use of native CVI controls is not yet fully implemented
 //#include "ImageDisplayCVI.h"
+// renders images into memory without display windows, e.g. for load tests
+//#include "ImageDisplayHeadless.h"
 //----------------------------------------------------------------------------
 
 									 
@@ -45,7 +47,6 @@
 
 #define MOD_LaserScanning_UI 								"./Modules/Laser Scanning/UI_LaserScanning.uir"
 #define VChanDataTimeout									1e4					// Timeout in [ms] for Sink VChans to receive data
-#define TaskControllerIterationTimeout						20					// Timeout in [s] to complete the task controller iteration function
 
 //--------------------------------------------------------------------------------
 // Default VChan names
@@ -61,7 +62,11 @@
 #define ScanEngine_SinkVChan_SlowAxis_Position				"slow axis position"
 #define ScanEngine_SourceVChan_CompositeImage				"composite image"			// Combined image channels.
 #define ScanEngine_SourceVChan_ImageChannel					"image channel"				// Assembled image from a single detection channel. VChan of DL_Image type for frame scan and Allowed_Detector_Data_Types for point scan.
+#define ScanEngine_SourceVChan_ImageHistogram				"image histogram"			// Pixel value histogram of each displayed image from a single detection channel. VChan of DL_Waveform_UInt type.
+#define ScanEngine_SourceVChan_ImageHistogramRange			"image histogram range"		// Pixel values at the start of the first and at the end of the last bin of each image histogram. VChan of DL_Waveform_Double type.
+#define ScanEngine_SourceVChan_ROITraces					"ROI traces"				// Mean pixel value of each ROI of each assembled image from a single detection channel, in the order of the image ROIs. Images are left out if their scan settings differ from the parent frame scan or their ROIs differ from those of the first image of the run, so that all traces of a run have the same ROIs. VChan of DL_Waveform_Double type.
 #define ScanEngine_SinkVChan_DetectionChan					"detection channel"			// Incoming fluorescence signal to assemble an image from.
+#define ScanEngine_SinkVChan_Display						"display"					// Images or waveforms from other modules shown in the displays of a detection channel. Only the latest data packet is kept. See Allowed_Display_Data_Types.
 #define ScanEngine_SourceVChan_PixelPulseTrain				"pixel pulse train"			// Source VChan of DL_PulseTrain_Ticks type
 #define ScanEngine_SourceVChan_PixelSamplingRate			"pixel sampling rate"		// 1/pixel_dwell_time = pixel sampling rate in [Hz]
 #define ScanEngine_SourceVChan_NPixels						"detection channel n pixels"
@@ -81,6 +86,8 @@
 // Scan engine settings
 #define Max_NewScanEngine_NameLength						50
 #define Allowed_Detector_Data_Types							{DL_Waveform_UChar, DL_Waveform_UShort, DL_Waveform_Short, DL_Waveform_Float}  // DL_Waveform_UInt is not allowed because of NI Vision
+#define Allowed_Display_Data_Types							{DL_Image, DL_Waveform_Char, DL_Waveform_UChar, DL_Waveform_Short, DL_Waveform_UShort, DL_Waveform_Int, DL_Waveform_UInt, \
+															 DL_Waveform_Int64, DL_Waveform_UInt64, DL_Waveform_Float, DL_Waveform_Double}
 
 // Non-resonant galvo calibration parameters
 #define	CALIBRATION_DATA_TO_STRING							"%s<%*f[j1] "
@@ -314,7 +321,14 @@ typedef enum {
 
 typedef struct {
 	SinkVChan_type*				detVChan;					// For receiving pixel data. See Allowed_Detector_Data_Types for VChan data types
+	SinkVChan_type*				displayVChan;				// For receiving images and waveforms to display. See Allowed_Display_Data_Types for VChan data types. Keeps only the latest data packet.
 	SourceVChan_type*			outputVChan;				// Assembled image or waveform for this channel. VChan of DL_Image type for frame scan and Allowed_Detector_Data_Types for point scan.
+	SourceVChan_type*			histogramVChan;				// Pixel value histogram of the displayed images of this channel. VChan of DL_Waveform_UInt type.
+	SourceVChan_type*			histogramRangeVChan;		// Pixel values at the start of the first and at the end of the last histogram bin, sent before each histogram. VChan of DL_Waveform_Double type.
+	ImageStats_type* volatile	pendingHistogramStats;		// Statistics of the latest displayed image waiting to be sent from a worker thread, NULL if none.
+	volatile LONG				histogramSendScheduled;		// 1 if sending the pending statistics was scheduled on a worker thread and did not finish, 0 otherwise.
+	CmtThreadFunctionID			histogramSendID;			// Worker thread function sending the pending statistics, 0 if none was scheduled.
+	SourceVChan_type*			ROITracesVChan;				// Mean pixel value of each ROI of the assembled images of this channel. VChan of DL_Waveform_Double type.
 	ScanChanColorScales			color;						// Color channel assigned to this channel.
 	ScanEngine_type*			scanEngine;					// Reference to scan engine to which this scan channel belongs.
 	CmtTSVHandle				imgDisplayTSV;				// Thread safe variable of ImageDisplay_type*
@@ -477,6 +491,7 @@ typedef struct {
 	void*						imagePixels;				// Pixel array for the image assembled so far. Array contains nImagePixels
 	uInt64						nImagePixels;				// Total number of pixels in imagePixels. Maximum Array size is imgWidth*imgHeight
 	uInt32						nAssembledRows;				// Number of assembled rows (in the direction of image height).
+	uInt32						nDisplayedRows;				// Number of assembled rows passed on to the display while the image is acquired.
 	void*						tmpPixels;					// Temporary pixels used to assemble an image. Array containing nTmpPixels elements
 	size_t						nTmpPixels;					// Number of pixels in tmpPixels.
 	size_t						nSkipPixels;				// Number of pixels left to skip from the pixel stream.
@@ -487,6 +502,8 @@ typedef struct {
 	DLDataTypes					pixelDataType;
 	ScanChan_type*				scanChan;					// Detection channel to which this image assembly buffer belongs.
 	Image_type*					image;						// A completely assembled image, otherwise this is NULL.
+	Image_type*					compositeImage;				// Copy of the last assembled image waiting for the images of the other channels to be combined in the composite image, otherwise NULL.
+	ROIMasks_type*				ROIMasks;					// Pixel masks of the ROIs of the first image of a run used to compute ROI traces. NULL if not created yet.
 } RectRasterImgBuff_type;
 
 
@@ -890,6 +907,10 @@ static int								NonResRectRasterScan_GenerateScanSignals			(RectRaster_type* s
 	// builds images from a continuous pixel stream
 static int 								NonResRectRasterScan_BuildImage 					(RectRaster_type* rectRaster, size_t bufferIdx, char** errorMsg);
 	// assembles a composite frame scan image
+	// Checks if the channel images must be combined in a composite image, i.e. if the composite image VChan is open or any channel is assigned a color.
+static BOOL								NonResRectRasterScan_CompositeImageNeeded			(RectRaster_type* rectRaster);
+
+	// Combines the last image of each channel into a composite image shown in the composite image display and sent on the composite image VChan.
 static int								NonResRectRasterScan_AssembleCompositeImage			(RectRaster_type* rectRaster, char** errorMsg);
 	// rounds a given time in [ms] to an integer of galvo sampling intervals
 static double 							NonResRectRasterScan_RoundToGalvoSampling 			(RectRaster_type* scanEngine, double time);
@@ -1026,6 +1047,9 @@ static void								GalvoComSampleRateVChan_StateChange 				(VChan_type* self, vo
 	// Detection Channels
 static void								DetectionVChan_StateChange							(VChan_type* self, void* VChanOwner, VChanStates state); 
 
+	// Shows the latest image or waveform received by the display VChan of a detection channel
+static int								DisplayVChan_DataReceived							(TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, SinkVChan_type* sinkVChan, BOOL const* abortFlag, char** errorMsg);
+
 	// Scan engine mode switching VChan activation/deactivation
 static void 							SetRectRasterScanEngineModeVChans 					(RectRaster_type* scanEngine);
 
@@ -1039,6 +1063,18 @@ static void 							ImageDisplay_CB 									(ImageDisplay_type* imgDisplay, int
 
 static void 							WaveformDisplay_CB 									(WaveformDisplay_type* waveformDisplay, int event, void* callbackData);
 
+	// Keeps the statistics of a displayed image for sending and schedules sending them on a worker thread, so that a slow histogram sink never holds up the main thread.
+static int								PostImageHistogram									(ScanChan_type* scanChan, ImageStats_type* stats, char** errorMsg);
+
+	// Sends the latest posted image statistics of a scan channel until none are pending.
+static int CVICALLBACK					SendImageHistogram_Thread							(void* functionData);
+
+	// Sends the histogram bin edges and the histogram of a displayed image on the histogram VChans of a scan channel.
+static int								SendImageHistogram									(ScanChan_type* scanChan, ImageStats_type* stats, char** errorMsg);
+
+	// Sends the mean pixel value of each ROI of an assembled image on the ROI traces VChan of a scan channel.
+static int								SendImageROITraces									(RectRaster_type* rectRaster, RectRasterImgBuff_type* imgBuffer, char** errorMsg);
+
 static void								RestoreScanSettingsFromImageDisplay					(ImageDisplay_type* imgDisplay, RectRaster_type* scanEngine, RectRasterScanSet_type* previousScanSettings); 
 
 //-----------------------------------------
@@ -1088,6 +1124,8 @@ static void 							ErrorTC_RectRaster 									(TaskControl_type* taskControl, i
 
 static int								ModuleEventHandler_RectRaster						(TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, void* eventData, BOOL const* abortFlag, char** errorMsg);
 
+static int								EstimateIterationTC_RectRaster						(TaskControl_type* taskControl, double* iterationDuration, ListType VChanData, char** errorMsg);
+
 static void								SetRectRasterTaskControllerSettings					(RectRaster_type* scanEngine);
 
 	// add below more task controller callbacks for different scan engine types
@@ -3330,6 +3368,10 @@ INIT_ERR
 	ScanChan_type* 			scanChan		= malloc(sizeof(ScanChan_type));
 	char*					detVChanName	= NULL;
 	char*					outputVChanName	= NULL;
+	char*					histVChanName	= NULL;
+	char*					histRangeName	= NULL;
+	char*					tracesVChanName	= NULL;
+	char*					dispVChanName	= NULL;
 	ImageDisplay_type**		imgDisplayPtr	= NULL;
 	
 	if (!scanChan) return NULL;
@@ -3339,11 +3381,19 @@ INIT_ERR
 	//--------------------
 	
 	DLDataTypes allowedPacketTypes[] 		= Allowed_Detector_Data_Types;
+	DLDataTypes allowedDisplayTypes[]		= Allowed_Display_Data_Types;
 	scanChan->imgDisplayTSV					= 0;
 	scanChan->imgDisplayTSVLineNumDebug		= 0;
 	scanChan->waveDisplay					= NULL;
 	scanChan->detVChan						= NULL;
+	scanChan->displayVChan					= NULL;
 	scanChan->outputVChan					= NULL;
+	scanChan->histogramVChan				= NULL;
+	scanChan->histogramRangeVChan			= NULL;
+	scanChan->pendingHistogramStats			= NULL;
+	scanChan->histogramSendScheduled		= 0;
+	scanChan->histogramSendID				= 0;
+	scanChan->ROITracesVChan				= NULL;
 	scanChan->color							= ScanChanColor_Grey;
 	scanChan->scanEngine 					= engine;
 	
@@ -3368,8 +3418,16 @@ INIT_ERR
 			nullChk( *imgDisplayPtr = (ImageDisplay_type*)init_ImageDisplayCVI_type(engine->lsModule->baseClass.workspacePanHndl, "", NULL) );
 	
 		#else
+		
+			#ifdef __ImageDisplayHeadless_H__
+			
+				nullChk( *imgDisplayPtr = (ImageDisplay_type*)init_ImageDisplayHeadless_type(scanChan, NULL) );
+			
+			#else
 	
-			SET_ERR(init_ScanChan_type_ERR_NoDisplay, "There is no display selected.");
+				SET_ERR(init_ScanChan_type_ERR_NoDisplay, "There is no display selected.");
+			
+			#endif
 	
 		#endif
 			
@@ -3383,12 +3441,30 @@ INIT_ERR
 	nullChk( detVChanName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SinkVChan_DetectionChan, chanIdx) );
 	nullChk( scanChan->detVChan = init_SinkVChan_type(detVChanName, allowedPacketTypes, NumElem(allowedPacketTypes), scanChan, VChanDataTimeout, DetectionVChan_StateChange) );
 	
+	// incoming images and waveforms to display, older data packets are dropped so that a slow display never holds up the sender
+	nullChk( dispVChanName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SinkVChan_Display, chanIdx) );
+	nullChk( scanChan->displayVChan = init_SinkVChan_type(dispVChanName, allowedDisplayTypes, NumElem(allowedDisplayTypes), scanChan, VChanDataTimeout, NULL) );
+	SetSinkVChanOverflowPolicy(scanChan->displayVChan, SinkVChan_LatestOnly);
+	
 	// outgoing image channel
 	nullChk( outputVChanName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SourceVChan_ImageChannel, chanIdx) );
 	nullChk( scanChan->outputVChan = init_SourceVChan_type(outputVChanName, DL_Image, scanChan, NULL) );
 	
-	// register sink VChan with task controller
+	// outgoing histogram of displayed images
+	nullChk( histVChanName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SourceVChan_ImageHistogram, chanIdx) );
+	nullChk( scanChan->histogramVChan = init_SourceVChan_type(histVChanName, DL_Waveform_UInt, scanChan, NULL) );
+	
+	// outgoing histogram bin edges
+	nullChk( histRangeName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SourceVChan_ImageHistogramRange, chanIdx) );
+	nullChk( scanChan->histogramRangeVChan = init_SourceVChan_type(histRangeName, DL_Waveform_Double, scanChan, NULL) );
+	
+	// outgoing ROI traces of assembled images
+	nullChk( tracesVChanName = DLVChanName((DAQLabModule_type*)engine->lsModule, engine->taskControl, ScanEngine_SourceVChan_ROITraces, chanIdx) );
+	nullChk( scanChan->ROITracesVChan = init_SourceVChan_type(tracesVChanName, DL_Waveform_Double, scanChan, NULL) );
+	
+	// register sink VChans with task controller
 	errChk( AddSinkVChan(engine->taskControl, scanChan->detVChan, NULL, NULL) );
+	errChk( AddSinkVChan(engine->taskControl, scanChan->displayVChan, DisplayVChan_DataReceived, NULL) );
 	
 	// waveform display for point recordings
 	nullChk( scanChan->waveDisplay = init_WaveformDisplay_type(engine->lsModule->baseClass.workspacePanHndl, detVChanName, WaveformDisplay_CB, scanChan) );
@@ -3396,6 +3472,10 @@ INIT_ERR
 	// cleanup
 	OKfree(detVChanName);
 	OKfree(outputVChanName);
+	OKfree(histVChanName);
+	OKfree(histRangeName);
+	OKfree(tracesVChanName);
+	OKfree(dispVChanName);
 	
 	return scanChan;
 	
@@ -3404,6 +3484,10 @@ Error:
 	// cleanup
 	OKfree(detVChanName);
 	OKfree(outputVChanName);
+	OKfree(histVChanName);
+	OKfree(histRangeName);
+	OKfree(tracesVChanName);
+	OKfree(dispVChanName);
 	if (imgDisplayPtr) {
 		CmtReleaseTSVPtr(scanChan->imgDisplayTSV);
 		imgDisplayPtr = NULL;
@@ -3421,10 +3505,23 @@ static void	discard_ScanChan_type (ScanChan_type** scanChanPtr)
 	
 	if (!scanChan) return;
 	
-	// unregister sink VChan from task controller
+	// wait for the image histogram being sent
+	if (scanChan->histogramSendID) {
+		CmtWaitForThreadPoolFunctionCompletion(DLGetThreadPoolHndl(DL_ThreadPool_Processing), scanChan->histogramSendID, 0);
+		CmtReleaseThreadPoolFunctionID(DLGetThreadPoolHndl(DL_ThreadPool_Processing), scanChan->histogramSendID);
+		scanChan->histogramSendID = 0;
+	}
+	OKfree(scanChan->pendingHistogramStats);
+	
+	// unregister sink VChans from task controller
 	RemoveSinkVChan(scanChan->scanEngine->taskControl, scanChan->detVChan, NULL); 
+	RemoveSinkVChan(scanChan->scanEngine->taskControl, scanChan->displayVChan, NULL);
 	discard_VChan_type((VChan_type**)&scanChan->detVChan);
+	discard_VChan_type((VChan_type**)&scanChan->displayVChan);
 	discard_VChan_type((VChan_type**)&scanChan->outputVChan);
+	discard_VChan_type((VChan_type**)&scanChan->histogramVChan);
+	discard_VChan_type((VChan_type**)&scanChan->histogramRangeVChan);
+	discard_VChan_type((VChan_type**)&scanChan->ROITracesVChan);
 	
 	// discard image display
 	if (!CmtGetTSVPtr(scanChan->imgDisplayTSV, &imgDisplayPtr)) {
@@ -3449,7 +3546,11 @@ static int RegisterDLScanChan (ScanChan_type* scanChan)
 {
 	// add detection and image channels to the framework
 	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->detVChan);
+	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->displayVChan);
 	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->outputVChan);
+	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->histogramVChan);
+	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->histogramRangeVChan);
+	DLRegisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->ROITracesVChan);
 	
 	return 0;
 }
@@ -3458,7 +3559,11 @@ static int UnregisterDLScanChan (ScanChan_type* scanChan)
 {
 	// remove detection and image VChans from the framework
 	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->detVChan);
+	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->displayVChan);
 	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->outputVChan);
+	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->histogramVChan);
+	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->histogramRangeVChan);
+	DLUnregisterVChan((DAQLabModule_type*)scanChan->scanEngine->lsModule, (VChan_type*)scanChan->ROITracesVChan);
 	
 	return 0;
 }
@@ -4436,7 +4541,7 @@ static ActiveNonResGalvoCal_type* init_ActiveNonResGalvoCal_type (LaserScanning_
 	cal->baseClass.VChanPos			= init_SinkVChan_type(positionVChanName, allowedPacketTypes, NumElem(allowedPacketTypes), cal, VChanDataTimeout + Default_ActiveNonResGalvoCal_ScanTime * 1e3, NULL);  
 	cal->baseClass.scanAxisType  	= NonResonantGalvo;
 	cal->baseClass.Discard			= discard_ActiveNonResGalvoCal_type; // override
-	cal->baseClass.taskController	= init_TaskControl_type(calName, cal, DLGetCommonThreadPoolHndl(), ConfigureTC_NonResGalvoCal, UncofigureTC_NonResGalvoCal, IterateTC_NonResGalvoCal, StartTC_NonResGalvoCal, ResetTC_NonResGalvoCal, 
+	cal->baseClass.taskController	= init_TaskControl_type(calName, cal, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC_NonResGalvoCal, UncofigureTC_NonResGalvoCal, IterateTC_NonResGalvoCal, StartTC_NonResGalvoCal, ResetTC_NonResGalvoCal, 
 								  DoneTC_NonResGalvoCal, StoppedTC_NonResGalvoCal, NULL, TaskTreeStateChange_NonResGalvoCal, NULL, NULL, NULL);
 	cal->baseClass.lsModule			= lsModule;
 	
@@ -4956,7 +5061,8 @@ static void	discard_ScanEngine_type (ScanEngine_type** enginePtr)
 	discard_VChan_type((VChan_type**)&engine->VChanROIShutter); 
 	
 	// discard composite image display
-	discard_ImageDisplay_type(&engine->compositeImgDisplay);
+	if (engine->compositeImgDisplay)
+		(*engine->compositeImgDisplay->imageDisplayDiscardFptr) ((void**)&engine->compositeImgDisplay);
 	
 	// discard active pixel builders thread safe variable
 	if (engine->nActivePixelBuildersTSV) {
@@ -5283,10 +5389,13 @@ INIT_ERR
 	//------------------------------------------------------------------------------------------------------------
 	
 	// task controller
-	nullChk( taskController	= init_TaskControl_type(engineName, NULL, DLGetCommonThreadPoolHndl(), ConfigureTC_RectRaster, UnconfigureTC_RectRaster, IterateTC_RectRaster, StartTC_RectRaster, ResetTC_RectRaster, 
+	nullChk( taskController	= init_TaskControl_type(engineName, NULL, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC_RectRaster, UnconfigureTC_RectRaster, IterateTC_RectRaster, StartTC_RectRaster, ResetTC_RectRaster, 
 										  DoneTC_RectRaster, StoppedTC_RectRaster, NULL, TaskTreeStateChange_RectRaster, NULL, ModuleEventHandler_RectRaster, ErrorTC_RectRaster) );
 	
-	SetTaskControlIterationTimeout(taskController, TaskControllerIterationTimeout);
+	// an iteration completes only once all pixels of the frames were assembled, which may be held back for any time by slow consumers of the image data,
+	// thus the iteration timeout is disabled
+	SetTaskControlIterationTimeout(taskController, 0);
+	SetTaskControlEstimateIterationFptr(taskController, EstimateIterationTC_RectRaster);
 	
 	errChk( init_ScanEngine_type((ScanEngine_type**)&rectRaster, lsModule, &taskController, continuousFrameScan, nFrames, ScanEngine_RectRaster_NonResonantGalvoFastAxis_NonResonantGalvoSlowAxis, referenceClockFreq, pixelDelay, shutterSwitchTime, scanLensFL, tubeLensFL) );
 	baseScanEngineClassInitialized = TRUE;
@@ -5484,6 +5593,7 @@ static RectRasterImgBuff_type* init_RectRasterImgBuff_type (ScanChan_type* scanC
 	// init
 	buffer->nImagePixels 			= 0;
 	buffer->nAssembledRows   		= 0;
+	buffer->nDisplayedRows			= 0;
 	buffer->tmpPixels				= NULL;
 	buffer->nTmpPixels				= 0;
 	buffer->nSkipPixels				= 0;			// calculated once scan signals are calculated
@@ -5495,6 +5605,8 @@ static RectRasterImgBuff_type* init_RectRasterImgBuff_type (ScanChan_type* scanC
 	buffer->scanChan				= scanChan;
 	buffer->imagePixels				= NULL;
 	buffer->image					= NULL;
+	buffer->compositeImage			= NULL;
+	buffer->ROIMasks				= NULL;
 	
 	return buffer;
 }
@@ -5503,6 +5615,7 @@ static void ResetRectRasterImgBuffer (RectRasterImgBuff_type* imgBuffer, BOOL fl
 {
 	imgBuffer->nImagePixels 		= 0;
 	imgBuffer->nAssembledRows   	= 0; 
+	imgBuffer->nDisplayedRows		= 0;
 	OKfree(imgBuffer->tmpPixels);
 	imgBuffer->nTmpPixels			= 0;
 	imgBuffer->nSkipPixels			= 0;
@@ -5511,6 +5624,8 @@ static void ResetRectRasterImgBuffer (RectRasterImgBuff_type* imgBuffer, BOOL fl
 	imgBuffer->skipFlybackRows		= 0;			// calculated once scan signals are calculated
 	imgBuffer->rowsSkipped			= 0;
 	discard_Image_type(&imgBuffer->image);
+	discard_Image_type(&imgBuffer->compositeImage);
+	discard_ROIMasks_type(&imgBuffer->ROIMasks);
 }
 
 static void	discard_RectRasterImgBuff_type (RectRasterImgBuff_type** imgBufferPtr)
@@ -5521,6 +5636,8 @@ static void	discard_RectRasterImgBuff_type (RectRasterImgBuff_type** imgBufferPt
 	OKfree(imgBuffer->imagePixels);
 	OKfree(imgBuffer->tmpPixels);
 	discard_Image_type(&imgBuffer->image);
+	discard_Image_type(&imgBuffer->compositeImage);
+	discard_ROIMasks_type(&imgBuffer->ROIMasks);
 	
 	OKfree(*imgBufferPtr);
 }
@@ -7757,13 +7874,41 @@ INIT_ERR
 	ImageDisplay_type**			imgDisplayPtr				= NULL;
 	DataPacket_type* 			imagePacket         		= NULL;
 	Image_type*					sendImage					= NULL;
+	Image_type*					compositeImage				= NULL;
 	int* 						nActivePixelBuildersTSVPtr 	= NULL;
 	
 	ListType					pointJumpROIList 			= 0;
 	ListType					frameScanROIList			= 0;
 	ListType					ROIList						= 0;
 	Rect_type*					parentRect	 				= NULL;
+	BOOL						storedROIs					= FALSE;	// TRUE if the image holds the ROIs stored for the parent frame scan, FALSE if it holds only the parent ROI.
 	
+	switch (imgBuffer->pixelDataType) {
+				
+		case DL_Waveform_UChar:
+			imageType = Image_UChar;
+			break;
+		
+		case DL_Waveform_UShort:
+			imageType = Image_UShort;    
+			break;
+			
+		case DL_Waveform_Short:
+			imageType = Image_Short;    
+			break;
+						
+		case DL_Waveform_UInt:
+			imageType = Image_UInt;    
+			break;
+						
+		case DL_Waveform_Float:
+			imageType = Image_Float;     
+			break;
+			
+		default:
+						
+			SET_ERR(NonResRectRasterScan_BuildImage_Err_WrongPixelDataType, "Wrong pixel data type.");
+	}
 	
 	do {
 		
@@ -7908,33 +8053,6 @@ INIT_ERR
 			
 			if (imgBuffer->nAssembledRows == rectRaster->scanSettings->height) {
 				
-				switch (imgBuffer->pixelDataType) {
-				
-					case DL_Waveform_UChar:
-						imageType = Image_UChar;
-						break;
-		
-					case DL_Waveform_UShort:
-						imageType = Image_UShort;    
-						break;
-			
-					case DL_Waveform_Short:
-						imageType = Image_Short;    
-						break;
-						
-					case DL_Waveform_UInt:
-						imageType = Image_UInt;    
-						break;
-						
-					case DL_Waveform_Float:
-						imageType = Image_Float;     
-						break;
-			
-					default:
-						
-						SET_ERR(NonResRectRasterScan_BuildImage_Err_WrongPixelDataType, "Wrong pixel data type.");
-				}
-				
 				//--------------------------------------------
 				// Wait if there is already an assembled image
 				//--------------------------------------------
@@ -7980,6 +8098,7 @@ INIT_ERR
 					OKfreeList(&frameScanROIList, NULL);
 					SetImageROIs(imgBuffer->image, ROIList);
 					ROIList = 0;
+					storedROIs = TRUE;
 				} else {
 					// add new frame scan settings as parent ROI
 					RGBA_type	parentRectROIColor	= {.R = 0, .G = 255, .B = 0, .alpha = 0};
@@ -8024,7 +8143,7 @@ INIT_ERR
 					
 				#else
 					
-					#ifdef __ImageDisplayCVI_H__
+					#if defined(__ImageDisplayCVI_H__) || defined(__ImageDisplayHeadless_H__)
 				
 						// discard old callback group
 						discard_CallbackGroup_type(&(*imgDisplayPtr)->callbackGroup);
@@ -8042,6 +8161,14 @@ INIT_ERR
 				#endif
 				
 						
+				//------------------------------------------
+				// Send ROI traces for this channel if needed
+				//------------------------------------------
+				
+				// the parent ROI alone would turn the traces into the mean of the whole frame
+				if (storedROIs && IsVChanOpen((VChan_type*)imgBuffer->scanChan->ROITracesVChan))
+					errChk( SendImageROITraces(rectRaster, imgBuffer, &errorInfo.errMsg) );
+				
 				//--------------------------------------
 				// Send image for this channel if needed
 				//--------------------------------------
@@ -8059,7 +8186,15 @@ INIT_ERR
 				// Display image for this channel
 				//--------------------------------------
 				
-				errChk( (*(*imgDisplayPtr)->displayImageFptr) (*imgDisplayPtr, &imgBuffer->image, &errorInfo.errMsg) );
+				// compute image statistics while the image is converted for display if the histogram is sent out
+				SetImageDisplayStats(*imgDisplayPtr, IsVChanOpen((VChan_type*)imgBuffer->scanChan->histogramVChan) || IsVChanOpen((VChan_type*)imgBuffer->scanChan->histogramRangeVChan), 0);
+				
+				// keep a copy of the image for the composite image, since the display takes over the image
+				if (NonResRectRasterScan_CompositeImageNeeded(rectRaster))
+					nullChk( compositeImage = copy_Image_type(imgBuffer->image) );
+				
+				// hand over the image without waiting for the display; images arriving faster than the display frame rate replace the pending image
+				errChk( UpdateImageDisplay(*imgDisplayPtr, &imgBuffer->image, &errorInfo.errMsg) );
 				
 				errChk( CmtReleaseTSVPtr(imgBuffer->scanChan->imgDisplayTSV) );
 				imgBuffer->scanChan->imgDisplayTSVLineNumDebug = 0;
@@ -8072,31 +8207,32 @@ INIT_ERR
 				
 				errChk( CmtGetTSVPtr(rectRaster->baseClass.nActivePixelBuildersTSV, &nActivePixelBuildersTSVPtr) );
 				(*nActivePixelBuildersTSVPtr)--;
+				
+				// the composite image is assembled while holding the number of active pixel builders, so that channels completing their next image wait to replace their composite image copy
+				discard_Image_type(&imgBuffer->compositeImage);
+				imgBuffer->compositeImage = compositeImage;
+				compositeImage = NULL;
 	
 				if (!*nActivePixelBuildersTSVPtr) {
 		
-					//errChk( NonResRectRasterScan_AssembleCompositeImage(rectRaster, &errMsg) );
-					
-					// TEMPORARY
-					// discard images from all the channels
-					for (size_t i = 0; i < rectRaster->nImgBuffers; i++) {
-						discard_Image_type(&rectRaster->imgBuffers[i]->image);
-						
-					}
+					if (NonResRectRasterScan_CompositeImageNeeded(rectRaster))
+						errChk( NonResRectRasterScan_AssembleCompositeImage(rectRaster, &errorInfo.errMsg) );
 		
 					// complete iteration
 					errChk( TaskControlIterationDone(rectRaster->baseClass.taskControl, 0, "", FALSE, &errorInfo.errMsg) );
 				}
 	
 				CmtReleaseTSVPtr(rectRaster->baseClass.nActivePixelBuildersTSV);
+				nActivePixelBuildersTSVPtr = NULL;
 				
 				
 				//------------------------
 				// reset number of elements in pixdata buffer (contents is not cleared!) new frame data will overwrite the old frame data in the buffer
 				// NOTE & WARNING: data in the imgBuffer->tmpPixels is kept since multiple images can follow and imgBuffer->tmpPixels may contain data from the next image
 				imgBuffer->nImagePixels = 0;
-				// reset row counter
+				// reset row counters
 				imgBuffer->nAssembledRows = 0;
+				imgBuffer->nDisplayedRows = 0;
 				// start skipping flyback rows
 				imgBuffer->skipRows = TRUE;
 				imgBuffer->rowsSkipped = 0;
@@ -8107,6 +8243,35 @@ INIT_ERR
 			
 		} // end of while loop, all available lines in tmpdata have been processed into pixdata
 		
+		//---------------------------------------------------------------------------
+		// Display rows assembled so far
+		//---------------------------------------------------------------------------
+		
+		// only the new rows are passed on so that slow scans show the image while it is acquired
+		if (imgBuffer->nAssembledRows > imgBuffer->nDisplayedRows) {
+			
+			imgDisplayPtr = NULL;
+			errChk( CmtGetTSVPtr(imgBuffer->scanChan->imgDisplayTSV, &imgDisplayPtr) ); imgBuffer->scanChan->imgDisplayTSVLineNumDebug = __LINE__;
+			
+			#ifdef __ImageDisplayNIVision_H__
+			
+				// create a display for the first image, its callback group is assigned once the image is complete
+				if (!*imgDisplayPtr)
+					nullChk( *imgDisplayPtr = (ImageDisplay_type*)init_ImageDisplayNIVision_type (imgBuffer->scanChan, 0, imageType, rectRaster->scanSettings->width, rectRaster->scanSettings->height, NULL) );
+				
+			#endif
+			
+			if (*imgDisplayPtr)
+				errChk( UpdateImageDisplayRows(*imgDisplayPtr, imageType, rectRaster->scanSettings->width, rectRaster->scanSettings->height, imgBuffer->nDisplayedRows, 
+											   imgBuffer->nAssembledRows - imgBuffer->nDisplayedRows, imgBuffer->imagePixels, &errorInfo.errMsg) );
+			
+			errChk( CmtReleaseTSVPtr(imgBuffer->scanChan->imgDisplayTSV) );
+			imgBuffer->scanChan->imgDisplayTSVLineNumDebug = 0;
+			imgDisplayPtr = NULL;
+			
+			imgBuffer->nDisplayedRows = imgBuffer->nAssembledRows;
+		}
+		
 		//---------------------------------------------------------------------------
 		// Receive pixel data 
 		//---------------------------------------------------------------------------
@@ -8205,6 +8370,7 @@ Error:
 	OKfreeList(&frameScanROIList, (DiscardFptr_type)discard_Rect_type);
 	OKfreeList(&ROIList, (DiscardFptr_type)discard_ROI_type);
 	discard_Rect_type(&parentRect);
+	discard_Image_type(&compositeImage);
 	
 	if (imgDisplayPtr) {
 		CmtReleaseTSVPtr(imgBuffer->scanChan->imgDisplayTSV);
@@ -8212,6 +8378,9 @@ Error:
 		imgDisplayPtr = NULL;
 	}
 	
+	if (nActivePixelBuildersTSVPtr)
+		CmtReleaseTSVPtr(rectRaster->baseClass.nActivePixelBuildersTSV);
+	
 RETURN_ERR
 }
 
@@ -8264,45 +8433,129 @@ Error:
 	return errorInfo.error;
 }
 
+static BOOL NonResRectRasterScan_CompositeImageNeeded (RectRaster_type* rectRaster)
+{
+	if (IsVChanOpen((VChan_type*)rectRaster->baseClass.VChanCompositeImage))
+		return TRUE;
+	
+	for (size_t i = 0; i < rectRaster->nImgBuffers; i++)
+		if (rectRaster->imgBuffers[i]->scanChan->color != ScanChanColor_Grey)
+			return TRUE;
+	
+	return FALSE;
+}
+
 static int NonResRectRasterScan_AssembleCompositeImage (RectRaster_type* rectRaster, char** errorMsg)
 {
 INIT_ERR
 
-	RGBA_type*		compositePixArray	= NULL;
-	void*			chanPixArray		= NULL;
+	ColorChannel_type**		colorChans			= NULL;
+	size_t					nColorChans			= 0;
+	uInt32					noOffset			= 0;
+	Image_type**			chanImagePtr		= NULL;
+	RGBA_type				chanColor			= {.R = 255, .G = 255, .B = 255, .alpha = 0};
+	Image_type*				compositeImage		= NULL;
+	Image_type*				sendImage			= NULL;
+	DataPacket_type*		imagePacket			= NULL;
+	DSInfo_type*			dsInfo				= NULL;
 	
-	// allocate memory for composite image
-	nullChk( compositePixArray = malloc(rectRaster->scanSettings->height * rectRaster->scanSettings->width * sizeof(RGBA_type)) );
+	nullChk( colorChans = calloc(rectRaster->nImgBuffers, sizeof(ColorChannel_type*)) );
 	
-	// assign channels
+	// assign channels, with grey channels shown in white
 	for (size_t chanIdx = 0; chanIdx < rectRaster->nImgBuffers; chanIdx++) {
-		chanPixArray = GetImagePixelArray(rectRaster->imgBuffers[chanIdx]->image);
+		if (!rectRaster->imgBuffers[chanIdx]->compositeImage) continue;
+		
 		switch(rectRaster->imgBuffers[chanIdx]->scanChan->color) {
 				
 			case ScanChanColor_Grey:
-											 
+				chanColor.R = 255; chanColor.G = 255; chanColor.B = 255;
 				break;
 				
 			case ScanChanColor_Red:
-				
+				chanColor.R = 255; chanColor.G = 0; chanColor.B = 0;
 				break;
 				
 			case ScanChanColor_Green:
-				
+				chanColor.R = 0; chanColor.G = 255; chanColor.B = 0;
 				break;
 				
 			case ScanChanColor_Blue:
-				
+				chanColor.R = 0; chanColor.G = 0; chanColor.B = 255;
 				break;
-			
 		}
+		
+		// the color channel takes over the channel image
+		chanImagePtr = &rectRaster->imgBuffers[chanIdx]->compositeImage;
+		nullChk( colorChans[nColorChans] = init_ColorChannel_type(1, &chanImagePtr, &noOffset, &noOffset) );
+		SetColorChannelDisplay(colorChans[nColorChans], chanColor, Default_ColorChannel_Gamma);
+		nColorChans++;
+	}
+	
+	if (!nColorChans) goto Error;
+	
+	//--------------------------------------
+	// Composite image display
+	//--------------------------------------
+	
+	if (!rectRaster->baseClass.compositeImgDisplay) {
+		
+		#ifdef __ImageDisplayNIVision_H__
+		
+			nullChk( rectRaster->baseClass.compositeImgDisplay = (ImageDisplay_type*)init_ImageDisplayNIVision_type(rectRaster, 0, Image_RGBA, rectRaster->scanSettings->width, rectRaster->scanSettings->height, NULL) );
+		
+		#else
+		
+			#ifdef __ImageDisplayCVI_H__
+			
+				nullChk( rectRaster->baseClass.compositeImgDisplay = (ImageDisplay_type*)init_ImageDisplayCVI_type(rectRaster->baseClass.lsModule->baseClass.workspacePanHndl, "Composite", rectRaster->scanSettings->width, rectRaster->scanSettings->height, NULL) );
+			
+			#else
+			
+				#ifdef __ImageDisplayHeadless_H__
+				
+					nullChk( rectRaster->baseClass.compositeImgDisplay = (ImageDisplay_type*)init_ImageDisplayHeadless_type(rectRaster, NULL) );
+				
+				#endif
+			
+			#endif
+		
+		#endif
 	}
 	
+	// compose the channels in the buffers kept by the composite display
+	errChk( CompositeColorChannels(rectRaster->baseClass.compositeImgDisplay, nColorChans, colorChans, ColorBlend_Additive, &compositeImage, &errorInfo.errMsg) );
+	
+	//--------------------------------------
+	// Send composite image if needed
+	//--------------------------------------
+	
+	if (IsVChanOpen((VChan_type*)rectRaster->baseClass.VChanCompositeImage)) {
+		nullChk( sendImage = copy_Image_type(compositeImage) );
+		dsInfo = GetIteratorDSData(GetTaskControlIterator(rectRaster->baseClass.taskControl), WAVERANK);
+		nullChk( imagePacket = init_DataPacket_type(DL_Image, (void**)&sendImage, &dsInfo, (DiscardFptr_type)discard_Image_type) );
+		errChk( SendDataPacket(rectRaster->baseClass.VChanCompositeImage, &imagePacket, 0, &errorInfo.errMsg) );
+	}
+	
+	//--------------------------------------
+	// Display composite image
+	//--------------------------------------
+	
+	// rendered on a worker thread and shown on the main thread like the channel images
+	errChk( UpdateImageDisplay(rectRaster->baseClass.compositeImgDisplay, &compositeImage, &errorInfo.errMsg) );
 	
 Error:
 	
-RETURN_ERR
+	if (colorChans)
+		for (size_t i = 0; i < nColorChans; i++)
+			discard_ColorChannel_type(&colorChans[i]);
 	
+	OKfree(colorChans);
+	discard_Image_type(&compositeImage);
+	discard_Image_type(&sendImage);
+	ReleaseDataPacket(&imagePacket);
+	discard_DSInfo_type(&dsInfo);
+	
+RETURN_ERR
 }
 
 static void NonResRectRasterScan_PointROIVoltage (RectRaster_type* rectRaster, Point_type* point, double* fastAxisCommandV, double* slowAxisCommandV)
@@ -9177,6 +9430,83 @@ PRINT_ERR
 
 
 // Detection channel
+static int DisplayVChan_DataReceived (TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, SinkVChan_type* sinkVChan, BOOL const* abortFlag, char** errorMsg)
+{
+INIT_ERR
+
+	ScanChan_type*			scanChan		= GetVChanOwner((VChan_type*)sinkVChan);
+	DataPacket_type**		dataPackets		= NULL;
+	size_t					nPackets		= 0;
+	DataPacket_type*		latestPacket	= NULL;
+	void*					dataPtr			= NULL;
+	DLDataTypes				dataType		= 0;
+	Image_type*				image			= NULL;
+	Waveform_type*			waveform		= NULL;
+	ImageDisplay_type**		imgDisplayPtr	= NULL;
+	int						imgWidth		= 0;
+	int						imgHeight		= 0;
+	
+	errChk( GetAllDataPackets(sinkVChan, &dataPackets, &nPackets, &errorInfo.errMsg) );
+	
+	// show only the latest data packet, older ones would be replaced right away
+	for (size_t i = 0; i < nPackets; i++)
+		if (dataPackets[i]) {
+			ReleaseDataPacket(&latestPacket);
+			latestPacket = dataPackets[i];
+			dataPackets[i] = NULL;
+		}
+	
+	if (latestPacket) {
+		dataPtr = GetDataPacketPtrToData(latestPacket, &dataType);
+		
+		switch (dataType) {
+				
+			case DL_Image:
+				
+				nullChk( image = copy_Image_type(*(Image_type**)dataPtr) );
+				errChk( CmtGetTSVPtr(scanChan->imgDisplayTSV, &imgDisplayPtr) ); scanChan->imgDisplayTSVLineNumDebug = __LINE__;
+				
+				#ifdef __ImageDisplayNIVision_H__
+				
+					// if display was discarded, create a new display
+					if (!*imgDisplayPtr) {
+						GetImageSize(image, &imgWidth, &imgHeight);
+						nullChk( *imgDisplayPtr = (ImageDisplay_type*)init_ImageDisplayNIVision_type(scanChan, 0, GetImageType(image), imgWidth, imgHeight, NULL) );
+					}
+					
+				#endif
+				
+				if (*imgDisplayPtr)
+					errChk( UpdateImageDisplay(*imgDisplayPtr, &image, &errorInfo.errMsg) );
+				
+				break;
+				
+			default:
+				
+				errChk( CopyWaveform(&waveform, *(Waveform_type**)dataPtr, &errorInfo.errMsg) );
+				errChk( DisplayWaveform(scanChan->waveDisplay, &waveform) );
+				break;
+		}
+	}
+	
+Error:
+	
+	// cleanup
+	if (imgDisplayPtr) {
+		CmtReleaseTSVPtr(scanChan->imgDisplayTSV);
+		scanChan->imgDisplayTSVLineNumDebug = 0;
+	}
+	
+	discard_Image_type(&image);
+	discard_Waveform_type(&waveform);
+	ReleaseDataPacket(&latestPacket);
+	for (size_t i = 0; i < nPackets; i++)
+		ReleaseDataPacket(&dataPackets[i]);
+	OKfree(dataPackets);
+	
+RETURN_ERR
+}
+
 static void DetectionVChan_StateChange (VChan_type* self, void* VChanOwner, VChanStates state)
 {
 	ScanChan_type* 	scanChan = VChanOwner;
@@ -9423,6 +9753,13 @@ INIT_ERR
 		case ImageDisplay_ROI_Removed:
 			
 			break;
+			
+		case ImageDisplay_Statistics:
+			
+			if (IsVChanOpen((VChan_type*)scanChan->histogramVChan) || IsVChanOpen((VChan_type*)scanChan->histogramRangeVChan))
+				errChk( PostImageHistogram(scanChan, eventData, &errorInfo.errMsg) );
+			
+			break;
 	}
 	
 	
@@ -9436,6 +9773,155 @@ Error:
 PRINT_ERR
 }
 
+static int PostImageHistogram (ScanChan_type* scanChan, ImageStats_type* stats, char** errorMsg)
+{
+INIT_ERR
+
+	ImageStats_type*		statsCopy		= NULL;
+	CmtThreadPoolHandle		poolHndl		= DLGetThreadPoolHndl(DL_ThreadPool_Processing);
+	
+	// replace statistics that were not sent yet
+	nullChk( statsCopy = malloc(sizeof(ImageStats_type)) );
+	*statsCopy = *stats;
+	statsCopy = InterlockedExchangePointer(&scanChan->pendingHistogramStats, statsCopy);
+	OKfree(statsCopy);
+	
+	if (InterlockedCompareExchange(&scanChan->histogramSendScheduled, 1, 0)) return 0; // pending statistics are sent by the scheduled function
+	
+	// the previous send function cleared its flag and is about to return
+	if (scanChan->histogramSendID) {
+		CmtWaitForThreadPoolFunctionCompletion(poolHndl, scanChan->histogramSendID, 0);
+		CmtReleaseThreadPoolFunctionID(poolHndl, scanChan->histogramSendID);
+		scanChan->histogramSendID = 0;
+	}
+	
+	if ( (errorInfo.error = CmtScheduleThreadPoolFunction(poolHndl, SendImageHistogram_Thread, scanChan, &scanChan->histogramSendID)) < 0) {
+		InterlockedExchange(&scanChan->histogramSendScheduled, 0);
+		scanChan->histogramSendID = 0;
+		SET_ERR(errorInfo.error, "Scheduling the image histogram for sending failed.");
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
+static int CVICALLBACK SendImageHistogram_Thread (void* functionData)
+{
+INIT_ERR
+
+	ScanChan_type*		scanChan	= functionData;
+	ImageStats_type*	stats		= NULL;
+	
+	do {
+		while ( (stats = InterlockedExchangePointer(&scanChan->pendingHistogramStats, NULL)) ) {
+			errChk( SendImageHistogram(scanChan, stats, &errorInfo.errMsg) );
+			OKfree(stats);
+		}
+		
+		InterlockedExchange(&scanChan->histogramSendScheduled, 0);
+		
+		// statistics posted after the last check and before clearing the flag were not scheduled
+	} while (scanChan->pendingHistogramStats && !InterlockedCompareExchange(&scanChan->histogramSendScheduled, 1, 0));
+	
+	return 0;
+	
+Error:
+	
+	OKfree(stats);
+	InterlockedExchange(&scanChan->histogramSendScheduled, 0);
+	
+PRINT_ERR
+
+	return errorInfo.error;
+}
+
+static int SendImageHistogram (ScanChan_type* scanChan, ImageStats_type* stats, char** errorMsg)
+{
+INIT_ERR
+
+	unsigned int*		histogram		= NULL;
+	double*				histRange		= NULL;
+	Waveform_type*		waveform		= NULL;
+	DSInfo_type*		dsInfo			= NULL;
+	DataPacket_type*	dataPacket		= NULL;
+	
+	// bin edges, which are the smallest and largest pixel values of the image
+	if (IsVChanOpen((VChan_type*)scanChan->histogramRangeVChan)) {
+		nullChk( histRange = malloc(2 * sizeof(double)) );
+		histRange[0] = stats->histMin;
+		histRange[1] = stats->histMax;
+		
+		nullChk( waveform = init_Waveform_type(Waveform_Double, 0, 2, (void**)&histRange) );
+		nullChk( dsInfo = init_DSInfo_type() );
+		nullChk( dataPacket = init_DataPacket_type(DL_Waveform_Double, (void**)&waveform, &dsInfo, (DiscardFptr_type)discard_Waveform_type) );
+		errChk( SendDataPacket(scanChan->histogramRangeVChan, &dataPacket, FALSE, &errorInfo.errMsg) );
+	}
+	
+	// histogram with the number of bins per pixel value as sampling rate
+	if (IsVChanOpen((VChan_type*)scanChan->histogramVChan)) {
+		nullChk( histogram = malloc(ImageStats_NBins * sizeof(unsigned int)) );
+		memcpy(histogram, stats->histogram, ImageStats_NBins * sizeof(unsigned int));
+		
+		nullChk( waveform = init_Waveform_type(Waveform_UInt, (stats->histMax > stats->histMin) ? ImageStats_NBins / (stats->histMax - stats->histMin) : 0, ImageStats_NBins, (void**)&histogram) );
+		nullChk( dsInfo = init_DSInfo_type() );
+		nullChk( dataPacket = init_DataPacket_type(DL_Waveform_UInt, (void**)&waveform, &dsInfo, (DiscardFptr_type)discard_Waveform_type) );
+		errChk( SendDataPacket(scanChan->histogramVChan, &dataPacket, FALSE, &errorInfo.errMsg) );
+	}
+	
+Error:
+	
+	OKfree(histogram);
+	OKfree(histRange);
+	discard_Waveform_type(&waveform);
+	discard_DSInfo_type(&dsInfo);
+	discard_DataPacket_type(&dataPacket);
+	
+RETURN_ERR
+}
+
+static int SendImageROITraces (RectRaster_type* rectRaster, RectRasterImgBuff_type* imgBuffer, char** errorMsg)
+{
+INIT_ERR
+
+	ListType			ROIList			= GetImageROIs(imgBuffer->image);
+	int					imgHeight		= 0;
+	int					imgWidth		= 0;
+	size_t				nROIs			= 0;
+	double*				means			= NULL;
+	Waveform_type*		waveform		= NULL;
+	DSInfo_type*		dsInfo			= NULL;
+	DataPacket_type*	dataPacket		= NULL;
+	
+	GetImageSize(imgBuffer->image, &imgWidth, &imgHeight);
+	
+	// the ROIs of the first image of the run set the traces, images with other ROIs are skipped so that each trace keeps the same ROI
+	if (!imgBuffer->ROIMasks) {
+		nullChk( imgBuffer->ROIMasks = init_ROIMasks_type(ROIList, imgWidth, imgHeight) );
+	} else if (!ROIMasksMatch(imgBuffer->ROIMasks, ROIList, imgWidth, imgHeight))
+		return 0;
+	
+	nROIs = GetROIMasksNumROIs(imgBuffer->ROIMasks);
+	if (!nROIs) return 0;
+	
+	nullChk( means = malloc(nROIs * sizeof(double)) );
+	errChk( GetImageROIIntensities(imgBuffer->ROIMasks, imgBuffer->image, NULL, means, &errorInfo.errMsg) );
+	
+	nullChk( waveform = init_Waveform_type(Waveform_Double, 0, nROIs, (void**)&means) );
+	nullChk( dsInfo = GetIteratorDSData(GetTaskControlIterator(rectRaster->baseClass.taskControl), WAVERANK) );
+	nullChk( dataPacket = init_DataPacket_type(DL_Waveform_Double, (void**)&waveform, &dsInfo, (DiscardFptr_type)discard_Waveform_type) );
+	errChk( SendDataPacket(imgBuffer->scanChan->ROITracesVChan, &dataPacket, FALSE, &errorInfo.errMsg) );
+	
+Error:
+	
+	OKfree(means);
+	discard_Waveform_type(&waveform);
+	discard_DSInfo_type(&dsInfo);
+	discard_DataPacket_type(&dataPacket);
+	
+RETURN_ERR
+}
+
 static void WaveformDisplay_CB (WaveformDisplay_type* waveformDisplay, int event, void* callbackData)
 {
 	ScanChan_type*	scanChan = callbackData;
@@ -10458,8 +10944,8 @@ INIT_ERR
 			// launch image assembly threads for each channel
 			for (size_t i = 0; i < engine->nImgBuffers; i++) {
 				nullChk( pixelBinding= init_PixelAssemblyBinding_type(engine, i) );
-				CmtErrChk( CmtScheduleThreadPoolFunctionAdv(DLGetCommonThreadPoolHndl(), NonResRectRasterScan_LaunchPixelBuilder, pixelBinding, DEFAULT_THREAD_PRIORITY, NULL, 
-									 	 (EVENT_TP_THREAD_FUNCTION_BEGIN | EVENT_TP_THREAD_FUNCTION_END), pixelBinding, RUN_IN_SCHEDULED_THREAD, NULL) );	
+				CmtErrChk( CmtScheduleThreadPoolFunctionAdv(DLGetThreadPoolHndl(DL_ThreadPool_Processing), NonResRectRasterScan_LaunchPixelBuilder, pixelBinding, DEFAULT_THREAD_PRIORITY, DLThreadPoolFunctionCallback, 
+									 	 EVENT_TP_THREAD_FUNCTION_BEGIN, pixelBinding, RUN_IN_SCHEDULED_THREAD, NULL) );	
 			}
 			
 			break;
@@ -10521,8 +11007,8 @@ INIT_ERR
 			// launch point scan threads for each channel
 			for (size_t i = 0; i < engine->nPointBuffers; i++) {
 				nullChk( pixelBinding = init_PixelAssemblyBinding_type(engine, i) );
-				CmtErrChk( CmtScheduleThreadPoolFunctionAdv(DLGetCommonThreadPoolHndl(), NonResRectRasterScan_LaunchPixelBuilder, pixelBinding, DEFAULT_THREAD_PRIORITY, NULL, 
-									 	 (EVENT_TP_THREAD_FUNCTION_BEGIN | EVENT_TP_THREAD_FUNCTION_END), pixelBinding, RUN_IN_SCHEDULED_THREAD, NULL) );	
+				CmtErrChk( CmtScheduleThreadPoolFunctionAdv(DLGetThreadPoolHndl(DL_ThreadPool_Processing), NonResRectRasterScan_LaunchPixelBuilder, pixelBinding, DEFAULT_THREAD_PRIORITY, DLThreadPoolFunctionCallback, 
+									 	 EVENT_TP_THREAD_FUNCTION_BEGIN, pixelBinding, RUN_IN_SCHEDULED_THREAD, NULL) );	
 			}
 			
 			break;
@@ -10817,6 +11303,66 @@ static int ModuleEventHandler_RectRaster (TaskControl_type* taskControl, TCState
 	return 0;
 }
 
+static int EstimateIterationTC_RectRaster (TaskControl_type* taskControl, double* iterationDuration, ListType VChanData, char** errorMsg)
+{
+INIT_ERR
+
+	RectRaster_type*		scanEngine		= GetTaskControlModuleData(taskControl);
+	NonResGalvoCal_type*	fastAxisCal		= (NonResGalvoCal_type*)scanEngine->baseClass.fastAxisCal;
+	uInt32					nPixelsPerLine	= scanEngine->scanSettings->width;
+	ScanChan_type*			scanChan		= NULL;
+	SourceVChan_type*		detSrcVChan		= NULL;
+	size_t					pixelSize		= 0;
+	
+	*iterationDuration = 0;
+	
+	// each iteration acquires one frame, point scan timing is not estimated
+	if (scanEngine->baseClass.scanMode != ScanEngineMode_FrameScan) return 0;
+	
+	// add line scan dead time pixels if the fast axis is calibrated
+	// note: deadTime in [ms] and pixelDwellTime in [us]
+	if (fastAxisCal && fastAxisCal->triangleCal)
+		nPixelsPerLine += 2 * (uInt32) ceil(fastAxisCal->triangleCal->deadTime * 1e3/scanEngine->scanSettings->pixelDwellTime);
+	
+	// frame duration in [s] without the slow axis fly back
+	*iterationDuration = nPixelsPerLine * scanEngine->scanSettings->height * scanEngine->scanSettings->pixelDwellTime * 1e-6;
+	
+	// each frame sends an image on the output VChan of each scan channel, with pixels of the same data type as the detector pixels
+	for (uInt32 i = 0; i < scanEngine->baseClass.nScanChans; i++) {
+		scanChan = scanEngine->baseClass.scanChans[i];
+		if (!IsVChanOpen((VChan_type*)scanChan->outputVChan) || !(detSrcVChan = GetSourceVChan(scanChan->detVChan))) continue;
+		
+		switch (GetSourceVChanDataType(detSrcVChan)) {
+				
+			case DL_Waveform_UChar:
+				pixelSize = sizeof(unsigned char);
+				break;
+				
+			case DL_Waveform_UShort:
+			case DL_Waveform_Short:
+				pixelSize = sizeof(unsigned short);
+				break;
+				
+			case DL_Waveform_UInt:
+				pixelSize = sizeof(unsigned int);
+				break;
+				
+			case DL_Waveform_Float:
+				pixelSize = sizeof(float);
+				break;
+				
+			default:
+				continue;
+		}
+		
+		errChk( AddTCVChanDataEstimate(VChanData, scanChan->outputVChan, (double)scanEngine->scanSettings->width * scanEngine->scanSettings->height * pixelSize) );
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
 static void SetRectRasterTaskControllerSettings (RectRaster_type* scanEngine)
 {
 	switch (scanEngine->baseClass.scanMode) {
@@ -1415,6 +1415,11 @@ static void				 			ErrorTC 								(TaskControl_type* taskControl, int errorID,
 
 static int							ModuleEventHandler						(TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, void* eventData, BOOL const* abortFlag, char** errorMsg);  
 
+static int							EstimateIterationTC						(TaskControl_type* taskControl, double* iterationDuration, ListType VChanData, char** errorMsg);
+
+	// Returns the duration in [s] of a finite AI, AO, DI or DO task and 0 for continuous or missing tasks.
+static double						GetADTaskDuration						(ADTaskSet_type* taskSet);
+
 //========================================================================================================================================================================================================
 // Global variables
 
@@ -3160,13 +3165,15 @@ static Dev_type* init_Dev_type (NIDAQmxManager_type* niDAQModule, DevAttr_type**
 	//-------------------------------------------------------------------------------------------------
 	// Task Controller
 	//-------------------------------------------------------------------------------------------------
-	dev -> taskController = init_TaskControl_type (taskControllerName, dev, DLGetCommonThreadPoolHndl(), ConfigureTC, UnconfigureTC, IterateTC, StartTC, 
+	dev -> taskController = init_TaskControl_type (taskControllerName, dev, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC, UnconfigureTC, IterateTC, StartTC, 
 						  ResetTC, DoneTC, StoppedTC, IterationStopTC, TaskTreeStateChange, NULL, ModuleEventHandler, ErrorTC);
 	// set no iteration function timeout
 	SetTaskControlIterationTimeout(dev->taskController, 0);
 	
 	if (!dev->taskController) goto Error;
 	
+	SetTaskControlEstimateIterationFptr(dev->taskController, EstimateIterationTC);
+	
 	dev -> niDAQModule			= niDAQModule;
 	dev -> attr					= NULL;  
 	dev -> devPanHndl			= 0;
@@ -14523,7 +14530,7 @@ INIT_ERR
 	
 	// AI
 	if (dev->AITaskSet && dev->AITaskSet->taskHndl && dev->AITaskSet->nOpenChannels) {
-		CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, StartAIDAQmxTask_CB, dev, NULL) );
+		CmtErrChk( CmtScheduleThreadPoolFunction(DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), StartAIDAQmxTask_CB, dev, NULL) );
 		(*nActiveTasksPtr)++;
 	}
 	
@@ -14536,7 +14543,7 @@ INIT_ERR
 		DAQmxErrChk( DAQmxRegisterDoneEvent(dev->AOTaskSet->taskHndl, 0, NULL, dev) );     
 		DAQmxErrChk( DAQmxRegisterDoneEvent(dev->AOTaskSet->taskHndl, 0, AODAQmxTaskDone_CB, dev) );  
 		
-		CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, StartAODAQmxTask_CB, dev, NULL) );
+		CmtErrChk( CmtScheduleThreadPoolFunction(DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), StartAODAQmxTask_CB, dev, NULL) );
 		(*nActiveTasksPtr)++;
 	}
 	
@@ -14557,7 +14564,7 @@ INIT_ERR
 		for (size_t i = 1; i <= nCI; i++) {
 			chanSet = *(ChanSet_CI_type**)ListGetPtrToItem(dev->CITaskSet->chanTaskSet, i);
 			if (chanSet->taskHndl) {
-				CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, StartCIDAQmxTasks_CB, chanSet, NULL) );
+				CmtErrChk( CmtScheduleThreadPoolFunction(DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), StartCIDAQmxTasks_CB, chanSet, NULL) );
 				(*nActiveTasksPtr)++;
 			}
 		}
@@ -14570,7 +14577,7 @@ INIT_ERR
 		for (size_t i = 1; i <= nCO; i++) {
 			chanSet = *(ChanSet_CO_type**)ListGetPtrToItem(dev->COTaskSet->chanTaskSet, i);
 			if (chanSet->taskHndl) {
-				CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, StartCODAQmxTasks_CB, chanSet, NULL) );
+				CmtErrChk( CmtScheduleThreadPoolFunction(DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), StartCODAQmxTasks_CB, chanSet, NULL) );
 				(*nActiveTasksPtr)++;
 			}
 		}
@@ -14827,4 +14834,71 @@ static int ModuleEventHandler (TaskControl_type* taskControl, TCStates taskState
 	
 	return 0;
 }
+
+static int EstimateIterationTC (TaskControl_type* taskControl, double* iterationDuration, ListType VChanData, char** errorMsg)
+{
+INIT_ERR
+
+	Dev_type*		dev				= GetTaskControlModuleData(taskControl);
+	ADTaskSet_type*	ADTaskSets[]	= {dev->AITaskSet, dev->AOTaskSet, dev->DITaskSet, dev->DOTaskSet};
+	double			taskDuration	= 0;
+	size_t			nChans			= 0;
+	ChanSet_type*	chanSet			= NULL;
+	size_t			sampleSize		= 0;
+	
+	// the iteration is done when the longest finite hardware timed task is done
+	*iterationDuration = 0;
+	for (size_t i = 0; i < NumElem(ADTaskSets); i++) {
+		taskDuration = GetADTaskDuration(ADTaskSets[i]);
+		if (taskDuration > *iterationDuration)
+			*iterationDuration = taskDuration;
+	}
+	
+	// AI data sent on Source VChans of finite tasks
+	// Note: counter tasks are not included in the estimate
+	if (!GetADTaskDuration(dev->AITaskSet)) return 0;
+	
+	nChans = ListNumItems(dev->AITaskSet->chanSet);
+	for (size_t i = 1; i <= nChans; i++) {
+		chanSet = *(ChanSet_type**)ListGetPtrToItem(dev->AITaskSet->chanSet, i);
+		if (!chanSet->srcVChan || chanSet->onDemand) continue;
+		
+		switch (chanSet->dataTypeConversion.dataType) {
+				
+			case Convert_To_Double:
+				sampleSize = sizeof(double);
+				break;
+				
+			case Convert_To_Float:
+				sampleSize = sizeof(float);
+				break;
+				
+			case Convert_To_UInt:
+				sampleSize = sizeof(unsigned int);
+				break;
+				
+			case Convert_To_UShort:
+				sampleSize = sizeof(unsigned short);
+				break;
+				
+			case Convert_To_UChar:
+				sampleSize = sizeof(unsigned char);
+				break;
+		}
+		
+		errChk( AddTCVChanDataEstimate(VChanData, chanSet->srcVChan, (double)dev->AITaskSet->timing->nSamples * sampleSize) );
+	}
+	
+Error:
+	
+RETURN_ERR
+}
+
+static double GetADTaskDuration (ADTaskSet_type* taskSet)
+{
+	if (!taskSet || !taskSet->timing || taskSet->timing->measMode != Operation_Finite || taskSet->timing->sampleRate <= 0) 
+		return 0;
+	
+	return taskSet->timing->nSamples / taskSet->timing->sampleRate;
+}
  
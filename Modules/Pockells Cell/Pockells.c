@@ -572,7 +572,7 @@ INIT_ERR
 	
 	errChk( DLGetXMLElementAttributes("", pockellsXMLElement, eomAttr, NumElem(eomAttr)) );
 	
-	nullChk( taskController = init_TaskControl_type(taskControllerName, NULL, DLGetCommonThreadPoolHndl(), ConfigureTC, UnconfigureTC, IterateTC, 
+	nullChk( taskController = init_TaskControl_type(taskControllerName, NULL, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC, UnconfigureTC, IterateTC, 
 									  StartTC, ResetTC, DoneTC, StoppedTC, NULL, TaskTreeStateChange, NULL, ModuleEventHandler, ErrorTC) );
 	
 	OKfree(taskControllerName);
@@ -759,7 +759,7 @@ INIT_ERR
 	nullChk( taskControllerName = DLGetUniqueTaskControllerName(TaskController_BaseName) );
 	
 	
-	nullChk(taskController = init_TaskControl_type(taskControllerName, eom, DLGetCommonThreadPoolHndl(), ConfigureTC, UnconfigureTC, IterateTC, 
+	nullChk(taskController = init_TaskControl_type(taskControllerName, eom, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC, UnconfigureTC, IterateTC, 
 									  StartTC, ResetTC, DoneTC, StoppedTC, NULL, TaskTreeStateChange, NULL, ModuleEventHandler, ErrorTC) );
 	// configure task controller
 	errChk( TaskControlEvent(taskController, TC_Event_Configure, NULL, NULL, &errorInfo.errMsg) );
@@ -723,7 +723,7 @@ INIT_ERR
 	SetMeasurementMode(mode);
 	errChk( PMTClearFifo() ); 
 	
-	errChk( StartDAQThread(mode, DEFAULT_THREAD_POOL_HANDLE) );
+	errChk( StartDAQThread(mode, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition)) );
 	
 	readdata = 1;   //start reading       
 	errChk( ReadPMTReg(CTRL_REG, &controlreg) );     
@@ -755,7 +755,7 @@ INIT_ERR
 	
 	
 	readdata = 0;  //stop reading  
-	errChk( StopDAQThread(DLGetCommonThreadPoolHndl()) );
+	errChk( StopDAQThread(DLGetThreadPoolHndl(DL_ThreadPool_Acquisition)) );
 
 	for (int i = 0; i < MAX_CHANNELS; i++)
 		OKfree(gchannels[i]);
@@ -862,10 +862,10 @@ INIT_ERR
 	
 	SetAcqBusy(1);   
 	
-	errChk(CmtScheduleThreadPoolFunctionAdv(poolHandle, PMTThreadFunction, NULL, THREAD_PRIORITY_NORMAL, NULL, 0, NULL, 0, NULL));   	   //&PMTThreadFunctionID
+	errChk(CmtScheduleThreadPoolFunctionAdv(poolHandle, PMTThreadFunction, NULL, THREAD_PRIORITY_NORMAL, DLThreadPoolFunctionCallback, EVENT_TP_THREAD_FUNCTION_BEGIN, NULL, 0, NULL));   	   //&PMTThreadFunctionID
 	//only launch second acq thread in movie mode
 	if (mode == TASK_CONTINUOUS){
-		errChk(CmtScheduleThreadPoolFunctionAdv(poolHandle, PMTThreadFunction2, NULL, THREAD_PRIORITY_NORMAL, NULL, 0, NULL, 0, NULL));   	   //&PMTThreadFunctionID
+		errChk(CmtScheduleThreadPoolFunctionAdv(poolHandle, PMTThreadFunction2, NULL, THREAD_PRIORITY_NORMAL, DLThreadPoolFunctionCallback, EVENT_TP_THREAD_FUNCTION_BEGIN, NULL, 0, NULL));   	   //&PMTThreadFunctionID
 	}
 	
 	ProcessSystemEvents();  //to start the tread functions      
@@ -151,7 +151,7 @@ DAQLabModule_type* initalloc_XYStage (DAQLabModule_type* mod, char className[],
 	
 	// initialize Task Controller from child class
 	
-	stage->taskController 		= init_TaskControl_type (instanceName, stage, DLGetCommonThreadPoolHndl(), ConfigureTC, NULL, IterateTC, StartTC, ResetTC, DoneTC, StoppedTC, 
+	stage->taskController 		= init_TaskControl_type (instanceName, stage, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC, NULL, IterateTC, StartTC, ResetTC, DoneTC, StoppedTC, 
 								  NULL, TaskTreeStateChange, NULL, StageEventHandler, ErrorTC);
 	
 	//---------------------------
@@ -165,7 +165,7 @@ INIT_ERR
 	initalloc_Zstage ((DAQLabModule_type*)zstage, className, instanceName, workspacePanHndl);
 	
 	// create PIStage Task Controller
-	nullChk( tc = init_TaskControl_type (instanceName, PIzstage, DLGetCommonThreadPoolHndl(), ConfigureTC, NULL, IterateTC, StartTC, 
+	nullChk( tc = init_TaskControl_type (instanceName, PIzstage, DLGetThreadPoolHndl(DL_ThreadPool_Acquisition), ConfigureTC, NULL, IterateTC, StartTC, 
 								ResetTC, DoneTC, StoppedTC, NULL, TaskTreeStateChange, NULL, ZStageEventHandler, ErrorTC) );
 	
 	//------------------------------------------------------------
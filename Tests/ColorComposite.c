@@ -0,0 +1,196 @@
+//==============================================================================
+//
+// Title:		ColorComposite.c
+// Purpose:		Benchmark of composing color channels into an RGBA image.
+//
+// Created on:	19-10-2026 at 17:05:31 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// Four color channels of 1024 x 1024 unsigned short images, shown in red, green, blue and white with the last channel placed at an offset, are composed
+// repeatedly into an RGBA image with additive and with max blending using the buffers of an image display. For each blend mode the test prints the time of
+// the first composite, which allocates the buffers kept by the display, and the mean, 99th percentile and longest time of the following composites together
+// with the number of composites per second. The test checks the composite image size, that pixels at the lowest value of all channels are black and that
+// the composite rate is above the given limit.
+// Build as a console application together with the Framework/Display/ImageDisplay.c, Framework/Data types and Framework/Iterators sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLab.h"
+#include "DAQLabErrHandling.h"
+#include "ImageDisplay.h"
+
+//==============================================================================
+// Constants
+
+#define NChannels						4			// Number of color channels.
+#define ImageWidth						1024		// Width of the channel images in pixels.
+#define ImageHeight						1024		// Height of the channel images in pixels.
+#define LastChannelOffset				16			// Offset in pixels of the last channel image in both directions.
+#define NComposites						100			// Number of timed composites for each blend mode.
+#define MinCompositeRate				10.0		// Minimum number of composites per second.
+
+//==============================================================================
+// Static functions
+
+static int						RunCompositeBenchmark			(ColorChannel_type* colorChans[], ColorBlendModes blendMode, char blendName[]);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+INIT_ERR
+
+	RGBA_type				chanColors[NChannels]	= {{.R = 255}, {.G = 255}, {.B = 255}, {.R = 255, .G = 255, .B = 255}};
+	ColorChannel_type*		colorChans[NChannels]	= {NULL};
+	unsigned short*			pixels					= NULL;
+	Image_type*				image					= NULL;
+	Image_type**			imagePtr				= &image;
+	uInt32					offset					= 0;
+	int						nFailed					= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	// channel images with a different pattern in each channel and the lowest value in the first pixel
+	for (int chan = 0; chan < NChannels; chan++) {
+		nullChk( pixels = malloc(ImageWidth * ImageHeight * sizeof(unsigned short)) );
+		for (size_t i = 0; i < ImageWidth * ImageHeight; i++)
+			pixels[i] = (unsigned short) ((i * (chan + 1) * 37) % 4096);
+
+		nullChk( image = init_Image_type(Image_UShort, ImageHeight, ImageWidth, (void**)&pixels) );
+		offset = (chan == NChannels - 1) ? LastChannelOffset : 0;
+		nullChk( colorChans[chan] = init_ColorChannel_type(1, &imagePtr, &offset, &offset) );
+		SetColorChannelDisplay(colorChans[chan], chanColors[chan], Default_ColorChannel_Gamma);
+	}
+
+	nFailed += (RunCompositeBenchmark(colorChans, ColorBlend_Additive, "Additive") < 0);
+	nFailed += (RunCompositeBenchmark(colorChans, ColorBlend_Max, "Max") < 0);
+
+	for (int chan = 0; chan < NChannels; chan++)
+		discard_ColorChannel_type(&colorChans[chan]);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+
+Error:
+
+	OKfree(pixels);
+	discard_Image_type(&image);
+	for (int chan = 0; chan < NChannels; chan++)
+		discard_ColorChannel_type(&colorChans[chan]);
+
+	printf("Out of memory.\nFAILED\n");
+
+	return -1;
+}
+
+/// HIFN Message output required by the image display, which is provided by DAQLab in the application.
+void DLMsg (const char* text, BOOL beep)
+{
+	printf("%s", text);
+}
+
+/// HIFN Thread pools required by the image display, which are provided by DAQLab in the application.
+CmtThreadPoolHandle DLGetThreadPoolHndl (DLThreadPoolRoles role)
+{
+	return DEFAULT_THREAD_POOL_HANDLE;
+}
+
+static int RunCompositeBenchmark (ColorChannel_type* colorChans[], ColorBlendModes blendMode, char blendName[])
+{
+#define RunCompositeBenchmark_Err_Size			-1
+#define RunCompositeBenchmark_Err_Black			-2
+#define RunCompositeBenchmark_Err_Rate			-3
+INIT_ERR
+
+	ImageDisplay_type*		imgDisplay			= NULL;
+	Image_type*				compositeImage		= NULL;
+	RGBA_type*				compositePixels		= NULL;
+	double					times[NComposites];
+	double					startTime			= 0;
+	double					firstTime			= 0;
+	double					totalTime			= 0;
+	int						compWidth			= 0;
+	int						compHeight			= 0;
+
+	// the image display keeps the composite buffers
+	nullChk( imgDisplay = calloc(1, sizeof(ImageDisplay_type)) );
+	errChk( init_ImageDisplay_type(imgDisplay, NULL, NULL, NULL, NULL, NULL, NULL) );
+
+	startTime = Timer();
+	errChk( CompositeColorChannels(imgDisplay, NChannels, colorChans, blendMode, &compositeImage, &errorInfo.errMsg) );
+	firstTime = Timer() - startTime;
+
+	GetImageSize(compositeImage, &compWidth, &compHeight);
+	if (compWidth != ImageWidth + LastChannelOffset || compHeight != ImageHeight + LastChannelOffset)
+		SET_ERR(RunCompositeBenchmark_Err_Size, "The composite image does not fit the channel images at their offsets.");
+
+	// the first pixel is covered by all channels except the last one, which adds up to the lowest intensity there
+	compositePixels = GetImagePixelArray(compositeImage);
+	if (compositePixels[0].R || compositePixels[0].G || compositePixels[0].B)
+		SET_ERR(RunCompositeBenchmark_Err_Black, "Pixels at the lowest channel intensities are not black.");
+
+	discard_Image_type(&compositeImage);
+
+	for (int i = 0; i < NComposites; i++) {
+		startTime = Timer();
+		errChk( CompositeColorChannels(imgDisplay, NChannels, colorChans, blendMode, &compositeImage, &errorInfo.errMsg) );
+		times[i] = Timer() - startTime;
+		totalTime += times[i];
+		discard_Image_type(&compositeImage);
+	}
+	qsort(times, NComposites, sizeof(double), CompareDoubles);
+
+	printf("%s blending, %d channels of %d x %d pixels: first composite %.1f ms, mean %.1f ms, p99 %.1f ms, max %.1f ms, %.1f composites/s.\n", blendName, NChannels,
+		   ImageWidth, ImageHeight, firstTime * 1e3, totalTime / NComposites * 1e3, Percentile(times, NComposites, 99) * 1e3, times[NComposites-1] * 1e3, NComposites / totalTime);
+
+	if (NComposites / totalTime < MinCompositeRate)
+		SET_ERR(RunCompositeBenchmark_Err_Rate, "The composite rate is below the limit.");
+
+	discard_ImageDisplay_type(&imgDisplay);
+
+	return 0;
+
+Error:
+
+	discard_Image_type(&compositeImage);
+	discard_ImageDisplay_type(&imgDisplay);
+
+	printf("%s blending: %s\n", blendName, errorInfo.errMsg);
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}
@@ -0,0 +1,252 @@
+//==============================================================================
+//
+// Title:		HeadlessDisplayBenchmark.c
+// Purpose:		Benchmark of the image display pipeline using the headless display timing.
+//
+// Created on:	19-10-2026 at 19:04:26 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// Unsigned short images of 512 x 512, 1024 x 1024 and 2048 x 2048 pixels are passed one at a time to a headless display, waiting for each image to be shown
+// before the next one is passed. For each image size the test prints the render and show times recorded by the display as min, mean, 99th percentile and max,
+// together with the time from passing an image until it is shown and the resulting number of frames per second. The 1024 x 1024 images are then shown again
+// while the display writes them to PNG files, which are removed afterwards. The test checks that every image was shown, that the 99th percentile of the
+// 1024 x 1024 render time stays below the given limit and that the written files are PNG files.
+// Build as a console application together with the Framework/Display/ImageDisplay.c, Framework/Display/ImageDisplayHeadless.c, Framework/Data types and
+// Framework/Iterators sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLab.h"
+#include "DAQLabErrHandling.h"
+#include "ImageDisplayHeadless.h"
+
+//==============================================================================
+// Constants
+
+#define NFrames							200			// Number of images shown for each image size.
+#define NDumpedFrames					20			// Number of 1024 x 1024 images shown while writing them to PNG files.
+#define DumpFilePrefix					"headless_benchmark_"		// File name prefix of the written PNG files, which are written to the current directory.
+#define MaxShowTime						5.0			// Maximum time in [s] to wait for an image to be shown.
+#define MaxRenderTimeP99				20.0		// Maximum 99th percentile of the 1024 x 1024 render time in [ms].
+
+//==============================================================================
+// Static global variables
+
+static int						imageSizes[]					= {512, 1024, 2048};
+
+//==============================================================================
+// Static functions
+
+static int						RunDisplayBenchmark				(ImageDisplayHeadless_type* display, int imageSize, size_t nFrames, BOOL dumpFrames, double* renderTimeP99Ptr);
+
+static int						ShowImage						(ImageDisplayHeadless_type* display, int imageSize, size_t frameIdx, char** errorMsg);
+
+static int						CheckDumpedFrames				(size_t nFrames);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+	ImageDisplayHeadless_type*	display				= NULL;
+	double						renderTimeP99		= 0;
+	int							nFailed				= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	if ( !(display = init_ImageDisplayHeadless_type(NULL, NULL)) ) {
+		printf("Out of memory.\nFAILED\n");
+		return -1;
+	}
+
+	for (size_t i = 0; i < NumElem(imageSizes); i++) {
+		nFailed += (RunDisplayBenchmark(display, imageSizes[i], NFrames, FALSE, &renderTimeP99) < 0);
+
+		if (imageSizes[i] == 1024 && renderTimeP99 > MaxRenderTimeP99) {
+			printf("The 99th percentile of the render time exceeds the limit.\n");
+			nFailed++;
+		}
+	}
+
+	nFailed += (RunDisplayBenchmark(display, 1024, NDumpedFrames, TRUE, NULL) < 0);
+	nFailed += (CheckDumpedFrames(NDumpedFrames) < 0);
+
+	discard_ImageDisplayHeadless_type(&display);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+/// HIFN Message output required by the image display, which is provided by DAQLab in the application.
+void DLMsg (const char* text, BOOL beep)
+{
+	printf("%s", text);
+}
+
+/// HIFN Thread pools required by the image display, which are provided by DAQLab in the application.
+CmtThreadPoolHandle DLGetThreadPoolHndl (DLThreadPoolRoles role)
+{
+	return DEFAULT_THREAD_POOL_HANDLE;
+}
+
+static int RunDisplayBenchmark (ImageDisplayHeadless_type* display, int imageSize, size_t nFrames, BOOL dumpFrames, double* renderTimeP99Ptr)
+{
+#define RunDisplayBenchmark_Err_MissingFrames		-1
+INIT_ERR
+
+	HeadlessDisplayTiming_type*		timing				= NULL;
+	double*							showTimes			= NULL;
+	double							startTime			= 0;
+	double							totalTime			= 0;
+	double							meanShowTime		= 0;
+
+	nullChk( timing = malloc(sizeof(HeadlessDisplayTiming_type)) );
+	nullChk( showTimes = malloc(nFrames * sizeof(double)) );
+
+	errChk( SetImageDisplayHeadlessDump(display, (dumpFrames) ? "." : NULL, DumpFilePrefix, HeadlessFrame_PNG, &errorInfo.errMsg) );
+	ResetImageDisplayHeadlessTiming(display);
+
+	for (size_t i = 0; i < nFrames; i++) {
+		startTime = Timer();
+		errChk( ShowImage(display, imageSize, i, &errorInfo.errMsg) );
+		showTimes[i] = (Timer() - startTime) * 1e3;
+		totalTime += showTimes[i] / 1e3;
+		meanShowTime += showTimes[i] / nFrames;
+	}
+
+	errChk( SetImageDisplayHeadlessDump(display, NULL, NULL, HeadlessFrame_PNG, &errorInfo.errMsg) );
+
+	// recorded timing, ordered from oldest to newest
+	GetImageDisplayHeadlessTiming(display, timing);
+	if (timing->nFrames != nFrames)
+		SET_ERR(RunDisplayBenchmark_Err_MissingFrames, "Not all images were shown.");
+
+	qsort(timing->renderTimes, timing->nTimedFrames, sizeof(double), CompareDoubles);
+	qsort(timing->blitTimes, timing->nTimedFrames, sizeof(double), CompareDoubles);
+	qsort(showTimes, nFrames, sizeof(double), CompareDoubles);
+
+	printf("%d x %d pixels%s, %d frames: render min %.2f ms, mean %.2f ms, p99 %.2f ms, max %.2f ms; show mean %.2f ms, p99 %.2f ms.\n", imageSize, imageSize,
+		   (dumpFrames) ? " written to PNG files" : "", (int)timing->nFrames, timing->minRenderTime, timing->meanRenderTime, Percentile(timing->renderTimes, timing->nTimedFrames, 99),
+		   timing->maxRenderTime, timing->meanBlitTime, Percentile(timing->blitTimes, timing->nTimedFrames, 99));
+	printf("%d x %d pixels%s: from passing an image until shown mean %.2f ms, p99 %.2f ms, max %.2f ms, %.1f frames/s.\n", imageSize, imageSize,
+		   (dumpFrames) ? " written to PNG files" : "", meanShowTime, Percentile(showTimes, nFrames, 99), showTimes[nFrames-1], nFrames / totalTime);
+
+	if (renderTimeP99Ptr)
+		*renderTimeP99Ptr = Percentile(timing->renderTimes, timing->nTimedFrames, 99);
+
+	OKfree(timing);
+	OKfree(showTimes);
+
+	return 0;
+
+Error:
+
+	SetImageDisplayHeadlessDump(display, NULL, NULL, HeadlessFrame_PNG, NULL);
+	OKfree(timing);
+	OKfree(showTimes);
+
+	printf("%d x %d pixels: %s\n", imageSize, imageSize, (errorInfo.errMsg) ? errorInfo.errMsg : "Out of memory.");
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Passes an image with a pattern that changes with each frame to the display and waits until it is shown.
+static int ShowImage (ImageDisplayHeadless_type* display, int imageSize, size_t frameIdx, char** errorMsg)
+{
+#define ShowImage_Err_Timeout		-1
+INIT_ERR
+
+	size_t							nPixels				= (size_t)imageSize * imageSize;
+	unsigned short*					pixels				= NULL;
+	Image_type*						image				= NULL;
+	HeadlessDisplayTiming_type*		timing				= NULL;
+	size_t							nShownFrames		= 0;
+	double							startTime			= 0;
+
+	nullChk( timing = malloc(sizeof(HeadlessDisplayTiming_type)) );
+	GetImageDisplayHeadlessTiming(display, timing);
+	nShownFrames = timing->nFrames;
+
+	nullChk( pixels = malloc(nPixels * sizeof(unsigned short)) );
+	for (size_t i = 0; i < nPixels; i++)
+		pixels[i] = (unsigned short) ((i + frameIdx * 13) % 4096);
+
+	nullChk( image = init_Image_type(Image_UShort, imageSize, imageSize, (void**)&pixels) );
+	errChk( UpdateImageDisplay((ImageDisplay_type*)display, &image, &errorInfo.errMsg) );
+
+	// the image is shown on the main thread
+	startTime = Timer();
+	do {
+		if (Timer() - startTime > MaxShowTime)
+			SET_ERR(ShowImage_Err_Timeout, "The image was not shown in time.");
+		ProcessSystemEvents();
+		GetImageDisplayHeadlessTiming(display, timing);
+	} while (timing->nFrames == nShownFrames);
+
+Error:
+
+	OKfree(pixels);
+	discard_Image_type(&image);
+	OKfree(timing);
+
+RETURN_ERR
+}
+
+/// HIFN Checks that the written files start with the PNG signature and removes them.
+static int CheckDumpedFrames (size_t nFrames)
+{
+	unsigned char		signature[]						= {137, 80, 78, 71, 13, 10, 26, 10};
+	unsigned char		fileStart[8]					= {0};
+	char				fileName[MAX_PATHNAME_LEN]		= "";
+	FILE*				file							= NULL;
+	size_t				nPNGFiles						= 0;
+
+	for (size_t i = 0; i < nFrames; i++) {
+		snprintf(fileName, sizeof(fileName), "%s%06u.png", DumpFilePrefix, (unsigned int)i);
+		if ( !(file = fopen(fileName, "rb")) ) continue;
+
+		if (fread(fileStart, 1, sizeof(fileStart), file) == sizeof(fileStart) && !memcmp(fileStart, signature, sizeof(signature)))
+			nPNGFiles++;
+
+		fclose(file);
+		remove(fileName);
+	}
+
+	printf("Written frames: %d of %d are PNG files.\n", (int)nPNGFiles, (int)nFrames);
+
+	return (nPNGFiles == nFrames) ? 0 : -1;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}
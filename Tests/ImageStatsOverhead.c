@@ -0,0 +1,254 @@
+//==============================================================================
+//
+// Title:		ImageStatsOverhead.c
+// Purpose:		Benchmark of the image display pixel statistics.
+//
+// Created on:	19-10-2026 at 18:12:47 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// Statistics of 1024 x 1024 unsigned short, short and float images are computed repeatedly by an image display, with every 97th pixel of the float image set
+// to NaN. For each pixel type the test prints the mean and longest time to compute the statistics, together with the time of a single reference pass summing
+// the pixels and the ratio of both. The test checks that the pixel count leaves out NaN pixels, that the histogram spans the smallest and largest pixel value
+// and holds all counted pixels, that the mean is a number and that statistics are computed at more than the given rate.
+// Build as a console application together with the Framework/Display/ImageDisplay.c, Framework/Data types and Framework/Iterators sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLab.h"
+#include "DAQLabErrHandling.h"
+#include "ImageDisplay.h"
+
+//==============================================================================
+// Constants
+
+#define ImageWidth						1024		// Width of the images in pixels.
+#define ImageHeight						1024		// Height of the images in pixels.
+#define NaNPixelInterval				97			// Every NaNPixelInterval-th pixel of the float image is NaN.
+#define NRuns							100			// Number of timed statistics for each pixel type.
+#define MinStatsRate					50.0		// Minimum number of images per second for which statistics are computed.
+
+//==============================================================================
+// Static functions
+
+static int						RunStatsBenchmark				(ImageTypes imageType, char typeName[]);
+
+static Image_type*				CreateTestImage					(ImageTypes imageType, double* minValPtr, double* maxValPtr, size_t* nValidPixelsPtr);
+
+static double					ReferencePassTime				(Image_type* image);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+	int		nFailed		= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	nFailed += (RunStatsBenchmark(Image_UShort, "Unsigned short") < 0);
+	nFailed += (RunStatsBenchmark(Image_Short, "Short") < 0);
+	nFailed += (RunStatsBenchmark(Image_Float, "Float") < 0);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+/// HIFN Message output required by the image display, which is provided by DAQLab in the application.
+void DLMsg (const char* text, BOOL beep)
+{
+	printf("%s", text);
+}
+
+/// HIFN Thread pools required by the image display, which are provided by DAQLab in the application.
+CmtThreadPoolHandle DLGetThreadPoolHndl (DLThreadPoolRoles role)
+{
+	return DEFAULT_THREAD_POOL_HANDLE;
+}
+
+static int RunStatsBenchmark (ImageTypes imageType, char typeName[])
+{
+#define RunStatsBenchmark_Err_PixelCount		-1
+#define RunStatsBenchmark_Err_Range				-2
+#define RunStatsBenchmark_Err_Histogram			-3
+#define RunStatsBenchmark_Err_Mean				-4
+#define RunStatsBenchmark_Err_Rate				-5
+INIT_ERR
+
+	ImageDisplay_type*		imgDisplay			= NULL;
+	Image_type*				image				= NULL;
+	ImageStats_type*		stats				= NULL;
+	double					minVal				= 0;
+	double					maxVal				= 0;
+	size_t					nValidPixels		= 0;
+	size_t					nHistPixels			= 0;
+	double					startTime			= 0;
+	double					runTime				= 0;
+	double					maxTime				= 0;
+	double					totalTime			= 0;
+	double					refTime				= 0;
+
+	nullChk( image = CreateTestImage(imageType, &minVal, &maxVal, &nValidPixels) );
+
+	// the display fills in the statistics returned by BeginImageDisplayStats each time they are computed
+	nullChk( imgDisplay = calloc(1, sizeof(ImageDisplay_type)) );
+	errChk( init_ImageDisplay_type(imgDisplay, NULL, NULL, NULL, NULL, NULL, NULL) );
+	SetImageDisplayStats(imgDisplay, TRUE, 0);
+	nullChk( stats = BeginImageDisplayStats(imgDisplay, imageType) );
+
+	for (int i = 0; i < NRuns; i++) {
+		startTime = Timer();
+		ComputeImageDisplayStats(imgDisplay, image);
+		runTime = Timer() - startTime;
+		totalTime += runTime;
+		if (runTime > maxTime)
+			maxTime = runTime;
+	}
+
+	refTime = ReferencePassTime(image);
+
+	printf("%s, %d x %d pixels: statistics mean %.2f ms, max %.2f ms, %.0f images/s; reference pass %.2f ms, ratio %.2f.\n", typeName, ImageWidth, ImageHeight,
+		   totalTime / NRuns * 1e3, maxTime * 1e3, NRuns / totalTime, refTime * 1e3, (refTime > 0) ? totalTime / NRuns / refTime : 0);
+	printf("%s: %d pixels, min %g, max %g, mean %g, std %g, histogram [%g, %g].\n", typeName, (int)stats->nPixels, stats->min, stats->max, stats->mean, stats->std,
+		   stats->histMin, stats->histMax);
+
+	if (stats->nPixels != nValidPixels)
+		SET_ERR(RunStatsBenchmark_Err_PixelCount, "The pixel count does not leave out NaN pixels.");
+
+	if (stats->min != minVal || stats->max != maxVal || stats->histMin != minVal || stats->histMax != maxVal)
+		SET_ERR(RunStatsBenchmark_Err_Range, "The histogram does not span the pixel value range.");
+
+	for (int i = 0; i < ImageStats_NBins; i++)
+		nHistPixels += stats->histogram[i];
+
+	if (nHistPixels != nValidPixels)
+		SET_ERR(RunStatsBenchmark_Err_Histogram, "The histogram does not hold all counted pixels.");
+
+	if (isnan(stats->mean))
+		SET_ERR(RunStatsBenchmark_Err_Mean, "The mean pixel value is not a number.");
+
+	if (NRuns / totalTime < MinStatsRate)
+		SET_ERR(RunStatsBenchmark_Err_Rate, "The statistics rate is below the limit.");
+
+	discard_ImageDisplay_type(&imgDisplay);
+	discard_Image_type(&image);
+
+	return 0;
+
+Error:
+
+	discard_ImageDisplay_type(&imgDisplay);
+	discard_Image_type(&image);
+
+	printf("%s: %s\n", typeName, (errorInfo.errMsg) ? errorInfo.errMsg : "Out of memory.");
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Creates an image with a ramp of pixel values and returns its smallest and largest pixel value and the number of pixels that are not NaN.
+static Image_type* CreateTestImage (ImageTypes imageType, double* minValPtr, double* maxValPtr, size_t* nValidPixelsPtr)
+{
+	size_t				nPixels			= (size_t)ImageWidth * ImageHeight;
+	void*				pixels			= NULL;
+	unsigned short*		ushortPix		= NULL;
+	short*				shortPix		= NULL;
+	float*				floatPix		= NULL;
+	Image_type*			image			= NULL;
+
+	*nValidPixelsPtr = nPixels;
+
+	switch (imageType) {
+
+		case Image_UShort:
+
+			if ( !(pixels = malloc(nPixels * sizeof(unsigned short))) ) return NULL;
+			ushortPix = pixels;
+			for (size_t i = 0; i < nPixels; i++)
+				ushortPix[i] = (unsigned short) (i % 4096);
+			*minValPtr = 0;
+			*maxValPtr = 4095;
+			break;
+
+		case Image_Short:
+
+			if ( !(pixels = malloc(nPixels * sizeof(short))) ) return NULL;
+			shortPix = pixels;
+			for (size_t i = 0; i < nPixels; i++)
+				shortPix[i] = (short) ((int)(i % 4096) - 2048);
+			*minValPtr = -2048;
+			*maxValPtr = 2047;
+			break;
+
+		case Image_Float:
+
+			if ( !(pixels = malloc(nPixels * sizeof(float))) ) return NULL;
+			floatPix = pixels;
+			for (size_t i = 0; i < nPixels; i++)
+				if (i % NaNPixelInterval)
+					floatPix[i] = (float) (i % 1000) * 0.5f + 0.5f;
+				else
+					floatPix[i] = NAN;
+
+			// the first pixel is NaN, the other pixel values run from 0.5 up to 500
+			*nValidPixelsPtr = nPixels - (nPixels + NaNPixelInterval - 1) / NaNPixelInterval;
+			*minValPtr = 0.5;
+			*maxValPtr = 500;
+			break;
+
+		default:
+			return NULL;
+	}
+
+	if ( !(image = init_Image_type(imageType, ImageHeight, ImageWidth, &pixels)) )
+		OKfree(pixels);
+
+	return image;
+}
+
+/// HIFN Returns the time of a single pass summing the pixels of an image, as reference for the statistics time.
+static double ReferencePassTime (Image_type* image)
+{
+	size_t				nPixels			= (size_t)ImageWidth * ImageHeight;
+	void*				pixArray		= GetImagePixelArray(image);
+	volatile double		sum				= 0;
+	double				partialSum		= 0;
+	double				startTime		= Timer();
+
+	switch (GetImageType(image)) {
+
+		case Image_UShort:
+			for (size_t i = 0; i < nPixels; i++)
+				partialSum += ((unsigned short*)pixArray)[i];
+			break;
+
+		case Image_Short:
+			for (size_t i = 0; i < nPixels; i++)
+				partialSum += ((short*)pixArray)[i];
+			break;
+
+		case Image_Float:
+			for (size_t i = 0; i < nPixels; i++)
+				partialSum += ((float*)pixArray)[i];
+			break;
+
+		default:
+			break;
+	}
+
+	sum = partialSum;
+
+	return Timer() - startTime;
+}
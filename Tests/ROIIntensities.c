@@ -0,0 +1,207 @@
+//==============================================================================
+//
+// Title:		ROIIntensities.c
+// Purpose:		Benchmark of computing the ROI traces of images.
+//
+// Created on:	19-10-2026 at 21:17:52 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// The sum and mean pixel value of each ROI of 1024 x 1024 unsigned short images are computed repeatedly for three sets of rectangle ROIs: a few small ROIs
+// spread over the image, which are summed directly, many large ROIs overlapping in a part of the image and many large ROIs overlapping over the whole image,
+// which are summed using a summed-area table. For each set the test prints the mean, 99th percentile and longest time per image, together with the time of a
+// single reference pass summing the pixels and the ratio of both. The test checks that the ROI sums equal the sums of their pixels and that ROI intensities
+// are computed at more than the given rate.
+// Build as a console application together with the Framework/Data types and Framework/Iterators sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLabErrHandling.h"
+#include "DataTypes.h"
+
+//==============================================================================
+// Constants
+
+#define ImageWidth						1024		// Width of the images in pixels.
+#define ImageHeight						1024		// Height of the images in pixels.
+#define NSparseROIs						16			// Number of small ROIs spread over the image.
+#define SparseROISize					32			// Width and height of the small ROIs in pixels.
+#define NOverlappingROIs				64			// Number of large overlapping ROIs.
+#define PartialROISize					448			// Width and height of the ROIs overlapping in a part of the image in pixels.
+#define FullROISize						960			// Width and height of the ROIs overlapping over the whole image in pixels.
+#define NRuns							200			// Number of timed images for each ROI set.
+#define MinROIRate						200.0		// Minimum number of images per second for which ROI intensities are computed.
+
+//==============================================================================
+// Static functions
+
+static int						RunROIBenchmark					(Image_type* image, int nROIs, int ROISize, int ROISpacing, char setName[]);
+
+static double					ReferencePassTime				(Image_type* image);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+	unsigned short*		pixels			= NULL;
+	Image_type*			image			= NULL;
+	int					nFailed			= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	if ( !(pixels = malloc(ImageWidth * ImageHeight * sizeof(unsigned short))) ) {
+		printf("Out of memory.\nFAILED\n");
+		return -1;
+	}
+
+	for (size_t i = 0; i < ImageWidth * ImageHeight; i++)
+		pixels[i] = (unsigned short) ((i * 37) % 65536);
+
+	if ( !(image = init_Image_type(Image_UShort, ImageHeight, ImageWidth, (void**)&pixels)) ) {
+		OKfree(pixels);
+		printf("Out of memory.\nFAILED\n");
+		return -1;
+	}
+
+	nFailed += (RunROIBenchmark(image, NSparseROIs, SparseROISize, ImageWidth / NSparseROIs, "Sparse ROIs") < 0);
+	nFailed += (RunROIBenchmark(image, NOverlappingROIs, PartialROISize, 1, "ROIs overlapping in part of the image") < 0);
+	nFailed += (RunROIBenchmark(image, NOverlappingROIs, FullROISize, 1, "ROIs overlapping over the whole image") < 0);
+
+	discard_Image_type(&image);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+/// HIFN Computes the ROI intensities of nROIs square ROIs of ROISize pixels placed diagonally ROISpacing pixels apart.
+static int RunROIBenchmark (Image_type* image, int nROIs, int ROISize, int ROISpacing, char setName[])
+{
+#define RunROIBenchmark_Err_Sum			-1
+#define RunROIBenchmark_Err_Rate		-2
+INIT_ERR
+
+	RGBA_type				ROIColor			= {.G = 255};
+	ListType				ROIList				= 0;
+	Rect_type*				rect				= NULL;
+	ROIMasks_type*			masks				= NULL;
+	unsigned short*			pixels				= GetImagePixelArray(image);
+	double*					sums				= NULL;
+	double*					means				= NULL;
+	double					times[NRuns];
+	double					startTime			= 0;
+	double					totalTime			= 0;
+	double					refTime				= 0;
+	double					pixelSum			= 0;
+	int						offset				= 0;
+
+	nullChk( ROIList = ListCreate(sizeof(ROI_type*)) );
+	for (int i = 0; i < nROIs; i++) {
+		offset = i * ROISpacing;
+		nullChk( rect = initalloc_Rect_type(NULL, "", ROIColor, FALSE, offset, offset, ROISize, ROISize) );
+		nullChk( ListInsertItem(ROIList, &rect, END_OF_LIST) );
+		rect = NULL;
+	}
+
+	nullChk( masks = init_ROIMasks_type(ROIList, ImageWidth, ImageHeight) );
+	nullChk( sums = malloc(nROIs * sizeof(double)) );
+	nullChk( means = malloc(nROIs * sizeof(double)) );
+
+	for (int i = 0; i < NRuns; i++) {
+		startTime = Timer();
+		errChk( GetImageROIIntensities(masks, image, sums, means, &errorInfo.errMsg) );
+		times[i] = Timer() - startTime;
+		totalTime += times[i];
+	}
+	qsort(times, NRuns, sizeof(double), CompareDoubles);
+
+	refTime = ReferencePassTime(image);
+
+	printf("%s, %d ROIs of %d x %d pixels: mean %.2f ms, p99 %.2f ms, max %.2f ms, %.0f images/s; reference pass %.2f ms, ratio %.2f.\n", setName, nROIs,
+		   ROISize, ROISize, totalTime / NRuns * 1e3, Percentile(times, NRuns, 99) * 1e3, times[NRuns-1] * 1e3, NRuns / totalTime, refTime * 1e3,
+		   (refTime > 0) ? totalTime / NRuns / refTime : 0);
+
+	// compare with the sums of the pixels of the ROIs that lie within the image
+	for (int i = 0; i < nROIs; i++) {
+		offset 		= i * ROISpacing;
+		pixelSum	= 0;
+		for (int row = offset; row < offset + ROISize && row < ImageHeight; row++)
+			for (int col = offset; col < offset + ROISize && col < ImageWidth; col++)
+				pixelSum += pixels[(size_t)row * ImageWidth + col];
+
+		if (sums[i] != pixelSum)
+			SET_ERR(RunROIBenchmark_Err_Sum, "The ROI sums differ from the sums of their pixels.");
+	}
+
+	if (NRuns / totalTime < MinROIRate)
+		SET_ERR(RunROIBenchmark_Err_Rate, "The ROI intensities rate is below the limit.");
+
+	OKfree(sums);
+	OKfree(means);
+	discard_ROIMasks_type(&masks);
+	OKfreeList(&ROIList, (DiscardFptr_type)discard_ROI_type);
+
+	return 0;
+
+Error:
+
+	discard_ROI_type((ROI_type**)&rect);
+	OKfree(sums);
+	OKfree(means);
+	discard_ROIMasks_type(&masks);
+	OKfreeList(&ROIList, (DiscardFptr_type)discard_ROI_type);
+
+	printf("%s: %s\n", setName, (errorInfo.errMsg) ? errorInfo.errMsg : "Out of memory.");
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Returns the time of a single pass summing the pixels of an image, as reference for the ROI intensities time.
+static double ReferencePassTime (Image_type* image)
+{
+	size_t				nPixels			= (size_t)ImageWidth * ImageHeight;
+	unsigned short*		pixels			= GetImagePixelArray(image);
+	volatile double		sum				= 0;
+	double				partialSum		= 0;
+	double				startTime		= Timer();
+
+	for (size_t i = 0; i < nPixels; i++)
+		partialSum += pixels[i];
+
+	sum = partialSum;
+
+	return Timer() - startTime;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}
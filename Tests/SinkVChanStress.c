@@ -0,0 +1,259 @@
+//==============================================================================
+//
+// Title:		SinkVChanStress.c
+// Purpose:		Stress test of the Sink VChan overflow policies with a slow consumer.
+//
+// Created on:	19-10-2026 at 10:12:40 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// A fast producer sends waveform data packets, each transmission being terminated by a NULL packet, to a Sink VChan read by a consumer
+// that is much slower than the producer. For each overflow policy the test checks that:
+//	- every data packet is either received or counted as dropped, and no data packet is dropped by SinkVChan_Block,
+//	- every NULL packet is received, in order after the data packets of its transmission,
+//	- the drop counters and metrics can be read while the producer waits for room in the Sink VChan.
+// The test prints for each policy the producer and consumer throughput, the longest SendDataPacket call and the longest time to read the drop counters.
+// Build as a console application together with the Framework/Virtual channels, Framework/Data packets, Framework/Data types and Framework/Iterators sources.
+
+//==============================================================================
+// Include files
+
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLabErrHandling.h"
+#include "VChannel.h"
+#include "DataPacket.h"
+
+//==============================================================================
+// Constants
+
+#define NTransmissions					200			// Number of transmissions sent for each overflow policy.
+#define NPacketsPerTransmission			10			// Number of data packets in each transmission, followed by a NULL packet.
+#define NSamplesPerPacket				10000		// Number of double samples in each data packet.
+#define SinkQueueSize					64			// Maximum number of data packets in the Sink VChan queue.
+#define SinkMaxQueuedPackets			8			// Maximum number of data packets in the Sink VChan queue set through the queued bytes limit.
+#define ConsumerDelay					0.002		// Time in [s] the consumer spends on each data packet.
+#define MonitorInterval					0.001		// Time in [s] between reads of the drop counters.
+#define MaxCounterReadTime				0.01		// Maximum time in [s] reading the drop counters may take.
+
+//==============================================================================
+// Types
+
+typedef struct {
+	SinkVChan_type*			sinkVChan;
+	volatile int			done;					// Set when the producer finished and all NULL packets were received.
+	size_t					nPacketsReceived;
+	size_t					nNullPacketsReceived;
+	size_t					nOrderErrors;			// NULL packets received after fewer data packets than sent before them, for SinkVChan_Block.
+	double					maxCounterReadTime;		// Longest time in [s] to read the drop counters.
+	int						error;
+} StressTest_type;
+
+//==============================================================================
+// Static functions
+
+static int CVICALLBACK			ConsumerThread					(void* functionData);
+
+static int CVICALLBACK			MonitorThread					(void* functionData);
+
+static int						RunStressTest					(SinkVChanOverflowPolicies policy, char policyName[]);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+	int		nFailed		= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	nFailed += (RunStressTest(SinkVChan_Block, "Block") < 0);
+	nFailed += (RunStressTest(SinkVChan_DropNewest, "Drop newest") < 0);
+	nFailed += (RunStressTest(SinkVChan_DropOldest, "Drop oldest") < 0);
+	nFailed += (RunStressTest(SinkVChan_LatestOnly, "Latest only") < 0);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+static int RunStressTest (SinkVChanOverflowPolicies policy, char policyName[])
+{
+#define RunStressTest_Err_LostPackets		-1
+#define RunStressTest_Err_LostNullPackets	-2
+#define RunStressTest_Err_BlockDropped		-3
+#define RunStressTest_Err_Order				-4
+#define RunStressTest_Err_CounterReadTime	-5
+INIT_ERR
+
+	DLDataTypes				dataTypes[]			= {DL_Waveform_Double};
+	SourceVChan_type*		srcVChan			= NULL;
+	SinkVChan_type*			sinkVChan			= NULL;
+	StressTest_type			test				= {0};
+	CmtThreadFunctionID		consumerID			= 0;
+	CmtThreadFunctionID		monitorID			= 0;
+	double*					samples				= NULL;
+	Waveform_type*			waveform			= NULL;
+	DataPacket_type*		dataPacket			= NULL;
+	size_t					nDroppedPackets		= 0;
+	unsigned long long		nDroppedBytes		= 0;
+	size_t					nPacketsSent		= 0;
+	double					startTime			= 0;
+	double					sendStartTime		= 0;
+	double					maxSendTime			= 0;
+	double					producerTime		= 0;
+	double					totalTime			= 0;
+
+	nullChk( srcVChan = init_SourceVChan_type("Stress source", DL_Waveform_Double, NULL, NULL) );
+	nullChk( sinkVChan = init_SinkVChan_type("Stress sink", dataTypes, NumElem(dataTypes), NULL, 10000, NULL) );
+	SetSinkVChanTSQSize(sinkVChan, SinkQueueSize);
+	SetSinkVChanOverflowPolicy(sinkVChan, policy);
+	SetSinkVChanMaxQueuedBytes(sinkVChan, SinkMaxQueuedPackets * NSamplesPerPacket * sizeof(double));
+	VChan_Connect(srcVChan, sinkVChan);
+	SetVChanActive((VChan_type*)srcVChan, TRUE);
+	SetVChanActive((VChan_type*)sinkVChan, TRUE);
+
+	test.sinkVChan = sinkVChan;
+	CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, ConsumerThread, &test, &consumerID) );
+	CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, MonitorThread, &test, &monitorID) );
+
+	// produce data as fast as possible
+	startTime = Timer();
+	for (size_t i = 0; i < NTransmissions; i++) {
+		for (size_t j = 0; j < NPacketsPerTransmission; j++) {
+			nullChk( samples = calloc(NSamplesPerPacket, sizeof(double)) );
+			nullChk( waveform = init_Waveform_type(Waveform_Double, 1e6, NSamplesPerPacket, (void**)&samples) );
+			nullChk( dataPacket = init_DataPacket_type(DL_Waveform_Double, (void**)&waveform, NULL, (DiscardFptr_type)discard_Waveform_type) );
+
+			sendStartTime = Timer();
+			errChk( SendDataPacket(srcVChan, &dataPacket, FALSE, &errorInfo.errMsg) );
+			if (Timer() - sendStartTime > maxSendTime)
+				maxSendTime = Timer() - sendStartTime;
+			nPacketsSent++;
+		}
+
+		errChk( SendNullPacket(srcVChan, &errorInfo.errMsg) );
+	}
+	producerTime = Timer() - startTime;
+
+	CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, consumerID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	test.done = TRUE;
+	CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, monitorID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	totalTime = Timer() - startTime;
+	errChk( test.error );
+
+	GetSinkVChanDropCounters(sinkVChan, &nDroppedPackets, &nDroppedBytes);
+
+	printf("%s: sent %d packets in %.3f s (%.0f packets/s), received %d packets in %.3f s, dropped %d packets (%.2f MB).\n", policyName, (int)nPacketsSent,
+		   producerTime, nPacketsSent / producerTime, (int)test.nPacketsReceived, totalTime, (int)nDroppedPackets, nDroppedBytes / 1048576.0);
+	printf("%s: longest send %.3f ms, longest drop counter read %.3f ms.\n", policyName, maxSendTime * 1e3, test.maxCounterReadTime * 1e3);
+
+	if (test.nPacketsReceived + nDroppedPackets != nPacketsSent)
+		SET_ERR(RunStressTest_Err_LostPackets, "Data packets were neither received nor counted as dropped.");
+
+	if (test.nNullPacketsReceived != NTransmissions)
+		SET_ERR(RunStressTest_Err_LostNullPackets, "NULL packets were lost.");
+
+	if (policy == SinkVChan_Block && nDroppedPackets)
+		SET_ERR(RunStressTest_Err_BlockDropped, "Data packets were dropped by a blocking Sink VChan.");
+
+	if (test.nOrderErrors)
+		SET_ERR(RunStressTest_Err_Order, "NULL packets overtook data packets.");
+
+	if (test.maxCounterReadTime > MaxCounterReadTime)
+		SET_ERR(RunStressTest_Err_CounterReadTime, "Reading the drop counters waited for the producer.");
+
+	discard_VChan_type((VChan_type**)&srcVChan);
+	discard_VChan_type((VChan_type**)&sinkVChan);
+
+	return 0;
+
+CmtError:
+
+Cmt_ERR
+
+Error:
+
+	test.done = TRUE;
+	if (consumerID) CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, consumerID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	if (monitorID) CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, monitorID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+
+	OKfree(samples);
+	discard_Waveform_type(&waveform);
+	ReleaseDataPacket(&dataPacket);
+	discard_VChan_type((VChan_type**)&srcVChan);
+	discard_VChan_type((VChan_type**)&sinkVChan);
+
+	printf("%s: %s\n", policyName, errorInfo.errMsg);
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Reads data packets slowly until all NULL packets were received.
+static int CVICALLBACK ConsumerThread (void* functionData)
+{
+INIT_ERR
+
+	StressTest_type*		test					= functionData;
+	DataPacket_type*		dataPacket				= NULL;
+	size_t					nTransmissionPackets	= 0;
+
+	while (test->nNullPacketsReceived < NTransmissions && !test->done) {
+		errChk( GetDataPacket(test->sinkVChan, &dataPacket, &errorInfo.errMsg) );
+
+		if (!dataPacket) {
+			// a blocking Sink VChan delivers all data packets of a transmission before its NULL packet
+			if (GetSinkVChanOverflowPolicy(test->sinkVChan) == SinkVChan_Block && nTransmissionPackets != NPacketsPerTransmission)
+				test->nOrderErrors++;
+			test->nNullPacketsReceived++;
+			nTransmissionPackets = 0;
+			continue;
+		}
+
+		SyncWait(Timer(), ConsumerDelay);
+		ReleaseDataPacket(&dataPacket);
+		test->nPacketsReceived++;
+		nTransmissionPackets++;
+	}
+
+	return 0;
+
+Error:
+
+	test->error = errorInfo.error;
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Reads the drop counters and metrics like the UI does while data is sent, and records the longest read.
+static int CVICALLBACK MonitorThread (void* functionData)
+{
+	StressTest_type*		test				= functionData;
+	size_t					nDroppedPackets		= 0;
+	unsigned long long		nDroppedBytes		= 0;
+	VChanMetrics_type		metrics;
+	double					readStartTime		= 0;
+	double					readTime			= 0;
+
+	while (!test->done) {
+		readStartTime = Timer();
+		GetSinkVChanDropCounters(test->sinkVChan, &nDroppedPackets, &nDroppedBytes);
+		GetVChanMetrics((VChan_type*)test->sinkVChan, &metrics);
+		readTime = Timer() - readStartTime;
+		if (readTime > test->maxCounterReadTime)
+			test->maxCounterReadTime = readTime;
+
+		SyncWait(Timer(), MonitorInterval);
+	}
+
+	return 0;
+}
@@ -0,0 +1,307 @@
+//==============================================================================
+//
+// Title:		TCAbortLatency.c
+// Purpose:		Stress test of the Task Controller stop latency under a high data event load.
+//
+// Created on:	19-10-2026 at 17:04:51 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// A producer thread sends data packets at 100 kHz to a Sink VChan registered with a continuous Task Controller whose iterations complete right away.
+// The Task Controller is started and stopped repeatedly while data is sent and the test measures the time from sending TC_Event_Stop until the
+// Task Controller is done. The test prints the achieved data rate, the number of data received events, the stop latency as min, mean, median,
+// 99th percentile and max, together with the control event latency recorded by the Task Controller. The test checks that all stops completed,
+// that data was received while running and that the longest stop latency is below the given limit.
+// Build as a console application together with the Framework/Execution control, Framework/Virtual channels, Framework/Data packets, Framework/Data types,
+// Framework/Iterators and Framework/HW triggering sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLabErrHandling.h"
+#include "TaskController.h"
+#include "VChannel.h"
+#include "DataPacket.h"
+
+//==============================================================================
+// Constants
+
+#define DataRate						1e5			// Rate in [Hz] at which the producer sends data packets.
+#define NStops							100			// Number of times the Task Controller is started and stopped.
+#define RunTime							0.05		// Time in [s] the Task Controller runs before it is stopped.
+#define StopTimeout						5.0			// Maximum time in [s] to wait for the Task Controller to be done after it was stopped.
+#define SinkQueueSize					100000		// Maximum number of data packets in the Sink VChan queue.
+#define MaxStopLatency					10.0		// Maximum time in [ms] from sending TC_Event_Stop until the Task Controller is done.
+
+//==============================================================================
+// Types
+
+typedef struct {
+	SourceVChan_type*		srcVChan;
+	volatile int			stopProducer;			// Set to stop the producer thread.
+	volatile int			done;					// Set by the Task Controller when it is done.
+	volatile int			error;					// Set when the Task Controller or the producer encountered an error.
+	double					doneTime;				// Time in [s] given by Timer() when the Task Controller was done.
+	size_t					nPacketsSent;
+	size_t					nPacketsReceived;
+	double					sendTime;				// Time in [s] the producer was sending data.
+} AbortTest_type;
+
+//==============================================================================
+// Static functions
+
+static int CVICALLBACK			ProducerThread					(void* functionData);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+static void						IterateTC_Abort					(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag);
+
+static int						DoneTC_Abort					(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg);
+
+static void						ErrorTC_Abort					(TaskControl_type* taskControl, int errorID, char errorMsg[]);
+
+static int						DataReceivedTC_Abort			(TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, SinkVChan_type* sinkVChan, BOOL const* abortFlag, char** errorMsg);
+
+//==============================================================================
+// Global functions
+
+void CVICALLBACK 				DLThreadPoolFunctionCallback 	(CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void* callbackData);
+
+int main (int argc, char *argv[])
+{
+#define main_Err_Timeout			-1
+#define main_Err_TCError			-2
+#define main_Err_NoData				-3
+#define main_Err_StopLatency		-4
+INIT_ERR
+
+	DLDataTypes					dataTypes[]				= {DL_Waveform_Double};
+	AbortTest_type				test					= {0};
+	TaskControl_type*			taskControl				= NULL;
+	SinkVChan_type*				sinkVChan				= NULL;
+	CmtThreadFunctionID			producerID				= 0;
+	double						stopLatencies[NStops]	= {0};
+	double						meanStopLatency			= 0;
+	double						stopTime				= 0;
+	TCLatencyHistogram_type		controlEventLatency		= {0};
+	unsigned long long			nDataEvents				= 0;
+	unsigned long long			nCoalescedDataEvents	= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	nullChk( test.srcVChan = init_SourceVChan_type("Abort source", DL_Waveform_Double, NULL, NULL) );
+	nullChk( sinkVChan = init_SinkVChan_type("Abort sink", dataTypes, NumElem(dataTypes), NULL, 10000, NULL) );
+	SetSinkVChanTSQSize(sinkVChan, SinkQueueSize);
+	SetSinkVChanOverflowPolicy(sinkVChan, SinkVChan_DropOldest);
+	VChan_Connect(test.srcVChan, sinkVChan);
+	SetVChanActive((VChan_type*)test.srcVChan, TRUE);
+	SetVChanActive((VChan_type*)sinkVChan, TRUE);
+
+	nullChk( taskControl = init_TaskControl_type("Abort", &test, DEFAULT_THREAD_POOL_HANDLE, NULL, NULL, IterateTC_Abort, NULL, NULL, DoneTC_Abort, NULL, NULL, NULL, NULL, NULL, ErrorTC_Abort) );
+	SetTaskControlMode(taskControl, TASK_CONTINUOUS);
+	errChk( AddSinkVChan(taskControl, sinkVChan, DataReceivedTC_Abort, &errorInfo.errMsg) );
+	errChk( TaskControlEvent(taskControl, TC_Event_Configure, NULL, NULL, &errorInfo.errMsg) );
+
+	CmtErrChk( CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, ProducerThread, &test, &producerID) );
+
+	// start and stop the Task Controller while data is sent
+	for (size_t i = 0; i < NStops; i++) {
+		test.done = FALSE;
+		errChk( TaskControlEvent(taskControl, TC_Event_Start, NULL, NULL, &errorInfo.errMsg) );
+		Sleep((DWORD)(RunTime * 1e3));
+
+		stopTime = Timer();
+		errChk( TaskControlEvent(taskControl, TC_Event_Stop, NULL, NULL, &errorInfo.errMsg) );
+		while (!test.done && !test.error) {
+			if (Timer() - stopTime > StopTimeout)
+				SET_ERR(main_Err_Timeout, "Task Controller was not done in time after it was stopped.");
+			Sleep(0);
+		}
+
+		if (test.error)
+			SET_ERR(main_Err_TCError, "Task Controller error.");
+
+		stopLatencies[i] = (test.doneTime - stopTime) * 1e3;
+		meanStopLatency += stopLatencies[i] / NStops;
+	}
+
+	test.stopProducer = TRUE;
+	CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, producerID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	producerID = 0;
+
+	qsort(stopLatencies, NStops, sizeof(double), CompareDoubles);
+	GetTaskControlMetrics(taskControl, NULL, NULL, &controlEventLatency, NULL);
+	GetTaskControlDataEventCounts(taskControl, &nDataEvents, &nCoalescedDataEvents);
+
+	printf("Sent %d packets in %.3f s (%.0f packets/s), received %d packets in %llu data received events, %llu data arrivals coalesced.\n", (int)test.nPacketsSent,
+		   test.sendTime, test.nPacketsSent / test.sendTime, (int)test.nPacketsReceived, nDataEvents, nCoalescedDataEvents);
+	printf("Stop latency over %d stops: min %.3f ms, mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms.\n", NStops, stopLatencies[0], meanStopLatency,
+		   Percentile(stopLatencies, NStops, 50), Percentile(stopLatencies, NStops, 99), stopLatencies[NStops-1]);
+	printf("Control event latency: %d events, mean %.3f ms, p99 < %.3f ms, max %.3f ms.\n", (int)controlEventLatency.nCalls,
+		   (controlEventLatency.nCalls) ? controlEventLatency.totalTime / controlEventLatency.nCalls : 0, GetTCLatencyPercentile(&controlEventLatency, 99), controlEventLatency.maxTime);
+
+	if (!nDataEvents)
+		SET_ERR(main_Err_NoData, "No data was received.");
+
+	if (stopLatencies[NStops-1] > MaxStopLatency)
+		SET_ERR(main_Err_StopLatency, "The stop latency exceeds the limit.");
+
+	RemoveAllSinkVChans(taskControl, NULL);
+	discard_TaskControl_type(&taskControl);
+	discard_VChan_type((VChan_type**)&test.srcVChan);
+	discard_VChan_type((VChan_type**)&sinkVChan);
+
+	printf("PASSED\n");
+
+	return 0;
+
+CmtError:
+
+Cmt_ERR
+
+Error:
+
+	test.stopProducer = TRUE;
+	if (producerID) CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, producerID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+
+	if (taskControl) RemoveAllSinkVChans(taskControl, NULL);
+	discard_TaskControl_type(&taskControl);
+	discard_VChan_type((VChan_type**)&test.srcVChan);
+	discard_VChan_type((VChan_type**)&sinkVChan);
+
+	printf("%s\nFAILED\n", errorInfo.errMsg);
+	OKfree(errorInfo.errMsg);
+
+	return -1;
+}
+
+/// HIFN Thread pool callback required by the Task Controller, which is provided by DAQLab in the application.
+void CVICALLBACK DLThreadPoolFunctionCallback (CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void* callbackData)
+{
+}
+
+/// HIFN Sends single sample data packets at DataRate until stopped.
+static int CVICALLBACK ProducerThread (void* functionData)
+{
+INIT_ERR
+
+	AbortTest_type*			test			= functionData;
+	double*					samples			= NULL;
+	Waveform_type*			waveform		= NULL;
+	DataPacket_type*		dataPacket		= NULL;
+	LARGE_INTEGER			frequency;
+	LARGE_INTEGER			startTicks;
+	LARGE_INTEGER			nowTicks;
+	double					startTime		= Timer();
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&startTicks);
+
+	while (!test->stopProducer) {
+		// wait until the next packet is due, the interval is too short to sleep
+		do {
+			QueryPerformanceCounter(&nowTicks);
+		} while ((double)(nowTicks.QuadPart - startTicks.QuadPart) / frequency.QuadPart < test->nPacketsSent / DataRate);
+
+		nullChk( samples = calloc(1, sizeof(double)) );
+		nullChk( waveform = init_Waveform_type(Waveform_Double, DataRate, 1, (void**)&samples) );
+		nullChk( dataPacket = init_DataPacket_type(DL_Waveform_Double, (void**)&waveform, NULL, (DiscardFptr_type)discard_Waveform_type) );
+		errChk( SendDataPacket(test->srcVChan, &dataPacket, FALSE, &errorInfo.errMsg) );
+		test->nPacketsSent++;
+	}
+
+	test->sendTime = Timer() - startTime;
+
+	return 0;
+
+Error:
+
+	OKfree(samples);
+	discard_Waveform_type(&waveform);
+	ReleaseDataPacket(&dataPacket);
+
+	printf("Producer error: %s\n", errorInfo.errMsg);
+	OKfree(errorInfo.errMsg);
+	test->sendTime	= Timer() - startTime;
+	test->error		= TRUE;
+
+	return errorInfo.error;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller Callbacks
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void IterateTC_Abort (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag)
+{
+	TaskControlIterationDone(taskControl, 0, "", FALSE, NULL);
+}
+
+static int DoneTC_Abort (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg)
+{
+	AbortTest_type*		test	= GetTaskControlModuleData(taskControl);
+
+	test->doneTime	= Timer();
+	test->done		= TRUE;
+
+	return 0;
+}
+
+static void ErrorTC_Abort (TaskControl_type* taskControl, int errorID, char errorMsg[])
+{
+	AbortTest_type*		test	= GetTaskControlModuleData(taskControl);
+
+	printf("Task Controller error %d: %s\n", errorID, errorMsg);
+	test->error = TRUE;
+}
+
+static int DataReceivedTC_Abort (TaskControl_type* taskControl, TCStates taskState, BOOL taskActive, SinkVChan_type* sinkVChan, BOOL const* abortFlag, char** errorMsg)
+{
+INIT_ERR
+
+	AbortTest_type*		test			= GetTaskControlModuleData(taskControl);
+	DataPacket_type**	dataPackets		= NULL;
+	size_t				nPackets		= 0;
+
+	errChk( GetAllDataPackets(sinkVChan, &dataPackets, &nPackets, &errorInfo.errMsg) );
+
+	for (size_t i = 0; i < nPackets; i++)
+		ReleaseDataPacket(&dataPackets[i]);
+
+	OKfree(dataPackets);
+	test->nPacketsReceived += nPackets;
+
+	return 0;
+
+Error:
+
+RETURN_ERR
+}
@@ -0,0 +1,233 @@
+//==============================================================================
+//
+// Title:		TCTimerJitter.c
+// Purpose:		Jitter report of Task Controller iterations waiting between iterations.
+//
+// Created on:	19-10-2026 at 15:36:12 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// A finite Task Controller without child TCs is iterated with a wait between iterations of 1 ms, 10 ms, 100 ms, 1 s and 10 s. The iteration function
+// records its start time and completes right away. For each wait the test prints the delay of the iteration starts from their ideal schedule, i.e. the
+// start of the first iteration plus a multiple of the wait, as min, mean, median, 95th and 99th percentile and max, together with the iteration jitter
+// recorded by the Task Controller. The test checks that all iterations were performed, that no iteration started before it was due and that the
+// 99th percentile of the delay is below the given limit.
+// Build as a console application together with the Framework/Execution control, Framework/Virtual channels, Framework/Data packets, Framework/Data types,
+// Framework/Iterators and Framework/HW triggering sources.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLabErrHandling.h"
+#include "TaskController.h"
+
+//==============================================================================
+// Constants
+
+#define MaxIterations					1000		// Maximum number of iterations for each wait between iterations.
+#define MaxRunTime						60.0		// Maximum time in [s] for the iterations of each wait between iterations to complete.
+#define MaxDelayP99						2.0			// Maximum 99th percentile of the iteration delay in [ms].
+#define EarlyStartTolerance				0.01		// Time in [ms] an iteration may start before it is due, accounting for the conversion of the timer ticks.
+
+//==============================================================================
+// Types
+
+typedef struct {
+	double					period;					// Wait between iterations in [s].
+	size_t					nIterations;			// Number of iterations.
+} JitterRun_type;
+
+typedef struct {
+	LARGE_INTEGER			startTimes[MaxIterations];	// Start times of the iteration functions in performance counter ticks.
+	volatile size_t			nIterations;			// Number of iterations performed.
+	volatile int			done;					// Set when the Task Controller is done.
+	volatile int			error;					// Set when the Task Controller encountered an error.
+} JitterTest_type;
+
+//==============================================================================
+// Static global variables
+
+static JitterRun_type			jitterRuns[]				= {{0.001, 1000}, {0.01, 500}, {0.1, 100}, {1, 20}, {10, 5}};
+
+//==============================================================================
+// Static functions
+
+static int						RunJitterTest					(double period, size_t nIterations);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+static void						IterateTC_Jitter				(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag);
+
+static int						DoneTC_Jitter					(TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg);
+
+static void						ErrorTC_Jitter					(TaskControl_type* taskControl, int errorID, char errorMsg[]);
+
+//==============================================================================
+// Global functions
+
+void CVICALLBACK 				DLThreadPoolFunctionCallback 	(CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void* callbackData);
+
+int main (int argc, char *argv[])
+{
+	int		nFailed		= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	for (size_t i = 0; i < NumElem(jitterRuns); i++)
+		nFailed += (RunJitterTest(jitterRuns[i].period, jitterRuns[i].nIterations) < 0);
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+/// HIFN Thread pool callback required by the Task Controller, which is provided by DAQLab in the application.
+void CVICALLBACK DLThreadPoolFunctionCallback (CmtThreadPoolHandle poolHandle, CmtThreadFunctionID functionID, unsigned int event, int value, void* callbackData)
+{
+}
+
+static int RunJitterTest (double period, size_t nIterations)
+{
+#define RunJitterTest_Err_Timeout			-1
+#define RunJitterTest_Err_TCError			-2
+#define RunJitterTest_Err_MissingIterations	-3
+#define RunJitterTest_Err_EarlyStart		-4
+#define RunJitterTest_Err_Delay				-5
+INIT_ERR
+
+	TaskControl_type*			taskControl			= NULL;
+	JitterTest_type*			test				= NULL;
+	double*						delays				= NULL;
+	TCLatencyHistogram_type		iterationJitter		= {0};
+	LARGE_INTEGER				frequency;
+	double						startTime			= 0;
+	double						meanDelay			= 0;
+	double						p99Delay			= 0;
+	size_t						nDelays				= 0;
+
+	nullChk( test = calloc(1, sizeof(JitterTest_type)) );
+	QueryPerformanceFrequency(&frequency);
+
+	nullChk( taskControl = init_TaskControl_type("Jitter", test, DEFAULT_THREAD_POOL_HANDLE, NULL, NULL, IterateTC_Jitter, NULL, NULL, DoneTC_Jitter, NULL, NULL, NULL, NULL, NULL, ErrorTC_Jitter) );
+	SetTaskControlMode(taskControl, TASK_FINITE);
+	SetTaskControlIterations(taskControl, nIterations);
+	SetTaskControlIterationsWait(taskControl, period);
+
+	errChk( TaskControlEvent(taskControl, TC_Event_Configure, NULL, NULL, &errorInfo.errMsg) );
+	errChk( TaskControlEvent(taskControl, TC_Event_Start, NULL, NULL, &errorInfo.errMsg) );
+
+	// wait for the iterations to complete
+	startTime = Timer();
+	while (!test->done && !test->error) {
+		if (Timer() - startTime > nIterations * period + MaxRunTime)
+			SET_ERR(RunJitterTest_Err_Timeout, "Iterations did not complete in time.");
+		Sleep(10);
+	}
+
+	if (test->error)
+		SET_ERR(RunJitterTest_Err_TCError, "Task Controller error.");
+
+	if (test->nIterations != nIterations)
+		SET_ERR(RunJitterTest_Err_MissingIterations, "Not all iterations were performed.");
+
+	// delays in [ms] of the iteration starts from the ideal schedule
+	nDelays = nIterations - 1;
+	nullChk( delays = malloc(nDelays * sizeof(double)) );
+	for (size_t i = 0; i < nDelays; i++) {
+		delays[i] = ((double)(test->startTimes[i+1].QuadPart - test->startTimes[0].QuadPart) / frequency.QuadPart - (i+1) * period) * 1e3;
+		meanDelay += delays[i] / nDelays;
+	}
+	qsort(delays, nDelays, sizeof(double), CompareDoubles);
+	p99Delay = Percentile(delays, nDelays, 99);
+
+	GetTaskControlMetrics(taskControl, NULL, NULL, NULL, &iterationJitter);
+
+	printf("Wait %g s, %d iterations: delay min %.3f ms, mean %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms.\n", period, (int)nIterations, delays[0],
+		   meanDelay, Percentile(delays, nDelays, 50), Percentile(delays, nDelays, 95), p99Delay, delays[nDelays-1]);
+	printf("Wait %g s, Task Controller iteration jitter: %d iterations, mean %.3f ms, p99 < %.3f ms, max %.3f ms.\n", period, (int)iterationJitter.nCalls,
+		   (iterationJitter.nCalls) ? iterationJitter.totalTime / iterationJitter.nCalls : 0, GetTCLatencyPercentile(&iterationJitter, 99), iterationJitter.maxTime);
+
+	if (delays[0] < -EarlyStartTolerance)
+		SET_ERR(RunJitterTest_Err_EarlyStart, "Iterations started before they were due.");
+
+	if (p99Delay > MaxDelayP99)
+		SET_ERR(RunJitterTest_Err_Delay, "The 99th percentile of the iteration delay exceeds the limit.");
+
+	OKfree(delays);
+	discard_TaskControl_type(&taskControl);
+	OKfree(test);
+
+	return 0;
+
+Error:
+
+	OKfree(delays);
+	discard_TaskControl_type(&taskControl);
+	OKfree(test);
+
+	printf("Wait %g s: %s\n", period, errorInfo.errMsg);
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// Task Controller Callbacks
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static void IterateTC_Jitter (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortIterationFlag)
+{
+	JitterTest_type*	test	= GetTaskControlModuleData(taskControl);
+
+	if (test->nIterations < MaxIterations)
+		QueryPerformanceCounter(&test->startTimes[test->nIterations]);
+
+	test->nIterations++;
+
+	TaskControlIterationDone(taskControl, 0, "", FALSE, NULL);
+}
+
+static int DoneTC_Jitter (TaskControl_type* taskControl, Iterator_type* iterator, BOOL const* abortFlag, char** errorMsg)
+{
+	JitterTest_type*	test	= GetTaskControlModuleData(taskControl);
+
+	test->done = TRUE;
+
+	return 0;
+}
+
+static void ErrorTC_Jitter (TaskControl_type* taskControl, int errorID, char errorMsg[])
+{
+	JitterTest_type*	test	= GetTaskControlModuleData(taskControl);
+
+	printf("Task Controller error %d: %s\n", errorID, errorMsg);
+	test->error = TRUE;
+}
@@ -0,0 +1,212 @@
+//==============================================================================
+//
+// Title:		ThreadPoolOversubscription.c
+// Purpose:		Benchmark of the start delay of replay functions while storage functions occupy their thread pool.
+//
+// Created on:	19-10-2026 at 20:41:08 by agent.
+// Copyright:	Vrije Universiteit Amsterdam. All Rights Reserved.
+// License:     This Source Code Form is subject to the terms of the Mozilla Public
+//              License v. 2.0. If a copy of the MPL was not distributed with this
+//              file, you can obtain one at https://mozilla.org/MPL/2.0/ .
+//
+//==============================================================================
+
+// Long running functions standing in for data storage Task Controllers are scheduled until they occupy every thread of a pool with the default number of
+// storage threads. Short functions standing in for data replay Task Controllers are then scheduled once in the same pool, as when storage and replay shared
+// a pool, and once in a separate pool with the default number of replay threads. For both cases the test prints the min, mean, 99th percentile and max delay
+// from scheduling a replay function until it starts. The test checks that replay functions in the separate pool start within the given limit, while in the
+// shared pool they wait for the storage functions to end.
+// Build as a console application, no framework sources are needed.
+
+//==============================================================================
+// Include files
+
+#include <windows.h>
+#include <cvirte.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "toolbox.h"
+#include "DAQLabErrHandling.h"
+
+//==============================================================================
+// Constants
+
+#define NStoragePoolThreads				4			// Default number of threads of the storage thread pool.
+#define NReplayPoolThreads				4			// Default number of threads of the replay thread pool.
+#define NStorageFunctions				4			// Number of long running storage functions, enough to occupy the storage thread pool.
+#define NReplayFunctions				100			// Number of replay functions for each case.
+#define StorageFunctionDuration			2.0			// Time in [s] each storage function runs.
+#define MaxStartDelayP99				5.0			// Maximum 99th percentile of the replay start delay in [ms] in the separate pool.
+
+//==============================================================================
+// Types
+
+typedef struct {
+	double					scheduleTime;			// Time when the replay function was scheduled.
+	double					startTime;				// Time when the replay function started.
+	CmtThreadFunctionID		functionID;
+} ReplayFunction_type;
+
+//==============================================================================
+// Static functions
+
+static int						RunReplayBenchmark				(BOOL sharedPool, double* startDelayP99Ptr);
+
+static int CVICALLBACK			StorageFunction					(void* functionData);
+
+static int CVICALLBACK			ReplayFunction					(void* functionData);
+
+static int						CompareDoubles					(const void* item1, const void* item2);
+
+static double					Percentile						(double sortedValues[], size_t nValues, double percentile);
+
+//==============================================================================
+// Global functions
+
+int main (int argc, char *argv[])
+{
+	double		sharedDelayP99			= 0;
+	double		separateDelayP99		= 0;
+	int			nFailed					= 0;
+
+	if (InitCVIRTE (0, argv, 0) == 0)
+		return -1;	/* out of memory */
+
+	nFailed += (RunReplayBenchmark(TRUE, &sharedDelayP99) < 0);
+	nFailed += (RunReplayBenchmark(FALSE, &separateDelayP99) < 0);
+
+	if (separateDelayP99 > MaxStartDelayP99) {
+		printf("The 99th percentile of the replay start delay in the separate pool exceeds the limit.\n");
+		nFailed++;
+	}
+
+	if (sharedDelayP99 <= separateDelayP99) {
+		printf("Replay functions in the shared pool did not wait for the storage functions.\n");
+		nFailed++;
+	}
+
+	printf("%s\n", (nFailed) ? "FAILED" : "PASSED");
+
+	return (nFailed) ? -1 : 0;
+}
+
+static int RunReplayBenchmark (BOOL sharedPool, double* startDelayP99Ptr)
+{
+INIT_ERR
+
+	CmtThreadPoolHandle		storagePool							= 0;
+	CmtThreadPoolHandle		replayPool							= 0;
+	CmtThreadFunctionID		storageIDs[NStorageFunctions]		= {0};
+	ReplayFunction_type		replayFunctions[NReplayFunctions];
+	double					startDelays[NReplayFunctions];
+	double					meanDelay							= 0;
+	char*					caseName							= (sharedPool) ? "Shared pool" : "Separate pools";
+
+	memset(replayFunctions, 0, sizeof(replayFunctions));
+
+	CmtErrChk( CmtNewThreadPool(NStoragePoolThreads, &storagePool) );
+	if (sharedPool)
+		replayPool = storagePool;
+	else
+		CmtErrChk( CmtNewThreadPool(NReplayPoolThreads, &replayPool) );
+
+	// occupy the storage pool
+	for (int i = 0; i < NStorageFunctions; i++)
+		CmtErrChk( CmtScheduleThreadPoolFunction(storagePool, StorageFunction, NULL, &storageIDs[i]) );
+
+	// let the storage functions start before scheduling the replay functions
+	Delay(0.1);
+
+	for (int i = 0; i < NReplayFunctions; i++) {
+		replayFunctions[i].scheduleTime = Timer();
+		CmtErrChk( CmtScheduleThreadPoolFunction(replayPool, ReplayFunction, &replayFunctions[i], &replayFunctions[i].functionID) );
+	}
+
+	for (int i = 0; i < NReplayFunctions; i++) {
+		CmtWaitForThreadPoolFunctionCompletion(replayPool, replayFunctions[i].functionID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+		CmtReleaseThreadPoolFunctionID(replayPool, replayFunctions[i].functionID);
+		startDelays[i] = (replayFunctions[i].startTime - replayFunctions[i].scheduleTime) * 1e3;
+		meanDelay += startDelays[i] / NReplayFunctions;
+	}
+
+	for (int i = 0; i < NStorageFunctions; i++) {
+		CmtWaitForThreadPoolFunctionCompletion(storagePool, storageIDs[i], OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+		CmtReleaseThreadPoolFunctionID(storagePool, storageIDs[i]);
+	}
+
+	if (!sharedPool)
+		CmtDiscardThreadPool(replayPool);
+	CmtDiscardThreadPool(storagePool);
+
+	qsort(startDelays, NReplayFunctions, sizeof(double), CompareDoubles);
+
+	printf("%s, %d storage functions of %.1f s on %d threads, %d replay functions: start delay min %.2f ms, mean %.2f ms, p99 %.2f ms, max %.2f ms.\n", caseName,
+		   NStorageFunctions, StorageFunctionDuration, NStoragePoolThreads, NReplayFunctions, startDelays[0], meanDelay, Percentile(startDelays, NReplayFunctions, 99),
+		   startDelays[NReplayFunctions-1]);
+
+	*startDelayP99Ptr = Percentile(startDelays, NReplayFunctions, 99);
+
+	return 0;
+
+CmtError:
+
+Cmt_ERR
+
+Error:
+
+	for (int i = 0; i < NStorageFunctions; i++)
+		if (storageIDs[i]) {
+			CmtWaitForThreadPoolFunctionCompletion(storagePool, storageIDs[i], OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+			CmtReleaseThreadPoolFunctionID(storagePool, storageIDs[i]);
+		}
+
+	for (int i = 0; i < NReplayFunctions; i++)
+		if (replayFunctions[i].functionID) {
+			CmtWaitForThreadPoolFunctionCompletion(replayPool, replayFunctions[i].functionID, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+			CmtReleaseThreadPoolFunctionID(replayPool, replayFunctions[i].functionID);
+		}
+
+	if (replayPool && !sharedPool)
+		CmtDiscardThreadPool(replayPool);
+	if (storagePool)
+		CmtDiscardThreadPool(storagePool);
+
+	printf("%s: %s\n", caseName, (errorInfo.errMsg) ? errorInfo.errMsg : "Out of memory.");
+	OKfree(errorInfo.errMsg);
+
+	return errorInfo.error;
+}
+
+/// HIFN Stands in for a data storage Task Controller, which holds a pool thread while it runs.
+static int CVICALLBACK StorageFunction (void* functionData)
+{
+	Delay(StorageFunctionDuration);
+
+	return 0;
+}
+
+/// HIFN Stands in for a data replay Task Controller and records when it starts.
+static int CVICALLBACK ReplayFunction (void* functionData)
+{
+	ReplayFunction_type*	replayFunction	= functionData;
+
+	replayFunction->startTime = Timer();
+
+	return 0;
+}
+
+static int CompareDoubles (const void* item1, const void* item2)
+{
+	double	value1	= *(const double*)item1;
+	double	value2	= *(const double*)item2;
+
+	return (value1 > value2) - (value1 < value2);
+}
+
+/// HIFN Returns the given percentile (0 - 100) of sorted values using the nearest rank.
+static double Percentile (double sortedValues[], size_t nValues, double percentile)
+{
+	size_t	rank	= (size_t) ceil(percentile / 100 * nValues);
+
+	return sortedValues[(rank) ? rank - 1 : 0];
+}